@@ -63,8 +63,8 @@ typedef struct faultd_info_s {
      * This will store the output from backtrace_symbols_fd(). 
      *
      * When writing the message to the pipe, set it to non-zero. 
-     * The reader will then read additional bytes until the null 
-     * terminating byte is found. 
+     * The symbols are then captured and sent as part of the
+     * fault record, truncated to fit FAULTD_CONFIG_RECORD_SIZE_MAX. 
      *
      * The pointer will then be replaced on the receiving side. 
      *
@@ -141,6 +141,26 @@ int faultd_server_read(faultd_server_t* fso, faultd_info_t* info,
 int faultd_server_process(faultd_server_t* fso, faultd_sid_t sid, 
                           int count, aim_pvs_t* pvs, int decode);
 
+/**
+ * @brief Keep a copy of every received fault in a ring file.
+ * @param fso The faultd server object.
+ * @param filename The ring file. NULL disables the ring.
+ * @param records The number of records to keep.
+ * @note The file is created if necessary. Existing records are kept
+ * if the file has the same geometry.
+ * @note FAULTD_CONFIG_RING_RECORDS will be used if records <= 0.
+ */
+int faultd_server_ring_set(faultd_server_t* fso, const char* filename,
+                           int records);
+
+/**
+ * @brief Show all records in a fault ring file, oldest first.
+ * @param filename The ring file.
+ * @param pvs The output pvs passed to faultd_info_show()
+ * @param decode Passed to faultd_info_show()
+ */
+int faultd_ring_show(const char* filename, aim_pvs_t* pvs, int decode);
+
 
 /**************************************************************************//**
  *
@@ -165,6 +185,8 @@ int faultd_client_create(faultd_client_t** fco, const char* pipename);
  * @note If backtrace_symbols is not NULL, the
  * backtrace_symbols_fd() will be called on the backtrace 
  * and included in the report. 
+ * @note Records are framed and versioned. A server only accepts
+ * records from clients built with the same record version.
  */
 int faultd_client_write(faultd_client_t* fco, faultd_info_t* info); 
 
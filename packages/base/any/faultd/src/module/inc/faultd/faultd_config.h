@@ -158,6 +158,36 @@
 #define FAULTD_CONFIG_BACKTRACE_SYMBOLS_SIZE 4096
 #endif
 
+/**
+ * FAULTD_CONFIG_RECORD_SIZE_MAX
+ *
+ * Maximum size of an encoded fault record. Records no larger than PIPE_BUF are written to the pipe atomically. */
+
+
+#ifndef FAULTD_CONFIG_RECORD_SIZE_MAX
+#define FAULTD_CONFIG_RECORD_SIZE_MAX 4096
+#endif
+
+/**
+ * FAULTD_CONFIG_READ_TIMEOUT_MS
+ *
+ * Partial records which are not completed within this time are discarded. */
+
+
+#ifndef FAULTD_CONFIG_READ_TIMEOUT_MS
+#define FAULTD_CONFIG_READ_TIMEOUT_MS 1000
+#endif
+
+/**
+ * FAULTD_CONFIG_RING_RECORDS
+ *
+ * Number of records kept in the fault ring file. */
+
+
+#ifndef FAULTD_CONFIG_RING_RECORDS
+#define FAULTD_CONFIG_RING_RECORDS 128
+#endif
+
 /**
  * FAULTD_CONFIG_INCLUDE_MAIN
  *
@@ -188,6 +218,16 @@
 #define FAULTD_CONFIG_MAIN_PIPENAME "/var/run/faultd.fifo"
 #endif
 
+/**
+ * FAULTD_CONFIG_MAIN_RING_FILE
+ *
+ * Default fault ring file used by faultd_main() if included. */
+
+
+#ifndef FAULTD_CONFIG_MAIN_RING_FILE
+#define FAULTD_CONFIG_MAIN_RING_FILE "/var/log/faultd.ring"
+#endif
+
 
 
 /**
@@ -23,13 +23,111 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
 
 #include <execinfo.h>
+#include <AIM/aim_time.h>
 #include "faultd_log.h"
 
+#if FAULTD_CONFIG_RECORD_SIZE_MAX > PIPE_BUF
+#error FAULTD_CONFIG_RECORD_SIZE_MAX must not exceed PIPE_BUF or records may interleave.
+#endif
+
+/**
+ * Fault Record Wire Format
+ *
+ * Every fault is sent as a single self-describing record:
+ *
+ *   faultd_record_hdr_t
+ *   faultd_record_info_t
+ *   uint64_t backtrace[backtrace_size]
+ *   char binary[binary_len]
+ *   char symbols[symbols_len]
+ *
+ * All fields are in host byte order (client and server are always
+ * on the same host). The record is written with a single write()
+ * no larger than PIPE_BUF, so records from concurrent clients never
+ * interleave in the pipe. The magic value lets the server resynchronize
+ * if it ever finds itself in the middle of garbage.
+ *
+ * Compatibility: this replaces the original stream of a raw
+ * faultd_info_t followed by NUL-terminated symbols. The two formats
+ * do not interoperate, so clients and the server must come from the
+ * same faultd. The server discards (and logs) old-format data and
+ * records with a different FAULTD_RECORD_VERSION, which must be
+ * incremented on any change to the layout below.
+ */
+#define FAULTD_RECORD_MAGIC 0x464c5444 /* "FLTD" */
+#define FAULTD_RECORD_VERSION 1
+
+typedef struct faultd_record_hdr_s {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    /** Length of the record following this header */
+    uint32_t length;
+} faultd_record_hdr_t;
+
+typedef struct faultd_record_info_s {
+    int32_t pid;
+    int32_t tid;
+    int32_t signal;
+    int32_t signal_code;
+    int32_t last_errno;
+    uint16_t binary_len;
+    uint16_t backtrace_size;
+    uint64_t fault_address;
+    uint32_t symbols_len;
+    uint32_t reserved;
+} faultd_record_info_t;
+
+#define FAULTD_RECORD_MIN (sizeof(faultd_record_hdr_t) + sizeof(faultd_record_info_t))
+
+
+/**
+ * Fault Ring File
+ *
+ * The ring file holds the most recent records exactly as they
+ * were received so bursts of faults are preserved even if the
+ * syslog output is rate-limited or lost.
+ */
+#define FAULTD_RING_MAGIC 0x464c5452 /* "FLTR" */
+#define FAULTD_RING_VERSION 1
+
+typedef struct faultd_ring_hdr_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_size;
+    uint32_t slots;
+    /** Next slot to be written */
+    uint32_t next;
+    /** Number of valid slots */
+    uint32_t count;
+    /** Total number of records ever written */
+    uint64_t sequence;
+} faultd_ring_hdr_t;
+
+typedef struct faultd_ring_slot_s {
+    uint32_t length;
+    uint32_t reserved;
+    /** Wall-clock receive time */
+    uint64_t timestamp;
+    uint8_t record[FAULTD_CONFIG_RECORD_SIZE_MAX];
+} faultd_ring_slot_t;
+
+#define FAULTD_RING_SIZE(_slots)                                        \
+    (sizeof(faultd_ring_hdr_t) + (size_t)(_slots) * sizeof(faultd_ring_slot_t))
+
+#define FAULTD_RING_SLOT(_hdr, _i)                                      \
+    ((faultd_ring_slot_t*)((uint8_t*)((_hdr)+1) + (size_t)(_i) * sizeof(faultd_ring_slot_t)))
+
 
 typedef struct faultd_service_s {
     /** The filename of the named pipe */
@@ -50,7 +148,7 @@ typedef struct faultd_service_s {
      * There is not necessarily a writer for the pipe at all times, as
      * this depends on whether any clients are currently connected. 
      *
-     * The server wants to use select() on the named pipe to wait for
+     * The server wants to use epoll() on the named pipe to wait for
      * any client connections, but this only works properly if
      * there is a writer connected to the pipe from which we are reading. 
      *
@@ -64,8 +162,27 @@ typedef struct faultd_service_s {
      */
     int writefd;         
 
+    /**
+     * Server only -- bytes read from the pipe which have not
+     * been consumed as complete records yet.
+     */
+    uint8_t* buf;
+    int len;
+
+    /**
+     * Server only -- when the partial record at the head of 'buf'
+     * started arriving. Partial records are discarded once they
+     * are older than FAULTD_CONFIG_READ_TIMEOUT_MS, since a client
+     * which dies mid-write would otherwise wedge the pipe.
+     */
+    uint64_t partial;
+
+    /** Server only -- the pipe is removed from the epoll set while buf is full. */
+    int paused;
+
 } faultd_service_t; 
 
+#define FAULTD_SERVICE_BUF_SIZE (2*FAULTD_CONFIG_RECORD_SIZE_MAX)
 
 
 /**
@@ -76,6 +193,11 @@ struct faultd_server_s {
     faultd_service_t services[FAULTD_CONFIG_SERVICE_PIPES_MAX]; 
     /** The last service from which we read a message */
     int sid_last;
+    /** Epoll descriptor for all service pipes */
+    int epfd;
+    /** Mapped fault ring, if configured */
+    faultd_ring_hdr_t* ring;
+    size_t ring_size;
 }; /* faultd_server_t */
 
 
@@ -89,6 +211,12 @@ faultd_server_create(faultd_server_t** rfso)
     }
 
     fso = aim_zmalloc(sizeof(*fso)); 
+    fso->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if(fso->epfd < 0) {
+        AIM_LOG_ERROR("epoll_create1: %s", strerror(errno));
+        AIM_FREE(fso);
+        return -1;
+    }
 
     *rfso = fso; 
     return 0;
@@ -102,6 +230,10 @@ faultd_server_destroy(faultd_server_t* fso)
         for(i = 0; i < AIM_ARRAYSIZE(fso->services); i++) { 
             faultd_server_remove(fso, NULL, i); 
         }
+        if(fso->ring) {
+            munmap(fso->ring, fso->ring_size);
+        }
+        close(fso->epfd);
         AIM_FREE(fso); 
     }
 }
@@ -119,6 +251,9 @@ faultd_service_destroy__(faultd_service_t* sp)
         if(sp->writefd) { 
             close(sp->writefd); 
         }
+        if(sp->buf) {
+            AIM_FREE(sp->buf);
+        }
         AIM_MEMSET(sp, 0, sizeof(*sp)); 
     }
 }
@@ -138,9 +273,11 @@ faultd_server_add(faultd_server_t* fso, char* pipename)
     for(i = 0; i < AIM_ARRAYSIZE(fso->services); i++) { 
         if(fso->services[i].pipename == NULL) { 
             int rv; 
+            struct epoll_event ev;
             faultd_service_t* sp = fso->services+i; 
 
             sp->pipename = aim_strdup(pipename); 
+            sp->buf = aim_zmalloc(FAULTD_SERVICE_BUF_SIZE);
 
             /**
              * Create the fifo if it doesn't already exist. 
@@ -153,8 +290,11 @@ faultd_server_add(faultd_server_t* fso, char* pipename)
 
             /** 
              * Open the fifo. 
+             *
+             * The pipe stays in non-blocking mode. All waiting is
+             * done in epoll_wait() and reads drain whatever is available.
              */
-            rv = open(sp->pipename, O_RDONLY | O_NONBLOCK); 
+            rv = open(sp->pipename, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
             if(rv < 0) { 
                 AIM_LOG_ERROR("open(pipe): %s", strerror(errno)); 
                 goto server_add_failed;
@@ -164,28 +304,18 @@ faultd_server_add(faultd_server_t* fso, char* pipename)
             /** 
              * Open our write connection. 
              */ 
-            rv = open(sp->pipename, O_WRONLY | O_NONBLOCK); 
+            rv = open(sp->pipename, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
             if(rv < 0) { 
                 AIM_LOG_ERROR("open(writefd): %s", strerror(errno)); 
                 goto server_add_failed;
             }
             sp->writefd = rv; 
     
-            /**
-             * We opened the pipe originally in non-blocking mode. 
-             * Otherwise, the open() would have blocked waiting for
-             * a client a client to open() it for writing. 
-             *
-             * We now want all reads on the pipe to be blocking so 
-             * we can use select() to pend on clients. 
-             *
-             * Reset the pipe to blocking here:
-             */
-            if( (rv = fcntl(sp->pipefd, F_GETFL, 0)) < 0) { 
-                goto server_add_failed; 
-            }
-            rv &= ~O_NONBLOCK; 
-            if(fcntl(sp->pipefd, F_SETFL, rv) < 0) { 
+            AIM_MEMSET(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            ev.data.u32 = i;
+            if(epoll_ctl(fso->epfd, EPOLL_CTL_ADD, sp->pipefd, &ev) < 0) {
+                AIM_LOG_ERROR("epoll_ctl(%s): %s", sp->pipename, strerror(errno));
                 goto server_add_failed;
             }
 
@@ -212,11 +342,508 @@ faultd_server_remove(faultd_server_t* fso, char* pipename,
         return -1; 
     }
     else {
+        /* Closing the pipe removes it from the epoll set. */
         faultd_service_destroy__(fso->services + sid); 
         return 0; 
     }
 }
 
+
+/**
+ * Open (and create or reinitialize if necessary) a ring file.
+ */
+static faultd_ring_hdr_t*
+ring_map__(const char* filename, int records, int writable, size_t* rsize)
+{
+    int fd;
+    struct stat st;
+    size_t size;
+    faultd_ring_hdr_t* hdr;
+
+    fd = open(filename, (writable ? (O_RDWR | O_CREAT) : O_RDONLY) | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        AIM_LOG_ERROR("open(%s): %s", filename, strerror(errno));
+        return NULL;
+    }
+    if(fstat(fd, &st) < 0) {
+        AIM_LOG_ERROR("fstat(%s): %s", filename, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    if(writable) {
+        size = FAULTD_RING_SIZE(records);
+        if(st.st_size != size && ftruncate(fd, size) < 0) {
+            AIM_LOG_ERROR("ftruncate(%s): %s", filename, strerror(errno));
+            close(fd);
+            return NULL;
+        }
+    }
+    else {
+        size = st.st_size;
+        if(size < sizeof(*hdr)) {
+            AIM_LOG_ERROR("%s: not a fault ring.", filename);
+            close(fd);
+            return NULL;
+        }
+    }
+
+    hdr = mmap(NULL, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+               MAP_SHARED, fd, 0);
+    close(fd);
+    if(hdr == MAP_FAILED) {
+        AIM_LOG_ERROR("mmap(%s): %s", filename, strerror(errno));
+        return NULL;
+    }
+
+    if(writable) {
+        /* Reuse the existing contents only if the geometry matches. */
+        if(hdr->magic != FAULTD_RING_MAGIC ||
+           hdr->version != FAULTD_RING_VERSION ||
+           hdr->slot_size != sizeof(faultd_ring_slot_t) ||
+           hdr->slots != records ||
+           hdr->next >= hdr->slots ||
+           hdr->count > hdr->slots) {
+            AIM_MEMSET(hdr, 0, sizeof(*hdr));
+            hdr->magic = FAULTD_RING_MAGIC;
+            hdr->version = FAULTD_RING_VERSION;
+            hdr->slot_size = sizeof(faultd_ring_slot_t);
+            hdr->slots = records;
+        }
+    }
+    else if(hdr->magic != FAULTD_RING_MAGIC ||
+            hdr->version != FAULTD_RING_VERSION ||
+            hdr->slot_size != sizeof(faultd_ring_slot_t) ||
+            FAULTD_RING_SIZE(hdr->slots) > size ||
+            hdr->next >= hdr->slots ||
+            hdr->count > hdr->slots) {
+        AIM_LOG_ERROR("%s: not a compatible fault ring.", filename);
+        munmap(hdr, size);
+        return NULL;
+    }
+
+    *rsize = size;
+    return hdr;
+}
+
+int
+faultd_server_ring_set(faultd_server_t* fso, const char* filename, int records)
+{
+    faultd_ring_hdr_t* hdr = NULL;
+    size_t size = 0;
+
+    if(fso == NULL) {
+        return -1;
+    }
+    if(records <= 0) {
+        records = FAULTD_CONFIG_RING_RECORDS;
+    }
+
+    if(filename) {
+        hdr = ring_map__(filename, records, 1, &size);
+        if(hdr == NULL) {
+            return -1;
+        }
+    }
+
+    if(fso->ring) {
+        munmap(fso->ring, fso->ring_size);
+    }
+    fso->ring = hdr;
+    fso->ring_size = size;
+    return 0;
+}
+
+static void
+ring_append__(faultd_server_t* fso, const uint8_t* record, int length)
+{
+    faultd_ring_hdr_t* hdr = fso->ring;
+    faultd_ring_slot_t* slot;
+
+    if(hdr == NULL) {
+        return;
+    }
+
+    slot = FAULTD_RING_SLOT(hdr, hdr->next);
+    FAULTD_MEMCPY(slot->record, record, length);
+    slot->length = length;
+    slot->timestamp = time(NULL);
+
+    hdr->next = (hdr->next + 1) % hdr->slots;
+    if(hdr->count < hdr->slots) {
+        hdr->count++;
+    }
+    hdr->sequence++;
+}
+
+
+/**
+ * Encode a fault record into 'dst'.
+ *
+ * This is called from the signal handler and must remain
+ * async-signal-safe. The symbols are truncated if necessary
+ * to keep the record within 'size'.
+ */
+static int
+record_encode__(faultd_info_t* info, const char* symbols, int symbols_len,
+                uint8_t* dst, int size)
+{
+    faultd_record_hdr_t hdr;
+    faultd_record_info_t ri;
+    uint8_t* p = dst;
+    int i;
+    int binary_len;
+    int backtrace_size;
+    int length;
+
+    binary_len = strnlen(info->binary, sizeof(info->binary));
+    backtrace_size = info->backtrace_size;
+    if(backtrace_size < 0) {
+        backtrace_size = 0;
+    }
+    if(backtrace_size > FAULTD_CONFIG_BACKTRACE_SIZE_MAX) {
+        backtrace_size = FAULTD_CONFIG_BACKTRACE_SIZE_MAX;
+    }
+
+    length = sizeof(ri) + backtrace_size*sizeof(uint64_t) + binary_len;
+    if(sizeof(hdr) + length > size) {
+        return -1;
+    }
+    if(symbols_len > size - sizeof(hdr) - length) {
+        symbols_len = size - sizeof(hdr) - length;
+    }
+    length += symbols_len;
+
+    hdr.magic = FAULTD_RECORD_MAGIC;
+    hdr.version = FAULTD_RECORD_VERSION;
+    hdr.flags = 0;
+    hdr.length = length;
+    FAULTD_MEMCPY(p, &hdr, sizeof(hdr));
+    p += sizeof(hdr);
+
+    FAULTD_MEMSET(&ri, 0, sizeof(ri));
+    ri.pid = info->pid;
+    ri.tid = info->tid;
+    ri.signal = info->signal;
+    ri.signal_code = info->signal_code;
+    ri.last_errno = info->last_errno;
+    ri.binary_len = binary_len;
+    ri.backtrace_size = backtrace_size;
+    ri.fault_address = (uintptr_t)info->fault_address;
+    ri.symbols_len = symbols_len;
+    FAULTD_MEMCPY(p, &ri, sizeof(ri));
+    p += sizeof(ri);
+
+    for(i = 0; i < backtrace_size; i++) {
+        uint64_t a = (uintptr_t)info->backtrace[i];
+        FAULTD_MEMCPY(p, &a, sizeof(a));
+        p += sizeof(a);
+    }
+
+    FAULTD_MEMCPY(p, info->binary, binary_len);
+    p += binary_len;
+
+    if(symbols_len) {
+        FAULTD_MEMCPY(p, symbols, symbols_len);
+        p += symbols_len;
+    }
+
+    return p - dst;
+}
+
+/**
+ * Decode a complete fault record.
+ */
+static int
+record_decode__(const uint8_t* src, int size, faultd_info_t* info)
+{
+    faultd_record_info_t ri;
+    const uint8_t* p = src + sizeof(faultd_record_hdr_t);
+    int i;
+
+    faultd_record_hdr_t hdr;
+
+    if(size < FAULTD_RECORD_MIN) {
+        return -1;
+    }
+    FAULTD_MEMCPY(&hdr, src, sizeof(hdr));
+    if(hdr.magic != FAULTD_RECORD_MAGIC ||
+       hdr.version != FAULTD_RECORD_VERSION ||
+       hdr.length != size - sizeof(hdr)) {
+        return -1;
+    }
+    FAULTD_MEMCPY(&ri, p, sizeof(ri));
+    p += sizeof(ri);
+
+    if(ri.backtrace_size > FAULTD_CONFIG_BACKTRACE_SIZE_MAX ||
+       ri.binary_len >= sizeof(info->binary) ||
+       FAULTD_RECORD_MIN + ri.backtrace_size*sizeof(uint64_t) +
+       ri.binary_len + ri.symbols_len != size) {
+        return -1;
+    }
+
+    FAULTD_MEMSET(info, 0, sizeof(*info));
+    info->pid = ri.pid;
+    info->tid = ri.tid;
+    info->signal = ri.signal;
+    info->signal_code = ri.signal_code;
+    info->last_errno = ri.last_errno;
+    info->fault_address = (void*)(uintptr_t)ri.fault_address;
+    info->backtrace_size = ri.backtrace_size;
+
+    for(i = 0; i < ri.backtrace_size; i++) {
+        uint64_t a;
+        FAULTD_MEMCPY(&a, p, sizeof(a));
+        info->backtrace[i] = (void*)(uintptr_t)a;
+        p += sizeof(a);
+    }
+
+    FAULTD_MEMCPY(info->binary, p, ri.binary_len);
+    p += ri.binary_len;
+
+    if(ri.symbols_len) {
+        info->backtrace_symbols = aim_zmalloc(ri.symbols_len + 1);
+        FAULTD_MEMCPY(info->backtrace_symbols, p, ri.symbols_len);
+    }
+    return 0;
+}
+
+
+/**
+ * Enable or disable epoll notifications for a service.
+ */
+static void
+service_pause__(faultd_server_t* fso, int sid, int pause)
+{
+    faultd_service_t* sp = fso->services + sid;
+    struct epoll_event ev;
+
+    if(sp->paused == pause) {
+        return;
+    }
+    AIM_MEMSET(&ev, 0, sizeof(ev));
+    ev.events = pause ? 0 : EPOLLIN;
+    ev.data.u32 = sid;
+    if(epoll_ctl(fso->epfd, EPOLL_CTL_MOD, sp->pipefd, &ev) == 0) {
+        sp->paused = pause;
+    }
+}
+
+/**
+ * Read whatever is available on a service pipe.
+ */
+static void
+service_fill__(faultd_server_t* fso, int sid)
+{
+    faultd_service_t* sp = fso->services + sid;
+    int rv;
+
+    if(sp->pipename == NULL) {
+        return;
+    }
+
+    while(sp->len < FAULTD_SERVICE_BUF_SIZE) {
+        rv = read(sp->pipefd, sp->buf + sp->len, FAULTD_SERVICE_BUF_SIZE - sp->len);
+        if(rv < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                AIM_LOG_ERROR("read(%s): %s", sp->pipename, strerror(errno));
+            }
+            break;
+        }
+        if(rv == 0) {
+            /* We hold a writer so this should not happen. */
+            break;
+        }
+        if(sp->len == 0) {
+            sp->partial = aim_time_monotonic();
+        }
+        sp->len += rv;
+    }
+
+    if(sp->len == FAULTD_SERVICE_BUF_SIZE) {
+        /*
+         * Stop polling until the buffered records are consumed.
+         * Otherwise a level-triggered pipe with a full buffer
+         * keeps waking us up for a service no one is reading.
+         */
+        service_pause__(fso, sid, 1);
+    }
+}
+
+static void
+service_consume__(faultd_server_t* fso, int sid, int count)
+{
+    faultd_service_t* sp = fso->services + sid;
+
+    memmove(sp->buf, sp->buf + count, sp->len - count);
+    sp->len -= count;
+    sp->partial = sp->len ? aim_time_monotonic() : 0;
+    service_pause__(fso, sid, 0);
+}
+
+/**
+ * Parse the next complete record buffered for the given service.
+ *
+ * @returns 1 if a record was returned in info, 0 if no complete
+ * record is available yet.
+ */
+static int
+service_record__(faultd_server_t* fso, int sid, faultd_info_t* info)
+{
+    faultd_service_t* sp = fso->services + sid;
+    faultd_record_hdr_t hdr;
+    int total;
+
+    while(sp->len >= sizeof(hdr)) {
+
+        FAULTD_MEMCPY(&hdr, sp->buf, sizeof(hdr));
+
+        if(hdr.magic != FAULTD_RECORD_MAGIC ||
+           hdr.version != FAULTD_RECORD_VERSION ||
+           hdr.length < sizeof(faultd_record_info_t) ||
+           hdr.length > FAULTD_CONFIG_RECORD_SIZE_MAX - sizeof(hdr)) {
+            /*
+             * Garbage or an unsupported writer.
+             * Resynchronize on the next record magic.
+             */
+            uint32_t magic = FAULTD_RECORD_MAGIC;
+            int i;
+
+            if(hdr.magic == FAULTD_RECORD_MAGIC &&
+               hdr.version != FAULTD_RECORD_VERSION) {
+                AIM_LOG_ERROR("%s: unsupported record version %d (expected %d).",
+                              sp->pipename, hdr.version, FAULTD_RECORD_VERSION);
+            }
+            for(i = 1; i + sizeof(magic) <= sp->len; i++) {
+                if(!memcmp(sp->buf + i, &magic, sizeof(magic))) {
+                    break;
+                }
+            }
+            if(i + sizeof(magic) > sp->len) {
+                /* Keep a possible partial magic at the end of the buffer. */
+                i = sp->len - (sizeof(magic) - 1);
+            }
+            AIM_LOG_ERROR("%s: discarding %d bytes of invalid record data.",
+                          sp->pipename, i);
+            service_consume__(fso, sid, i);
+            continue;
+        }
+
+        total = sizeof(hdr) + hdr.length;
+        if(sp->len < total) {
+            /* Incomplete */
+            return 0;
+        }
+
+        if(record_decode__(sp->buf, total, info) < 0) {
+            AIM_LOG_ERROR("%s: discarding malformed record.", sp->pipename);
+        }
+        else {
+            ring_append__(fso, sp->buf, total);
+            info->pipename = sp->pipename;
+            service_consume__(fso, sid, total);
+            return 1;
+        }
+        service_consume__(fso, sid, total);
+    }
+    return 0;
+}
+
+/**
+ * Discard partial records which have not been completed in time.
+ * @returns The epoll_wait() timeout until the next expiry, or -1.
+ */
+static int
+service_expire__(faultd_server_t* fso, int sid)
+{
+    uint64_t now = aim_time_monotonic();
+    uint64_t limit = FAULTD_CONFIG_READ_TIMEOUT_MS * 1000ULL;
+    uint64_t remaining = UINT64_MAX;
+    int i;
+
+    for(i = 0; i < AIM_ARRAYSIZE(fso->services); i++) {
+        faultd_service_t* sp = fso->services + i;
+        if(sp->pipename == NULL || sp->len == 0 || (sid != -1 && sid != i)) {
+            continue;
+        }
+        if(now - sp->partial >= limit) {
+            AIM_LOG_ERROR("%s: discarding %d bytes of incomplete record after %d ms.",
+                          sp->pipename, sp->len, FAULTD_CONFIG_READ_TIMEOUT_MS);
+            service_consume__(fso, i, sp->len);
+        }
+        else if(limit - (now - sp->partial) < remaining) {
+            remaining = limit - (now - sp->partial);
+        }
+    }
+
+    return (remaining == UINT64_MAX) ? -1 : (int)((remaining + 999) / 1000);
+}
+
+
+int
+faultd_server_read(faultd_server_t* fso, faultd_info_t* info, int sid)
+{
+    int i;
+    int rv;
+    int count;
+    struct epoll_event events[FAULTD_CONFIG_SERVICE_PIPES_MAX];
+
+    if(fso == NULL || info == NULL) {
+        return -1;
+    }
+    if(sid != -1 &&
+       (sid < 0 || sid >= AIM_ARRAYSIZE(fso->services) ||
+        fso->services[sid].pipename == NULL)) {
+        /* Invalid sid */
+        return -1;
+    }
+
+    for(;;) {
+        /**
+         * Return any complete record which is already buffered.
+         *
+         * If we're polling all services, we start looking for the
+         * next sid after the last sid we've received a message on.
+         * This avoids starvation if multiple services are producing
+         * messages.
+         */
+        if(sid == -1) {
+            for(i = fso->sid_last+1, count = 0;
+                count < AIM_ARRAYSIZE(fso->services);
+                i++, count++) {
+                int s = i % AIM_ARRAYSIZE(fso->services);
+                if(fso->services[s].pipename &&
+                   service_record__(fso, s, info)) {
+                    fso->sid_last = s;
+                    return s;
+                }
+            }
+        }
+        else if(service_record__(fso, sid, info)) {
+            fso->sid_last = sid;
+            return sid;
+        }
+
+        /* Wait for more data, or until the oldest partial record expires. */
+        rv = epoll_wait(fso->epfd, events, AIM_ARRAYSIZE(events),
+                        service_expire__(fso, sid));
+        if(rv < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            AIM_LOG_ERROR("epoll_wait: %s", strerror(errno));
+            return -1;
+        }
+        for(i = 0; i < rv; i++) {
+            service_fill__(fso, events[i].data.u32);
+        }
+    }
+}
+
+
 int 
 faultd_server_process(faultd_server_t* fdo, faultd_sid_t sid,
                       int count, aim_pvs_t* pvs, int decode)
@@ -226,7 +853,9 @@ faultd_server_process(faultd_server_t* fdo, faultd_sid_t sid,
     
     for(c = 0; c < count || count == -1; c++) {         
         FAULTD_MEMSET(&fault_info, 0, sizeof(fault_info)); 
-        faultd_server_read(fdo, &fault_info, sid); 
+        if(faultd_server_read(fdo, &fault_info, sid) < 0) {
+            return -1;
+        }
         faultd_info_show(&fault_info, pvs, decode);
         if(fault_info.backtrace_symbols) { 
             AIM_FREE(fault_info.backtrace_symbols); 
@@ -235,8 +864,64 @@ faultd_server_process(faultd_server_t* fdo, faultd_sid_t sid,
     return 0; 
 }
 
+int
+faultd_ring_show(const char* filename, aim_pvs_t* pvs, int decode)
+{
+    faultd_ring_hdr_t* hdr;
+    size_t size;
+    uint32_t i;
+    uint32_t slot;
+    faultd_info_t info;
+
+    if(filename == NULL) {
+        return -1;
+    }
+    if((hdr = ring_map__(filename, 0, 0, &size)) == NULL) {
+        return -1;
+    }
+
+    /* Oldest first */
+    slot = (hdr->next + hdr->slots - hdr->count) % hdr->slots;
+    for(i = 0; i < hdr->count; i++, slot = (slot + 1) % hdr->slots) {
+        faultd_ring_slot_t* sp = FAULTD_RING_SLOT(hdr, slot);
+        time_t t = sp->timestamp;
+        char tbuf[64];
+
+        if(sp->length > sizeof(sp->record) ||
+           record_decode__(sp->record, sp->length, &info) < 0) {
+            aim_printf(pvs, "record %u: invalid\n", i);
+            continue;
+        }
+        info.pipename = (char*)filename;
+        ctime_r(&t, tbuf);
+        tbuf[strcspn(tbuf, "\n")] = 0;
+        aim_printf(pvs, "record %u: %s\n", i, tbuf);
+        faultd_info_show(&info, pvs, decode);
+        if(info.backtrace_symbols) {
+            AIM_FREE(info.backtrace_symbols);
+        }
+    }
+
+    munmap(hdr, size);
+    return 0;
+}
+
 struct faultd_client_s { 
     faultd_service_t s;
+
+    /**
+     * Pipe used to capture the output of backtrace_symbols_fd().
+     * It is non-blocking so a large backtrace cannot deadlock
+     * the faulting process.
+     */
+    int symfds[2];
+
+    /**
+     * Preallocated record buffer. faultd_client_write() is called
+     * from the signal handler and cannot allocate. The second half
+     * is scratch space for the backtrace symbols.
+     */
+    uint8_t* record;
 }; /* faultd_client_t */
 
 int
@@ -255,16 +940,26 @@ faultd_client_create(faultd_client_t** rfco, const char* pipename)
 
     fco = aim_zmalloc(sizeof(*fco)); 
     fco->s.pipename = aim_strdup(pipename); 
+    fco->symfds[0] = fco->symfds[1] = -1;
+    fco->record = aim_zmalloc(2*FAULTD_CONFIG_RECORD_SIZE_MAX);
     
     /** 
      * Open the fifo. 
      */
-    rv = open(fco->s.pipename, O_WRONLY | O_NONBLOCK); 
+    rv = open(fco->s.pipename, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
     if(rv < 0) { 
         goto client_create_failed; 
     }
     fco->s.pipefd = rv; 
 
+    /*
+     * Symbols are optional. If the pipe cannot be created
+     * the records are simply sent without them.
+     */
+    if(pipe2(fco->symfds, O_NONBLOCK | O_CLOEXEC) < 0) {
+        fco->symfds[0] = fco->symfds[1] = -1;
+    }
+
     *rfco = fco; 
     return 0; 
     
@@ -277,73 +972,52 @@ void
 faultd_client_destroy(faultd_client_t* fco)
 {
     if(fco) { 
+        if(fco->symfds[0] >= 0) {
+            close(fco->symfds[0]);
+        }
+        if(fco->symfds[1] >= 0) {
+            close(fco->symfds[1]);
+        }
+        if(fco->record) {
+            AIM_FREE(fco->record);
+        }
         faultd_service_destroy__(&fco->s); 
         AIM_FREE(fco);
     }
 }
 
+/**
+ * Drain a non-blocking descriptor into dst.
+ * Anything beyond 'size' bytes is discarded.
+ */
 static int
-read_until__(int fd, char terminator, char* dst, int size)
+read_drain__(int fd, char* dst, int size)
 {
     int rv; 
     int count = 0;
-    char c; 
+    char discard[256];
 
-    do { 
-        rv = read(fd, &c, 1); 
-        if(rv < 0) { 
-            if(errno == EINTR) { 
-                continue; 
-            }
-            else {
-                return rv; 
-            }
+    for(;;) {
+        if(count < size) {
+            rv = read(fd, dst + count, size - count);
         }
-        if(count < size) { 
-            dst[count] = c; 
-        }
-        if(c == terminator) { 
-            return count; 
+        else {
+            rv = read(fd, discard, sizeof(discard));
         }
-        count++; 
-    
-        /* Fixme - need a timeout */
-    } while(1);
-}
-
-
-
-static int
-read_size__(int fd, char* dst, int size)
-{
-    int rv; 
-    int remaining = size;       
-    char* p = dst; 
-
-    do { 
-        rv = read(fd, p, remaining); 
         if(rv < 0) { 
             if(errno == EINTR) { 
-                /* Keep trying */
                 continue; 
             }
-            else {
-                /* Read failed. Probably not good. */
-                /* Do something here */
-                AIM_LOG_MSG("read failed errno=%d %s\n", errno, strerror(errno)); 
-                return -1; 
-            }
+            break;
         }
-        if(rv == 0 && remaining) {  
-            /* What to do here? */
-            AIM_LOG_MSG("read() returned zero but we didn't get everything."); 
-            return -1; 
+        if(rv == 0) {
+            break;
         }
-        p += rv; 
-        remaining -= rv; 
-    } while(remaining); 
-
-    return size; 
+        if(count < size) { 
+            count += rv;
+        }
+    }
+    return count;
 }
 
 
@@ -381,128 +1055,33 @@ write_size__(int fd, char* src, int size)
 }
 
 int 
-faultd_wait_services__(faultd_server_t* fso, int sid, fd_set* rfds)
+faultd_client_write(faultd_client_t* fco, faultd_info_t* info)
 {
     int rv; 
-    int maxfd; 
+    char* symbols = NULL;
+    int symbols_len = 0;
 
-    FD_ZERO(rfds); 
-
-    if(sid < 0 && sid >= AIM_ARRAYSIZE(fso->services) && sid != -1) { 
-        /* invalid sid */
+    if(fco == NULL || info == NULL) {
         return -1; 
     }
     
-    if(sid == -1) { 
-        /* All services */
-        int i; 
-        for(i = 0, maxfd = 0; i < AIM_ARRAYSIZE(fso->services); i++) { 
-            if(fso->services[i].pipefd) { 
-                FD_SET(fso->services[i].pipefd, rfds); 
-                if(fso->services[i].pipefd > maxfd) { 
-                    maxfd = fso->services[i].pipefd; 
-                }
-            }
-        }
-    }
-    else { 
-        /* Single service */
-        if(fso->services[sid].pipefd == 0) { 
-            /* Invalid sid */
-            return -1;
-        }
-        else {
-            FD_SET(fso->services[sid].pipefd, rfds); 
-            maxfd = fso->services[sid].pipefd; 
-        }
+    if(info->backtrace_symbols && fco->symfds[1] >= 0) {
+        symbols = (char*)fco->record + FAULTD_CONFIG_RECORD_SIZE_MAX;
+        backtrace_symbols_fd(info->backtrace, info->backtrace_size,
+                             fco->symfds[1]);
+        symbols_len = read_drain__(fco->symfds[0], symbols,
+                                   FAULTD_CONFIG_RECORD_SIZE_MAX);
     }
 
-    /* Wait on configured services */
-    do { 
-        rv = select(maxfd+1, rfds, NULL, NULL, NULL); 
-    } while(rv == -1 && errno == EINTR); 
-
-    return rv; 
-}
-
-
-int 
-faultd_server_read(faultd_server_t* fso, faultd_info_t* info, int sid)
-{
-    int i;      
-    int rv; 
-    fd_set rfds;
-    int count; 
-
-    rv = faultd_wait_services__(fso, sid, &rfds); 
-    
-    if(rv < 0) { 
-        /* Error on select or sid */
-        return rv; 
-    }
-
-    /** 
-     * Read message on a ready descriptor.
-     *
-     * If we're polling all services, we start looking for the 
-     * next sid after the last sid we've received a message on. 
-     * This avoids starvation if multiple services are producing
-     * messages. This is unlikely to be a problem under normal
-     * circumstances and use cases, but can be avoided easily nonetheless. 
-     */
-    for(i = fso->sid_last+1, count = 0; 
-        count < AIM_ARRAYSIZE(fso->services); 
-        i++, count++) { 
-        int s = i % AIM_ARRAYSIZE(fso->services); 
-        if(FD_ISSET(fso->services[s].pipefd, &rfds)) { 
-            rv = read_size__(fso->services[s].pipefd, (char*)info, sizeof(*info)); 
-    
-            if(rv < 0) { 
-                /* Do something here, like restare the pipe */
-                AIM_LOG_ERROR("truncated read on pipe."); 
-                continue; 
-            }
-            
-            /**
-             * Backtrace symbols information available? 
-             */
-            if(info->backtrace_symbols) { 
-                /*
-                 * The backtrace symbol information is of variable length. 
-                 */
-                info->backtrace_symbols = aim_zmalloc(FAULTD_CONFIG_BACKTRACE_SYMBOLS_SIZE); 
-                /* Backtrace symbols are terminated with a null character. */
-                read_until__(fso->services[s].pipefd, 0, info->backtrace_symbols, 
-                             FAULTD_CONFIG_BACKTRACE_SYMBOLS_SIZE); 
-            }
-
-            info->pipename = fso->services[s].pipename; 
-            fso->sid_last = s; 
-            return s; 
-        }
-    }
-    /* Error while reading on the only ready descriptor */
-    return -1; 
-}
-        
- 
-int
-faultd_client_write(faultd_client_t* fco, faultd_info_t* info)
-{
-    int rv = write_size__(fco->s.pipefd, (char*)info, sizeof(*info)); 
-    
+    rv = record_encode__(info, symbols, symbols_len,
+                         fco->record, FAULTD_CONFIG_RECORD_SIZE_MAX);
     if(rv < 0) { 
         return rv; 
     }
 
-    if(info->backtrace_symbols) { 
-        char c = 0; 
-        backtrace_symbols_fd(info->backtrace, info->backtrace_size, 
-                             fco->s.pipefd); 
-        /* Terminate backtrace symbols with a null character. */
-        write_size__(fco->s.pipefd, &c, 1); 
-    }
-    return 0; 
+    /* A single write of at most PIPE_BUF bytes is atomic. */
+    rv = write_size__(fco->s.pipefd, (char*)fco->record, rv);
+    return (rv < 0) ? rv : 0;
 }
 
 int
@@ -527,12 +1106,4 @@ faultd_info_show(faultd_info_t* info, aim_pvs_t* pvs, int decode)
     }
     return 0; 
 }       
-        
-
-
-
-        
-    
-    
-    
-    
+        
\ No newline at end of file
@@ -85,6 +85,21 @@ faultd_config_settings_t faultd_config_settings[] =
 #else
 { FAULTD_CONFIG_BACKTRACE_SYMBOLS_SIZE(__faultd_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef FAULTD_CONFIG_RECORD_SIZE_MAX
+    { __faultd_config_STRINGIFY_NAME(FAULTD_CONFIG_RECORD_SIZE_MAX), __faultd_config_STRINGIFY_VALUE(FAULTD_CONFIG_RECORD_SIZE_MAX) },
+#else
+{ FAULTD_CONFIG_RECORD_SIZE_MAX(__faultd_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef FAULTD_CONFIG_READ_TIMEOUT_MS
+    { __faultd_config_STRINGIFY_NAME(FAULTD_CONFIG_READ_TIMEOUT_MS), __faultd_config_STRINGIFY_VALUE(FAULTD_CONFIG_READ_TIMEOUT_MS) },
+#else
+{ FAULTD_CONFIG_READ_TIMEOUT_MS(__faultd_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef FAULTD_CONFIG_RING_RECORDS
+    { __faultd_config_STRINGIFY_NAME(FAULTD_CONFIG_RING_RECORDS), __faultd_config_STRINGIFY_VALUE(FAULTD_CONFIG_RING_RECORDS) },
+#else
+{ FAULTD_CONFIG_RING_RECORDS(__faultd_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef FAULTD_CONFIG_INCLUDE_MAIN
     { __faultd_config_STRINGIFY_NAME(FAULTD_CONFIG_INCLUDE_MAIN), __faultd_config_STRINGIFY_VALUE(FAULTD_CONFIG_INCLUDE_MAIN) },
 #else
@@ -99,6 +114,11 @@ faultd_config_settings_t faultd_config_settings[] =
     { __faultd_config_STRINGIFY_NAME(FAULTD_CONFIG_MAIN_PIPENAME), __faultd_config_STRINGIFY_VALUE(FAULTD_CONFIG_MAIN_PIPENAME) },
 #else
 { FAULTD_CONFIG_MAIN_PIPENAME(__faultd_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef FAULTD_CONFIG_MAIN_RING_FILE
+    { __faultd_config_STRINGIFY_NAME(FAULTD_CONFIG_MAIN_RING_FILE), __faultd_config_STRINGIFY_VALUE(FAULTD_CONFIG_MAIN_RING_FILE) },
+#else
+{ FAULTD_CONFIG_MAIN_RING_FILE(__faultd_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
@@ -51,6 +51,7 @@ static int test__(const char* binaryname, const char* pipename);
  * Hardcoded to :
  * - Listen on FAULTD_CONFIG_MAIN_PIPENAME
  * - Output messages to syslog and stderr (if a tty)
+ * - Keep recent faults in FAULTD_CONFIG_MAIN_RING_FILE
  * - Daemonize and Restart on "-d", "-dr"
  */
 
@@ -60,7 +61,7 @@ static char help__[] =
 \n\
 SYNOPSIS\n\
 \n\
-        faultd [-dr|-d] [-pid file] [-t] [-h | --help]\n\
+        faultd [-dr|-d] [-pid file] [-r file | -nr] [-show file] [-t] [-h | --help]\n\
 \n\
 OPTIONS\n\
         -d            Daemonize.\n\
@@ -69,6 +70,11 @@ OPTIONS\n\
         -p            Server pipe. Default is %s\n\
 \n\
         -pid file     Write PID to the given filename.\n\
+\n\
+        -r file       Keep recent faults in the given ring file. Default is %s\n\
+        -nr           Do not keep a ring file.\n\
+\n\
+        -show file    Show the faults recorded in the given ring file and exit.\n\
 \n\
         -t            Test mode. Sends a test backtrace the the existing faultd\n\
                       server.\n\
@@ -88,6 +94,7 @@ faultd_main(int argc, char* argv[])
     int restart = 0;
     int test = 0;
     char* pipename = FAULTD_CONFIG_MAIN_PIPENAME;
+    char* ringfile = FAULTD_CONFIG_MAIN_RING_FILE;
 
     aim_pvs_t* aim_pvs_syslog = NULL;
     faultd_server_t* faultd_server = NULL;
@@ -119,11 +126,31 @@ faultd_main(int argc, char* argv[])
                 exit(1);
             }
         }
+        else if(!strcmp(*arg, "-r")) {
+            arg++;
+            ringfile = *arg;
+            if(!ringfile) {
+                fprintf(stderr, "-r requires an argument.\n");
+                exit(1);
+            }
+        }
+        else if(!strcmp(*arg, "-nr")) {
+            ringfile = NULL;
+        }
+        else if(!strcmp(*arg, "-show")) {
+            arg++;
+            if(!*arg) {
+                fprintf(stderr, "-show requires an argument.\n");
+                exit(1);
+            }
+            return faultd_ring_show(*arg, &aim_pvs_stdout, 0) < 0 ? 1 : 0;
+        }
         else if(!strcmp(*arg, "-t")) {
             test = 1;
         }
         else if(!strcmp(*arg, "-h") || !strcmp(*arg, "--help")) {
-            printf(help__, FAULTD_CONFIG_MAIN_PIPENAME);
+            printf(help__, FAULTD_CONFIG_MAIN_PIPENAME,
+                   FAULTD_CONFIG_MAIN_RING_FILE);
             exit(0);
         }
     }
@@ -145,6 +172,12 @@ faultd_main(int argc, char* argv[])
         abort();
     }
 
+    if(ringfile && faultd_server_ring_set(faultd_server, ringfile,
+                                          FAULTD_CONFIG_RING_RECORDS) < 0) {
+        /* Not fatal. Faults are still reported. */
+        aim_printf(aim_pvs_syslog, "could not open ring file %s\n", ringfile);
+    }
+
     if(daemonize) {
         aim_daemon_restart_config_t rconfig;
         aim_daemon_config_t config;
@@ -195,6 +228,9 @@ faultd_main(int argc, char* argv[])
             if(aim_pvs_isatty(&aim_pvs_stderr)) {
                 faultd_info_show(&faultd_info, &aim_pvs_stderr, 0);
             }
+            if(faultd_info.backtrace_symbols) {
+                aim_free(faultd_info.backtrace_symbols);
+            }
         }
     }
 }
@@ -25,8 +25,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <AIM/aim.h>
+#include <AIM/aim_pvs_buffer.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <signal.h>
 #include <execinfo.h>
 
@@ -111,11 +114,118 @@ server_main(int argc, char* argv[])
     return 0; 
 }
 
+#define CHECK(_expr)                                                    \
+    do {                                                                \
+        if(!(_expr)) {                                                  \
+            AIM_DIE("%s:%d: check failed: %s", __FILE__, __LINE__, #_expr); \
+        }                                                               \
+    } while(0)
+
+#define UTEST_RING_RECORDS 4
+
+static void
+utest_info__(faultd_info_t* info, int code)
+{
+    int i;
+    memset(info, 0, sizeof(*info));
+    strcpy(info->binary, "utest-roundtrip");
+    info->pid = 1234;
+    info->tid = 5678;
+    info->signal = SIGBUS;
+    info->signal_code = code;
+    info->fault_address = (void*)(0xDEAD);
+    info->last_errno = -42;
+    info->backtrace_size = 3;
+    for(i = 0; i < info->backtrace_size; i++) {
+        info->backtrace[i] = (void*)(uintptr_t)(0x1000 * (i+1));
+    }
+}
+
+/**
+ * Send framed records through a service pipe into the fault ring
+ * and read them back from both the server and the ring file.
+ */
 int
 utest_main(int argc, char* argv[])
 {
-    fprintf(stderr, "No standalone unit test implemented.\n"); 
-    return 0; 
+    char pipename[64];
+    char ringname[64];
+    faultd_server_t* fso;
+    faultd_client_t* fco;
+    faultd_info_t info;
+    faultd_info_t rinfo;
+    aim_pvs_t* pvs;
+    char* out;
+    char expect[64];
+    int i;
+    int fd;
+
+    snprintf(pipename, sizeof(pipename), "/tmp/faultd-utest.%d.pipe", getpid());
+    snprintf(ringname, sizeof(ringname), "/tmp/faultd-utest.%d.ring", getpid());
+    unlink(pipename);
+    unlink(ringname);
+
+    CHECK(faultd_server_create(&fso) == 0);
+    CHECK(faultd_server_add(fso, pipename) >= 0);
+    CHECK(faultd_server_ring_set(fso, ringname, UTEST_RING_RECORDS) == 0);
+    CHECK(faultd_client_create(&fco, pipename) == 0);
+
+    /* Garbage and an unsupported record version ahead of a valid record. */
+    CHECK( (fd = open(pipename, O_WRONLY | O_NONBLOCK)) >= 0);
+    CHECK(write(fd, "garbage", 7) == 7);
+    {
+        /* magic, version 2, length */
+        uint32_t hdr[3] = { 0x464c5444, 2, 64 };
+        uint8_t body[64] = { 0 };
+        CHECK(write(fd, hdr, sizeof(hdr)) == sizeof(hdr));
+        CHECK(write(fd, body, sizeof(body)) == sizeof(body));
+    }
+    close(fd);
+
+    /* More records than the ring holds. */
+    for(i = 0; i < UTEST_RING_RECORDS + 2; i++) {
+        utest_info__(&info, i);
+        CHECK(faultd_client_write(fco, &info) == 0);
+
+        CHECK(faultd_server_read(fso, &rinfo, -1) >= 0);
+        CHECK(!strcmp(rinfo.pipename, pipename));
+        CHECK(!strcmp(rinfo.binary, info.binary));
+        CHECK(rinfo.pid == info.pid);
+        CHECK(rinfo.tid == info.tid);
+        CHECK(rinfo.signal == info.signal);
+        CHECK(rinfo.signal_code == i);
+        CHECK(rinfo.fault_address == info.fault_address);
+        CHECK(rinfo.last_errno == info.last_errno);
+        CHECK(rinfo.backtrace_size == info.backtrace_size);
+        CHECK(!memcmp(rinfo.backtrace, info.backtrace,
+                      sizeof(void*)*info.backtrace_size));
+        CHECK(rinfo.backtrace_symbols == NULL);
+    }
+
+    /* The ring keeps the most recent records, oldest first. */
+    pvs = aim_pvs_buffer_create();
+    CHECK(faultd_ring_show(ringname, pvs, 0) == 0);
+    out = aim_pvs_buffer_get(pvs);
+    CHECK(strstr(out, "invalid") == NULL);
+    CHECK(strstr(out, "binary = utest-roundtrip\n"));
+    CHECK(strstr(out, "errno = -42\n"));
+    CHECK(strstr(out, "    0x3000\n"));
+    CHECK(strstr(out, "code = 1\n") == NULL);
+    for(i = 2; i < UTEST_RING_RECORDS + 2; i++) {
+        snprintf(expect, sizeof(expect), "record %d:", i - 2);
+        CHECK(strstr(out, expect));
+        snprintf(expect, sizeof(expect), "code = %d\n", i);
+        CHECK(strstr(out, expect));
+    }
+    CHECK(strstr(out, "code = 2\n") < strstr(out, "code = 5\n"));
+    aim_free(out);
+    aim_pvs_destroy(pvs);
+
+    faultd_client_destroy(fco);
+    faultd_server_destroy(fso);
+    unlink(pipename);
+    unlink(ringname);
+    return 0;
 }
 
 int
@@ -97,6 +97,23 @@
  * In anticipation of future applications and devices, this driver
  * supports access to the full architected range, 256 pages.
  *
+ * Page select caching:
+ *	When loaded with page_cache=1, the driver remembers the page last
+ *	written to the page select register of each client and only
+ *	writes it when a different page is needed.  The page register is
+ *	no longer restored to 0 after each access.  The paging capability
+ *	registers are likewise read once and cached.  Both are forgotten
+ *	on any I2C error, on any write to the page select register through
+ *	the eeprom file, when dev_class changes, and when anything is
+ *	written to the 'flush_cache' attribute.  Counters are reported in
+ *	'page_stats'.
+ *
+ *	The driver cannot see a module being swapped, or the page select
+ *	register being written by anything other than itself (e.g. raw
+ *	I2C access from userspace).  Only enable the cache on platforms
+ *	which write 'flush_cache' on every presence change and do not
+ *	access the module behind the driver's back.  It is off by default.
+ *
  **/
 
 /* #define DEBUG 1 */
@@ -172,6 +189,7 @@ struct optoe_platform_data {
 #define OPTOE_READ_OP 0
 #define OPTOE_WRITE_OP 1
 #define OPTOE_EOF 0  /* used for access beyond end of device */
+#define OPTOE_PAGE_UNKNOWN (-1)
 
 struct optoe_data {
 	struct optoe_platform_data chip;
@@ -198,6 +216,21 @@ struct optoe_data {
 	/* dev_class: ONE_ADDR (QSFP) or TWO_ADDR (SFP) */
 	int dev_class;
 
+	/* currently selected page per client, or OPTOE_PAGE_UNKNOWN */
+	int page[2];
+
+	/* cached paging capability registers */
+	bool caps_valid;
+	u8 pageable_reg;
+	u8 addr_0x51_reg;
+
+	/* page select and capability statistics */
+	unsigned long page_writes;
+	unsigned long page_writes_skipped;
+	unsigned long caps_reads;
+	unsigned long caps_hits;
+	unsigned long cache_flushes;
+
 	struct i2c_client *client[];
 };
 
@@ -219,6 +252,16 @@ static unsigned int io_limit = OPTOE_PAGE_SIZE;
  */
 static unsigned int write_timeout = 25;
 
+/*
+ * Cache the selected page and the paging capabilities between accesses.
+ * This is only safe if the platform writes 'flush_cache' on presence
+ * changes and nothing else writes the page select register, so it is
+ * opt-in.
+ */
+static bool page_cache = false;
+module_param(page_cache, bool, 0444);
+MODULE_PARM_DESC(page_cache, "Cache the page select register (default false)");
+
 /*
  * flags to distinguish one-address (QSFP family) from two-address (SFP family)
  * If the family is not known, figure it out when the device is accessed
@@ -295,6 +338,24 @@ static uint8_t optoe_translate_offset(struct optoe_data *optoe,
 	return page;  /* note also returning client and offset */
 }
 
+/*
+ * Forget the selected pages and paging capabilities.
+ * Must be called with the lock held.
+ */
+static void optoe_cache_flush(struct optoe_data *optoe)
+{
+	optoe->page[0] = OPTOE_PAGE_UNKNOWN;
+	optoe->page[1] = OPTOE_PAGE_UNKNOWN;
+	optoe->caps_valid = false;
+	optoe->cache_flushes++;
+}
+
+static int optoe_client_index(struct optoe_data *optoe,
+		struct i2c_client *client)
+{
+	return (client == optoe->client[0]) ? 0 : 1;
+}
+
 static ssize_t optoe_eeprom_read(struct optoe_data *optoe,
 		    struct i2c_client *client,
 		    char *buf, unsigned int offset, size_t count)
@@ -505,21 +566,40 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 	loff_t phy_offset = off;
 	int ret = 0;
 
+	int index;
+
 	page = optoe_translate_offset(optoe, &phy_offset, &client);
+	index = optoe_client_index(optoe, client);
 	dev_dbg(&client->dev,
 		"%s off %lld  page:%d phy_offset:%lld, count:%ld, opcode:%d\n",
 		__func__, off, page, phy_offset, (long int) count, opcode);
-	if (page > 0) {
+	/*
+	 * The page register only matters for the upper half.  With the
+	 * page cache, it is left at whatever page was last selected.
+	 */
+	if (phy_offset >= OPTOE_PAGE_SIZE &&
+	    (page > 0 || page_cache) && optoe->page[index] != page) {
 		ret = optoe_eeprom_write(optoe, client, &page,
 			OPTOE_PAGE_SELECT_REG, 1);
 		if (ret < 0) {
 			dev_dbg(&client->dev,
 				"Write page register for page %d failed ret:%d!\n",
 					page, ret);
+			optoe_cache_flush(optoe);
 			return ret;
 		}
+		optoe->page_writes++;
+		if (page_cache)
+			optoe->page[index] = page;
+	} else if (phy_offset >= OPTOE_PAGE_SIZE && page_cache) {
+		optoe->page_writes_skipped++;
 	}
 
+	/* Any write to the page select register drops the cache. */
+	if (opcode == OPTOE_WRITE_OP && phy_offset <= OPTOE_PAGE_SELECT_REG &&
+	    phy_offset + count > OPTOE_PAGE_SELECT_REG)
+		optoe_cache_flush(optoe);
+
 	while (count) {
 		ssize_t	status;
 
@@ -533,6 +613,9 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 		if (status <= 0) {
 			if (retval == 0)
 				retval = status;
+			/* The module may have been replaced. */
+			if (status < 0)
+				optoe_cache_flush(optoe);
 			break;
 		}
 		buf += status;
@@ -542,7 +625,7 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 	}
 
 
-	if (page > 0) {
+	if (page > 0 && !page_cache) {
 		/* return the page register to page 0 (why?) */
 		page = 0;
 		ret = optoe_eeprom_write(optoe, client, &page,
@@ -558,10 +641,68 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 	return retval;
 }
 
+/*
+ * Read a paging capability register.  With page_cache the registers
+ * page_legal needs are read together once and then served from cache.
+ */
+static int optoe_caps_read(struct optoe_data *optoe, u8 reg, u8 *regval)
+{
+	struct i2c_client *client = optoe->client[0];
+	int status;
+
+	if (!page_cache) {
+		/* No cache: read just this register on every access. */
+		status = optoe_eeprom_read(optoe, client, regval, reg, 1);
+		if (status >= 0)
+			optoe->caps_reads++;
+		return status;
+	}
+
+	if (optoe->caps_valid) {
+		optoe->caps_hits++;
+		*regval = (reg == TWO_ADDR_0X51_REG) ?
+			optoe->addr_0x51_reg : optoe->pageable_reg;
+		return 1;
+	}
+
+	status = optoe_eeprom_read(optoe, client, regval, reg, 1);
+	if (status < 0) {
+		optoe_cache_flush(optoe);
+		return status;
+	}
+	optoe->caps_reads++;
+
+	/*
+	 * The cache is only valid once everything page_legal
+	 * may need has been read.
+	 */
+	if (reg == TWO_ADDR_0X51_REG) {
+		optoe->addr_0x51_reg = *regval;
+		optoe->caps_valid = true;
+	} else {
+		optoe->pageable_reg = *regval;
+		if (optoe->dev_class == ONE_ADDR) {
+			optoe->caps_valid = true;
+		} else {
+			/* SFP also needs the 0x51 support register. */
+			status = optoe_eeprom_read(optoe, client,
+				&optoe->addr_0x51_reg, TWO_ADDR_0X51_REG, 1);
+			if (status < 0) {
+				optoe_cache_flush(optoe);
+				return status;
+			}
+			optoe->caps_reads++;
+			optoe->caps_valid = true;
+		}
+	}
+	return 1;
+}
+
 /*
  * Figure out if this access is within the range of supported pages.
  * Note this is called on every access because we don't know if the
- * module has been replaced since the last call.
+ * module has been replaced since the last call.  With the page cache
+ * the capability registers are only read again after a cache flush.
  * If/when modules support more pages, this is the routine to update
  * to validate and allow access to additional pages.
  *
@@ -589,8 +730,7 @@ static ssize_t optoe_page_legal(struct optoe_data *optoe,
 		if (off >= TWO_ADDR_EEPROM_SIZE)
 			return OPTOE_EOF;
 		/* in between, are pages supported? */
-		status = optoe_eeprom_read(optoe, client, &regval,
-				TWO_ADDR_PAGEABLE_REG, 1);
+		status = optoe_caps_read(optoe, TWO_ADDR_PAGEABLE_REG, &regval);
 		if (status < 0)
 			return status;  /* error out (no module?) */
 		if (regval & TWO_ADDR_PAGEABLE) {
@@ -603,8 +743,8 @@ static ssize_t optoe_page_legal(struct optoe_data *optoe,
 
 			/* will be accessing addr 0x51, is that supported? */
 			/* byte 92, bit 6 implies DDM support, 0x51 support */
-			status = optoe_eeprom_read(optoe, client, &regval,
-						TWO_ADDR_0X51_REG, 1);
+			status = optoe_caps_read(optoe, TWO_ADDR_0X51_REG,
+						&regval);
 			if (status < 0)
 				return status;
 			if (regval & TWO_ADDR_0X51_SUPP) {
@@ -630,8 +770,7 @@ static ssize_t optoe_page_legal(struct optoe_data *optoe,
 		if (off >= ONE_ADDR_EEPROM_SIZE)
 			return OPTOE_EOF;
 		/* in between, are pages supported? */
-		status = optoe_eeprom_read(optoe, client, &regval,
-				ONE_ADDR_PAGEABLE_REG, 1);
+		status = optoe_caps_read(optoe, ONE_ADDR_PAGEABLE_REG, &regval);
 		if (status < 0)
 			return status;  /* error out (no module?) */
 		if (regval & ONE_ADDR_NOT_PAGEABLE) {
@@ -833,6 +972,7 @@ static ssize_t set_dev_class(struct device *dev,
 
 	mutex_lock(&optoe->lock);
 	optoe->dev_class = dev_class;
+	optoe_cache_flush(optoe);
 	mutex_unlock(&optoe->lock);
 
 	return count;
@@ -884,11 +1024,56 @@ static DEVICE_ATTR(port_name,  0644, show_port_name, set_port_name);
 
 static DEVICE_ATTR(dev_class,  0644, show_dev_class, set_dev_class);
 
+static ssize_t show_page_stats(struct device *dev,
+			struct device_attribute *dattr, char *buf)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+	ssize_t count;
+
+	mutex_lock(&optoe->lock);
+	count = sprintf(buf,
+		"page_writes %lu\n"
+		"page_writes_skipped %lu\n"
+		"caps_reads %lu\n"
+		"caps_hits %lu\n"
+		"cache_flushes %lu\n",
+		optoe->page_writes, optoe->page_writes_skipped,
+		optoe->caps_reads, optoe->caps_hits,
+		optoe->cache_flushes);
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
+/*
+ * Any write forgets the cached page and capabilities.
+ * Platforms should write this when the module presence changes.
+ */
+static ssize_t set_flush_cache(struct device *dev,
+			struct device_attribute *attr,
+			const char *buf, size_t count)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+
+	mutex_lock(&optoe->lock);
+	optoe_cache_flush(optoe);
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
+static DEVICE_ATTR(page_stats, 0444, show_page_stats, NULL);
+static DEVICE_ATTR(flush_cache, 0200, NULL, set_flush_cache);
+
 static struct attribute *optoe_attrs[] = {
 #ifndef EEPROM_CLASS
 	&dev_attr_port_name.attr,
 #endif
 	&dev_attr_dev_class.attr,
+	&dev_attr_page_stats.attr,
+	&dev_attr_flush_cache.attr,
 	NULL,
 };
 
@@ -969,6 +1154,8 @@ static int optoe_probe(struct i2c_client *client,
 	}
 
 	mutex_init(&optoe->lock);
+	optoe->page[0] = OPTOE_PAGE_UNKNOWN;
+	optoe->page[1] = OPTOE_PAGE_UNKNOWN;
 
 	/* determine whether this is a one-address or two-address module */
 	if ((strcmp(client->name, "optoe1") == 0) ||
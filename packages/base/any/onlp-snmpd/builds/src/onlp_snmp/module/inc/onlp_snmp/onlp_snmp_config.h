@@ -201,6 +201,16 @@
 #define ONLP_SNMP_CONFIG_RESOURCE_UPDATE_SECONDS 5
 #endif
 
+/**
+ * ONLP_SNMP_CONFIG_RESOURCE_CPUS_MAX
+ *
+ * Maximum number of CPUs reported in the resource table. */
+
+
+#ifndef ONLP_SNMP_CONFIG_RESOURCE_CPUS_MAX
+#define ONLP_SNMP_CONFIG_RESOURCE_CPUS_MAX 64
+#endif
+
 
 
 /**
@@ -26,8 +26,6 @@
 #include "onlp_snmp_log.h"
 
 #include <AIM/aim_time.h>
-#include <cjson/cJSON.h>
-#include <cjson_util/cjson_util.h>
 #include <net-snmp/net-snmp-config.h>
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/agent/net-snmp-agent-includes.h>
@@ -39,6 +37,8 @@
 
 #include <pthread.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
 
 static void
 platform_string_register(int index, const char* desc, char* value)
@@ -98,10 +98,26 @@ resource_int_register(int index, const char* desc,
 /* updates happen in this pthread */
 static pthread_t update_thread_handle;
 
+/*
+ * Utilization values are reported in hundredths of a percent.
+ */
+typedef struct {
+    uint32_t utilization_percent;
+    uint32_t idle_percent;
+    uint32_t iowait_percent;
+    uint32_t softirq_percent;
+} cpu_resources_t;
+
 /* resource objects */
 typedef struct {
     uint32_t utilization_percent;
     uint32_t idle_percent;
+    uint32_t iowait_percent;
+    uint32_t softirq_percent;
+
+    /* Per-CPU values */
+    int cpus;
+    cpu_resources_t cpu[ONLP_SNMP_CONFIG_RESOURCE_CPUS_MAX];
 } resources_t;
 
 #define NUM_RESOURCE_BUFFERS (2)
@@ -129,6 +145,137 @@ swap_curr_next_resources(void)
     curr_resource = next_resource();
 }
 
+/*
+ * /proc/stat CPU time counters.
+ */
+typedef struct {
+    uint64_t total;
+    uint64_t idle;
+    uint64_t iowait;
+    uint64_t softirq;
+    /* Set if the CPU was listed (online) when sampled. */
+    int online;
+} cpu_times_t;
+
+typedef struct {
+    int cpus;
+    /* Entry 0 is the aggregate, followed by each CPU. */
+    cpu_times_t times[ONLP_SNMP_CONFIG_RESOURCE_CPUS_MAX+1];
+} cpu_sample_t;
+
+/* The cpu lines come first so the rest of /proc/stat is never read. */
+#define PROC_STAT_BUFFER_SIZE (256 + ONLP_SNMP_CONFIG_RESOURCE_CPUS_MAX*160)
+
+static int proc_stat_fd = -1;
+static cpu_sample_t cpu_samples[2];
+static int cpu_sample_valid;
+
+/*
+ * Read all cpu lines from /proc/stat into the given sample.
+ * The file is kept open and reread from offset 0.
+ */
+static int
+cpu_sample_read(cpu_sample_t* sample)
+{
+    static char buf[PROC_STAT_BUFFER_SIZE];
+    char* line;
+    char* next;
+    ssize_t len;
+
+    if (proc_stat_fd < 0) {
+        proc_stat_fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+        if (proc_stat_fd < 0) {
+            AIM_LOG_ERROR("open(/proc/stat): %{errno}", errno);
+            return -1;
+        }
+    }
+
+    len = pread(proc_stat_fd, buf, sizeof(buf) - 1, 0);
+    if (len <= 0) {
+        AIM_LOG_ERROR("read(/proc/stat): %{errno}", errno);
+        close(proc_stat_fd);
+        proc_stat_fd = -1;
+        return -1;
+    }
+    buf[len] = 0;
+
+    /* Offline CPUs are not listed. */
+    memset(sample, 0, sizeof(*sample));
+    for (line = buf; line && !strncmp(line, "cpu", 3); line = next) {
+        unsigned long long v[8] = { 0 };
+        int index;
+
+        if ((next = strchr(line, '\n')) == NULL) {
+            /* Truncated line */
+            break;
+        }
+        *next++ = 0;
+
+        if (line[3] == ' ') {
+            index = 0;
+        }
+        else {
+            index = atoi(line + 3) + 1;
+            if (index > ONLP_SNMP_CONFIG_RESOURCE_CPUS_MAX) {
+                continue;
+            }
+        }
+
+        /* user nice system idle iowait irq softirq steal */
+        if (sscanf(line + 3 + strcspn(line + 3, " "), "%llu %llu %llu %llu %llu %llu %llu %llu",
+                   v, v+1, v+2, v+3, v+4, v+5, v+6, v+7) < 4) {
+            continue;
+        }
+
+        cpu_times_t* t = sample->times + index;
+        t->total = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+        t->idle = v[3];
+        t->iowait = v[4];
+        t->softirq = v[6];
+        t->online = 1;
+        if (index > sample->cpus) {
+            sample->cpus = index;
+        }
+    }
+    return 0;
+}
+
+static uint32_t
+cpu_percent(uint64_t part, uint64_t total)
+{
+    if (part > total) {
+        part = total;
+    }
+    return total ? (uint32_t)((part * 100 * 100) / total) : 0;
+}
+
+/*
+ * The counters can go backwards (e.g. iowait, or a CPU which
+ * was hotplugged between samples). Treat that as no time.
+ */
+static uint64_t
+cpu_delta(uint64_t curr, uint64_t prev)
+{
+    return (curr > prev) ? curr - prev : 0;
+}
+
+static void
+cpu_resources_compute(cpu_times_t* prev, cpu_times_t* curr, cpu_resources_t* r)
+{
+    uint64_t total;
+
+    if (!prev->online || !curr->online) {
+        memset(r, 0, sizeof(*r));
+        return;
+    }
+
+    total = cpu_delta(curr->total, prev->total);
+    r->idle_percent = cpu_percent(cpu_delta(curr->idle, prev->idle), total);
+    r->iowait_percent = cpu_percent(cpu_delta(curr->iowait, prev->iowait), total);
+    r->softirq_percent = cpu_percent(cpu_delta(curr->softirq, prev->softirq), total);
+    r->utilization_percent = total ? 100*100 - r->idle_percent : 0;
+}
+
 static void
 resource_update(void)
 {
@@ -137,45 +284,49 @@ resource_update(void)
         (ONLP_SNMP_CONFIG_RESOURCE_UPDATE_SECONDS * 1000 * 1000)) {
         last_resource_update_time = now;
 
-        /* invoke mpstat collection script for json output */
-        FILE *fp = popen("/usr/bin/onl-snmp-mpstat", "r");
-        if (fp == NULL) {
-            AIM_LOG_ERROR("failed invoking onl-snmp-mpstat");
+        cpu_sample_t* prev = &cpu_samples[0];
+        cpu_sample_t* curr = &cpu_samples[1];
+
+        if (cpu_sample_read(curr) < 0) {
             return;
         }
 
-        /* parse json output */
-        char line[1024];
-        while (fgets(line, sizeof(line), fp) != NULL) {
-            cJSON *root = cJSON_Parse(line);
-            int result;
-            int rv = cjson_util_lookup_int(root, &result, "all.%%idle");
-            if (rv == 0) {
-                resources_t *next = get_next_resources();
-                /* save it */
-                next->idle_percent = result;
-                next->utilization_percent = 100*100 - result;
-                /* swap buffers */
-                swap_curr_next_resources();
+        if (cpu_sample_valid) {
+            int i;
+            cpu_resources_t all;
+            resources_t *next = get_next_resources();
+
+            cpu_resources_compute(prev->times, curr->times, &all);
+            next->utilization_percent = all.utilization_percent;
+            next->idle_percent = all.idle_percent;
+            next->iowait_percent = all.iowait_percent;
+            next->softirq_percent = all.softirq_percent;
+
+            next->cpus = (curr->cpus < prev->cpus) ? curr->cpus : prev->cpus;
+            for (i = 0; i < next->cpus; i++) {
+                cpu_resources_compute(prev->times + i + 1, curr->times + i + 1,
+                                      next->cpu + i);
             }
-            cJSON_Delete(root);
+            /* swap buffers */
+            swap_curr_next_resources();
         }
 
-        pclose(fp);
+        /* The current sample becomes the baseline for the next update. */
+        *prev = *curr;
+        cpu_sample_valid = 1;
     }
 }
 
 static int
-utilization_handler(netsnmp_mib_handler *handler,
-             netsnmp_handler_registration *reginfo,
-             netsnmp_agent_request_info *reqinfo,
-             netsnmp_request_info *requests)
+resource_gauge_handler(netsnmp_mib_handler *handler,
+                       netsnmp_agent_request_info *reqinfo,
+                       netsnmp_handler_registration *reginfo,
+                       netsnmp_request_info *requests,
+                       uint32_t* value)
 {
     if (MODE_GET == reqinfo->mode) {
-        resources_t *curr = get_curr_resources();
         snmp_set_var_typed_value(requests->requestvb, ASN_GAUGE,
-                                 (u_char *) &curr->utilization_percent,
-                                 sizeof(curr->utilization_percent));
+                                 (u_char *) value, sizeof(*value));
     } else {
         netsnmp_assert("bad mode in RO handler");
     }
@@ -187,26 +338,75 @@ utilization_handler(netsnmp_mib_handler *handler,
     return SNMP_ERR_NOERROR;
 }
 
+#define RESOURCE_HANDLER(_field)                                        \
+    static int                                                          \
+    _field##_handler(netsnmp_mib_handler *handler,                      \
+                     netsnmp_handler_registration *reginfo,             \
+                     netsnmp_agent_request_info *reqinfo,               \
+                     netsnmp_request_info *requests)                    \
+    {                                                                   \
+        resources_t *curr = get_curr_resources();                       \
+        return resource_gauge_handler(handler, reqinfo, reginfo,        \
+                                      requests, &curr->_field##_percent); \
+    }
+
+RESOURCE_HANDLER(utilization)
+RESOURCE_HANDLER(idle)
+RESOURCE_HANDLER(iowait)
+RESOURCE_HANDLER(softirq)
+
+/*
+ * Per-CPU resource table (CpuTable in OCP-ONL-RESOURCE-MIB).
+ * The column and CPU are taken from the registered OID.
+ * Column 1 is the not-accessible CpuIndex.
+ */
+enum {
+    CPU_COLUMN_UTILIZATION = 2,
+    CPU_COLUMN_IDLE = 3,
+    CPU_COLUMN_IOWAIT = 4,
+    CPU_COLUMN_SOFTIRQ = 5,
+};
+
 static int
-idle_handler(netsnmp_mib_handler *handler,
-             netsnmp_handler_registration *reginfo,
-             netsnmp_agent_request_info *reqinfo,
-             netsnmp_request_info *requests)
+cpu_handler(netsnmp_mib_handler *handler,
+            netsnmp_handler_registration *reginfo,
+            netsnmp_agent_request_info *reqinfo,
+            netsnmp_request_info *requests)
 {
-    if (MODE_GET == reqinfo->mode) {
-        resources_t *curr = get_curr_resources();
-        snmp_set_var_typed_value(requests->requestvb, ASN_GAUGE,
-                                 (u_char *) &curr->idle_percent,
-                                 sizeof(curr->idle_percent));
-    } else {
-        netsnmp_assert("bad mode in RO handler");
+    uint32_t zero = 0;
+    uint32_t* value = &zero;
+    resources_t *curr = get_curr_resources();
+    int column = reginfo->rootoid[reginfo->rootoid_len-2];
+    int cpu = reginfo->rootoid[reginfo->rootoid_len-1] - 1;
+
+    if (cpu >= 0 && cpu < curr->cpus) {
+        switch(column)
+            {
+            case CPU_COLUMN_UTILIZATION: value = &curr->cpu[cpu].utilization_percent; break;
+            case CPU_COLUMN_IDLE: value = &curr->cpu[cpu].idle_percent; break;
+            case CPU_COLUMN_IOWAIT: value = &curr->cpu[cpu].iowait_percent; break;
+            case CPU_COLUMN_SOFTIRQ: value = &curr->cpu[cpu].softirq_percent; break;
+            }
     }
+    return resource_gauge_handler(handler, reqinfo, reginfo, requests, value);
+}
 
-    if (handler->next && handler->next->access_method) {
-        return netsnmp_call_next_handler(handler, reginfo, reqinfo, requests);
-    }
+static void
+resource_cpu_register(int column, int cpu, const char* desc)
+{
+    oid tree[] = { 1, 3, 6, 1, 4, 1, 42623, 1, 3, 2, 1, 1, 1 };
+    tree[11] = column;
+    tree[12] = cpu + 1;
 
-    return SNMP_ERR_NOERROR;
+    char* name = aim_fstrdup("Cpu%d%s", cpu, desc);
+    netsnmp_handler_registration *reg =
+        netsnmp_create_handler_registration(name, cpu_handler,
+                                            tree, OID_LENGTH(tree),
+                                            HANDLER_CAN_RONLY);
+    if (netsnmp_register_instance(reg) != MIB_REGISTERED_OK) {
+        AIM_LOG_ERROR("registering handler for %s failed", name);
+    }
+    aim_free(name);
 }
 
 void
@@ -253,6 +453,22 @@ onlp_snmp_platform_init(void)
     }
     resource_int_register(1, "CpuAllPercentUtilization", utilization_handler);
     resource_int_register(2, "CpuAllPercentIdle", idle_handler);
+    resource_int_register(3, "CpuAllPercentIowait", iowait_handler);
+    resource_int_register(4, "CpuAllPercentSoftirq", softirq_handler);
+
+    /* The baseline sample also determines the number of CPUs. */
+    cpu_sample_t* sample = &cpu_samples[0];
+    if (cpu_sample_read(sample) == 0) {
+        int cpu;
+        cpu_sample_valid = 1;
+        last_resource_update_time = aim_time_monotonic();
+        for (cpu = 0; cpu < sample->cpus; cpu++) {
+            resource_cpu_register(CPU_COLUMN_UTILIZATION, cpu, "PercentUtilization");
+            resource_cpu_register(CPU_COLUMN_IDLE, cpu, "PercentIdle");
+            resource_cpu_register(CPU_COLUMN_IOWAIT, cpu, "PercentIowait");
+            resource_cpu_register(CPU_COLUMN_SOFTIRQ, cpu, "PercentSoftirq");
+        }
+    }
 }
 
 #define MIN(a,b) ((a)<(b)? (a): (b))
@@ -277,6 +493,32 @@ cpu_utilization_handler__(int fd, void* cookie)
     return 0;
 }
 
+/*
+ * One line for the aggregate and each CPU:
+ * <name> <utilization> <idle> <iowait> <softirq>
+ */
+static int
+cpu_utilization_all_handler__(int fd, void* cookie)
+{
+    int i, len;
+    char svalue[(ONLP_SNMP_CONFIG_RESOURCE_CPUS_MAX+1)*64];
+    resources_t *curr = get_curr_resources();
+
+    len = snprintf(svalue, sizeof(svalue), "all %u %u %u %u\n",
+                   curr->utilization_percent, curr->idle_percent,
+                   curr->iowait_percent, curr->softirq_percent);
+    for (i = 0; i < curr->cpus; i++) {
+        cpu_resources_t* c = curr->cpu + i;
+        len += snprintf(svalue + len, sizeof(svalue) - len,
+                        "cpu%d %u %u %u %u\n", i,
+                        c->utilization_percent, c->idle_percent,
+                        c->iowait_percent, c->softirq_percent);
+    }
+    write(fd, svalue, len);
+    close(fd);
+    return 0;
+}
+
 static void *
 do_update(void *arg)
 {
@@ -285,6 +527,9 @@ do_update(void *arg)
         onlp_file_uds_add(uds,
                           "/var/run/onl/cpu-utilization",
                           cpu_utilization_handler__, NULL);
+        onlp_file_uds_add(uds,
+                          "/var/run/onl/cpu-utilization-all",
+                          cpu_utilization_all_handler__, NULL);
     }
 
     for (;;) {
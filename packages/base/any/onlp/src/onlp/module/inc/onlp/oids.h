@@ -366,6 +366,109 @@ int onlp_oid_hdr_get_all(onlp_oid_t root, onlp_oid_type_flags_t types,
  */
 int onlp_oid_get_all_free(biglist_t* list);
 
+/**
+ * OID status change event.
+ */
+typedef struct onlp_oid_status_event_s {
+    /** The OID */
+    onlp_oid_t oid;
+    /** The previous status flags */
+    uint32_t previous;
+    /** The current status flags */
+    uint32_t current;
+    /** ONLP_OID_STATUS_EVENT_F_* */
+    uint32_t flags;
+} onlp_oid_status_event_t;
+
+/** First observation of this OID. */
+#define ONLP_OID_STATUS_EVENT_F_INITIAL 0x1
+/** The OID appeared after the first observation. */
+#define ONLP_OID_STATUS_EVENT_F_NEW     0x2
+/** The OID is no longer reported by the platform. */
+#define ONLP_OID_STATUS_EVENT_F_GONE    0x4
+
+/**
+ * OID status change handler.
+ */
+typedef void (*onlp_oid_status_f)(onlp_oid_status_event_t* event, void* cookie);
+
+/**
+ * @brief Poll the status of all subscribed OIDs and publish changes.
+ * @returns The number of events published.
+ * @note The platform manager calls this periodically. Applications
+ * which do not run the platform manager can call it directly.
+ */
+int onlp_oid_status_poll(void);
+
+/**
+ * @brief Subscribe to OID status changes.
+ * @param types The OID types of interest.
+ * @param mask The status flags of interest. 0 selects
+ * PRESENT, FAILED, and UNPLUGGED.
+ * @param handler Called from onlp_oid_status_poll() for each event.
+ * @param cookie Passed to the handler.
+ * @returns A subscription handle.
+ */
+int onlp_oid_status_subscribe(onlp_oid_type_flags_t types, uint32_t mask,
+                              onlp_oid_status_f handler, void* cookie);
+
+/**
+ * @brief Subscribe to OID status changes through an eventfd.
+ * @param types The OID types of interest.
+ * @param mask The status flags of interest (see above).
+ * @param[out] fd Receives a descriptor which becomes readable
+ * when events are queued.
+ * @returns A subscription handle for onlp_oid_status_read().
+ */
+int onlp_oid_status_subscribe_fd(onlp_oid_type_flags_t types, uint32_t mask,
+                                 int* fd);
+
+/**
+ * @brief Read queued events from an eventfd subscription.
+ * @param handle The subscription handle.
+ * @param[out] events Receives the events.
+ * @param max The size of the events array.
+ * @returns The number of events read.
+ */
+int onlp_oid_status_read(int handle, onlp_oid_status_event_t* events, int max);
+
+/**
+ * @brief Cancel a subscription.
+ * @param handle The subscription handle.
+ */
+int onlp_oid_status_unsubscribe(int handle);
+
+/**
+ * @brief Publish the current state of all OIDs to the shared snapshot.
+ * @returns The number of OIDs published.
+ * @note onlpd publishes every ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS if it
+ * is non-zero. Only one process should publish.
+ */
+int onlp_oid_snapshot_publish(void);
+
+/**
+ * @brief Get an OID information structure from the shared snapshot.
+ * @param oid The oid
+ * @param[out] info Receives the information structure.
+ * @param size The size of the info buffer.
+ * @param[out] age Receives the age of the data in microseconds (optional).
+ * @returns ONLP_STATUS_E_UNSUPPORTED if no snapshot has been published.
+ * @returns ONLP_STATUS_E_MISSING if less than size bytes were published
+ * for the OID. The header is valid and the remainder is zeroed.
+ * @note This does not access the hardware or take the API lock.
+ */
+int onlp_oid_snapshot_info_get(onlp_oid_t oid, onlp_oid_hdr_t* info, int size,
+                               uint64_t* age);
+
+/**
+ * @brief Get an OID header from the shared snapshot.
+ * @param oid The oid
+ * @param[out] hdr Receives the header.
+ * @param[out] age Receives the age of the data in microseconds (optional).
+ */
+int onlp_oid_snapshot_hdr_get(onlp_oid_t oid, onlp_oid_hdr_t* hdr,
+                              uint64_t* age);
+
 /**
  * Manipulating OID Status Flags
  */
@@ -435,6 +538,99 @@ int onlp_oid_get_all_free(biglist_t* list);
 #define ONLP_OID_TABLE_ITER_TYPE(_table, _oidp, _type)                  \
     ONLP_OID_TABLE_ITER_EXPR(_table, _oidp, ONLP_OID_IS_TYPE(ONLP_OID_TYPE_##_type, *_oidp))
 
+/**
+ * @brief Pack the populated entries of an OID table.
+ * @param table The OID table
+ * @param[out] dst Receives the packed OIDs (optional).
+ * @returns The number of populated entries.
+ */
+int onlp_oid_table_pack(onlp_oid_table_t table, onlp_oid_t* dst);
+
+
+/**
+ * Compact OID header.
+ *
+ * Same as onlp_oid_hdr_t but only the populated child OIDs are
+ * stored, packed at the end of the structure. These are allocated
+ * with ONLP_OID_CHDR_SIZE(ccount) bytes.
+ */
+typedef struct onlp_oid_chdr_s {
+    /** The OID */
+    onlp_oid_t id;
+    /** The description of this object. */
+    onlp_oid_desc_t description;
+    /** The parent OID of this object. */
+    onlp_oid_t poid;
+    /** The current status (if applicable) */
+    onlp_oid_status_flags_t status;
+    /** The number of children */
+    uint32_t ccount;
+    /** The children of this OID */
+    onlp_oid_t coids[];
+} onlp_oid_chdr_t;
+
+/** The allocation size of a compact header with the given children. */
+#define ONLP_OID_CHDR_SIZE(_ccount) \
+    (sizeof(onlp_oid_chdr_t) + sizeof(onlp_oid_t)*(_ccount))
+
+/**
+ * @brief Iterate over the children of a compact header that match the given expression.
+ * @param _chdr The compact header
+ * @param _oidp OID pointer iterator
+ * @param _expr OID Expression which must be true
+ */
+#define ONLP_OID_CHDR_ITER_EXPR(_chdr, _oidp, _expr)                    \
+    for(_oidp = (_chdr)->coids; _oidp < ((_chdr)->coids+(_chdr)->ccount); _oidp++) \
+        if(_expr)
+
+/**
+ * @brief Iterate over the children of a compact header.
+ * @param _chdr The compact header
+ * @param _oidp OID pointer iterator
+ */
+#define ONLP_OID_CHDR_ITER(_chdr, _oidp) ONLP_OID_CHDR_ITER_EXPR(_chdr, _oidp, 1)
+
+/**
+ * @brief Iterate over the children of a compact header of the given type.
+ * @param _chdr The compact header
+ * @param _oidp OID pointer iterator
+ * @param _type The OID Type
+ */
+#define ONLP_OID_CHDR_ITER_TYPE(_chdr, _oidp, _type)                    \
+    ONLP_OID_CHDR_ITER_EXPR(_chdr, _oidp, ONLP_OID_IS_TYPE(ONLP_OID_TYPE_##_type, *_oidp))
+
+/**
+ * @brief Convert an OID header to a newly allocated compact header.
+ * @param hdr The OID header.
+ * @returns The compact header. Release with aim_free().
+ */
+onlp_oid_chdr_t* onlp_oid_chdr_from_hdr(onlp_oid_hdr_t* hdr);
+
+/**
+ * @brief Convert a compact header to an OID header.
+ * @param chdr The compact header.
+ * @param[out] hdr Receives the OID header.
+ */
+int onlp_oid_chdr_to_hdr(onlp_oid_chdr_t* chdr, onlp_oid_hdr_t* hdr);
+
+/**
+ * @brief Get the compact header for a given OID.
+ * @param oid The oid
+ * @param[out] chdr Receives the compact header. Release with aim_free().
+ */
+int onlp_oid_chdr_get(onlp_oid_t oid, onlp_oid_chdr_t** chdr);
+
+/**
+ * @brief Iterate over all given OID types and return their compact headers.
+ * @param root The root OID.
+ * @param types The OID types filter (optional)
+ * @param flags The iterator flags.
+ * @param[out] list Receives a list of all compact headers.
+ * @note Free the list with onlp_oid_get_all_free().
+ */
+int onlp_oid_chdr_get_all(onlp_oid_t root, onlp_oid_type_flags_t types,
+                          uint32_t flags, biglist_t** list);
+
 
 /**
  * @brief Return whether an OID is present or not.
@@ -475,6 +671,14 @@ int onlp_oid_table_from_json(cJSON* cj, onlp_oid_table_t table);
  */
 int onlp_oid_hdr_to_json(onlp_oid_hdr_t* hdr, cJSON** cj, uint32_t flags);
 
+/**
+ * @brief Compact OID Header -> JSON
+ * @param chdr The compact header
+ * @param[out] cj Receives the JSON representation.
+ * @param flags The JSON conversion flags.
+ */
+int onlp_oid_chdr_to_json(onlp_oid_chdr_t* chdr, cJSON** cj, uint32_t flags);
+
 /**
  * @brief JSON -> OID Header
  * @param cj The source json
@@ -26,6 +26,7 @@
 #define __ONLP_ONLP_H__
 
 #include <onlp/onlp_config.h>
+#include <cjson/cJSON.h>
 
 /* <auto.start.enum(tag:onlp).define> */
 /** onlp_status */
@@ -91,6 +92,25 @@ int onlp_sw_denit(void);
 void onlp_platform_dump(aim_pvs_t* pvs, uint32_t flags);
 void onlp_platform_show(aim_pvs_t* pvs, uint32_t flags);
 
+/**
+ * @brief Show the per-API call statistics.
+ * @param pvs The output pvs.
+ * @param histograms Include the latency histograms.
+ */
+void onlp_api_stats_show(aim_pvs_t* pvs, int histograms);
+
+/**
+ * @brief Get the per-API call statistics as JSON.
+ * @param [out] cjp Receives the JSON object.
+ * @note All times are in microseconds.
+ */
+int onlp_api_stats_to_json(cJSON** cjp);
+
+/**
+ * @brief Reset the per-API call statistics.
+ */
+void onlp_api_stats_reset(void);
+
 /** Standardized macros for dealing with sensor milli-values */
 #define ONLP_MILLI_NORMAL_INTEGER(_m) (_m / 1000)
 #define ONLP_MILLI_NORMAL_TENTHS(_m) ( (_m % 1000) / 100)
@@ -208,6 +208,16 @@
 #define ONLP_CONFIG_API_LOCK_TIMEOUT 60000000
 #endif
 
+/**
+ * ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM
+ *
+ * If 0, a single API lock covers all subsystems. If 1, each OID type has its own API lock and get-only APIs may run concurrently. Only enable this if the platform drivers are re-entrant. */
+
+
+#ifndef ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM
+#define ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM 0
+#endif
+
 /**
  * ONLP_CONFIG_INFO_STR_MAX
  *
@@ -238,6 +248,156 @@
 #define ONLP_CONFIG_INCLUDE_API_PROFILING 0
 #endif
 
+/**
+ * ONLP_CONFIG_INCLUDE_API_STATS
+ *
+ * Include per-API call counters and latency histograms. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_API_STATS
+#define ONLP_CONFIG_INCLUDE_API_STATS 1
+#endif
+
+/**
+ * ONLP_CONFIG_API_STATS_MAX
+ *
+ * The maximum number of APIs tracked by the API statistics. */
+
+
+#ifndef ONLP_CONFIG_API_STATS_MAX
+#define ONLP_CONFIG_API_STATS_MAX 256
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_SFP_CACHE
+ *
+ * Cache the static SFP EEPROM contents while a module remains present. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_SFP_CACHE
+#define ONLP_CONFIG_INCLUDE_SFP_CACHE 1
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_DOM_CACHE_USECS
+ *
+ * The minimum age (in usecs) of cached SFP DOM data before it is read again. */
+
+
+#ifndef ONLP_CONFIG_SFP_DOM_CACHE_USECS
+#define ONLP_CONFIG_SFP_DOM_CACHE_USECS 1000000
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_SFP_SWEEP
+ *
+ * Read SFP EEPROMs in parallel across the access domains declared by the platform. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_SFP_SWEEP
+#define ONLP_CONFIG_INCLUDE_SFP_SWEEP 1
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_SWEEP_WORKERS_MAX
+ *
+ * Maximum number of SFP sweep worker threads. */
+
+
+#ifndef ONLP_CONFIG_SFP_SWEEP_WORKERS_MAX
+#define ONLP_CONFIG_SFP_SWEEP_WORKERS_MAX 8
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS
+ *
+ * The time (in usecs) a bulk SFP presence read is reused. 0 disables. */
+
+
+#ifndef ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS
+#define ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS 100000
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX
+ *
+ * Maximum number of registered platform manager callbacks. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX
+#define ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX 32
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX
+ *
+ * Maximum factor by which a failing platform manager callback is slowed down. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX
+#define ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX 8
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX
+ *
+ * Maximum factor by which an adaptive platform manager callback is sped up while its readings are changing. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX
+#define ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX 8
+#endif
+
+/**
+ * ONLP_CONFIG_OID_STATUS_SUBSCRIBERS_MAX
+ *
+ * Maximum number of OID status change subscribers. */
+
+
+#ifndef ONLP_CONFIG_OID_STATUS_SUBSCRIBERS_MAX
+#define ONLP_CONFIG_OID_STATUS_SUBSCRIBERS_MAX 16
+#endif
+
+/**
+ * ONLP_CONFIG_OID_STATUS_QUEUE_SIZE
+ *
+ * Number of OID status change events queued for each eventfd subscriber. */
+
+
+#ifndef ONLP_CONFIG_OID_STATUS_QUEUE_SIZE
+#define ONLP_CONFIG_OID_STATUS_QUEUE_SIZE 256
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_OID_SNAPSHOT
+ *
+ * Include the shared memory OID snapshot. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_OID_SNAPSHOT
+#define ONLP_CONFIG_INCLUDE_OID_SNAPSHOT 1
+#endif
+
+/**
+ * ONLP_CONFIG_OID_SNAPSHOT_ENTRIES_MAX
+ *
+ * Maximum number of OIDs in the shared memory snapshot. */
+
+
+#ifndef ONLP_CONFIG_OID_SNAPSHOT_ENTRIES_MAX
+#define ONLP_CONFIG_OID_SNAPSHOT_ENTRIES_MAX 512
+#endif
+
+/**
+ * ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS
+ *
+ * Snapshot publish interval used by onlpd. 0 disables publishing. */
+
+
+#ifndef ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS
+#define ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS 0
+#endif
+
 
 
 /**
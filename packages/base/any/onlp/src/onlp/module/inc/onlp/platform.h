@@ -82,6 +82,55 @@ int onlp_platform_manager_join(void);
  */
 void onlp_platform_manager_manage(void);
 
+/**
+ * Platform management callback.
+ * @param cookie The registration cookie.
+ * @returns 0 if nothing of interest happened.
+ * @returns > 0 if the monitored readings are changing.
+ * Adaptive entries are called more often while this is reported.
+ * @returns < 0 on failure. Failing entries are called less often
+ * until they recover.
+ */
+typedef int (*onlp_platform_manager_f)(void* cookie);
+
+/** Speed up the callback while it reports changing readings. */
+#define ONLP_PLATFORM_MANAGER_F_ADAPTIVE 0x1
+
+/** Make the first call immediately instead of after one period. */
+#define ONLP_PLATFORM_MANAGER_F_NOW 0x2
+
+/**
+ * @brief Register a platform management callback.
+ * @param name The name of the callback (for debugging).
+ * @param manage The callback.
+ * @param cookie Passed to the callback.
+ * @param rate The callback rate in microseconds.
+ * @param flags See ONLP_PLATFORM_MANAGER_F_*
+ * @returns The registration handle, or an error.
+ * @note Callbacks run on the platform manager thread, or from
+ * onlp_platform_manager_manage() if the thread is not running.
+ * Platforms may register their own entries from onlp_platformi_manage_init().
+ */
+int onlp_platform_manager_register(const char* name,
+                                   onlp_platform_manager_f manage,
+                                   void* cookie, uint64_t rate,
+                                   uint32_t flags);
+
+/**
+ * @brief Unregister a platform management callback.
+ * @param handle The registration handle.
+ * @note This may be called from within the callback itself.
+ */
+int onlp_platform_manager_unregister(int handle);
+
+/**
+ * @brief Change the rate of a platform management callback.
+ * @param handle The registration handle.
+ * @param rate The new rate in microseconds.
+ * @note Any current backoff or speed-up is reset.
+ */
+int onlp_platform_manager_rate_set(int handle, uint64_t rate);
+
 /**
  * @brief Run in platform manager dameon mode.
  */
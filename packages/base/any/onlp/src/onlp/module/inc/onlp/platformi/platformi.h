@@ -74,6 +74,8 @@ int onlp_platformi_hw_init(uint32_t flags);
 
 /**
  * @brief Initialize the platform manager features.
+ * @note Additional management callbacks can be registered
+ * here with onlp_platform_manager_register().
  */
 int onlp_platformi_manage_init(void);
 
@@ -203,6 +203,19 @@ int onlp_sfpi_control_get(onlp_oid_id_t id, onlp_sfp_control_t control,
  */
 int onlp_sfpi_port_map(onlp_oid_id_t id, int* rport);
 
+/**
+ * @brief Get the access domain for an SFP port.
+ * @param id The SFP Port ID.
+ * @param[out] domain Receives the domain.
+ * @note The domain is usually the root i2c adapter behind which the
+ * port's EEPROM sits (see onlp_i2c_root_bus_get()). By implementing
+ * this function the platform declares that onlp_sfpi_dev_read*() calls
+ * for ports in different domains may run concurrently. Ports in the
+ * same domain are never accessed concurrently.
+ * If unsupported, all ports are accessed serially.
+ */
+int onlp_sfpi_port_domain_get(onlp_oid_id_t id, int* domain);
+
 
 /**
  * @brief Get the SFP's OID header.
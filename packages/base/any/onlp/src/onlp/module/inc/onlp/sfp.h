@@ -176,6 +176,22 @@ int onlp_sfp_bitmap_get(onlp_sfp_bitmap_t* bmap);
  */
 int onlp_sfp_info_get(onlp_oid_t port, onlp_sfp_info_t* info);
 
+/**
+ * @brief Get the SFP information structures for a set of ports.
+ * @param ports The ports to query, or NULL for all valid ports.
+ * @param[out] info Receives one information structure per port, in port order.
+ * @param count The number of entries available in info.
+ * @returns The number of entries populated, or an error.
+ * @note Presence is read once for all ports and the whole request is
+ * made under a single lock. Absent ports only have their header, type,
+ * and controls populated. Ports which could not be read are marked
+ * with the FAILED status flag.
+ * If the platform declares port access domains the EEPROM reads are
+ * spread across one worker thread per domain.
+ */
+int onlp_sfp_info_get_all(onlp_sfp_bitmap_t* ports, onlp_sfp_info_t* info,
+                          int count);
+
 /**
  * @brief Get the SFP information structure (including DOM)
  * @param port The SFP OID or Port ID.
@@ -190,6 +206,13 @@ int onlp_sfp_info_dom_get(onlp_oid_t port, onlp_sfp_info_t* info);
  */
 int onlp_sfp_hdr_get(onlp_oid_t port, onlp_oid_hdr_t* rv);
 
+/**
+ * @brief Discard any cached EEPROM data for the given SFP.
+ * @param port The SFP OID or Port ID.
+ * @note The next onlp_sfp_info_get() will re-read the module.
+ */
+int onlp_sfp_cache_invalidate(onlp_oid_t port);
+
 /**
  * @brief Determine if a given port number is a valid SFP port.
  * @param port The port number.
@@ -215,9 +238,10 @@ int onlp_sfp_is_present(onlp_oid_t port);
 /**
  * @brief Return the presence bitmap for all ports.
  * @param dst The receives the presence bitmap for all ports.
- * @note This function can return Unsupported.
- * It will not be emulated if the SFPI driver does not support
- * batch collection of the SFP presence.
+ * @note If the SFPI driver does not support batch collection
+ * the bitmap is generated from the single-port presence API.
+ * @note The result is reused for ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS
+ * so callers within one poll cycle share a single hardware read.
  */
 int onlp_sfp_presence_bitmap_get(onlp_sfp_bitmap_t* dst);
 
@@ -0,0 +1,306 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * ONLP API call statistics.
+ *
+ * Every locked API entry point records its lock wait and
+ * function times here. Each API registers a slot on its first
+ * call and all subsequent updates are lock-free.
+ *
+ ***********************************************************/
+#include <onlp/onlp_config.h>
+#include <onlp/onlp.h>
+#include "onlp_locks.h"
+#include "onlp_log.h"
+
+#if ONLP_CONFIG_INCLUDE_API_STATS == 1
+
+#include <pthread.h>
+#include <stdlib.h>
+
+static onlp_api_stats_t api_stats__[ONLP_CONFIG_API_STATS_MAX];
+static int api_stats_count__ = 0;
+static pthread_mutex_t api_stats_lock__ = PTHREAD_MUTEX_INITIALIZER;
+
+/** Shared by all APIs registered after the table is full. */
+static onlp_api_stats_t api_stats_overflow__ = { "(other)" };
+
+onlp_api_stats_t*
+onlp_api_stats_register(const char* name)
+{
+    int i;
+    onlp_api_stats_t* rv = NULL;
+
+    pthread_mutex_lock(&api_stats_lock__);
+    for(i = 0; i < api_stats_count__; i++) {
+        if(!strcmp(api_stats__[i].name, name)) {
+            rv = api_stats__ + i;
+            break;
+        }
+    }
+    if(rv == NULL) {
+        if(api_stats_count__ < AIM_ARRAYSIZE(api_stats__)) {
+            rv = api_stats__ + api_stats_count__;
+            rv->name = name;
+            __atomic_store_n(&api_stats_count__, api_stats_count__ + 1,
+                             __ATOMIC_RELEASE);
+        }
+        else {
+            AIM_LOG_WARN("API statistics table full. %s is counted as %s.",
+                         name, api_stats_overflow__.name);
+            rv = &api_stats_overflow__;
+        }
+    }
+    pthread_mutex_unlock(&api_stats_lock__);
+    return rv;
+}
+
+static int
+bucket__(uint64_t usecs)
+{
+    int b = (usecs == 0) ? 0 : 64 - __builtin_clzll(usecs);
+    return (b < ONLP_API_STATS_BUCKETS) ? b : ONLP_API_STATS_BUCKETS - 1;
+}
+
+static void
+max__(uint64_t* dst, uint64_t v)
+{
+    uint64_t cur = __atomic_load_n(dst, __ATOMIC_RELAXED);
+    while(v > cur &&
+          !__atomic_compare_exchange_n(dst, &cur, v, 1,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+void
+onlp_api_stats_record(onlp_api_stats_t* stats,
+                      uint64_t ltime, uint64_t ftime, int rv)
+{
+    __atomic_fetch_add(&stats->calls, 1, __ATOMIC_RELAXED);
+    if(ONLP_FAILURE(rv)) {
+        __atomic_fetch_add(&stats->errors, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&stats->ltime, ltime, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->ftime, ftime, __ATOMIC_RELAXED);
+    __atomic_fetch_add(stats->lhist + bucket__(ltime), 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(stats->fhist + bucket__(ftime), 1, __ATOMIC_RELAXED);
+    max__(&stats->lmax, ltime);
+    max__(&stats->fmax, ftime);
+}
+
+/**
+ * Take a consistent enough copy of every slot which has been called.
+ * Slots are sorted by total time, most expensive first.
+ */
+static int
+snapshot_compare__(const void* a, const void* b)
+{
+    const onlp_api_stats_t* sa = a;
+    const onlp_api_stats_t* sb = b;
+    uint64_t ta = sa->ltime + sa->ftime;
+    uint64_t tb = sb->ltime + sb->ftime;
+    return (ta < tb) ? 1 : (ta > tb) ? -1 : strcmp(sa->name, sb->name);
+}
+
+static int
+snapshot__(onlp_api_stats_t** snapshot)
+{
+    int i, j, count;
+    onlp_api_stats_t* s;
+
+    count = __atomic_load_n(&api_stats_count__, __ATOMIC_ACQUIRE);
+    s = aim_zmalloc(sizeof(*s) * (count + 1));
+    for(i = 0, j = 0; i <= count; i++) {
+        onlp_api_stats_t* src = (i < count) ? api_stats__ + i : &api_stats_overflow__;
+        int b;
+        /* Load once. A concurrent reset must not leave calls at 0 here. */
+        uint64_t calls = __atomic_load_n(&src->calls, __ATOMIC_RELAXED);
+        if(calls == 0) {
+            continue;
+        }
+        s[j].name = src->name;
+        s[j].calls = calls;
+        s[j].errors = __atomic_load_n(&src->errors, __ATOMIC_RELAXED);
+        s[j].ltime = __atomic_load_n(&src->ltime, __ATOMIC_RELAXED);
+        s[j].lmax = __atomic_load_n(&src->lmax, __ATOMIC_RELAXED);
+        s[j].ftime = __atomic_load_n(&src->ftime, __ATOMIC_RELAXED);
+        s[j].fmax = __atomic_load_n(&src->fmax, __ATOMIC_RELAXED);
+        for(b = 0; b < ONLP_API_STATS_BUCKETS; b++) {
+            s[j].lhist[b] = __atomic_load_n(src->lhist + b, __ATOMIC_RELAXED);
+            s[j].fhist[b] = __atomic_load_n(src->fhist + b, __ATOMIC_RELAXED);
+        }
+        j++;
+    }
+    qsort(s, j, sizeof(*s), snapshot_compare__);
+    *snapshot = s;
+    return j;
+}
+
+static void
+reset__(onlp_api_stats_t* s)
+{
+    int b;
+    __atomic_store_n(&s->calls, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->errors, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->ltime, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->lmax, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->ftime, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->fmax, 0, __ATOMIC_RELAXED);
+    for(b = 0; b < ONLP_API_STATS_BUCKETS; b++) {
+        __atomic_store_n(s->lhist + b, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(s->fhist + b, 0, __ATOMIC_RELAXED);
+    }
+}
+
+void
+onlp_api_stats_reset(void)
+{
+    int i;
+    int count = __atomic_load_n(&api_stats_count__, __ATOMIC_ACQUIRE);
+    for(i = 0; i < count; i++) {
+        reset__(api_stats__ + i);
+    }
+    reset__(&api_stats_overflow__);
+}
+
+/** Upper bound (usecs) of the given histogram bucket. */
+static uint64_t
+bucket_limit__(int b)
+{
+    return 1ULL << b;
+}
+
+static void
+hist_show__(aim_pvs_t* pvs, const char* label, uint64_t* hist)
+{
+    int b;
+    aim_printf(pvs, "    %s:", label);
+    for(b = 0; b < ONLP_API_STATS_BUCKETS; b++) {
+        if(hist[b]) {
+            if(b == ONLP_API_STATS_BUCKETS - 1) {
+                aim_printf(pvs, " >=%"PRIu64"us:%"PRIu64,
+                           bucket_limit__(b-1), hist[b]);
+            }
+            else {
+                aim_printf(pvs, " <%"PRIu64"us:%"PRIu64,
+                           bucket_limit__(b), hist[b]);
+            }
+        }
+    }
+    aim_printf(pvs, "\n");
+}
+
+void
+onlp_api_stats_show(aim_pvs_t* pvs, int histograms)
+{
+    int i, count;
+    onlp_api_stats_t* s;
+
+    count = snapshot__(&s);
+    aim_printf(pvs, "%-40s %10s %8s %10s %10s %10s %10s\n",
+               "API", "Calls", "Errors", "LockAvg", "LockMax",
+               "FuncAvg", "FuncMax");
+    for(i = 0; i < count; i++) {
+        aim_printf(pvs, "%-40s %10"PRIu64" %8"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64"\n",
+                   s[i].name, s[i].calls, s[i].errors,
+                   s[i].ltime / s[i].calls, s[i].lmax,
+                   s[i].ftime / s[i].calls, s[i].fmax);
+        if(histograms) {
+            hist_show__(pvs, "lock", s[i].lhist);
+            hist_show__(pvs, "func", s[i].fhist);
+        }
+    }
+    aim_free(s);
+}
+
+static cJSON*
+hist_to_json__(uint64_t* hist)
+{
+    int b;
+    cJSON* cj = cJSON_CreateArray();
+    for(b = 0; b < ONLP_API_STATS_BUCKETS; b++) {
+        cJSON_AddItemToArray(cj, cJSON_CreateNumber(hist[b]));
+    }
+    return cj;
+}
+
+int
+onlp_api_stats_to_json(cJSON** cjp)
+{
+    int i, b, count;
+    onlp_api_stats_t* s;
+    cJSON* cj;
+    cJSON* apis;
+    cJSON* limits;
+
+    if(cjp == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    cj = cJSON_CreateObject();
+
+    /* The upper bound of each histogram bucket, in usecs. */
+    limits = cJSON_CreateArray();
+    for(b = 0; b < ONLP_API_STATS_BUCKETS - 1; b++) {
+        cJSON_AddItemToArray(limits, cJSON_CreateNumber(bucket_limit__(b)));
+    }
+    cJSON_AddItemToObject(cj, "buckets", limits);
+
+    apis = cJSON_CreateObject();
+    count = snapshot__(&s);
+    for(i = 0; i < count; i++) {
+        cJSON* api = cJSON_CreateObject();
+        cJSON_AddNumberToObject(api, "calls", s[i].calls);
+        cJSON_AddNumberToObject(api, "errors", s[i].errors);
+        cJSON_AddNumberToObject(api, "lock-total", s[i].ltime);
+        cJSON_AddNumberToObject(api, "lock-max", s[i].lmax);
+        cJSON_AddNumberToObject(api, "func-total", s[i].ftime);
+        cJSON_AddNumberToObject(api, "func-max", s[i].fmax);
+        cJSON_AddItemToObject(api, "lock-histogram", hist_to_json__(s[i].lhist));
+        cJSON_AddItemToObject(api, "func-histogram", hist_to_json__(s[i].fhist));
+        cJSON_AddItemToObject(apis, s[i].name, api);
+    }
+    aim_free(s);
+    cJSON_AddItemToObject(cj, "apis", apis);
+
+    *cjp = cj;
+    return ONLP_STATUS_OK;
+}
+
+#else
+
+void
+onlp_api_stats_show(aim_pvs_t* pvs, int histograms)
+{
+    aim_printf(pvs, "API statistics are not available in this build.\n");
+}
+
+int
+onlp_api_stats_to_json(cJSON** cjp)
+{
+    return ONLP_STATUS_E_UNSUPPORTED;
+}
+
+void
+onlp_api_stats_reset(void)
+{
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_API_STATS */
@@ -27,6 +27,7 @@
 #include <onlp/stdattrs.h>
 #include <onlp/oids.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_ATTRIBUTE
 #include "onlp_locks.h"
 #include "onlp_log.h"
 
@@ -64,7 +65,7 @@ onlp_attribute_supported_locked__(onlp_oid_t oid, const char* attribute)
 {
     return onlp_attributei_supported(oid, attribute);
 }
-ONLP_LOCKED_API2(onlp_attribute_supported, onlp_oid_t, oid, const char*, attribute)
+ONLP_LOCKED_RAPI2(onlp_attribute_supported, onlp_oid_t, oid, const char*, attribute)
 
 /**
  * @brief Set an attribute on the given OID.
@@ -106,7 +107,7 @@ onlp_attribute_get_locked__(onlp_oid_t oid, const char* attribute,
 {
     return onlp_attributei_get(oid, attribute, value);
 }
-ONLP_LOCKED_API3(onlp_attribute_get, onlp_oid_t, oid, const char*, attribute, void**, value)
+ONLP_LOCKED_RAPI3(onlp_attribute_get, onlp_oid_t, oid, const char*, attribute, void**, value)
 
 
 static int
@@ -130,7 +131,7 @@ onlp_attribute_onie_info_get_locked__(onlp_oid_t oid, onlp_onie_info_t** rvp)
     *rvp = rp;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_attribute_onie_info_get, onlp_oid_t, oid, onlp_onie_info_t**, rvp);
+ONLP_LOCKED_RAPI2(onlp_attribute_onie_info_get, onlp_oid_t, oid, onlp_onie_info_t**, rvp);
 
 int
 onlp_attribute_onie_info_free(onlp_oid_t oid, onlp_onie_info_t* p)
@@ -208,7 +209,7 @@ onlp_attribute_asset_info_get_locked__(onlp_oid_t oid, onlp_asset_info_t** rvp)
     *rvp = rp;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_attribute_asset_info_get, onlp_oid_t, oid, onlp_asset_info_t**, rvp);
+ONLP_LOCKED_RAPI2(onlp_attribute_asset_info_get, onlp_oid_t, oid, onlp_asset_info_t**, rvp);
 
 int
 onlp_attribute_asset_info_free(onlp_oid_t oid, onlp_asset_info_t* p)
@@ -28,6 +28,7 @@
 #include <AIM/aim.h>
 #include "onlp_log.h"
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_CHASSIS
 #include "onlp_locks.h"
 
 
@@ -63,7 +64,7 @@ onlp_chassis_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
     onlp_oid_hdr_sort(hdr);
     return rv;
 }
-ONLP_LOCKED_API2(onlp_chassis_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_chassis_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
 
 
 static int
@@ -76,7 +77,7 @@ onlp_chassis_info_get_locked__(onlp_oid_t oid, onlp_chassis_info_t* cip)
     onlp_oid_hdr_sort(&cip->hdr);
     return rv;
 }
-ONLP_LOCKED_API2(onlp_chassis_info_get,onlp_oid_t, oid,
+ONLP_LOCKED_RAPI2(onlp_chassis_info_get,onlp_oid_t, oid,
                  onlp_chassis_info_t*, rv);
 
 int
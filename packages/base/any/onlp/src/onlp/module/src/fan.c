@@ -26,6 +26,7 @@
 #include <onlp/platformi/fani.h>
 #include <onlp/oids.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_FAN
 #include "onlp_locks.h"
 #include "onlp_log.h"
 #include "onlp_json.h"
@@ -77,7 +78,7 @@ onlp_fan_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
     hdr->id = oid;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_fan_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_fan_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
 
 /**
  * Fan Info Get
@@ -99,7 +100,7 @@ onlp_fan_info_get_locked__(onlp_oid_t oid, onlp_fan_info_t* info)
     info->hdr.id = oid;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_fan_info_get, onlp_oid_t, oid, onlp_fan_info_t*, info);
+ONLP_LOCKED_RAPI2(onlp_fan_info_get, onlp_oid_t, oid, onlp_fan_info_t*, info);
 
 /**
  * Fan Caps Get
@@ -117,7 +118,7 @@ onlp_fan_caps_get_locked__(onlp_oid_t oid, uint32_t* rv)
                           onlp_fani_caps_get(id, rv),
                           "fani caps get %{onlp_oid}", oid);
 }
-ONLP_LOCKED_API2(onlp_fan_caps_get, onlp_oid_t, oid, uint32_t*, rv);
+ONLP_LOCKED_RAPI2(onlp_fan_caps_get, onlp_oid_t, oid, uint32_t*, rv);
 
 
 static int
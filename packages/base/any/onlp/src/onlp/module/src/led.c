@@ -27,6 +27,7 @@
 #include <onlp/led.h>
 #include <onlp/platformi/ledi.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_LED
 #include "onlp_locks.h"
 
 static int
@@ -64,7 +65,7 @@ onlp_led_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
                           onlp_ledi_hdr_get(id, hdr),
                           "ledi hdr get %{onlp_oid}", oid);
 }
-ONLP_LOCKED_API2(onlp_led_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_led_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
 
 
 static int
@@ -79,7 +80,7 @@ onlp_led_info_get_locked__(onlp_oid_t oid, onlp_led_info_t* info)
                           onlp_ledi_info_get(id, info),
                           "ledi info get %{onlp_oid}", oid);
 }
-ONLP_LOCKED_API2(onlp_led_info_get, onlp_oid_t, id, onlp_led_info_t*, info);
+ONLP_LOCKED_RAPI2(onlp_led_info_get, onlp_oid_t, id, onlp_led_info_t*, info);
 
 
 static int
@@ -94,7 +95,7 @@ onlp_led_caps_get_locked__(onlp_oid_t oid, uint32_t* rv)
                           onlp_ledi_caps_get(id, rv),
                           "ledi caps get %{onlp_oid}", oid);
 }
-ONLP_LOCKED_API2(onlp_led_caps_get, onlp_oid_t, oid, uint32_t*, rv);
+ONLP_LOCKED_RAPI2(onlp_led_caps_get, onlp_oid_t, oid, uint32_t*, rv);
 
 
 static int
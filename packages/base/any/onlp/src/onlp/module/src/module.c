@@ -1,6 +1,7 @@
 #include <onlp/module.h>
 #include <onlp/platformi/modulei.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_MODULE
 #include "onlp_locks.h"
 #include "onlp_log.h"
 
@@ -41,7 +42,7 @@ onlp_module_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
     hdr->id = oid;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_module_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr)
+ONLP_LOCKED_RAPI2(onlp_module_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr)
 
 static int
 onlp_module_info_get_locked__(onlp_oid_t oid, onlp_module_info_t* info)
@@ -59,7 +60,7 @@ onlp_module_info_get_locked__(onlp_oid_t oid, onlp_module_info_t* info)
     info->hdr.id = oid;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_module_info_get, onlp_oid_t, oid, onlp_module_info_t*, info)
+ONLP_LOCKED_RAPI2(onlp_module_info_get, onlp_oid_t, oid, onlp_module_info_t*, info)
 
 int
 onlp_module_info_to_user_json(onlp_module_info_t* info, cJSON** cjp, uint32_t flags)
@@ -0,0 +1,377 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Shared memory OID snapshot.
+ *
+ * The platform manager daemon periodically publishes the header and
+ * information structure of every OID into a shared memory segment.
+ * Readers in other processes copy entries out under a sequence lock
+ * and never touch the hardware or the API locks.
+ *
+ ***********************************************************/
+#include <onlp/onlp_config.h>
+#include <onlp/oids.h>
+#include "onlp_log.h"
+#include "onlp_int.h"
+#include <AIM/aim.h>
+
+#include <onlp/chassis.h>
+#include <onlp/module.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/led.h>
+#include <onlp/psu.h>
+#include <onlp/sfp.h>
+#include <onlp/generic.h>
+
+#if ONLP_CONFIG_INCLUDE_OID_SNAPSHOT == 1
+
+#include <onlplib/shlocks.h>
+#include <OS/os_time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+
+#define SNAPSHOT_KEY__ (ONLP_SHLOCK_GLOBAL_KEY + 0x200)
+#define SNAPSHOT_LOCK_KEY__ (ONLP_SHLOCK_GLOBAL_KEY + 0x201)
+#define SNAPSHOT_MAGIC__ 0x4F49444E
+
+/** Reader retries before giving up on a stuck publisher. */
+#define SNAPSHOT_READ_RETRIES__ 10000
+
+/**
+ * Any OID information structure.
+ */
+typedef union snapshot_info_u {
+    onlp_oid_hdr_t hdr;
+#define ONLP_OID_TYPE_ENTRY(_name, _value, _upper, _lower)  \
+    onlp_##_lower##_info_t _lower;
+#include <onlp/onlp.x>
+} snapshot_info_t;
+
+typedef struct snapshot_entry_s {
+    onlp_oid_t oid;
+    /** The size of the valid information structure */
+    uint32_t size;
+    snapshot_info_t info;
+} snapshot_entry_t;
+
+/**
+ * Shared memory layout.
+ */
+typedef struct snapshot_s {
+    uint32_t magic;
+    /** sizeof(snapshot_t) of the publisher */
+    uint32_t size;
+    /** Odd while an update is in progress */
+    uint32_t seq;
+    /** Number of valid entries, sorted by OID */
+    uint32_t count;
+    /** Monotonic time of the last update */
+    uint64_t updated;
+    /** The publishing process */
+    int32_t pid;
+    snapshot_entry_t entries[ONLP_CONFIG_OID_SNAPSHOT_ENTRIES_MAX];
+} snapshot_t;
+
+static snapshot_t* shared__;
+static pthread_once_t shared_once__ = PTHREAD_ONCE_INIT;
+
+static void
+shared_attach__(void)
+{
+    if(onlp_shmem_create(SNAPSHOT_KEY__, sizeof(snapshot_t),
+                         (void**)&shared__) < 0) {
+        AIM_LOG_ERROR("The OID snapshot segment could not be attached.");
+        shared__ = NULL;
+    }
+}
+
+static snapshot_t*
+shared_get__(void)
+{
+    pthread_once(&shared_once__, shared_attach__);
+    return shared__;
+}
+
+
+/**************************************************************************//**
+ *
+ * Publisher
+ *
+ *****************************************************************************/
+
+static snapshot_t* private__;
+static onlp_shlock_t* publish_lock__;
+
+static snapshot_entry_t*
+entry_next__(snapshot_t* s)
+{
+    static int warned = 0;
+    if(s->count >= AIM_ARRAYSIZE(s->entries)) {
+        if(!warned) {
+            AIM_LOG_WARN("The OID snapshot is full (%d entries).",
+                         AIM_ARRAYSIZE(s->entries));
+            warned = 1;
+        }
+        return NULL;
+    }
+    return s->entries + s->count;
+}
+
+static int
+gather_iterate__(onlp_oid_t oid, void* cookie)
+{
+    int rv;
+    snapshot_t* s = (snapshot_t*)cookie;
+    snapshot_entry_t* e = entry_next__(s);
+
+    if(e == NULL) {
+        return 0;
+    }
+
+    switch(ONLP_OID_TYPE_GET(oid))
+        {
+#define ONLP_OID_TYPE_ENTRY(_name, _value, _upper, _lower)              \
+            case ONLP_OID_TYPE_##_name:                                 \
+                rv = onlp_##_lower##_info_get(oid, &e->info._lower);    \
+                e->size = sizeof(e->info._lower);                       \
+                break;
+#include <onlp/onlp.x>
+        default:
+            return 0;
+        }
+
+    if(ONLP_FAILURE(rv)) {
+        /* Publish the header so readers can see the OID exists. */
+        if(ONLP_FAILURE(onlp_oid_hdr_get(oid, &e->info.hdr))) {
+            return 0;
+        }
+        e->size = sizeof(e->info.hdr);
+    }
+    e->oid = oid;
+    s->count++;
+    return 0;
+}
+
+static void
+gather_sfps__(snapshot_t* s)
+{
+    int i, n;
+    int space = AIM_ARRAYSIZE(s->entries) - s->count;
+    onlp_sfp_info_t* info;
+
+    if(space <= 0) {
+        return;
+    }
+
+    info = aim_zmalloc(sizeof(*info)*space);
+    n = onlp_sfp_info_get_all(NULL, info, space);
+    for(i = 0; i < n; i++) {
+        snapshot_entry_t* e = s->entries + s->count++;
+        e->oid = info[i].hdr.id;
+        e->size = sizeof(e->info.sfp);
+        e->info.sfp = info[i];
+    }
+    aim_free(info);
+}
+
+static int
+entry_compare__(const void* a, const void* b)
+{
+    onlp_oid_t oa = ((const snapshot_entry_t*)a)->oid;
+    onlp_oid_t ob = ((const snapshot_entry_t*)b)->oid;
+    return (oa < ob) ? -1 : (oa > ob);
+}
+
+int
+onlp_oid_snapshot_publish(void)
+{
+    uint32_t seq;
+    snapshot_t* s;
+    snapshot_t* shared = shared_get__();
+
+    if(shared == NULL) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    if(private__ == NULL) {
+        if(onlp_shlock_create(SNAPSHOT_LOCK_KEY__, &publish_lock__,
+                              "onlp-oid-snapshot") < 0) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        private__ = aim_zmalloc(sizeof(*private__));
+    }
+
+    /*
+     * Everything is gathered into private memory first so
+     * the shared update is a single copy.
+     */
+    s = private__;
+    s->count = 0;
+    {
+        snapshot_entry_t* e = entry_next__(s);
+        if(e && ONLP_SUCCESS(onlp_chassis_info_get(ONLP_OID_CHASSIS,
+                                                   &e->info.chassis))) {
+            e->oid = ONLP_OID_CHASSIS;
+            e->size = sizeof(e->info.chassis);
+            s->count++;
+        }
+    }
+    onlp_oid_iterate(ONLP_OID_CHASSIS,
+                     ~(onlp_oid_type_flags_t)ONLP_OID_TYPE_FLAG_SFP,
+                     gather_iterate__, s);
+    gather_sfps__(s);
+    qsort(s->entries, s->count, sizeof(s->entries[0]), entry_compare__);
+
+    onlp_shlock_take(publish_lock__);
+
+    /* A publisher which died mid-update leaves the sequence odd. */
+    seq = shared->seq | 1;
+    __atomic_store_n(&shared->seq, seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(shared->entries, s->entries, sizeof(s->entries[0])*s->count);
+    shared->count = s->count;
+    shared->updated = os_time_monotonic();
+    shared->pid = getpid();
+    shared->size = sizeof(*shared);
+    shared->magic = SNAPSHOT_MAGIC__;
+
+    __atomic_store_n(&shared->seq, seq + 1, __ATOMIC_RELEASE);
+
+    onlp_shlock_give(publish_lock__);
+    return s->count;
+}
+
+
+/**************************************************************************//**
+ *
+ * Readers
+ *
+ *****************************************************************************/
+
+static snapshot_entry_t*
+entry_find__(snapshot_t* s, onlp_oid_t oid)
+{
+    /* The count may be torn during an update. The caller retries. */
+    int lo = 0;
+    int hi = (s->count > AIM_ARRAYSIZE(s->entries)) ?
+        AIM_ARRAYSIZE(s->entries) : s->count;
+
+    while(lo < hi) {
+        int mid = lo + (hi - lo)/2;
+        onlp_oid_t m = s->entries[mid].oid;
+        if(m == oid) {
+            return s->entries + mid;
+        }
+        if(m < oid) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+int
+onlp_oid_snapshot_info_get(onlp_oid_t oid, onlp_oid_hdr_t* info, int size,
+                           uint64_t* age)
+{
+    int retries;
+    snapshot_t* s = shared_get__();
+
+    if(info == NULL || size < sizeof(onlp_oid_hdr_t)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(s == NULL || s->magic != SNAPSHOT_MAGIC__ || s->size != sizeof(*s)) {
+        /* No publisher has run. */
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    for(retries = 0; retries < SNAPSHOT_READ_RETRIES__; retries++) {
+        int rv = ONLP_STATUS_E_INVALID;
+        uint64_t updated;
+        snapshot_entry_t* e;
+        uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+
+        if(seq & 1) {
+            sched_yield();
+            continue;
+        }
+
+        if( (e = entry_find__(s, oid)) ) {
+            int n = (e->size < size) ? e->size : size;
+            if(n > sizeof(snapshot_info_t)) {
+                n = sizeof(snapshot_info_t);
+            }
+            memcpy(info, &e->info, n);
+            if(n < size) {
+                /* Only the header was published for this OID. */
+                memset((uint8_t*)info + n, 0, size - n);
+                rv = ONLP_STATUS_E_MISSING;
+            }
+            else {
+                rv = ONLP_STATUS_OK;
+            }
+        }
+        updated = s->updated;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != seq) {
+            continue;
+        }
+
+        if(age) {
+            uint64_t now = os_time_monotonic();
+            *age = (now > updated) ? now - updated : 0;
+        }
+        return rv;
+    }
+
+    AIM_LOG_ERROR("OID snapshot read timed out (publisher %d).", s->pid);
+    return ONLP_STATUS_E_INTERNAL;
+}
+
+#else
+
+int
+onlp_oid_snapshot_publish(void)
+{
+    return ONLP_STATUS_E_UNSUPPORTED;
+}
+
+int
+onlp_oid_snapshot_info_get(onlp_oid_t oid, onlp_oid_hdr_t* info, int size,
+                           uint64_t* age)
+{
+    return ONLP_STATUS_E_UNSUPPORTED;
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_OID_SNAPSHOT */
+
+int
+onlp_oid_snapshot_hdr_get(onlp_oid_t oid, onlp_oid_hdr_t* hdr, uint64_t* age)
+{
+    return onlp_oid_snapshot_info_get(oid, hdr, sizeof(*hdr), age);
+}
@@ -0,0 +1,443 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * OID status change notifications.
+ *
+ * A single poller tracks the status of every OID of the subscribed
+ * types in tables indexed by OID id and publishes the transitions
+ * to all subscribers.
+ *
+ ***********************************************************/
+#include <onlp/onlp_config.h>
+#include <onlp/oids.h>
+#include <onlp/sfp.h>
+#include "onlp_log.h"
+#include "onlp_int.h"
+#include <AIM/aim.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+
+/** Status transitions reported when the subscriber does not specify any. */
+#define STATUS_MASK_DEFAULT__                   \
+    (ONLP_OID_STATUS_FLAG_PRESENT |             \
+     ONLP_OID_STATUS_FLAG_FAILED |              \
+     ONLP_OID_STATUS_FLAG_UNPLUGGED)
+
+typedef struct subscriber_s {
+    onlp_oid_type_flags_t types;
+    uint32_t mask;
+
+    /** Callback subscribers */
+    onlp_oid_status_f handler;
+    void* cookie;
+
+    /** Eventfd subscribers */
+    int fd;
+    onlp_oid_status_event_t* queue;
+    int head;
+    int count;
+    int dropped;
+
+} subscriber_t;
+
+/**
+ * Last known status for all OIDs of a single type, indexed by OID id.
+ */
+typedef struct status_table_s {
+    uint32_t* status;
+    /** The poll in which each OID was last seen. Zero if never. */
+    uint32_t* seen;
+    int size;
+    /** The initial poll of this type has completed. */
+    int baseline;
+} status_table_t;
+
+static struct {
+    pthread_once_t once;
+    pthread_mutex_t lock;
+    uint32_t poll;
+    int events;
+    subscriber_t* subscribers[ONLP_CONFIG_OID_STATUS_SUBSCRIBERS_MAX];
+    status_table_t tables[ONLP_OID_TYPE_GENERIC+1];
+} ctrl__ = { PTHREAD_ONCE_INIT };
+
+static void
+ctrl_init__(void)
+{
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    /* Handlers may subscribe or unsubscribe. */
+    pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&ctrl__.lock, &ma);
+    pthread_mutexattr_destroy(&ma);
+}
+
+#define LOCK__()                                        \
+    do {                                                \
+        pthread_once(&ctrl__.once, ctrl_init__);        \
+        pthread_mutex_lock(&ctrl__.lock);               \
+    } while(0)
+
+#define UNLOCK__() pthread_mutex_unlock(&ctrl__.lock)
+
+static void
+subscriber_queue__(subscriber_t* s, onlp_oid_status_event_t* event)
+{
+    int size = ONLP_CONFIG_OID_STATUS_QUEUE_SIZE;
+
+    if(s->count == size) {
+        /* Drop the oldest event. */
+        s->head = (s->head + 1) % size;
+        s->count--;
+        s->dropped++;
+    }
+    s->queue[(s->head + s->count) % size] = *event;
+    s->count++;
+}
+
+static void
+publish__(onlp_oid_status_event_t* event)
+{
+    int i;
+    uint32_t xor = event->previous ^ event->current;
+
+    ctrl__.events++;
+
+    for(i = 0; i < AIM_ARRAYSIZE(ctrl__.subscribers); i++) {
+        subscriber_t* s = ctrl__.subscribers[i];
+        if(s == NULL || !ONLP_OID_IS_TYPE_FLAGS(s->types, event->oid)) {
+            continue;
+        }
+        if(event->flags == 0 && (xor & s->mask) == 0) {
+            continue;
+        }
+        if(s->handler) {
+            s->handler(event, s->cookie);
+        }
+        else {
+            subscriber_queue__(s, event);
+        }
+    }
+}
+
+static void
+observe__(onlp_oid_t oid, uint32_t status)
+{
+    int type = ONLP_OID_TYPE_GET(oid);
+    int id = ONLP_OID_ID_GET(oid);
+    status_table_t* t;
+
+    if(type <= 0 || type >= AIM_ARRAYSIZE(ctrl__.tables)) {
+        return;
+    }
+    t = ctrl__.tables + type;
+
+    if(id >= t->size) {
+        int size = (id + 16) & ~15;
+        t->status = aim_realloc(t->status, size*sizeof(uint32_t));
+        t->seen = aim_realloc(t->seen, size*sizeof(uint32_t));
+        memset(t->status + t->size, 0, (size - t->size)*sizeof(uint32_t));
+        memset(t->seen + t->size, 0, (size - t->size)*sizeof(uint32_t));
+        t->size = size;
+    }
+
+    if(t->seen[id] == 0 || t->status[id] != status) {
+        onlp_oid_status_event_t event;
+        event.oid = oid;
+        event.previous = t->status[id];
+        event.current = status;
+        event.flags = 0;
+        if(t->seen[id] == 0) {
+            event.flags = (t->baseline) ? ONLP_OID_STATUS_EVENT_F_NEW :
+                ONLP_OID_STATUS_EVENT_F_INITIAL;
+        }
+        t->status[id] = status;
+        t->seen[id] = ctrl__.poll;
+        publish__(&event);
+    }
+    t->seen[id] = ctrl__.poll;
+}
+
+/**
+ * Mark a known OID as seen without changing its status.
+ * Used when the status could not be read this time.
+ */
+static void
+touch__(onlp_oid_t oid)
+{
+    int type = ONLP_OID_TYPE_GET(oid);
+    int id = ONLP_OID_ID_GET(oid);
+
+    if(type > 0 && type < AIM_ARRAYSIZE(ctrl__.tables) &&
+       id < ctrl__.tables[type].size && ctrl__.tables[type].seen[id]) {
+        ctrl__.tables[type].seen[id] = ctrl__.poll;
+    }
+}
+
+static int
+observe_iterate__(onlp_oid_t oid, void* cookie)
+{
+    onlp_oid_hdr_t hdr;
+    if(ONLP_SUCCESS(onlp_oid_hdr_get(oid, &hdr))) {
+        observe__(oid, hdr.status);
+    }
+    else {
+        touch__(oid);
+    }
+    return 0;
+}
+
+static int
+observe_sfps__(void)
+{
+    int p;
+    onlp_sfp_bitmap_t valid, present;
+
+    onlp_sfp_bitmap_t_init(&valid);
+    onlp_sfp_bitmap_t_init(&present);
+
+    /* One presence read instead of a header read per port. */
+    if(ONLP_FAILURE(onlp_sfp_bitmap_get(&valid)) ||
+       ONLP_FAILURE(onlp_sfp_presence_bitmap_get(&present))) {
+        return -1;
+    }
+
+    AIM_BITMAP_ITER(&valid, p) {
+        observe__(ONLP_SFP_ID_CREATE(p+1),
+                  AIM_BITMAP_GET(&present, p) ? ONLP_OID_STATUS_FLAG_PRESENT : 0);
+    }
+    return 0;
+}
+
+int
+onlp_oid_status_poll(void)
+{
+    int i, id, rv;
+    onlp_oid_type_flags_t types = 0;
+
+    LOCK__();
+
+    for(i = 0; i < AIM_ARRAYSIZE(ctrl__.subscribers); i++) {
+        if(ctrl__.subscribers[i]) {
+            types |= ctrl__.subscribers[i]->types;
+        }
+    }
+
+    ctrl__.events = 0;
+    if(++ctrl__.poll == 0) {
+        ctrl__.poll = 1;
+    }
+
+    /* The types which were walked successfully */
+    onlp_oid_type_flags_t walked = 0;
+
+    if(types & ~ONLP_OID_TYPE_FLAG_SFP) {
+        if(ONLP_SUCCESS(onlp_oid_iterate(ONLP_OID_CHASSIS,
+                                         types & ~ONLP_OID_TYPE_FLAG_SFP,
+                                         observe_iterate__, NULL))) {
+            walked |= types & ~ONLP_OID_TYPE_FLAG_SFP;
+        }
+    }
+    if(types & ONLP_OID_TYPE_FLAG_SFP) {
+        if(ONLP_SUCCESS(observe_sfps__())) {
+            walked |= ONLP_OID_TYPE_FLAG_SFP;
+        }
+    }
+
+    /* Anything not seen in a complete walk has gone away. */
+    for(i = 1; i < AIM_ARRAYSIZE(ctrl__.tables); i++) {
+        status_table_t* t = ctrl__.tables + i;
+        if((walked & (1 << i)) == 0) {
+            continue;
+        }
+        for(id = 0; id < t->size; id++) {
+            if(t->seen[id] && t->seen[id] != ctrl__.poll) {
+                onlp_oid_status_event_t event;
+                event.oid = ONLP_OID_TYPE_CREATE(i, id);
+                event.previous = t->status[id];
+                event.current = 0;
+                event.flags = ONLP_OID_STATUS_EVENT_F_GONE;
+                t->status[id] = 0;
+                t->seen[id] = 0;
+                publish__(&event);
+            }
+        }
+        t->baseline = 1;
+    }
+
+    /* Wake the eventfd subscribers with pending events. */
+    for(i = 0; i < AIM_ARRAYSIZE(ctrl__.subscribers); i++) {
+        subscriber_t* s = ctrl__.subscribers[i];
+        if(s && s->fd >= 0 && s->count) {
+            uint64_t one = 1;
+            if(write(s->fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+                AIM_LOG_ERROR("oid status eventfd write: %{errno}", errno);
+            }
+        }
+    }
+
+    rv = ctrl__.events;
+    UNLOCK__();
+    return rv;
+}
+
+static int
+subscribe__(subscriber_t* s)
+{
+    int i, rv = ONLP_STATUS_E_INTERNAL;
+
+    if(s->mask == 0) {
+        s->mask = STATUS_MASK_DEFAULT__;
+    }
+
+    LOCK__();
+    for(i = 0; i < AIM_ARRAYSIZE(ctrl__.subscribers); i++) {
+        if(ctrl__.subscribers[i] == NULL) {
+            ctrl__.subscribers[i] = s;
+            rv = i;
+            break;
+        }
+    }
+    UNLOCK__();
+
+    if(ONLP_FAILURE(rv)) {
+        AIM_LOG_ERROR("No OID status subscribers available.");
+    }
+    return rv;
+}
+
+int
+onlp_oid_status_subscribe(onlp_oid_type_flags_t types, uint32_t mask,
+                          onlp_oid_status_f handler, void* cookie)
+{
+    int rv;
+    subscriber_t* s;
+
+    if(handler == NULL || types == 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    s = aim_zmalloc(sizeof(*s));
+    s->types = types;
+    s->mask = mask;
+    s->handler = handler;
+    s->cookie = cookie;
+    s->fd = -1;
+
+    if(ONLP_FAILURE(rv = subscribe__(s))) {
+        aim_free(s);
+    }
+    return rv;
+}
+
+int
+onlp_oid_status_subscribe_fd(onlp_oid_type_flags_t types, uint32_t mask,
+                             int* fd)
+{
+    int rv;
+    subscriber_t* s;
+
+    if(fd == NULL || types == 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    s = aim_zmalloc(sizeof(*s));
+    s->types = types;
+    s->mask = mask;
+    if( (s->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("eventfd: %{errno}", errno);
+        aim_free(s);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    s->queue = aim_zmalloc(sizeof(*s->queue)*ONLP_CONFIG_OID_STATUS_QUEUE_SIZE);
+
+    if(ONLP_FAILURE(rv = subscribe__(s))) {
+        close(s->fd);
+        aim_free(s->queue);
+        aim_free(s);
+        return rv;
+    }
+    *fd = s->fd;
+    return rv;
+}
+
+int
+onlp_oid_status_read(int handle, onlp_oid_status_event_t* events, int max)
+{
+    int rv = 0;
+    subscriber_t* s;
+
+    if(handle < 0 || handle >= AIM_ARRAYSIZE(ctrl__.subscribers) ||
+       events == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    LOCK__();
+    if( (s = ctrl__.subscribers[handle]) == NULL || s->queue == NULL) {
+        rv = ONLP_STATUS_E_PARAM;
+    }
+    else {
+        uint64_t value;
+        if(s->dropped) {
+            AIM_LOG_WARN("OID status subscriber %d dropped %d events.",
+                         handle, s->dropped);
+            s->dropped = 0;
+        }
+        while(rv < max && s->count) {
+            events[rv++] = s->queue[s->head];
+            s->head = (s->head + 1) % ONLP_CONFIG_OID_STATUS_QUEUE_SIZE;
+            s->count--;
+        }
+        if(s->count == 0) {
+            /* Reset the eventfd until the next events arrive. */
+            while(read(s->fd, &value, sizeof(value)) > 0);
+        }
+    }
+    UNLOCK__();
+    return rv;
+}
+
+int
+onlp_oid_status_unsubscribe(int handle)
+{
+    subscriber_t* s;
+
+    if(handle < 0 || handle >= AIM_ARRAYSIZE(ctrl__.subscribers)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    LOCK__();
+    s = ctrl__.subscribers[handle];
+    ctrl__.subscribers[handle] = NULL;
+    UNLOCK__();
+
+    if(s == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if(s->fd >= 0) {
+        close(s->fd);
+    }
+    aim_free(s->queue);
+    aim_free(s);
+    return 0;
+}
@@ -147,9 +147,8 @@ int
 onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_flags_t types,
                  onlp_oid_iterate_f itf, void* cookie)
 {
-    int rv;
+    int rv, i, count;
     onlp_oid_hdr_t hdr;
-    onlp_oid_t* oidp;
 
     if(oid == 0) {
         oid = ONLP_OID_CHASSIS;
@@ -160,17 +159,20 @@ onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_flags_t types,
         return rv;
     }
 
+    /** Pack the children so both passes only visit populated entries. */
+    count = onlp_oid_table_pack(hdr.coids, hdr.coids);
+
     /** Iterate over all top level ids */
-    ONLP_OID_TABLE_ITER(hdr.coids, oidp) {
-        if(ONLP_OID_IS_TYPE_FLAGSZ(types, *oidp)) {
-            int rv = itf(*oidp, cookie);
+    for(i = 0; i < count; i++) {
+        if(ONLP_OID_IS_TYPE_FLAGSZ(types, hdr.coids[i])) {
+            int rv = itf(hdr.coids[i], cookie);
             if(rv < 0) {
                 return rv;
             }
         }
     }
-    ONLP_OID_TABLE_ITER(hdr.coids, oidp) {
-        rv = onlp_oid_iterate(*oidp, types, itf, cookie);
+    for(i = 0; i < count; i++) {
+        rv = onlp_oid_iterate(hdr.coids[i], types, itf, cookie);
         if(rv < 0) {
             return rv;
         }
@@ -178,6 +180,67 @@ onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_flags_t types,
     return ONLP_STATUS_OK;
 }
 
+int
+onlp_oid_table_pack(onlp_oid_table_t table, onlp_oid_t* dst)
+{
+    int i, count = 0;
+    for(i = 0; i < ONLP_OID_TABLE_SIZE; i++) {
+        if(table[i]) {
+            if(dst) {
+                dst[count] = table[i];
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+onlp_oid_chdr_t*
+onlp_oid_chdr_from_hdr(onlp_oid_hdr_t* hdr)
+{
+    int count = onlp_oid_table_pack(hdr->coids, NULL);
+    onlp_oid_chdr_t* chdr = aim_zmalloc(ONLP_OID_CHDR_SIZE(count));
+
+    chdr->id = hdr->id;
+    memcpy(chdr->description, hdr->description, sizeof(chdr->description));
+    chdr->poid = hdr->poid;
+    chdr->status = hdr->status;
+    chdr->ccount = onlp_oid_table_pack(hdr->coids, chdr->coids);
+    return chdr;
+}
+
+int
+onlp_oid_chdr_to_hdr(onlp_oid_chdr_t* chdr, onlp_oid_hdr_t* hdr)
+{
+    if(chdr->ccount > ONLP_OID_TABLE_SIZE) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->id = chdr->id;
+    memcpy(hdr->description, chdr->description, sizeof(hdr->description));
+    hdr->poid = chdr->poid;
+    hdr->status = chdr->status;
+    memcpy(hdr->coids, chdr->coids, sizeof(onlp_oid_t)*chdr->ccount);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_oid_chdr_get(onlp_oid_t oid, onlp_oid_chdr_t** chdr)
+{
+    int rv;
+    onlp_oid_hdr_t hdr;
+
+    if(chdr == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(ONLP_SUCCESS(rv = onlp_oid_hdr_get(oid, &hdr))) {
+        *chdr = onlp_oid_chdr_from_hdr(&hdr);
+    }
+    return rv;
+}
+
 typedef struct onlp_oid_get_all_ctrl_s {
     biglist_t* list;
     uint32_t flags;
@@ -262,6 +325,44 @@ onlp_oid_hdr_get_all(onlp_oid_t root, onlp_oid_type_flags_t types,
     return ctrl.rv;
 }
 
+static int
+onlp_oid_chdr_get_all_iterate__(onlp_oid_t oid, void* cookie)
+{
+    int rv;
+    onlp_oid_get_all_ctrl_t* ctrl = (onlp_oid_get_all_ctrl_t*)cookie;
+    onlp_oid_chdr_t* obj;
+    if(ONLP_SUCCESS(rv = onlp_oid_chdr_get(oid, &obj))) {
+        ctrl->list = biglist_append(ctrl->list, obj);
+        return 0;
+    }
+    else {
+        ctrl->rv = rv;
+        return -1;
+    }
+}
+
+int
+onlp_oid_chdr_get_all(onlp_oid_t root, onlp_oid_type_flags_t types,
+                      uint32_t flags, biglist_t** list)
+{
+    onlp_oid_get_all_ctrl_t ctrl;
+
+    ctrl.list = NULL;
+    ctrl.flags = flags;
+    ctrl.rv = 0;
+
+    onlp_oid_iterate(root, types, onlp_oid_chdr_get_all_iterate__,
+                     &ctrl);
+    if(ONLP_SUCCESS(ctrl.rv)) {
+        *list = ctrl.list;
+    }
+    else {
+        onlp_oid_get_all_free(ctrl.list);
+    }
+
+    return ctrl.rv;
+}
+
 int
 onlp_oid_get_all_free(biglist_t* list)
 {
@@ -329,15 +430,17 @@ onlp_oid_from_str(char* str, onlp_oid_t* oid)
     return ONLP_STATUS_E_PARAM;
 }
 
-int
-onlp_oid_table_to_json(onlp_oid_table_t table, cJSON** cjp)
+static int
+oid_array_to_json__(onlp_oid_t* oids, int count, cJSON** cjp)
 {
-    int rv;
+    int i, rv;
     cJSON* cj = cJSON_CreateArray();
-    onlp_oid_t* oidp;
-    ONLP_OID_TABLE_ITER(table, oidp) {
+    for(i = 0; i < count; i++) {
         char str[32];
-        if(ONLP_FAILURE(rv = onlp_oid_to_str(*oidp, str))) {
+        if(oids[i] == 0) {
+            continue;
+        }
+        if(ONLP_FAILURE(rv = onlp_oid_to_str(oids[i], str))) {
             cJSON_Delete(cj);
             return rv;
         }
@@ -347,6 +450,12 @@ onlp_oid_table_to_json(onlp_oid_table_t table, cJSON** cjp)
     return ONLP_STATUS_OK;
 }
 
+int
+onlp_oid_table_to_json(onlp_oid_table_t table, cJSON** cjp)
+{
+    return oid_array_to_json__(table, ONLP_OID_TABLE_SIZE, cjp);
+}
+
 int
 onlp_oid_table_from_json(cJSON* cj, onlp_oid_table_t table)
 {
@@ -374,27 +483,28 @@ onlp_oid_table_from_json(cJSON* cj, onlp_oid_table_t table)
     return ONLP_STATUS_OK;
 }
 
-int
-onlp_oid_hdr_to_json(onlp_oid_hdr_t* hdr, cJSON** cjp, uint32_t flags)
+static int
+oid_hdr_to_json__(onlp_oid_t id, const char* description, onlp_oid_t poid,
+                  onlp_oid_t* coids, int ccount, uint32_t status, cJSON** cjp)
 {
     int rv;
     char str[32];
 
-    if(ONLP_FAILURE(rv = onlp_oid_to_str(hdr->id, str))) {
+    if(ONLP_FAILURE(rv = onlp_oid_to_str(id, str))) {
         return ONLP_STATUS_E_PARAM;
     }
 
     cJSON* cj = cJSON_CreateObject();
     cJSON_AddStringToObject(cj, "id", str);
 
-    if(hdr->description[0]) {
-        cJSON_AddStringToObject(cj, "description", hdr->description);
+    if(description[0]) {
+        cJSON_AddStringToObject(cj, "description", description);
     }
     else {
         cJSON_AddNullToObject(cj, "description");
     }
-    if(hdr->poid) {
-        if(ONLP_FAILURE(rv = onlp_oid_to_str(hdr->poid, str))) {
+    if(poid) {
+        if(ONLP_FAILURE(rv = onlp_oid_to_str(poid, str))) {
             goto error;
         }
         cJSON_AddStringToObject(cj, "poid", str);
@@ -403,14 +513,14 @@ onlp_oid_hdr_to_json(onlp_oid_hdr_t* hdr, cJSON** cjp, uint32_t flags)
         cJSON_AddNullToObject(cj, "poid");
     }
 
-    cJSON* coids = NULL;
-    if(ONLP_FAILURE(rv = onlp_oid_table_to_json(hdr->coids, &coids))) {
+    cJSON* jcoids = NULL;
+    if(ONLP_FAILURE(rv = oid_array_to_json__(coids, ccount, &jcoids))) {
         goto error;
     }
 
-    cJSON_AddItemToObject(cj, "coids", coids);
-    cJSON* status = cjson_util_flag_array(hdr->status, onlp_oid_status_flag_map);
-    cJSON_AddItemToObject(cj, "status", status);
+    cJSON_AddItemToObject(cj, "coids", jcoids);
+    cJSON* jstatus = cjson_util_flag_array(status, onlp_oid_status_flag_map);
+    cJSON_AddItemToObject(cj, "status", jstatus);
 
     *cjp = cj;
     return ONLP_STATUS_OK;
@@ -420,6 +530,22 @@ onlp_oid_hdr_to_json(onlp_oid_hdr_t* hdr, cJSON** cjp, uint32_t flags)
     return ONLP_STATUS_E_PARAM;
 }
 
+int
+onlp_oid_hdr_to_json(onlp_oid_hdr_t* hdr, cJSON** cjp, uint32_t flags)
+{
+    return oid_hdr_to_json__(hdr->id, hdr->description, hdr->poid,
+                             hdr->coids, ONLP_OID_TABLE_SIZE,
+                             hdr->status, cjp);
+}
+
+int
+onlp_oid_chdr_to_json(onlp_oid_chdr_t* chdr, cJSON** cjp, uint32_t flags)
+{
+    return oid_hdr_to_json__(chdr->id, chdr->description, chdr->poid,
+                             chdr->coids, chdr->ccount,
+                             chdr->status, cjp);
+}
+
 int
 onlp_oid_hdr_from_json(cJSON* cj, onlp_oid_hdr_t* hdr)
 {
@@ -612,7 +738,7 @@ static int oid_compare__(const void* a, const void* b)
 void
 onlp_oid_hdr_sort(onlp_oid_hdr_t* hdr)
 {
-    qsort(hdr->coids, sizeof(onlp_oid_t), AIM_ARRAYSIZE(hdr->coids),
+    qsort(hdr->coids, AIM_ARRAYSIZE(hdr->coids), sizeof(onlp_oid_t),
           oid_compare__);
 }
 
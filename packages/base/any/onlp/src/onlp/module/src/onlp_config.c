@@ -115,6 +115,11 @@ onlp_config_settings_t onlp_config_settings[] =
 #else
 { ONLP_CONFIG_API_LOCK_TIMEOUT(__onlp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM) },
+#else
+{ ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef ONLP_CONFIG_INFO_STR_MAX
     { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INFO_STR_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INFO_STR_MAX) },
 #else
@@ -129,6 +134,81 @@ onlp_config_settings_t onlp_config_settings[] =
     { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_API_PROFILING), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_API_PROFILING) },
 #else
 { ONLP_CONFIG_INCLUDE_API_PROFILING(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_API_STATS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_API_STATS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_API_STATS) },
+#else
+{ ONLP_CONFIG_INCLUDE_API_STATS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_STATS_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_STATS_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_STATS_MAX) },
+#else
+{ ONLP_CONFIG_API_STATS_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_SFP_CACHE
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_SFP_CACHE), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_SFP_CACHE) },
+#else
+{ ONLP_CONFIG_INCLUDE_SFP_CACHE(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_DOM_CACHE_USECS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_DOM_CACHE_USECS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_DOM_CACHE_USECS) },
+#else
+{ ONLP_CONFIG_SFP_DOM_CACHE_USECS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_SFP_SWEEP
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_SFP_SWEEP), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_SFP_SWEEP) },
+#else
+{ ONLP_CONFIG_INCLUDE_SFP_SWEEP(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_SWEEP_WORKERS_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_SWEEP_WORKERS_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_SWEEP_WORKERS_MAX) },
+#else
+{ ONLP_CONFIG_SFP_SWEEP_WORKERS_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS) },
+#else
+{ ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_OID_STATUS_SUBSCRIBERS_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_OID_STATUS_SUBSCRIBERS_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_OID_STATUS_SUBSCRIBERS_MAX) },
+#else
+{ ONLP_CONFIG_OID_STATUS_SUBSCRIBERS_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_OID_STATUS_QUEUE_SIZE
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_OID_STATUS_QUEUE_SIZE), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_OID_STATUS_QUEUE_SIZE) },
+#else
+{ ONLP_CONFIG_OID_STATUS_QUEUE_SIZE(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_OID_SNAPSHOT
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_OID_SNAPSHOT), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_OID_SNAPSHOT) },
+#else
+{ ONLP_CONFIG_INCLUDE_OID_SNAPSHOT(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_OID_SNAPSHOT_ENTRIES_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_OID_SNAPSHOT_ENTRIES_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_OID_SNAPSHOT_ENTRIES_MAX) },
+#else
+{ ONLP_CONFIG_OID_SNAPSHOT_ENTRIES_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS) },
+#else
+{ ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
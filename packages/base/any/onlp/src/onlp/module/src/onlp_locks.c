@@ -28,8 +28,182 @@
 
 #if ONLP_CONFIG_INCLUDE_API_LOCK == 1
 
+#if ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM == 1
+
+/**
+ * Each domain has its own lock. The GLOBAL domain takes
+ * every other domain's lock, always in domain order.
+ *
+ * Locked APIs never call other locked APIs, so a thread
+ * holds at most one subsystem lock at a time.
+ */
+#define API_LOCK_FIRST__ (ONLP_API_LOCK_DOMAIN_GLOBAL + 1)
+
+static void lock_take__(int index, int rd, const char* api);
+static void lock_give__(int index);
+
+void
+onlp_api_lock(onlp_api_lock_domain_t domain, const char* api)
+{
+    int i;
+    if(domain == ONLP_API_LOCK_DOMAIN_GLOBAL) {
+        for(i = API_LOCK_FIRST__; i < ONLP_API_LOCK_DOMAIN_COUNT; i++) {
+            lock_take__(i, 0, api);
+        }
+    }
+    else {
+        lock_take__(domain, 0, api);
+    }
+}
+
+void
+onlp_api_rlock(onlp_api_lock_domain_t domain, const char* api)
+{
+    if(domain == ONLP_API_LOCK_DOMAIN_GLOBAL) {
+        onlp_api_lock(domain, api);
+    }
+    else {
+        lock_take__(domain, 1, api);
+    }
+}
+
+void
+onlp_api_unlock(onlp_api_lock_domain_t domain)
+{
+    int i;
+    if(domain == ONLP_API_LOCK_DOMAIN_GLOBAL) {
+        for(i = ONLP_API_LOCK_DOMAIN_COUNT-1; i >= API_LOCK_FIRST__; i--) {
+            lock_give__(i);
+        }
+    }
+    else {
+        lock_give__(domain);
+    }
+}
+
 #if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 0
 
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+/**
+ * Process-local reader/writer locks.
+ */
+static pthread_rwlock_t api_locks__[ONLP_API_LOCK_DOMAIN_COUNT];
+static const char* owner__[ONLP_API_LOCK_DOMAIN_COUNT];
+
+void
+onlp_api_lock_init(void)
+{
+    int i;
+    for(i = API_LOCK_FIRST__; i < ONLP_API_LOCK_DOMAIN_COUNT; i++) {
+        pthread_rwlock_init(api_locks__ + i, NULL);
+    }
+}
+
+void
+onlp_api_lock_denit(void)
+{
+    int i;
+    for(i = API_LOCK_FIRST__; i < ONLP_API_LOCK_DOMAIN_COUNT; i++) {
+        pthread_rwlock_destroy(api_locks__ + i);
+    }
+}
+
+static void
+lock_take__(int index, int rd, const char* api)
+{
+    int rv;
+    pthread_rwlock_t* l = api_locks__ + index;
+
+    if(ONLP_CONFIG_API_LOCK_TIMEOUT == 0) {
+        rv = (rd) ? pthread_rwlock_rdlock(l) : pthread_rwlock_wrlock(l);
+    }
+    else {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += ONLP_CONFIG_API_LOCK_TIMEOUT / 1000000;
+        ts.tv_nsec += (ONLP_CONFIG_API_LOCK_TIMEOUT % 1000000) * 1000;
+        if(ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        rv = (rd) ? pthread_rwlock_timedrdlock(l, &ts) : pthread_rwlock_timedwrlock(l, &ts);
+    }
+
+    if(rv != 0) {
+        AIM_DIE("The ONLP API lock (domain %d) in %s could not be acquired after %d microseconds. It appears to be currently owned by call to %s. This is considered fatal.",
+                index, api, ONLP_CONFIG_API_LOCK_TIMEOUT,
+                owner__[index] ? owner__[index] : "(none)");
+    }
+    if(!rd) {
+        owner__[index] = api;
+    }
+}
+
+static void
+lock_give__(int index)
+{
+    pthread_rwlock_unlock(api_locks__ + index);
+}
+
+#else
+
+#include <onlplib/shlocks.h>
+
+/**
+ * Shared mutexes, one per domain. These are exclusive
+ * for both readers and writers.
+ */
+#define API_SHLOCK_KEY_BASE__ (ONLP_SHLOCK_GLOBAL_KEY + 0x100)
+static onlp_shlock_t* api_locks__[ONLP_API_LOCK_DOMAIN_COUNT];
+
+void
+onlp_api_lock_init(void)
+{
+    int i;
+    for(i = API_LOCK_FIRST__; i < ONLP_API_LOCK_DOMAIN_COUNT; i++) {
+        if(api_locks__[i] == NULL &&
+           onlp_shlock_create(API_SHLOCK_KEY_BASE__ + i, api_locks__ + i,
+                              "onlp-api-lock-%d", i) < 0) {
+            AIM_DIE("API lock %d creation failed.", i);
+        }
+    }
+}
+
+void
+onlp_api_lock_denit(void)
+{
+    int i;
+    /*
+     * Only this process' references are released. The shared
+     * segments stay behind for any other process using them.
+     */
+    for(i = API_LOCK_FIRST__; i < ONLP_API_LOCK_DOMAIN_COUNT; i++) {
+        if(api_locks__[i]) {
+            onlp_shlock_destroy(api_locks__[i]);
+            api_locks__[i] = NULL;
+        }
+    }
+}
+
+static void
+lock_take__(int index, int rd, const char* api)
+{
+    onlp_shlock_take(api_locks__[index]);
+}
+
+static void
+lock_give__(int index)
+{
+    onlp_shlock_give(api_locks__[index]);
+}
+
+#endif /* ONLP_CONFIG_API_LOCK_GLOBAL_SHARED */
+
+#elif ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 0
+
 #include <OS/os_sem.h>
 
 /**
@@ -52,7 +226,7 @@ onlp_api_lock_denit(void)
 }
 
 void
-onlp_api_lock(const char* api)
+onlp_api_lock(onlp_api_lock_domain_t domain, const char* api)
 {
     if(os_sem_take_timeout(api_sem__, ONLP_CONFIG_API_LOCK_TIMEOUT) != 0) {
         AIM_DIE("The ONLP API lock in %s could not be acquired after %d microseconds. It appears to be currently owned by call to %s. This is considered fatal.",
@@ -62,7 +236,13 @@ onlp_api_lock(const char* api)
 }
 
 void
-onlp_api_unlock(void)
+onlp_api_rlock(onlp_api_lock_domain_t domain, const char* api)
+{
+    onlp_api_lock(domain, api);
+}
+
+void
+onlp_api_unlock(onlp_api_lock_domain_t domain)
 {
     os_sem_give(api_sem__);
 }
@@ -84,12 +264,19 @@ onlp_api_lock_denit(void)
 }
 
 void
-onlp_api_lock(const char* api)
+onlp_api_lock(onlp_api_lock_domain_t domain, const char* api)
 {
     onlp_shlock_global_take();
 }
+
+void
+onlp_api_rlock(onlp_api_lock_domain_t domain, const char* api)
+{
+    onlp_shlock_global_take();
+}
+
 void
-onlp_api_unlock(void)
+onlp_api_unlock(onlp_api_lock_domain_t domain)
 {
     onlp_shlock_global_give();
 }
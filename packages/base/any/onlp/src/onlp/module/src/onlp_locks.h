@@ -27,6 +27,29 @@
 
 #include <onlp/onlp_config.h>
 
+/**
+ * API lock domains.
+ *
+ * Each source file which instantiates locked APIs defines
+ * ONLP_API_LOCK_DOMAIN before including this file. Files which
+ * do not are in the GLOBAL domain, which excludes all others.
+ *
+ * All domains share a single lock unless
+ * ONLP_CONFIG_API_LOCK_PER_SUBSYSTEM is enabled.
+ */
+typedef enum onlp_api_lock_domain_e {
+    ONLP_API_LOCK_DOMAIN_GLOBAL = 0,
+#define ONLP_OID_TYPE_ENTRY(_name, _id, _upper, _lower) \
+    ONLP_API_LOCK_DOMAIN_##_upper = _id,
+#include <onlp/onlp.x>
+    ONLP_API_LOCK_DOMAIN_ATTRIBUTE,
+    ONLP_API_LOCK_DOMAIN_COUNT,
+} onlp_api_lock_domain_t;
+
+#ifndef ONLP_API_LOCK_DOMAIN
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_GLOBAL
+#endif
+
 #if ONLP_CONFIG_INCLUDE_API_LOCK == 1
 
 /**
@@ -40,24 +63,37 @@ void onlp_api_lock_init();
 void onlp_api_lock_denit(void);
 
 /**
- * @brief Take the ONLP API lock.
+ * @brief Take the ONLP API lock for exclusive access.
+ * @param domain The lock domain.
+ * @param api The calling API.
+ */
+void onlp_api_lock(onlp_api_lock_domain_t domain, const char* api);
+
+/**
+ * @brief Take the ONLP API lock for read access.
+ * @param domain The lock domain.
+ * @param api The calling API.
+ * @note Readers may share the lock if the lock implementation supports it.
  */
-void onlp_api_lock(const char* api);
+void onlp_api_rlock(onlp_api_lock_domain_t domain, const char* api);
 
 /**
  * @brief Give the ONLP API lock.
+ * @param domain The lock domain.
  */
-void onlp_api_unlock(void);
+void onlp_api_unlock(onlp_api_lock_domain_t domain);
 
 
 #define ONLP_API_LOCK_INIT() onlp_api_lock_init()
-#define ONLP_API_LOCK(_api)      onlp_api_lock(_api)
-#define ONLP_API_UNLOCK()    onlp_api_unlock()
+#define ONLP_API_LOCK(_api)      onlp_api_lock(ONLP_API_LOCK_DOMAIN, _api)
+#define ONLP_API_RLOCK(_api)     onlp_api_rlock(ONLP_API_LOCK_DOMAIN, _api)
+#define ONLP_API_UNLOCK()    onlp_api_unlock(ONLP_API_LOCK_DOMAIN)
 
 #else
 
 #define ONLP_API_LOCK_INIT()
 #define ONLP_API_LOCK(_api)
+#define ONLP_API_RLOCK(_api)
 #define ONLP_API_UNLOCK()
 
 #endif /** ONLP_CONFIG_INCLUDE_API_LOCK */
@@ -75,165 +111,271 @@ void onlp_api_unlock(void);
 
 #define ONLP_LOCKED_API_NAME(_name) _name##_locked__
 
+/*
+ * ONLP_LOCKED_APIn() take the API lock for exclusive access.
+ * ONLP_LOCKED_RAPIn() take the API lock for read access and must only
+ * be used for APIs which do not modify any shared state.
+ */
+
+#if ONLP_CONFIG_INCLUDE_API_STATS == 1
+
+/**
+ * Latency histograms use log2 microsecond buckets.
+ * Bucket 0 counts calls under 1us. Bucket N counts calls
+ * in [2^(N-1), 2^N) usecs. The last bucket is open ended.
+ */
+#define ONLP_API_STATS_BUCKETS 24
+
+/**
+ * Per-API statistics. All counters are updated atomically.
+ */
+typedef struct onlp_api_stats_s {
+    /** The API name */
+    const char* name;
+    /** Number of calls */
+    uint64_t calls;
+    /** Number of calls which returned an error */
+    uint64_t errors;
+    /** Total and maximum lock wait time (usecs) */
+    uint64_t ltime;
+    uint64_t lmax;
+    /** Total and maximum function time (usecs) */
+    uint64_t ftime;
+    uint64_t fmax;
+    /** Lock wait histogram */
+    uint64_t lhist[ONLP_API_STATS_BUCKETS];
+    /** Function time histogram */
+    uint64_t fhist[ONLP_API_STATS_BUCKETS];
+} onlp_api_stats_t;
+
+/**
+ * @brief Get the statistics slot for the given API.
+ * @param name The API name. This must be a static string.
+ */
+onlp_api_stats_t* onlp_api_stats_register(const char* name);
+
+/**
+ * @brief Record a single API call.
+ * @param stats The API statistics slot.
+ * @param ltime The lock wait time.
+ * @param ftime The function time.
+ * @param rv The return value.
+ */
+void onlp_api_stats_record(onlp_api_stats_t* stats,
+                           uint64_t ltime, uint64_t ftime, int rv);
+
+#define ONLP_API_STATS__(_name, _rv)                                    \
+    do {                                                                \
+        static onlp_api_stats_t* _stats = NULL;                         \
+        onlp_api_stats_t* _s = __atomic_load_n(&_stats, __ATOMIC_ACQUIRE); \
+        if(_s == NULL) {                                                \
+            _s = onlp_api_stats_register(#_name);                       \
+            __atomic_store_n(&_stats, _s, __ATOMIC_RELEASE);            \
+        }                                                               \
+        onlp_api_stats_record(_s, t1-t0, t2-t1, _rv);                   \
+    } while(0)
+
+#else
+
+#define ONLP_API_STATS__(_name, _rv)
+
+#endif /* ONLP_CONFIG_INCLUDE_API_STATS */
+
 #if ONLP_CONFIG_INCLUDE_API_PROFILING == 1
 
+#define ONLP_API_PROFILE__(_name)                                       \
+    AIM_LOG_MSG("API '%s' : (total=%"PRId64", ltime=%"PRId64" ftime=%"PRId64")", #_name, t2-t0, t1-t0, t2-t1)
+
+#else
+
+#define ONLP_API_PROFILE__(_name)
+
+#endif /* ONLP_CONFIG_INCLUDE_API_PROFILING */
+
+#if ONLP_CONFIG_INCLUDE_API_PROFILING == 1 || ONLP_CONFIG_INCLUDE_API_STATS == 1
+
 #define ONLP_API_T0(_name)                              \
     uint64_t t0, t1, t2; t0 = aim_time_monotonic()
 
 #define ONLP_API_T1(_name)                      \
     t1 = aim_time_monotonic();
 
-#define ONLP_API_T2(_name)                                              \
+#define ONLP_API_T2(_name, _rv)                                         \
     do {                                                                \
         t2 = aim_time_monotonic();                                      \
-        AIM_LOG_MSG("API '%s' : (total=%"PRId64", ltime=%"PRId64" ftime=%"PRId64")", #_name, t2-t0, t1-t0, t2-t1); \
+        ONLP_API_PROFILE__(_name);                                      \
+        ONLP_API_STATS__(_name, _rv);                                   \
     } while(0)
 
 #else
 
 #define ONLP_API_T0(_name)
 #define ONLP_API_T1(_name)
-#define ONLP_API_T2(_name)
+#define ONLP_API_T2(_name, _rv)
 
 #endif
 
-#define ONLP_LOCKED_API0(_name)                            \
-    int _name (void)                                       \
-    {                                                      \
-        ONLP_API_T0(_name);                                \
-        ONLP_API_LOCK(#_name);                             \
-        ONLP_API_T1(_name);                                \
-        int _rv = ONLP_LOCKED_API_NAME(_name)();           \
-        ONLP_API_UNLOCK();                                 \
-        ONLP_API_T2(_name);                                \
-        return _rv;                                        \
-    }
-
-#define ONLP_LOCKED_API1(_name, _t, _v)                         \
-    int _name (_t _v)                                           \
-    {                                                           \
-        ONLP_API_T0(_name);                                     \
-        ONLP_API_LOCK(#_name);                                  \
-        ONLP_API_T1(_name);                                     \
-        int _rv = ONLP_LOCKED_API_NAME(_name)(_v);              \
-        ONLP_API_UNLOCK();                                      \
-        ONLP_API_T2(_name);                                     \
-        return _rv;                                             \
-    }
-
-#define ONLP_LOCKED_API2(_name, _t1, _v1, _t2, _v2)                     \
-    int _name (_t1 _v1, _t2 _v2)                                        \
+#define ONLP_LOCKED_API0_(_lock, _name)                                 \
+    int _name (void)                                                    \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        _lock(#_name);                                                  \
         ONLP_API_T1(_name);                                             \
-        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2);               \
+        int _rv = ONLP_LOCKED_API_NAME(_name)();                        \
         ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        ONLP_API_T2(_name, _rv);                                        \
         return _rv;                                                     \
     }
+#define ONLP_LOCKED_API0(_name) ONLP_LOCKED_API0_(ONLP_API_LOCK, _name)
+#define ONLP_LOCKED_RAPI0(_name) ONLP_LOCKED_API0_(ONLP_API_RLOCK, _name)
 
-#define ONLP_LOCKED_API3(_name, _t1, _v1, _t2, _v2, _t3, _v3)           \
-    int _name (_t1 _v1, _t2 _v2, _t3 _v3)                               \
+#define ONLP_LOCKED_API1_(_lock, _name, _t, _v)                         \
+    int _name (_t _v)                                                   \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        _lock(#_name);                                                  \
         ONLP_API_T1(_name);                                             \
-        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);          \
+        int _rv = ONLP_LOCKED_API_NAME(_name)(_v);                      \
         ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        ONLP_API_T2(_name, _rv);                                        \
         return _rv;                                                     \
     }
+#define ONLP_LOCKED_API1(...) ONLP_LOCKED_API1_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI1(...) ONLP_LOCKED_API1_(ONLP_API_RLOCK, __VA_ARGS__)
 
-#define ONLP_LOCKED_API4(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
-    int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4)                      \
+#define ONLP_LOCKED_API2_(_lock, _name, _t1, _v1, _t2, _v2)             \
+    int _name (_t1 _v1, _t2 _v2)                                        \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        _lock(#_name);                                                  \
         ONLP_API_T1(_name);                                             \
-        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);     \
+        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2);               \
         ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        ONLP_API_T2(_name, _rv);                                        \
         return _rv;                                                     \
     }
+#define ONLP_LOCKED_API2(...) ONLP_LOCKED_API2_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI2(...) ONLP_LOCKED_API2_(ONLP_API_RLOCK, __VA_ARGS__)
 
-#define ONLP_LOCKED_API5(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
-    int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5)             \
+#define ONLP_LOCKED_API3_(_lock, _name, _t1, _v1, _t2, _v2, _t3, _v3)   \
+    int _name (_t1 _v1, _t2 _v2, _t3 _v3)                               \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        _lock(#_name);                                                  \
         ONLP_API_T1(_name);                                             \
-        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5); \
+        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);          \
         ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        ONLP_API_T2(_name, _rv);                                        \
         return _rv;                                                     \
     }
-
-#define ONLP_LOCKED_VAPI0(_name)                                 \
-    void _name (void)                                            \
-    {                                                            \
-        ONLP_API_T0(_name);                                      \
-        ONLP_API_LOCK(#_name);                                   \
-        ONLP_API_T1(_name);                                      \
-        ONLP_LOCKED_API_NAME(_name)();                           \
-        ONLP_API_UNLOCK();                                       \
-        ONLP_API_T2(_name);                                      \
+#define ONLP_LOCKED_API3(...) ONLP_LOCKED_API3_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI3(...) ONLP_LOCKED_API3_(ONLP_API_RLOCK, __VA_ARGS__)
+
+#define ONLP_LOCKED_API4_(_lock, _name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
+    int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4)                              \
+    {                                                                           \
+        ONLP_API_T0(_name);                                                     \
+        _lock(#_name);                                                          \
+        ONLP_API_T1(_name);                                                     \
+        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);             \
+        ONLP_API_UNLOCK();                                                      \
+        ONLP_API_T2(_name, _rv);                                                \
+        return _rv;                                                             \
     }
-
-#define ONLP_LOCKED_VAPI1(_name, _t, _v)                  \
-    void _name (_t _v)                                    \
-    {                                                     \
-        ONLP_API_T0(_name);                               \
-        ONLP_API_LOCK(#_name);                            \
-        ONLP_API_T1(_name);                               \
-        ONLP_LOCKED_API_NAME(_name)(_v);                  \
-        ONLP_API_UNLOCK();                                \
-        ONLP_API_T2(_name);                               \
+#define ONLP_LOCKED_API4(...) ONLP_LOCKED_API4_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI4(...) ONLP_LOCKED_API4_(ONLP_API_RLOCK, __VA_ARGS__)
+
+#define ONLP_LOCKED_API5_(_lock, _name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
+    int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5)                               \
+    {                                                                                     \
+        ONLP_API_T0(_name);                                                               \
+        _lock(#_name);                                                                    \
+        ONLP_API_T1(_name);                                                               \
+        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5);                  \
+        ONLP_API_UNLOCK();                                                                \
+        ONLP_API_T2(_name, _rv);                                                          \
+        return _rv;                                                                       \
     }
+#define ONLP_LOCKED_API5(...) ONLP_LOCKED_API5_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_RAPI5(...) ONLP_LOCKED_API5_(ONLP_API_RLOCK, __VA_ARGS__)
 
-#define ONLP_LOCKED_VAPI2(_name, _t1, _v1, _t2, _v2)              \
-    void _name (_t1 _v1, _t2 _v2)                                 \
-    {                                                             \
-        ONLP_API_T0(_name);                                       \
-        ONLP_API_LOCK(#_name);                                    \
-        ONLP_API_T1(_name);                                       \
-        ONLP_LOCKED_API_NAME(_name) (_v1, _v2);                   \
-        ONLP_API_UNLOCK();                                        \
-        ONLP_API_T2(_name);                                       \
+#define ONLP_LOCKED_VAPI0_(_lock, _name)                                \
+    void _name (void)                                                   \
+    {                                                                   \
+        ONLP_API_T0(_name);                                             \
+        _lock(#_name);                                                  \
+        ONLP_API_T1(_name);                                             \
+        ONLP_LOCKED_API_NAME(_name)();                                  \
+        ONLP_API_UNLOCK();                                              \
+        ONLP_API_T2(_name, 0);                                          \
     }
+#define ONLP_LOCKED_VAPI0(_name) ONLP_LOCKED_VAPI0_(ONLP_API_LOCK, _name)
+#define ONLP_LOCKED_VRAPI0(_name) ONLP_LOCKED_VAPI0_(ONLP_API_RLOCK, _name)
 
-#define ONLP_LOCKED_VAPI3(_name, _t1, _v1, _t2, _v2, _t3, _v3)          \
-    void _name (_t1 _v1, _t2 _v2, _t3 _v3)                              \
+#define ONLP_LOCKED_VAPI1_(_lock, _name, _t, _v)                        \
+    void _name (_t _v)                                                  \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        _lock(#_name);                                                  \
         ONLP_API_T1(_name);                                             \
-        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);                    \
+        ONLP_LOCKED_API_NAME(_name)(_v);                                \
         ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2_(name);                                             \
+        ONLP_API_T2(_name, 0);                                          \
     }
+#define ONLP_LOCKED_VAPI1(...) ONLP_LOCKED_VAPI1_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_VRAPI1(...) ONLP_LOCKED_VAPI1_(ONLP_API_RLOCK, __VA_ARGS__)
 
-#define ONLP_LOCKED_VAPI4(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
-    void _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4)                     \
+#define ONLP_LOCKED_VAPI2_(_lock, _name, _t1, _v1, _t2, _v2)            \
+    void _name (_t1 _v1, _t2 _v2)                                       \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        _lock(#_name);                                                  \
         ONLP_API_T1(_name);                                             \
-        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);               \
+        ONLP_LOCKED_API_NAME(_name) (_v1, _v2);                         \
         ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        ONLP_API_T2(_name, 0);                                          \
     }
+#define ONLP_LOCKED_VAPI2(...) ONLP_LOCKED_VAPI2_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_VRAPI2(...) ONLP_LOCKED_VAPI2_(ONLP_API_RLOCK, __VA_ARGS__)
 
-#define ONLP_LOCKED_VAPI5(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
-    void _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5)            \
+#define ONLP_LOCKED_VAPI3_(_lock, _name, _t1, _v1, _t2, _v2, _t3, _v3)  \
+    void _name (_t1 _v1, _t2 _v2, _t3 _v3)                              \
     {                                                                   \
         ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
+        _lock(#_name);                                                  \
         ONLP_API_T1(_name);                                             \
-        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5);          \
+        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);                    \
         ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        ONLP_API_T2(_name, 0);                                          \
+    }
+#define ONLP_LOCKED_VAPI3(...) ONLP_LOCKED_VAPI3_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_VRAPI3(...) ONLP_LOCKED_VAPI3_(ONLP_API_RLOCK, __VA_ARGS__)
+
+#define ONLP_LOCKED_VAPI4_(_lock, _name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
+    void _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4)                              \
+    {                                                                            \
+        ONLP_API_T0(_name);                                                      \
+        _lock(#_name);                                                           \
+        ONLP_API_T1(_name);                                                      \
+        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);                        \
+        ONLP_API_UNLOCK();                                                       \
+        ONLP_API_T2(_name, 0);                                                   \
+    }
+#define ONLP_LOCKED_VAPI4(...) ONLP_LOCKED_VAPI4_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_VRAPI4(...) ONLP_LOCKED_VAPI4_(ONLP_API_RLOCK, __VA_ARGS__)
+
+#define ONLP_LOCKED_VAPI5_(_lock, _name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
+    void _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5)                               \
+    {                                                                                      \
+        ONLP_API_T0(_name);                                                                \
+        _lock(#_name);                                                                     \
+        ONLP_API_T1(_name);                                                                \
+        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5);                             \
+        ONLP_API_UNLOCK();                                                                 \
+        ONLP_API_T2(_name, 0);                                                             \
     }
+#define ONLP_LOCKED_VAPI5(...) ONLP_LOCKED_VAPI5_(ONLP_API_LOCK, __VA_ARGS__)
+#define ONLP_LOCKED_VRAPI5(...) ONLP_LOCKED_VAPI5_(ONLP_API_RLOCK, __VA_ARGS__)
 
 
 
@@ -297,6 +297,13 @@ sighandler__(int signal)
     onlp_platform_manager_stop(0);
 }
 
+static int
+oid_snapshot_publish__(void* cookie)
+{
+    int rv = onlp_oid_snapshot_publish();
+    return (rv < 0) ? rv : 0;
+}
+
 static void
 platform_manager_daemon__(const char* pidfile, char** argv)
 {
@@ -336,6 +343,18 @@ platform_manager_daemon__(const char* pidfile, char** argv)
     /** Signal handler for terminating the platform manager */
     signal(SIGTERM, sighandler__);
 
+    /**
+     * Publish the shared OID snapshot for other processes.
+     * This reads every OID, including the SFP EEPROMs and DOM,
+     * so it is only done when the build asks for it.
+     */
+    if(ONLP_CONFIG_INCLUDE_OID_SNAPSHOT &&
+       ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS > 0) {
+        onlp_platform_manager_register("OID Snapshot", oid_snapshot_publish__, NULL,
+                                       ONLP_CONFIG_OID_SNAPSHOT_PUBLISH_USECS,
+                                       ONLP_PLATFORM_MANAGER_F_NOW);
+    }
+
     /** Start and block in platform manager. */
     onlp_platform_manager_start(1);
 
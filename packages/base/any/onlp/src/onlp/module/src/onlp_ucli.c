@@ -468,6 +468,54 @@ onlp_ucli__platform__manager__daemon__(ucli_context_t* uc)
     return UCLI_STATUS_E_INTERNAL;
 }
 
+static ucli_status_t
+onlp_ucli__debug__api__stats__show__(ucli_context_t* uc)
+{
+    UCLI_COMMAND_INFO(uc,
+                      "show", 0,
+                      "$summary#Show the API call statistics.");
+    onlp_api_stats_show(&uc->pvs, 0);
+    return UCLI_STATUS_OK;
+}
+
+static ucli_status_t
+onlp_ucli__debug__api__stats__histograms__(ucli_context_t* uc)
+{
+    UCLI_COMMAND_INFO(uc,
+                      "histograms", 0,
+                      "$summary#Show the API call statistics and latency histograms.");
+    onlp_api_stats_show(&uc->pvs, 1);
+    return UCLI_STATUS_OK;
+}
+
+static ucli_status_t
+onlp_ucli__debug__api__stats__json__(ucli_context_t* uc)
+{
+    UCLI_COMMAND_INFO(uc,
+                      "json", 0,
+                      "$summary#Show the API call statistics as JSON.");
+    int rv;
+    cJSON* cj;
+    if(ONLP_SUCCESS(rv = onlp_api_stats_to_json(&cj))) {
+        cjson_util_json_pvs(&uc->pvs, cj);
+        cJSON_Delete(cj);
+    }
+    else {
+        ucli_printf(uc, "onlp_api_stats_to_json failed: %{onlp_status}", rv);
+    }
+    return UCLI_STATUS_OK;
+}
+
+static ucli_status_t
+onlp_ucli__debug__api__stats__reset__(ucli_context_t* uc)
+{
+    UCLI_COMMAND_INFO(uc,
+                      "reset", 0,
+                      "$summary#Reset the API call statistics.");
+    onlp_api_stats_reset();
+    return UCLI_STATUS_OK;
+}
+
 
 /* <auto.ucli.handlers.start> */
 /******************************************************************************
@@ -673,6 +721,24 @@ static ucli_module_t onlp_ucli__debug__oid__to__to__module__ =
     NULL,
     NULL
 };
+ucli_node_t* onlp_ucli__debug__api__node__ = NULL;
+ucli_node_t* onlp_ucli__debug__api__stats__node__ = NULL;
+static ucli_command_handler_f onlp_ucli__debug__api__stats__stats__handlers__[] = 
+{
+    onlp_ucli__debug__api__stats__show__,
+    onlp_ucli__debug__api__stats__histograms__,
+    onlp_ucli__debug__api__stats__json__,
+    onlp_ucli__debug__api__stats__reset__,
+    NULL
+};
+static ucli_module_t onlp_ucli__debug__api__stats__stats__module__ = 
+{
+    "stats",
+    NULL,
+    onlp_ucli__debug__api__stats__stats__handlers__,
+    NULL,
+    NULL
+};
 static ucli_node_t* __ucli_auto_init__(void)
 {
     if(onlp_ucli__node__ == NULL) onlp_ucli__node__ = ucli_node_create("onlp", NULL, NULL);
@@ -709,6 +775,9 @@ static ucli_node_t* __ucli_auto_init__(void)
     ucli_module_init(&onlp_ucli__debug__oid__from__from__module__);
     if(onlp_ucli__debug__oid__to__node__ == NULL) onlp_ucli__debug__oid__to__node__ = ucli_node_create("to", NULL, NULL);
     ucli_module_init(&onlp_ucli__debug__oid__to__to__module__);
+    if(onlp_ucli__debug__api__node__ == NULL) onlp_ucli__debug__api__node__ = ucli_node_create("api", NULL, NULL);
+    if(onlp_ucli__debug__api__stats__node__ == NULL) onlp_ucli__debug__api__stats__node__ = ucli_node_create("stats", NULL, NULL);
+    ucli_module_init(&onlp_ucli__debug__api__stats__stats__module__);
     ucli_node_subnode_add(onlp_ucli__node__, onlp_ucli__oid__node__);
     ucli_node_subnode_add(onlp_ucli__oid__node__, onlp_ucli__oid__hdr__node__);
     ucli_node_subnode_add(onlp_ucli__oid__hdr__node__, onlp_ucli__oid__hdr__json__node__);
@@ -742,6 +811,9 @@ static ucli_node_t* __ucli_auto_init__(void)
     ucli_node_module_add(onlp_ucli__debug__oid__from__node__, &onlp_ucli__debug__oid__from__from__module__);
     ucli_node_subnode_add(onlp_ucli__debug__oid__node__, onlp_ucli__debug__oid__to__node__);
     ucli_node_module_add(onlp_ucli__debug__oid__to__node__, &onlp_ucli__debug__oid__to__to__module__);
+    ucli_node_subnode_add(onlp_ucli__debug__node__, onlp_ucli__debug__api__node__);
+    ucli_node_subnode_add(onlp_ucli__debug__api__node__, onlp_ucli__debug__api__stats__node__);
+    ucli_node_module_add(onlp_ucli__debug__api__stats__node__, &onlp_ucli__debug__api__stats__stats__module__);
     return onlp_ucli__node__;
 }
 /******************************************************************************/
@@ -24,143 +24,410 @@
  ***********************************************************/
 #include <onlp/psu.h>
 #include <onlp/fan.h>
+#include <onlp/platform.h>
 #include <onlp/platformi/platformi.h>
 #include <onlplib/mmap.h>
-#include <timer_wheel/timer_wheel.h>
 #include <OS/os_time.h>
 #include <OS/os_thread.h>
 #include <AIM/aim.h>
 #include "onlp_log.h"
 #include "onlp_int.h"
 #include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/epoll.h>
+#include <unistd.h>
 #include <errno.h>
 #include <pthread.h>
 
 /**
- * Timer wheel callback entry.
+ * Management callback entry.
  */
 typedef struct management_entry_s {
-    /** Timer wheel for this entry */
-    timer_wheel_entry_t twe;
+    /** The callback for this entry */
+    onlp_platform_manager_f manage;
 
-    /** This is the callback for this timer */
-    int (*manage)(void);
+    /** Callback cookie */
+    void* cookie;
 
-    /** This is the callback rate in microseconds */
+    /** The configured callback rate in microseconds */
     uint64_t rate;
 
+    /** The current callback rate after backoff or speed-up */
+    uint64_t current;
+
+    /** ONLP_PLATFORM_MANAGER_F_* */
+    uint32_t flags;
+
     /** The name of this callback (for debugging) */
-    const char* name;
+    char name[32];
+
+    /** One-shot timer for this entry */
+    int tfd;
 
     /** The number of times this has been called. */
     int calls;
 
+    /** Consecutive failures */
+    int failures;
+
 } management_entry_t;
 
+/**
+ * Handles encode the table index and a generation count so stale
+ * handles (and stale epoll events) are never mistaken for new entries.
+ */
+#define HANDLE_INDEX__(_h) ((_h) & 0xFFFF)
+#define HANDLE_GEN__(_h) (((_h) >> 16) & 0x7FFF)
+#define HANDLE_MAKE__(_i, _g) ( ((_g & 0x7FFF) << 16) | (_i) )
+
 /**
  * Platform management control structure.
  */
 typedef struct management_ctrl_s {
-    timer_wheel_t* tw;
-
+    int epfd;
     int eventfd;
     pthread_t thread;
 
+    /** Held while modifying the entries. Callbacks run without it. */
+    pthread_mutex_t lock;
+
+    struct {
+        management_entry_t* entry;
+        int gen;
+    } entries[ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX];
+
 } management_ctrl_t;
 
 /* This is the global control state */
-static management_ctrl_t control__ = { NULL };
+static management_ctrl_t control__ = { -1, -1 };
+static pthread_once_t control_once__ = PTHREAD_ONCE_INIT;
 
 
 /*
  * Internal notification handler for PSU
  * status changes (all platforms)
  */
-static int platform_psus_notify__(void);
+static void platform_psus_notify__(onlp_oid_status_event_t* event, void* cookie);
 
 
 /*
  * Internal notification handler for FAN
  * status changes (all platforms)
  */
-static int platform_fans_notify__(void);
+static void platform_fans_notify__(onlp_oid_status_event_t* event, void* cookie);
 
+/*
+ * Polls the OID status change subscriptions.
+ */
+static int platform_oid_status_poll__(void* cookie);
 
+static int
+platform_manage_fans__(void* cookie)
+{
+    return onlp_platformi_manage_fans();
+}
 
-/*
- * First Version : Static callback rates.
- * TODO: Allow individual platform callbacks to reregister
- * themselves at whatever rate they want.
+static int
+platform_manage_leds__(void* cookie)
+{
+    return onlp_platformi_manage_leds();
+}
+
+static void
+control_init__(void)
+{
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    /* Callbacks may register or unregister entries. */
+    pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&control__.lock, &ma);
+    pthread_mutexattr_destroy(&ma);
+}
+
+static management_entry_t*
+entry_get__(int handle)
+{
+    int i = HANDLE_INDEX__(handle);
+    if(handle < 0 || i >= AIM_ARRAYSIZE(control__.entries) ||
+       control__.entries[i].gen != HANDLE_GEN__(handle)) {
+        return NULL;
+    }
+    return control__.entries[i].entry;
+}
+
+static int
+entry_arm__(management_entry_t* e, uint64_t usecs)
+{
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if(usecs == 0) {
+        /* A zero value disarms the timer. */
+        usecs = 1;
+    }
+    its.it_value.tv_sec = usecs / 1000000;
+    its.it_value.tv_nsec = (usecs % 1000000) * 1000;
+    if(timerfd_settime(e->tfd, 0, &its, NULL) < 0) {
+        AIM_LOG_ERROR("%s: timerfd_settime: %{errno}", e->name, errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+/**
+ * Adjust the current rate based on the result of the last call.
+ *
+ * Failures double the interval up to BACKOFF_MAX times the configured
+ * rate. Adaptive entries which report changed readings halve it down
+ * to 1/SPEEDUP_MAX of the configured rate. Once things settle the
+ * interval returns to the configured rate.
  */
-static management_entry_t management_entries[] =
-    {
-        {
-            { },
-            onlp_platformi_manage_fans,
-            /* Every 10 seconds */
-            10*1000*1000,
-            "Fans",
-        },
-        {
-            { },
-            onlp_platformi_manage_leds,
-            /* Every 2 seconds */
-            2*1000*1000,
-            "LEDs",
-
-        },
-        {
-            { },
-            platform_psus_notify__,
-            /* Every second */
-            1*1000*1000,
-            "PSUs",
-        },
-        {
-            { },
-            platform_fans_notify__,
-            /* Every second */
-            1*1000*1000,
-            "Fans",
+static void
+entry_rate_update__(management_entry_t* e, int rv)
+{
+    uint64_t c = e->current;
+
+    if(rv < 0) {
+        if(e->failures++ == 0) {
+            AIM_LOG_ERROR("%s: management callback failed: %{onlp_status}",
+                          e->name, rv);
+        }
+        c = (c < e->rate) ? e->rate : c*2;
+        if(c > e->rate*ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX) {
+            c = e->rate*ONLP_CONFIG_PLATFORM_MANAGER_BACKOFF_MAX;
+        }
+    }
+    else {
+        if(e->failures) {
+            AIM_LOG_INFO("%s: management callback recovered after %d failures.",
+                         e->name, e->failures);
+            e->failures = 0;
+            c = e->rate;
+        }
+        if(rv > 0 && (e->flags & ONLP_PLATFORM_MANAGER_F_ADAPTIVE)) {
+            c /= 2;
+            if(c < e->rate/ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX) {
+                c = e->rate/ONLP_CONFIG_PLATFORM_MANAGER_SPEEDUP_MAX;
+            }
         }
-    };
+        else if(c < e->rate) {
+            c *= 2;
+            if(c > e->rate) {
+                c = e->rate;
+            }
+        }
+    }
+    e->current = c;
+}
 
+/**
+ * The callback is called without the control lock so that slow
+ * callbacks do not block registration from other threads.
+ */
+static void
+entry_dispatch__(int handle)
+{
+    uint64_t expirations;
+    management_entry_t* e;
+    onlp_platform_manager_f manage = NULL;
+    void* cookie = NULL;
+    int rv;
+
+    pthread_mutex_lock(&control__.lock);
+    if( (e = entry_get__(handle)) &&
+        read(e->tfd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+        manage = e->manage;
+        cookie = e->cookie;
+    }
+    pthread_mutex_unlock(&control__.lock);
+
+    if(manage == NULL) {
+        return;
+    }
+
+    rv = manage(cookie);
+
+    pthread_mutex_lock(&control__.lock);
+    /* The entry may have been unregistered during the callback. */
+    if( (e = entry_get__(handle)) ) {
+        e->calls++;
+        entry_rate_update__(e, rv);
+        entry_arm__(e, e->current);
+    }
+    pthread_mutex_unlock(&control__.lock);
+}
+
+int
+onlp_platform_manager_register(const char* name, onlp_platform_manager_f manage,
+                               void* cookie, uint64_t rate, uint32_t flags)
+{
+    int i, handle = ONLP_STATUS_E_PARAM;
+    management_entry_t* e;
+
+    if(manage == NULL || rate == 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_once(&control_once__, control_init__);
+    pthread_mutex_lock(&control__.lock);
+
+    for(i = 0; i < AIM_ARRAYSIZE(control__.entries); i++) {
+        if(control__.entries[i].entry == NULL) {
+            break;
+        }
+    }
+    if(i == AIM_ARRAYSIZE(control__.entries)) {
+        AIM_LOG_ERROR("No management entries available for %s.", name);
+        handle = ONLP_STATUS_E_INTERNAL;
+        goto out;
+    }
+
+    e = aim_zmalloc(sizeof(*e));
+    e->manage = manage;
+    e->cookie = cookie;
+    e->rate = e->current = rate;
+    e->flags = flags;
+    aim_strlcpy(e->name, name ? name : "", sizeof(e->name));
+
+    if( (e->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("%s: timerfd_create: %{errno}", e->name, errno);
+        aim_free(e);
+        handle = ONLP_STATUS_E_INTERNAL;
+        goto out;
+    }
+
+    control__.entries[i].gen = (control__.entries[i].gen + 1) & 0x7FFF;
+    control__.entries[i].entry = e;
+    handle = HANDLE_MAKE__(i, control__.entries[i].gen);
+
+    if(control__.epfd >= 0) {
+        struct epoll_event ev = { EPOLLIN, { .u32 = handle } };
+        if(epoll_ctl(control__.epfd, EPOLL_CTL_ADD, e->tfd, &ev) < 0) {
+            AIM_LOG_ERROR("%s: epoll_ctl: %{errno}", e->name, errno);
+        }
+    }
+    entry_arm__(e, (flags & ONLP_PLATFORM_MANAGER_F_NOW) ? 1 : rate);
+
+ out:
+    pthread_mutex_unlock(&control__.lock);
+    return handle;
+}
+
+int
+onlp_platform_manager_unregister(int handle)
+{
+    int rv = ONLP_STATUS_E_PARAM;
+    management_entry_t* e;
+
+    pthread_once(&control_once__, control_init__);
+    pthread_mutex_lock(&control__.lock);
+    if( (e = entry_get__(handle)) ) {
+        if(control__.epfd >= 0) {
+            epoll_ctl(control__.epfd, EPOLL_CTL_DEL, e->tfd, NULL);
+        }
+        close(e->tfd);
+        aim_free(e);
+        control__.entries[HANDLE_INDEX__(handle)].entry = NULL;
+        rv = 0;
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return rv;
+}
+
+int
+onlp_platform_manager_rate_set(int handle, uint64_t rate)
+{
+    int rv = ONLP_STATUS_E_PARAM;
+    management_entry_t* e;
+
+    if(rate == 0) {
+        return rv;
+    }
+
+    pthread_once(&control_once__, control_init__);
+    pthread_mutex_lock(&control__.lock);
+    if( (e = entry_get__(handle)) ) {
+        e->rate = e->current = rate;
+        rv = entry_arm__(e, rate);
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return rv;
+}
 
 void
 onlp_sys_platform_manage_init(void)
 {
-    if(control__.tw == NULL) {
+    pthread_once(&control_once__, control_init__);
+    pthread_mutex_lock(&control__.lock);
+
+    if(control__.epfd < 0) {
         int i;
-        uint64_t now = os_time_monotonic();
 
-        onlp_platformi_manage_init();
-        control__.tw = timer_wheel_create(4, 512, now);
+        if( (control__.epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+            AIM_DIE("epoll_create1 failed: %{errno}", errno);
+        }
 
-        for(i = 0; i < AIM_ARRAYSIZE(management_entries); i++) {
-            management_entry_t* e = management_entries+i;
-            timer_wheel_insert(control__.tw,  &e->twe, now + e->rate);
+        /* Entries registered before initialization. */
+        for(i = 0; i < AIM_ARRAYSIZE(control__.entries); i++) {
+            management_entry_t* e = control__.entries[i].entry;
+            if(e) {
+                struct epoll_event ev = { EPOLLIN,
+                                          { .u32 = HANDLE_MAKE__(i, control__.entries[i].gen) } };
+                epoll_ctl(control__.epfd, EPOLL_CTL_ADD, e->tfd, &ev);
+            }
         }
+
+        /*
+         * Default management entries. The platform may register
+         * additional entries or re-rate these from onlp_platformi_manage_init().
+         */
+        onlp_platform_manager_register("Fans", platform_manage_fans__, NULL,
+                                       10*1000*1000, 0);
+        onlp_platform_manager_register("LEDs", platform_manage_leds__, NULL,
+                                       2*1000*1000, 0);
+        onlp_oid_status_subscribe(ONLP_OID_TYPE_FLAG_PSU, 0,
+                                  platform_psus_notify__, NULL);
+        onlp_oid_status_subscribe(ONLP_OID_TYPE_FLAG_FAN,
+                                  ONLP_OID_STATUS_FLAG_PRESENT |
+                                  ONLP_OID_STATUS_FLAG_FAILED,
+                                  platform_fans_notify__, NULL);
+        onlp_platform_manager_register("OID Status", platform_oid_status_poll__, NULL,
+                                       1*1000*1000, ONLP_PLATFORM_MANAGER_F_ADAPTIVE);
+
+        onlp_platformi_manage_init();
     }
+
+    pthread_mutex_unlock(&control__.lock);
 }
 
 
 void
 onlp_sys_platform_manage_now(void)
 {
-    management_entry_t* e;
+    int i, count = 0;
+    int handles[ONLP_CONFIG_PLATFORM_MANAGER_ENTRIES_MAX];
 
     onlp_sys_platform_manage_init();
 
-    while( (e = (management_entry_t*) timer_wheel_next(control__.tw,
-                                                       os_time_monotonic())) ) {
-        if(e->manage) {
-            e->manage();
+    pthread_mutex_lock(&control__.lock);
+    for(i = 0; i < AIM_ARRAYSIZE(control__.entries); i++) {
+        if(control__.entries[i].entry) {
+            handles[count++] = HANDLE_MAKE__(i, control__.entries[i].gen);
         }
-        e->calls++;
-        timer_wheel_insert(control__.tw, &e->twe, os_time_monotonic() + e->rate);
+    }
+    pthread_mutex_unlock(&control__.lock);
+
+    /* Only expired timers will dispatch. */
+    for(i = 0; i < count; i++) {
+        entry_dispatch__(handles[i]);
     }
 }
 
+void
+onlp_platform_manager_manage(void)
+{
+    onlp_sys_platform_manage_now();
+}
+
 static void*
 onlp_sys_platform_manage_thread__(void* vctrl)
 {
@@ -169,61 +436,32 @@ onlp_sys_platform_manage_thread__(void* vctrl)
     os_thread_name_set("onlp.sys.pm");
 
     /*
-     * Wait on the eventfd for the specified timeout period.
+     * Wait for the entry timers or the termination eventfd.
      */
     for(;;) {
+        int i, rv;
+        struct epoll_event events[16];
 
-        fd_set fds;
-        uint64_t now;
-        struct timeval tv;
-        timer_wheel_entry_t* twe;
-
-        FD_ZERO(&fds);
-        FD_SET(ctrl->eventfd, &fds);
-
-        /*
-         * Ask the timer wheel if there is an expiration in the next 2 seconds.
-         */
-        now = os_time_monotonic();
-        twe = timer_wheel_peek(ctrl->tw, now + 20000000);
-
-        if(twe == NULL) {
-            /* Nothing in the next two seconds. */
-            tv.tv_sec = 2;
-            tv.tv_usec = 0;
-        }
-        else {
-            if(twe->deadline > now) {
-                /* Sleep until next deadline */
-                tv.tv_sec = (twe->deadline - now) / 1000000;
-                tv.tv_usec = (twe->deadline - now) % 1000000;
-            }
-            else {
-                /* We have surpassed the current deadline */
-                tv.tv_sec = 0;
-                tv.tv_usec = 0;
+        rv = epoll_wait(ctrl->epfd, events, AIM_ARRAYSIZE(events), -1);
+        if(rv < 0) {
+            if(errno != EINTR) {
+                AIM_LOG_ERROR("epoll_wait() returned %d (%{errno})", rv, errno);
+                /* Sleep 1 second, but continue to run */
+                sleep(1);
             }
+            continue;
         }
 
-        int rv = select(ctrl->eventfd+1, &fds, NULL, NULL, &tv);
-        if(rv == 1 && FD_ISSET(ctrl->eventfd, &fds)) {
-            /* We've been asked to terminate. */
-            AIM_LOG_MSG("Terminating.");
-            /* Also signifies that we have exit */
-            close(ctrl->eventfd);
-            ctrl->eventfd = -1;
-            return NULL;
+        for(i = 0; i < rv; i++) {
+            if(events[i].data.u32 == (uint32_t)-1) {
+                /* We've been asked to terminate. */
+                AIM_LOG_MSG("Terminating.");
+                return NULL;
+            }
         }
-        if(rv < 0) {
-            AIM_LOG_ERROR("select() returned %d (%{errno})", rv, errno);
-            /* Sleep 1 second, but continue to run */
-            sleep(1);
+        for(i = 0; i < rv; i++) {
+            entry_dispatch__(events[i].data.u32);
         }
-
-        /*
-         * We don't bother to check the result of select() here.
-         */
-        onlp_sys_platform_manage_now();
     }
 }
 
@@ -242,9 +480,18 @@ onlp_platform_manager_start(int block)
         return -1;
     }
 
+    struct epoll_event ev = { EPOLLIN, { .u32 = (uint32_t)-1 } };
+    if(epoll_ctl(control__.epfd, EPOLL_CTL_ADD, control__.eventfd, &ev) < 0) {
+        AIM_LOG_ERROR("epoll_ctl failed: %{errno}", errno);
+        close(control__.eventfd);
+        control__.eventfd = -1;
+        return -1;
+    }
+
     if( (pthread_create(&control__.thread, NULL, onlp_sys_platform_manage_thread__,
                         &control__)) != 0) {
         AIM_LOG_ERROR("pthread create failed.");
+        epoll_ctl(control__.epfd, EPOLL_CTL_DEL, control__.eventfd, NULL);
         close(control__.eventfd);
         control__.eventfd = -1;
         return -1;
@@ -278,251 +525,185 @@ onlp_platform_manager_join(void)
     if(control__.eventfd > 0) {
         /* Wait for the thread to terminate */
         pthread_join(control__.thread, NULL);
+        epoll_ctl(control__.epfd, EPOLL_CTL_DEL, control__.eventfd, NULL);
         close(control__.eventfd);
         control__.eventfd = -1;
     }
     return 0;
 }
 
-static onlp_oid_hdr_t*
-oid_hdr_entry_find__(biglist_t* list, onlp_oid_t oid)
-{
-    onlp_oid_hdr_t* hdr;
-    biglist_t* ble;
-
-    BIGLIST_FOREACH_DATA(ble, list, onlp_oid_hdr_t*, hdr) {
-        if(hdr->id == oid) {
-            return hdr;
-        }
-    }
-    return NULL;
-}
-
 static int
-platform_psus_notify__(void)
+platform_oid_status_poll__(void* cookie)
 {
-    int rv;
-    static biglist_t* previous = NULL;
-    static biglist_t* current = NULL;
+    return onlp_oid_status_poll();
+}
 
-    biglist_t* ble;
-    onlp_oid_hdr_t* hdr;
+#define STATUS_IS_SET__(_status, _name) \
+    AIM_FLAG_IS_SET(_status, ONLP_OID_STATUS_FLAG_##_name)
 
-    if(ONLP_FAILURE(rv = onlp_oid_hdr_get_all(ONLP_OID_CHASSIS,
-                                              ONLP_OID_TYPE_FLAG_PSU, 0x0,
-                                              &current))) {
-        return rv;
-    }
+static void
+platform_psus_notify__(onlp_oid_status_event_t* event, void* cookie)
+{
+    int pid = ONLP_OID_ID_GET(event->oid);
+    uint32_t status = event->current;
+    uint32_t xor;
 
-    if(previous == NULL) {
+    if(event->flags & ONLP_OID_STATUS_EVENT_F_INITIAL) {
         /** Log initial states. */
-        BIGLIST_FOREACH_DATA(ble, current, onlp_oid_hdr_t*, hdr) {
-            int pid = ONLP_OID_ID_GET(hdr->id);
-
-            if(ONLP_OID_PRESENT(hdr)) {
-                AIM_SYSLOG_INFO("PSU <id> is present.",
-                                "The given PSU is present.",
-                                "PSU %d is present.", pid);
-
-                if(ONLP_OID_FAILED(hdr)) {
-                    AIM_SYSLOG_CRIT("PSU <id> has failed.",
-                                    "The given PSU has failed.",
-                                    "PSU %d has failed.", pid);
-                }
-                else if(ONLP_OID_STATUS_FLAG_IS_SET(hdr, UNPLUGGED)) {
-                    AIM_SYSLOG_WARN("PSU <id> is unplugged.",
-                                    "The given PSU is unplugged.",
-                                    "PSU %d is unplugged.", pid);
-                }
+        if(STATUS_IS_SET__(status, PRESENT)) {
+            AIM_SYSLOG_INFO("PSU <id> is present.",
+                            "The given PSU is present.",
+                            "PSU %d is present.", pid);
+
+            if(STATUS_IS_SET__(status, FAILED)) {
+                AIM_SYSLOG_CRIT("PSU <id> has failed.",
+                                "The given PSU has failed.",
+                                "PSU %d has failed.", pid);
             }
-            else {
-                AIM_SYSLOG_INFO("PSU <id> is not present.",
-                                "The given PSU is not present.",
-                                "PSU %d is not present.", pid);
+            else if(STATUS_IS_SET__(status, UNPLUGGED)) {
+                AIM_SYSLOG_WARN("PSU <id> is unplugged.",
+                                "The given PSU is unplugged.",
+                                "PSU %d is unplugged.", pid);
             }
         }
-        previous = current;
-        current = NULL;
-        return 0;
+        else {
+            AIM_SYSLOG_INFO("PSU <id> is not present.",
+                            "The given PSU is not present.",
+                            "PSU %d is not present.", pid);
+        }
+        return;
     }
 
+    if(event->flags & ONLP_OID_STATUS_EVENT_F_NEW) {
+        /* A new PSU has popped into existance. Unlikely. */
+        AIM_SYSLOG_INFO("PSU <id> has been discovered.",
+                        "A new PSU has been discovered.",
+                        "PSU %d has been discovered.", pid);
+        return;
+    }
 
-    BIGLIST_FOREACH_DATA(ble, current, onlp_oid_hdr_t*, hdr) {
+    if(event->flags & ONLP_OID_STATUS_EVENT_F_GONE) {
+        /* A PSU has disappeared. */
+        AIM_SYSLOG_INFO("PSU <id> has disappeared.",
+                        "A PSU has disappeared.",
+                        "PSU %d has disappeared.", pid);
+        return;
+    }
 
-        int pid = ONLP_OID_ID_GET(hdr->id);
-        onlp_oid_hdr_t* phdr = oid_hdr_entry_find__(previous, hdr->id);
+    xor = event->current ^ event->previous;
 
-        if(!phdr) {
-            /* A new PSU has popped into existance. Unlikely. */
-            AIM_SYSLOG_INFO("PSU <id> has been discovered.",
-                            "A new PSU has been discovered.",
-                            "PSU %d has been discovered.", pid);
-            continue;
+    if(xor & ONLP_OID_STATUS_FLAG_PRESENT) {
+        if(STATUS_IS_SET__(status, PRESENT)) {
+            AIM_SYSLOG_INFO("PSU <id> has been inserted.",
+                            "A PSU has been inserted in the given slot.",
+                            "PSU %d has been inserted.", pid);
         }
-
-        uint32_t xor = hdr->status ^ phdr->status;
-
-        if(xor & ONLP_OID_STATUS_FLAG_PRESENT) {
-            if(ONLP_OID_PRESENT(hdr)) {
-                AIM_SYSLOG_INFO("PSU <id> has been inserted.",
-                                "A PSU has been inserted in the given slot.",
-                                "PSU %d has been inserted.", pid);
-            }
-            else {
-                AIM_SYSLOG_WARN("PSU <id> has been removed.",
-                                "A PSU has been removed from the given slot.",
-                                "PSU %d has been removed.", pid);
-                /* The remaining bits are only relevant if the PSU is present. */
-                continue;
-            }
+        else {
+            AIM_SYSLOG_WARN("PSU <id> has been removed.",
+                            "A PSU has been removed from the given slot.",
+                            "PSU %d has been removed.", pid);
+            /* The remaining bits are only relevant if the PSU is present. */
+            return;
         }
-        if(xor & ONLP_OID_STATUS_FLAG_FAILED) {
-            if(ONLP_OID_FAILED(hdr)) {
-                AIM_SYSLOG_CRIT("PSU <id> has failed.",
-                                "The given PSU has failed.",
-                                "PSU %d has failed.", pid);
-            }
-            else {
-                AIM_SYSLOG_INFO("PSU <id> has recovered.",
-                                "The given PSU has recovered from a failure.",
-                                "PSU %d has recovered.", pid);
-            }
+    }
+    if(xor & ONLP_OID_STATUS_FLAG_FAILED) {
+        if(STATUS_IS_SET__(status, FAILED)) {
+            AIM_SYSLOG_CRIT("PSU <id> has failed.",
+                            "The given PSU has failed.",
+                            "PSU %d has failed.", pid);
         }
-        if(xor & ONLP_OID_STATUS_FLAG_UNPLUGGED) {
-            if(ONLP_OID_STATUS_FLAG_IS_SET(hdr, UNPLUGGED)) {
-                /* PSU has been unplugged. */
-                AIM_SYSLOG_WARN("PSU <id> has been unplugged.",
-                                "The given PSU has been unplugged.",
-                                "PSU %d has been unplugged.", pid);
-            }
-            else {
-                /* PSU has been plugged in */
-                AIM_SYSLOG_INFO("PSU <id> has been plugged in.",
-                                "The given PSU has been plugged in.",
-                                "PSU %d has been plugged in.", pid);
-            }
+        else {
+            AIM_SYSLOG_INFO("PSU <id> has recovered.",
+                            "The given PSU has recovered from a failure.",
+                            "PSU %d has recovered.", pid);
         }
     }
-
-    BIGLIST_FOREACH_DATA(ble, previous, onlp_oid_hdr_t*, hdr) {
-        onlp_oid_hdr_t* chdr = oid_hdr_entry_find__(current, hdr->id);
-        if(!chdr) {
-            /* A PSU has disappeared. */
-            AIM_SYSLOG_INFO("PSU <id> has disappeared.",
-                            "A PSU has disappeared.",
-                            "PSU %d has disappeared.", ONLP_OID_ID_GET(hdr->id));
+    if(xor & ONLP_OID_STATUS_FLAG_UNPLUGGED) {
+        if(STATUS_IS_SET__(status, UNPLUGGED)) {
+            /* PSU has been unplugged. */
+            AIM_SYSLOG_WARN("PSU <id> has been unplugged.",
+                            "The given PSU has been unplugged.",
+                            "PSU %d has been unplugged.", pid);
+        }
+        else {
+            /* PSU has been plugged in */
+            AIM_SYSLOG_INFO("PSU <id> has been plugged in.",
+                            "The given PSU has been plugged in.",
+                            "PSU %d has been plugged in.", pid);
         }
     }
-
-
-    /* The previous list is deleted and the current list becomes the previous */
-    onlp_oid_get_all_free(previous);
-    previous = current;
-    current = NULL;
-    return 0;
 }
 
-static int
-platform_fans_notify__(void)
+static void
+platform_fans_notify__(onlp_oid_status_event_t* event, void* cookie)
 {
-    int rv;
-    static biglist_t* previous = NULL;
-    static biglist_t* current = NULL;
-
-    biglist_t* ble;
-    onlp_oid_hdr_t* hdr;
-
-    if(ONLP_FAILURE(rv = onlp_oid_hdr_get_all(ONLP_OID_CHASSIS,
-                                              ONLP_OID_TYPE_FLAG_FAN, 0x0,
-                                              &current))) {
-        return rv;
-    }
+    int fid = ONLP_OID_ID_GET(event->oid);
+    uint32_t status = event->current;
+    uint32_t xor;
 
-    if(previous == NULL) {
+    if(event->flags & ONLP_OID_STATUS_EVENT_F_INITIAL) {
         /** Log initial states. */
-        BIGLIST_FOREACH_DATA(ble, current, onlp_oid_hdr_t*, hdr) {
-            int fid = ONLP_OID_ID_GET(hdr->id);
-
-            if(ONLP_OID_PRESENT(hdr)) {
-                AIM_SYSLOG_INFO("Fan <id> is present.",
-                                "The given fan is present.",
-                                "Fan %d is present.", fid);
-
-                if(ONLP_OID_FAILED(hdr)) {
-                    AIM_SYSLOG_INFO("Fan <id> has failed.",
-                                    "The given fan has failed.",
-                                    "Fan %d has failed.", fid);
-                }
-            }
-            else {
-                AIM_SYSLOG_INFO("Fan <id> is not present.",
-                                "The given fan is not present.",
-                                "Fan %d is not present.", fid);
+        if(STATUS_IS_SET__(status, PRESENT)) {
+            AIM_SYSLOG_INFO("Fan <id> is present.",
+                            "The given fan is present.",
+                            "Fan %d is present.", fid);
+
+            if(STATUS_IS_SET__(status, FAILED)) {
+                AIM_SYSLOG_INFO("Fan <id> has failed.",
+                                "The given fan has failed.",
+                                "Fan %d has failed.", fid);
             }
         }
-        previous = current;
-        current = NULL;
-        return 0;
+        else {
+            AIM_SYSLOG_INFO("Fan <id> is not present.",
+                            "The given fan is not present.",
+                            "Fan %d is not present.", fid);
+        }
+        return;
     }
 
+    if(event->flags & ONLP_OID_STATUS_EVENT_F_NEW) {
+        /* A new Fan has popped into existance. Unlikely. */
+        AIM_SYSLOG_INFO("Fan <id> has been discovered.",
+                        "A new fan has been discovered.",
+                        "Fan %d has been discovered.", fid);
+        return;
+    }
 
-    BIGLIST_FOREACH_DATA(ble, current, onlp_oid_hdr_t*, hdr) {
-
-        int fid = ONLP_OID_ID_GET(hdr->id);
-        onlp_oid_hdr_t* phdr = oid_hdr_entry_find__(previous, hdr->id);
-
-        if(!phdr) {
-            /* A new Fan has popped into existance. Unlikely. */
-            AIM_SYSLOG_INFO("Fan <id> has been discovered.",
-                            "A new fan has been discovered.",
-                            "Fan %d has been discovered.", fid);
-            continue;
-        }
+    if(event->flags & ONLP_OID_STATUS_EVENT_F_GONE) {
+        /* A Fan has disappeared. */
+        AIM_SYSLOG_INFO("Fan <id> has disappeared.",
+                        "A fan has disappeared.",
+                        "Fan %d has disappeared.", fid);
+        return;
+    }
 
-        uint32_t xor = hdr->status ^ phdr->status;
+    xor = event->current ^ event->previous;
 
-        if(xor & ONLP_OID_STATUS_FLAG_PRESENT) {
-            if(ONLP_OID_PRESENT(hdr)) {
-                AIM_SYSLOG_INFO("Fan <id> has been inserted.",
-                                "A fan has been inserted.",
-                                "Fan %d has been inserted.", fid);
-            }
-            else {
-                AIM_SYSLOG_WARN("Fan <id> has been removed.",
-                                "A fan has been removed.",
-                                "Fan %d has been removed.", fid);
-                /* The remaining bits are only relevant if the Fan is present. */
-                continue;
-            }
+    if(xor & ONLP_OID_STATUS_FLAG_PRESENT) {
+        if(STATUS_IS_SET__(status, PRESENT)) {
+            AIM_SYSLOG_INFO("Fan <id> has been inserted.",
+                            "A fan has been inserted.",
+                            "Fan %d has been inserted.", fid);
         }
-        if(xor & ONLP_OID_STATUS_FLAG_FAILED) {
-            if(ONLP_OID_FAILED(hdr)) {
-                AIM_SYSLOG_CRIT("Fan <id> has failed.",
-                                "The given fan has failed.",
-                                "Fan %d has failed.", fid);
-            }
-            else {
-                AIM_SYSLOG_INFO("Fan <id> has recovered.",
-                                "The given fan has recovered from a failure.",
-                                "Fan %d has recovered.", fid);
-            }
+        else {
+            AIM_SYSLOG_WARN("Fan <id> has been removed.",
+                            "A fan has been removed.",
+                            "Fan %d has been removed.", fid);
+            /* The remaining bits are only relevant if the Fan is present. */
+            return;
         }
     }
-
-    BIGLIST_FOREACH_DATA(ble, previous, onlp_oid_hdr_t*, hdr) {
-        onlp_oid_hdr_t* chdr = oid_hdr_entry_find__(current, hdr->id);
-        if(!chdr) {
-            /* A Fan has disappeared. */
-            AIM_SYSLOG_INFO("Fan <id> has disappeared.",
-                            "A fan has disappeared.",
-                            "Fan %d has disappeared.", ONLP_OID_ID_GET(hdr->id));
+    if(xor & ONLP_OID_STATUS_FLAG_FAILED) {
+        if(STATUS_IS_SET__(status, FAILED)) {
+            AIM_SYSLOG_CRIT("Fan <id> has failed.",
+                            "The given fan has failed.",
+                            "Fan %d has failed.", fid);
+        }
+        else {
+            AIM_SYSLOG_INFO("Fan <id> has recovered.",
+                            "The given fan has recovered from a failure.",
+                            "Fan %d has recovered.", fid);
         }
     }
-
-
-    /* The previous list is deleted and the current list becomes the previous */
-    onlp_oid_get_all_free(previous);
-    previous = current;
-    current = NULL;
-    return 0;
 }
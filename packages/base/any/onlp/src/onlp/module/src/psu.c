@@ -28,6 +28,7 @@
 #include <onlp/psu.h>
 #include <onlp/platformi/psui.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_PSU
 #include "onlp_locks.h"
 
 static int
@@ -67,7 +68,7 @@ onlp_psu_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
     hdr->id = oid;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_psu_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_psu_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
 
 static int
 onlp_psu_info_get_locked__(onlp_oid_t oid,  onlp_psu_info_t* info)
@@ -85,7 +86,7 @@ onlp_psu_info_get_locked__(onlp_oid_t oid,  onlp_psu_info_t* info)
     info->hdr.id = oid;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_psu_info_get, onlp_oid_t, oid, onlp_psu_info_t*, info);
+ONLP_LOCKED_RAPI2(onlp_psu_info_get, onlp_oid_t, oid, onlp_psu_info_t*, info);
 
 int
 onlp_psu_info_to_user_json(onlp_psu_info_t* info, cJSON** cjp, uint32_t flags)
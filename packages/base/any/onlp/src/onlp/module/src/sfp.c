@@ -25,10 +25,15 @@
 #include <onlp/sfp.h>
 #include <onlp/platformi/sfpi.h>
 #include "onlp_log.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_SFP
 #include "onlp_locks.h"
 #include <onlp/oids.h>
 #include "onlp_int.h"
 #include <IOF/iof.h>
+#include <OS/os_time.h>
+#include <OS/os_thread.h>
+#include <pthread.h>
+#include <errno.h>
 
 /**
  * All port numbers will be validated before calling the SFP driver.
@@ -79,6 +84,125 @@ static int sfp_oid_validate__(onlp_oid_t* oid, int* pid)
         ONLP_IF_ERROR_RETURN(sfp_oid_validate__(_oid, _port));          \
     } while(0)
 
+#if ONLP_CONFIG_INCLUDE_SFP_CACHE == 1
+
+/**
+ * The static EEPROM contents of a module do not change while it
+ * remains plugged in. The last successful parse is kept per port
+ * and only the DOM monitor bytes are refreshed once they are older
+ * than ONLP_CONFIG_SFP_DOM_CACHE_USECS.
+ *
+ * An entry is dropped whenever the port's presence changes, whenever
+ * the module is written to, and whenever a read fails. A module can
+ * also be swapped between two presence reads, so the identifier and
+ * vendor serial number are re-read and compared before every hit.
+ */
+typedef struct sfp_cache_entry_s {
+    /** Only the sff, dom, and bytes fields are used. */
+    onlp_sfp_info_t info;
+
+    /** Time of the last DOM read. */
+    uint64_t dom_updated;
+} sfp_cache_entry_t;
+
+/** Indexed by OID id - 1 */
+static sfp_cache_entry_t* sfp_cache__[256];
+
+/** The last presence seen for each port. */
+static onlp_sfp_bitmap_t sfp_cache_present__;
+
+static sfp_cache_entry_t*
+sfp_cache_entry__(onlp_oid_t oid)
+{
+    int id = ONLP_OID_ID_GET(oid);
+    if(id < 1 || id > AIM_ARRAYSIZE(sfp_cache__)) {
+        return NULL;
+    }
+    return sfp_cache__[id-1];
+}
+
+static void
+sfp_cache_invalidate__(onlp_oid_t oid)
+{
+    int id = ONLP_OID_ID_GET(oid);
+    if(id >= 1 && id <= AIM_ARRAYSIZE(sfp_cache__)) {
+        aim_free(sfp_cache__[id-1]);
+        sfp_cache__[id-1] = NULL;
+    }
+}
+
+static void
+sfp_cache_store__(onlp_oid_t oid, onlp_sfp_info_t* info)
+{
+    int id = ONLP_OID_ID_GET(oid);
+    if(id < 1 || id > AIM_ARRAYSIZE(sfp_cache__)) {
+        return;
+    }
+    if(sfp_cache__[id-1] == NULL) {
+        sfp_cache__[id-1] = aim_zmalloc(sizeof(sfp_cache_entry_t));
+    }
+    sfp_cache_entry_t* e = sfp_cache__[id-1];
+    e->info.sff = info->sff;
+    e->info.dom = info->dom;
+    memcpy(&e->info.bytes, &info->bytes, sizeof(e->info.bytes));
+    e->dom_updated = os_time_monotonic();
+}
+
+static void
+sfp_cache_clear__(void)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(sfp_cache__); i++) {
+        aim_free(sfp_cache__[i]);
+        sfp_cache__[i] = NULL;
+    }
+    onlp_sfp_bitmap_t_init(&sfp_cache_present__);
+}
+
+/**
+ * Record a presence read for the port.
+ * The entry is dropped if the module is absent or was absent last time.
+ */
+static void
+sfp_cache_presence__(onlp_oid_t oid, int present)
+{
+    int id = ONLP_OID_ID_GET(oid);
+    if(id < 1 || id > AIM_ARRAYSIZE(sfp_cache__)) {
+        return;
+    }
+    if(present <= 0 || AIM_BITMAP_GET(&sfp_cache_present__, id-1) == 0) {
+        sfp_cache_invalidate__(oid);
+    }
+    if(present > 0) {
+        AIM_BITMAP_SET(&sfp_cache_present__, id-1);
+    }
+    else {
+        AIM_BITMAP_CLR(&sfp_cache_present__, id-1);
+    }
+}
+
+#else
+
+#define sfp_cache_invalidate__(_oid)
+#define sfp_cache_clear__()
+#define sfp_cache_presence__(_oid, _present)
+
+#endif /* ONLP_CONFIG_INCLUDE_SFP_CACHE */
+
+/**
+ * The last bulk presence read. Back-to-back callers within
+ * ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS share one hardware read.
+ */
+static struct {
+    onlp_sfp_bitmap_t bmap;
+    uint64_t updated;
+    int valid;
+    /** Cleared if the platform has no onlp_sfpi_presence_bitmap_get(). */
+    int bulk;
+} sfp_presence__ = { .bulk = 1 };
+
+#define sfp_presence_invalidate__() sfp_presence__.valid = 0
+
 void
 onlp_sfp_bitmap_t_init(onlp_sfp_bitmap_t* bmap)
 {
@@ -90,6 +214,10 @@ static int
 onlp_sfp_sw_init_locked__(void)
 {
     onlp_sfp_bitmap_t_init(&sfpi_bitmap__);
+    onlp_sfp_bitmap_t_init(&sfp_presence__.bmap);
+    sfp_presence_invalidate__();
+    sfp_cache_clear__();
+    sfp_presence__.bulk = 1;
 
     int rv = onlp_sfpi_sw_init();
     if(rv < 0) {
@@ -129,12 +257,14 @@ onlp_sfp_bitmap_get_locked__(onlp_sfp_bitmap_t* bmap)
     AIM_BITMAP_ASSIGN(bmap, &sfpi_bitmap__);
     return ONLP_STATUS_OK;
 }
-ONLP_LOCKED_API1(onlp_sfp_bitmap_get, onlp_sfp_bitmap_t*, bmap);
+ONLP_LOCKED_RAPI1(onlp_sfp_bitmap_get, onlp_sfp_bitmap_t*, bmap);
 
 
 static int
 onlp_sfp_sw_denit_locked__(void)
 {
+    sfp_cache_clear__();
+    sfp_presence_invalidate__();
     return onlp_sfpi_sw_denit();
 }
 ONLP_LOCKED_API0(onlp_sfp_sw_denit);
@@ -143,9 +273,20 @@ ONLP_LOCKED_API0(onlp_sfp_sw_denit);
 static int
 onlp_sfp_is_present_locked__(onlp_oid_t oid)
 {
-    int port;
+    int port, rv;
     ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
-    return onlp_sfpi_is_present(port);
+    rv = onlp_sfpi_is_present(port);
+    sfp_cache_presence__(oid, rv);
+    if(rv >= 0 && sfp_presence__.valid) {
+        /* Keep the bulk result coherent with what we just saw. */
+        if(rv) {
+            AIM_BITMAP_SET(&sfp_presence__.bmap, ONLP_OID_ID_GET(oid)-1);
+        }
+        else {
+            AIM_BITMAP_CLR(&sfp_presence__.bmap, ONLP_OID_ID_GET(oid)-1);
+        }
+    }
+    return rv;
 }
 ONLP_LOCKED_API1(onlp_sfp_is_present, onlp_oid_t, port);
 
@@ -156,19 +297,17 @@ onlp_sfp_type_get_locked__(onlp_oid_t oid, onlp_sfp_type_t* rtype)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
     return onlp_sfpi_type_get(port, rtype);
 }
-ONLP_LOCKED_API2(onlp_sfp_type_get, onlp_oid_t, oid, onlp_sfp_type_t*, rtype);
+ONLP_LOCKED_RAPI2(onlp_sfp_type_get, onlp_oid_t, oid, onlp_sfp_type_t*, rtype);
 
 static int
-onlp_sfp_presence_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
+sfp_presence_read__(onlp_sfp_bitmap_t* dst)
 {
-    ONLP_PTR_VALIDATE_ZERO(dst);
-    onlp_sfp_bitmap_t_init(dst);
-
     int rv = onlp_sfpi_presence_bitmap_get(dst);
 
     if(rv == ONLP_STATUS_E_UNSUPPORTED) {
         /* Generate from single-port API */
         int p;
+        sfp_presence__.bulk = 0;
         AIM_BITMAP_CLR_ALL(dst);
         AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
             rv = onlp_sfp_is_present_locked__(p);
@@ -182,10 +321,60 @@ onlp_sfp_presence_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
         return 0;
     }
 
+#if ONLP_CONFIG_INCLUDE_SFP_CACHE == 1
+    if(ONLP_SUCCESS(rv)) {
+        /* Drop the cache entries for any ports whose presence changed. */
+        int p;
+        AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
+            sfp_cache_presence__(ONLP_SFP_ID_CREATE(p+1), AIM_BITMAP_GET(dst, p));
+        }
+    }
+#endif
+
+    return rv;
+}
+
+static int
+onlp_sfp_presence_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
+{
+    ONLP_PTR_VALIDATE_ZERO(dst);
+    onlp_sfp_bitmap_t_init(dst);
+
+    uint64_t now = os_time_monotonic();
+    if(sfp_presence__.valid &&
+       now - sfp_presence__.updated < ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS) {
+        AIM_BITMAP_ASSIGN(dst, &sfp_presence__.bmap);
+        return 0;
+    }
+
+    int rv = sfp_presence_read__(dst);
+    if(ONLP_SUCCESS(rv) && ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS > 0) {
+        AIM_BITMAP_ASSIGN(&sfp_presence__.bmap, dst);
+        sfp_presence__.updated = now;
+        sfp_presence__.valid = 1;
+    }
     return rv;
 }
 ONLP_LOCKED_API1(onlp_sfp_presence_bitmap_get, onlp_sfp_bitmap_t*, dst);
 
+/**
+ * Presence of a single validated port for the enumeration paths.
+ * Uses the (possibly shared) bulk presence read when the platform
+ * provides one, so walking all SFP OIDs costs one hardware read.
+ */
+static int
+sfp_present_get__(onlp_oid_t oid)
+{
+    if(sfp_presence__.bulk && ONLP_CONFIG_SFP_PRESENCE_CACHE_USECS > 0) {
+        onlp_sfp_bitmap_t present;
+        if(ONLP_SUCCESS(onlp_sfp_presence_bitmap_get_locked__(&present)) &&
+           sfp_presence__.bulk) {
+            return AIM_BITMAP_GET(&present, ONLP_OID_ID_GET(oid)-1) ? 1 : 0;
+        }
+    }
+    return onlp_sfp_is_present_locked__(oid);
+}
+
 int
 onlp_sfp_port_valid(onlp_oid_t oid)
 {
@@ -265,7 +454,7 @@ onlp_sfp_control_get_locked__(onlp_oid_t oid, onlp_sfp_control_t control, int* v
 
     return (value) ? onlp_sfpi_control_get(port, control, value) : ONLP_STATUS_E_PARAM;
 }
-ONLP_LOCKED_API3(onlp_sfp_control_get, onlp_oid_t, port, onlp_sfp_control_t, control,
+ONLP_LOCKED_RAPI3(onlp_sfp_control_get, onlp_oid_t, port, onlp_sfp_control_t, control,
                  int*, value);
 
 
@@ -296,14 +485,13 @@ onlp_sfp_rx_los_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
 
     return rv;
 }
-ONLP_LOCKED_API1(onlp_sfp_rx_los_bitmap_get, onlp_sfp_bitmap_t*, dst);
+ONLP_LOCKED_RAPI1(onlp_sfp_rx_los_bitmap_get, onlp_sfp_bitmap_t*, dst);
 
 
-int
-onlp_sfp_control_flags_get(onlp_oid_t oid, uint32_t* flags)
+static int
+onlp_sfp_control_flags_get_locked__(onlp_oid_t oid, uint32_t* flags)
 {
-    int port;
-    ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, NULL);
 
     /**
      * These are the control bits queried and returned.
@@ -326,7 +514,7 @@ onlp_sfp_control_flags_get(onlp_oid_t oid, uint32_t* flags)
     int rv, i, v;
 
     for(i = 0; i < AIM_ARRAYSIZE(controls); i++) {
-        rv = onlp_sfp_control_get(port, controls[i], &v);
+        rv = onlp_sfp_control_get_locked__(oid, controls[i], &v);
         if(rv >= 0) {
             if(v) {
                 *flags |= (1 << controls[i]);
@@ -340,6 +528,7 @@ onlp_sfp_control_flags_get(onlp_oid_t oid, uint32_t* flags)
     }
     return 0;
 }
+ONLP_LOCKED_RAPI2(onlp_sfp_control_flags_get, onlp_oid_t, port, uint32_t*, flags);
 
 int
 onlp_sfp_dev_alloc_read(onlp_oid_t port,
@@ -367,7 +556,7 @@ onlp_sfp_dev_read_locked__(onlp_oid_t oid, int devaddr, int addr,
     ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
     return onlp_sfpi_dev_read(port, devaddr, addr, dst, len);
 }
-ONLP_LOCKED_API5(onlp_sfp_dev_read, onlp_oid_t, port, int, devaddr,
+ONLP_LOCKED_RAPI5(onlp_sfp_dev_read, onlp_oid_t, port, int, devaddr,
                  int, addr, uint8_t*, dst, int, len);
 
 int
@@ -376,6 +565,7 @@ onlp_sfp_dev_write_locked__(onlp_oid_t oid, int devaddr, int addr,
 {
     int port;
     ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
+    sfp_cache_invalidate__(oid);
     return onlp_sfpi_dev_write(port, devaddr, addr, src, len);
 }
 ONLP_LOCKED_API5(onlp_sfp_dev_write, onlp_oid_t, port, int, devaddr,
@@ -388,7 +578,7 @@ onlp_sfp_dev_readb_locked__(onlp_oid_t oid, int devaddr, int addr)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
     return onlp_sfpi_dev_readb(port, devaddr, addr);
 }
-ONLP_LOCKED_API3(onlp_sfp_dev_readb, onlp_oid_t, port, int, devaddr, int, addr);
+ONLP_LOCKED_RAPI3(onlp_sfp_dev_readb, onlp_oid_t, port, int, devaddr, int, addr);
 
 int
 onlp_sfp_dev_writeb_locked__(onlp_oid_t oid, int devaddr, int addr,
@@ -396,6 +586,7 @@ onlp_sfp_dev_writeb_locked__(onlp_oid_t oid, int devaddr, int addr,
 {
     int port;
     ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
+    sfp_cache_invalidate__(oid);
     return onlp_sfpi_dev_writeb(port, devaddr, addr, value);
 }
 ONLP_LOCKED_API4(onlp_sfp_dev_writeb, onlp_oid_t, port, int, devaddr, int, addr, uint8_t, value);
@@ -407,13 +598,14 @@ onlp_sfp_dev_readw_locked__(onlp_oid_t oid, int devaddr, int addr)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
     return onlp_sfpi_dev_readw(port, devaddr, addr);
 }
-ONLP_LOCKED_API3(onlp_sfp_dev_readw, onlp_oid_t, port, int, devaddr, int, addr);
+ONLP_LOCKED_RAPI3(onlp_sfp_dev_readw, onlp_oid_t, port, int, devaddr, int, addr);
 
 int
 onlp_sfp_dev_writew_locked__(onlp_oid_t oid, int devaddr, int addr, uint16_t value)
 {
     int port;
     ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
+    sfp_cache_invalidate__(oid);
     return onlp_sfpi_dev_writew(port, devaddr, addr, value);
 }
 ONLP_LOCKED_API4(onlp_sfp_dev_writew, onlp_oid_t, port, int, devaddr, int, addr, uint16_t, value);
@@ -442,44 +634,41 @@ sfp_control_str__(uint32_t controls)
     return aim_strdup(tmp);
 }
 
-static int
-sfp_inventory_show_iter__(onlp_oid_t oid, void* cookie)
+static void
+sfp_inventory_show_entry__(aim_pvs_t* pvs, onlp_sfp_info_t* info)
 {
-    int rv = 0;
-    onlp_sfp_info_t info;
+    int i;
     char* fields[10] = { 0 };
 
-    fields[0] = aim_dfstrdup("%d", ONLP_OID_ID_GET(oid));
-
-    rv = onlp_sfp_info_get(oid, &info);
+    fields[0] = aim_dfstrdup("%d", ONLP_OID_ID_GET(info->hdr.id));
 
     /*
      * These fields get populated regardless of the
-     * success or failure of the call to onlp_sfp_info_get().
+     * success or failure of the information request.
      */
-    if(ONLP_SFP_TYPE_VALID(info.type)) {
-        fields[1] = aim_dfstrdup("%{onlp_sfp_type}", info.type);
+    if(ONLP_SFP_TYPE_VALID(info->type)) {
+        fields[1] = aim_dfstrdup("%{onlp_sfp_type}", info->type);
     }
     else {
         fields[1] = aim_strdup("");
     }
 
-    if(ONLP_SUCCESS(rv)) {
+    if(ONLP_OID_STATUS_FLAG_NOT_SET(info, FAILED)) {
 
-        fields[4] = sfp_control_str__(info.controls);
+        fields[4] = sfp_control_str__(info->controls);
 
-        if(ONLP_OID_PRESENT(&info)) {
+        if(ONLP_OID_PRESENT(info)) {
 
             /** SFP Present. */
-            fields[6] = aim_strdup(info.sff.vendor);
-            fields[7] = aim_strdup(info.sff.model);
-            fields[8] = aim_strdup(info.sff.serial);
+            fields[6] = aim_strdup(info->sff.vendor);
+            fields[7] = aim_strdup(info->sff.model);
+            fields[8] = aim_strdup(info->sff.serial);
 
-            if(info.sff.sfp_type != SFF_SFP_TYPE_INVALID) {
+            if(info->sff.sfp_type != SFF_SFP_TYPE_INVALID) {
                 /** SFP Identified */
-                fields[2] = aim_strdup(info.sff.module_type_name);
-                fields[3] = aim_strdup(info.sff.media_type_name);
-                fields[5] = aim_strdup(info.sff.length_desc);
+                fields[2] = aim_strdup(info->sff.module_type_name);
+                fields[3] = aim_strdup(info->sff.media_type_name);
+                fields[5] = aim_strdup(info->sff.length_desc);
             }
             else {
                 fields[2] = aim_strdup("Unknown");
@@ -487,19 +676,18 @@ sfp_inventory_show_iter__(onlp_oid_t oid, void* cookie)
         }
     }
     else {
-        fields[2] = aim_dfstrdup("%{onlp_status}", rv);
+        fields[2] = aim_strdup("Failed");
     }
 
 #define _NS(_string) ( (_string) ? (_string) : "")
 
-    aim_printf((aim_pvs_t*)cookie, "%4s  %-6s  %-14s  %-6s  %-6.6s  %-5.5s  %-16.16s  %-16.16s  %16.16s\n",
+    aim_printf(pvs, "%4s  %-6s  %-14s  %-6s  %-6.6s  %-5.5s  %-16.16s  %-16.16s  %16.16s\n",
                _NS(fields[0]), _NS(fields[1]), _NS(fields[2]), _NS(fields[3]),
                _NS(fields[4]), _NS(fields[5]), _NS(fields[6]), _NS(fields[7]), _NS(fields[8]));
 
-    for(rv = 0; rv < AIM_ARRAYSIZE(fields); rv++) {
-        aim_free(fields[rv]);
+    for(i = 0; i < AIM_ARRAYSIZE(fields); i++) {
+        aim_free(fields[i]);
     }
-    return 0;
 }
 
 
@@ -508,67 +696,189 @@ onlp_sfp_inventory_show(aim_pvs_t* pvs)
 {
     aim_printf(pvs, "Port  Type    Module          Media   Status  Len    Vendor            Model             S/N             \n");
     aim_printf(pvs, "----  ------  --------------  ------  ------  -----  ----------------  ----------------  ----------------\n");
-    onlp_oid_iterate(ONLP_OID_CHASSIS, ONLP_OID_TYPE_FLAG_SFP,
-                     sfp_inventory_show_iter__, pvs);
+
+    onlp_sfp_bitmap_t bmap;
+    onlp_sfp_bitmap_t_init(&bmap);
+    ONLP_IF_ERROR_RETURN(onlp_sfp_bitmap_get(&bmap));
+
+    int i, count = AIM_BITMAP_COUNT(&bmap);
+    if(count == 0) {
+        return 0;
+    }
+
+    onlp_sfp_info_t* info = aim_zmalloc(sizeof(*info)*count);
+    int rv = onlp_sfp_info_get_all(&bmap, info, count);
+    if(ONLP_FAILURE(rv)) {
+        aim_printf(pvs, "Error: %{onlp_status}\n", rv);
+    }
+    for(i = 0; i < rv; i++) {
+        sfp_inventory_show_entry__(pvs, info + i);
+    }
+    aim_free(info);
     return 0;
 }
 
-int
-onlp_sfp_hdr_get(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
+static void
+sfp_hdr_init__(onlp_oid_t oid, int port, int present, onlp_oid_hdr_t* hdr)
 {
-    int port, rv;
-    ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
-
     memset(hdr, 0, sizeof(*hdr));
-    ONLP_IF_ERROR_RETURN(rv = onlp_sfp_is_present(oid));
-
-    if(rv) {
+    if(present) {
         ONLP_OID_STATUS_FLAG_SET(hdr, PRESENT);
     }
     hdr->id = oid;
     hdr->poid = ONLP_OID_CHASSIS;
     sprintf(hdr->description, "SFP %d", port);
+}
+
+static int
+onlp_sfp_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
+{
+    int port, rv;
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, &port);
+    ONLP_IF_ERROR_RETURN(rv = sfp_present_get__(oid));
+    sfp_hdr_init__(oid, port, rv, hdr);
     return rv;
 }
+ONLP_LOCKED_API2(onlp_sfp_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
 
-int
-onlp_sfp_info_get(onlp_oid_t oid, onlp_sfp_info_t* info)
+#if ONLP_CONFIG_INCLUDE_SFP_CACHE == 1
+/**
+ * Offset of the 16 byte vendor serial number in the 0x50 map
+ * for the given SFF-8024 identifier.
+ */
+static int
+sfp_serial_offset__(uint8_t identifier)
 {
-    int rv;
+    switch(identifier)
+        {
+        case 0x0C: /* QSFP */
+        case 0x0D: /* QSFP+ */
+        case 0x11: /* QSFP28 */
+            return 196;
+        case 0x18: /* QSFP-DD */
+        case 0x19: /* OSFP */
+        case 0x1E: /* QSFP+ with CMIS */
+            return 166;
+        default:
+            return 68;
+        }
+}
 
-    memset(info, 0, sizeof(*info));
+/**
+ * Returns 1 if the module is still the one the cache entry was
+ * parsed from. The entry is dropped otherwise.
+ */
+static int
+sfp_cache_identity_valid__(onlp_oid_t oid, sfp_cache_entry_t* e)
+{
+    uint8_t identifier;
+    uint8_t serial[16];
+    int offset = sfp_serial_offset__(e->info.bytes.a0[0]);
+
+    if(ONLP_FAILURE(onlp_sfp_dev_read_locked__(oid, 0x50, 0, &identifier, 1)) ||
+       identifier != e->info.bytes.a0[0] ||
+       ONLP_FAILURE(onlp_sfp_dev_read_locked__(oid, 0x50, offset,
+                                               serial, sizeof(serial))) ||
+       memcmp(serial, e->info.bytes.a0 + offset, sizeof(serial))) {
+        sfp_cache_invalidate__(oid);
+        return 0;
+    }
+    return 1;
+}
 
-    ONLP_IF_ERROR_RETURN(onlp_sfp_hdr_get(oid, &info->hdr));
-    ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, NULL);
+/**
+ * Populate the SFF and DOM fields from the cache entry.
+ * The DOM monitor bytes are re-read if they have expired.
+ */
+static int
+sfp_info_from_cache__(onlp_oid_t oid, sfp_cache_entry_t* e,
+                      onlp_sfp_info_t* info)
+{
+    int rv = 0;
+    uint64_t now = os_time_monotonic();
+
+    if(e->info.dom.spec != SFF_DOM_SPEC_UNSUPPORTED &&
+       now - e->dom_updated >= ONLP_CONFIG_SFP_DOM_CACHE_USECS) {
+
+        switch(e->info.dom.spec)
+            {
+            case SFF_DOM_SPEC_SFF8472:
+                /** Diagnostics, status, and flags live in A2 96-127 */
+                rv = onlp_sfp_dev_read_locked__(oid, 0x51, 96,
+                                                e->info.bytes.a2 + 96, 32);
+                break;
+            default:
+                /** SFF-8436/8636 monitors live in the lower page. */
+                rv = onlp_sfp_dev_read_locked__(oid, 0x50, 0,
+                                                e->info.bytes.a0, 128);
+                break;
+            }
 
-    if(ONLP_FAILURE(rv = onlp_sfp_type_get(oid, &info->type))) {
+        if(ONLP_SUCCESS(rv)) {
+            rv = sff_dom_info_get(&e->info.dom, &e->info.sff,
+                                  e->info.bytes.a0, e->info.bytes.a2);
+        }
+        if(ONLP_FAILURE(rv)) {
+            AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: dom refresh failed: %{onlp_status}",
+                          oid, rv);
+            sfp_cache_invalidate__(oid);
+            return rv;
+        }
+        e->dom_updated = now;
+    }
+
+    info->sff = e->info.sff;
+    info->dom = e->info.dom;
+    memcpy(&info->bytes, &e->info.bytes, sizeof(info->bytes));
+    return 0;
+}
+#endif
+
+/**
+ * Populate the type and controls for a validated port
+ * whose header has already been initialized.
+ */
+static int
+sfp_info_controls_get__(onlp_oid_t oid, onlp_sfp_info_t* info)
+{
+    int rv;
+
+    if(ONLP_FAILURE(rv = onlp_sfp_type_get_locked__(oid, &info->type))) {
         info->type = ONLP_SFP_TYPE_INVALID;
     }
 
-    if(ONLP_FAILURE(rv = onlp_sfp_control_flags_get(oid, &info->controls))) {
+    if(ONLP_FAILURE(rv = onlp_sfp_control_flags_get_locked__(oid, &info->controls))) {
         AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: sfp_control_flags_get returned %{onlp_status}",
                       oid, rv);
         return rv;
     }
+    return 0;
+}
 
-    if(ONLP_FAILURE(rv = onlp_sfp_is_present(oid))) {
-        AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: is_present returned %{onlp_status}",
-                      oid, rv);
-        return rv;
-    }
+/**
+ * Populate the EEPROM and DOM fields if the module is present.
+ * This only issues onlp_sfpi_dev_read() calls for the given port.
+ */
+static int
+sfp_info_eeprom_get__(onlp_oid_t oid, onlp_sfp_info_t* info)
+{
+    int rv;
 
-    if(rv == 0) {
+    if(ONLP_OID_STATUS_FLAG_NOT_SET(info, PRESENT)) {
         /** Module not present. */
-        ONLP_OID_STATUS_FLAG_CLR(info, PRESENT);
         return 0;
     }
 
-    /** Module present. */
-    ONLP_OID_STATUS_FLAG_SET(info, PRESENT);
+#if ONLP_CONFIG_INCLUDE_SFP_CACHE == 1
+    sfp_cache_entry_t* e = sfp_cache_entry__(oid);
+    if(e && sfp_cache_identity_valid__(oid, e)) {
+        return sfp_info_from_cache__(oid, e, info);
+    }
+#endif
 
     /** Read the IDPROM */
-    if(ONLP_FAILURE(rv = onlp_sfp_dev_read(oid, 0x50, 0, info->bytes.a0,
-                                           sizeof(info->bytes.a0)))) {
+    if(ONLP_FAILURE(rv = onlp_sfp_dev_read_locked__(oid, 0x50, 0, info->bytes.a0,
+                                                    sizeof(info->bytes.a0)))) {
         AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: sfp_dev_read(0x50) failed: %{onlp_status}",
                       oid, rv);
         return rv;
@@ -580,7 +890,10 @@ onlp_sfp_info_get(onlp_oid_t oid, onlp_sfp_info_t* info)
     memcpy(&info->sff, &sffe.info, sizeof(info->sff));
     if(sffe.identified == 0) {
         info->sff.sfp_type = SFF_SFP_TYPE_INVALID;
-        /* Nothing more to do */
+        /*
+         * Nothing more to do. This is not cached so that a module
+         * which is still initializing is parsed again on the next read.
+         */
         return 0;
     }
 
@@ -591,30 +904,266 @@ onlp_sfp_info_get(onlp_oid_t oid, onlp_sfp_info_t* info)
         return rv;
     }
 
-    if(info->dom.spec == SFF_DOM_SPEC_UNSUPPORTED) {
-        return 0;
-    }
+    if(info->dom.spec != SFF_DOM_SPEC_UNSUPPORTED) {
+
+        if(info->dom.spec == SFF_DOM_SPEC_SFF8472) {
+            /** Need the a2 data */
+            if(ONLP_FAILURE(rv = onlp_sfp_dev_read_locked__(oid, 0x51, 0, info->bytes.a2,
+                                                            sizeof(info->bytes.a2)))) {
+                AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: sfp_dev_read(0x51) failed: %{onlp_status}",
+                              oid, rv);
+                return rv;
+            }
+        }
 
-    if(info->dom.spec == SFF_DOM_SPEC_SFF8472) {
-        /** Need the a2 data */
-        if(ONLP_FAILURE(rv = onlp_sfp_dev_read(oid, 0x51, 0, info->bytes.a2,
-                                               sizeof(info->bytes.a2)))) {
-            AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: sfp_dev_read(0x51) failed: %{onlp_status}",
+        if(ONLP_FAILURE(rv = sff_dom_info_get(&info->dom, &info->sff,
+                                              info->bytes.a0, info->bytes.a2))) {
+            AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: sfp_dom_info_get failed: %{onlp_status}",
                           oid, rv);
             return rv;
         }
     }
 
-    if(ONLP_FAILURE(rv = sff_dom_info_get(&info->dom, &info->sff,
-                                          info->bytes.a0, info->bytes.a2))) {
-        AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: sfp_dom_info_get failed: %{onlp_status}",
+#if ONLP_CONFIG_INCLUDE_SFP_CACHE == 1
+    sfp_cache_store__(oid, info);
+#endif
+
+    return 0;
+}
+
+static int
+sfp_info_populate__(onlp_oid_t oid, onlp_sfp_info_t* info)
+{
+    ONLP_IF_ERROR_RETURN(sfp_info_controls_get__(oid, info));
+    return sfp_info_eeprom_get__(oid, info);
+}
+
+static void
+sfp_sweep_entry__(onlp_sfp_info_t* info)
+{
+    if(ONLP_OID_STATUS_FLAG_NOT_SET(info, FAILED) &&
+       ONLP_FAILURE(sfp_info_eeprom_get__(info->hdr.id, info))) {
+        ONLP_OID_STATUS_FLAG_SET(info, FAILED);
+    }
+}
+
+#if ONLP_CONFIG_INCLUDE_SFP_SWEEP == 1
+
+/**
+ * Each worker reads the EEPROMs of the ports in one or more access
+ * domains, one port at a time. Workers never share a domain.
+ */
+typedef struct sfp_sweep_worker_s {
+    pthread_t thread;
+    int domain;
+    int count;
+    onlp_sfp_info_t** entries;
+} sfp_sweep_worker_t;
+
+static void*
+sfp_sweep_worker__(void* arg)
+{
+    int i;
+    sfp_sweep_worker_t* w = (sfp_sweep_worker_t*)arg;
+
+    os_thread_name_set("onlp.sfp.sweep");
+    for(i = 0; i < w->count; i++) {
+        sfp_sweep_entry__(w->entries[i]);
+    }
+    return NULL;
+}
+
+/**
+ * Assign each port to a worker based on its access domain.
+ * Returns the number of workers required, or 0 if the platform
+ * does not declare access domains.
+ */
+static int
+sfp_sweep_assign__(onlp_sfp_info_t* info, int count, int* wid,
+                   sfp_sweep_worker_t* workers, int max)
+{
+    int i, w, n = 0;
+
+    for(i = 0; i < count; i++) {
+        onlp_sfp_info_t* ip = info + i;
+        onlp_oid_t oid = ip->hdr.id;
+        int port, domain;
+
+        wid[i] = -1;
+        if(ONLP_OID_STATUS_FLAG_NOT_SET(ip, PRESENT) ||
+           ONLP_OID_STATUS_FLAG_IS_SET(ip, FAILED)) {
+            /** Nothing to read. */
+            continue;
+        }
+
+        if(ONLP_FAILURE(sfp_oid_validate__(&oid, &port)) ||
+           ONLP_FAILURE(onlp_sfpi_port_domain_get(port, &domain))) {
+            return 0;
+        }
+
+        for(w = 0; w < n; w++) {
+            if(workers[w].domain == domain) {
+                break;
+            }
+        }
+        if(w == n) {
+            if(n < max) {
+                workers[n++].domain = domain;
+            }
+            else {
+                /** Out of workers. Share one; they are serial anyway. */
+                w = (unsigned)domain % max;
+            }
+        }
+        wid[i] = w;
+        workers[w].count++;
+    }
+    return n;
+}
+
+static void
+sfp_sweep__(onlp_sfp_info_t* info, int count)
+{
+    sfp_sweep_worker_t workers[ONLP_CONFIG_SFP_SWEEP_WORKERS_MAX];
+    int i, w, n;
+    int* wid;
+
+    if(count < 2) {
+        goto serial;
+    }
+
+    memset(workers, 0, sizeof(workers));
+    wid = aim_zmalloc(sizeof(*wid)*count);
+    n = sfp_sweep_assign__(info, count, wid, workers, AIM_ARRAYSIZE(workers));
+    if(n < 2) {
+        aim_free(wid);
+        goto serial;
+    }
+
+    for(w = 0; w < n; w++) {
+        workers[w].entries = aim_zmalloc(sizeof(onlp_sfp_info_t*)*workers[w].count);
+        workers[w].count = 0;
+    }
+    for(i = 0; i < count; i++) {
+        if(wid[i] >= 0) {
+            sfp_sweep_worker_t* wp = workers + wid[i];
+            wp->entries[wp->count++] = info + i;
+        }
+    }
+    aim_free(wid);
+
+    /** The calling thread services the first worker. */
+    for(w = 1; w < n; w++) {
+        if(pthread_create(&workers[w].thread, NULL,
+                          sfp_sweep_worker__, workers + w) != 0) {
+            AIM_LOG_ERROR("sfp sweep: pthread_create failed: %{errno}", errno);
+            workers[w].thread = 0;
+            sfp_sweep_worker__(workers + w);
+        }
+    }
+    sfp_sweep_worker__(workers + 0);
+
+    for(w = 0; w < n; w++) {
+        if(w > 0 && workers[w].thread) {
+            pthread_join(workers[w].thread, NULL);
+        }
+        aim_free(workers[w].entries);
+    }
+    return;
+
+ serial:
+    for(i = 0; i < count; i++) {
+        sfp_sweep_entry__(info + i);
+    }
+}
+
+#else
+
+static void
+sfp_sweep__(onlp_sfp_info_t* info, int count)
+{
+    int i;
+    for(i = 0; i < count; i++) {
+        sfp_sweep_entry__(info + i);
+    }
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_SFP_SWEEP */
+
+static int
+onlp_sfp_info_get_locked__(onlp_oid_t oid, onlp_sfp_info_t* info)
+{
+    int rv;
+
+    memset(info, 0, sizeof(*info));
+
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, NULL);
+
+    if(ONLP_FAILURE(rv = onlp_sfp_hdr_get_locked__(oid, &info->hdr))) {
+        AIM_LOG_ERROR("%{onlp_oid}: sfp_info_get: is_present returned %{onlp_status}",
                       oid, rv);
         return rv;
     }
 
+    return sfp_info_populate__(oid, info);
+}
+ONLP_LOCKED_API2(onlp_sfp_info_get, onlp_oid_t, oid, onlp_sfp_info_t*, info);
+
+static int
+onlp_sfp_info_get_all_locked__(onlp_sfp_bitmap_t* ports,
+                               onlp_sfp_info_t* info, int count)
+{
+    int p, rv, n = 0;
+    onlp_sfp_bitmap_t present;
 
+    if(info == NULL || count < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(ports == NULL) {
+        ports = &sfpi_bitmap__;
+    }
+
+    /** A single presence read covers every requested port. */
+    ONLP_IF_ERROR_RETURN(onlp_sfp_presence_bitmap_get_locked__(&present));
+
+    AIM_BITMAP_ITER(ports, p) {
+        if(n >= count) {
+            break;
+        }
+
+        onlp_oid_t oid = p;
+        int port;
+        if(ONLP_FAILURE(sfp_oid_validate__(&oid, &port))) {
+            /** Not a valid port on this platform. */
+            continue;
+        }
+
+        onlp_sfp_info_t* ip = info + n++;
+        memset(ip, 0, sizeof(*ip));
+        sfp_hdr_init__(oid, port, AIM_BITMAP_GET(&present, p), &ip->hdr);
+
+        if(ONLP_FAILURE(rv = sfp_info_controls_get__(oid, ip))) {
+            /** Report the failure for this port and continue. */
+            ONLP_OID_STATUS_FLAG_SET(ip, FAILED);
+        }
+    }
+
+    /** EEPROM reads for all present ports. */
+    sfp_sweep__(info, n);
+    return n;
+}
+ONLP_LOCKED_API3(onlp_sfp_info_get_all, onlp_sfp_bitmap_t*, ports,
+                 onlp_sfp_info_t*, info, int, count);
+
+static int
+onlp_sfp_cache_invalidate_locked__(onlp_oid_t oid)
+{
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(&oid, NULL);
+    sfp_cache_invalidate__(oid);
     return 0;
 }
+ONLP_LOCKED_API1(onlp_sfp_cache_invalidate, onlp_oid_t, port);
 
 int
 onlp_sfp_info_to_user_json(onlp_sfp_info_t* info, cJSON** cjp, uint32_t flags)
@@ -26,6 +26,7 @@
 #include <onlp/platformi/thermali.h>
 #include <onlp/oids.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_THERMAL
 #include "onlp_locks.h"
 #include "onlp_log.h"
 
@@ -67,7 +68,7 @@ onlp_thermal_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
     hdr->id = oid;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_thermal_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_RAPI2(onlp_thermal_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
 
 
 static int
@@ -86,7 +87,7 @@ onlp_thermal_info_get_locked__(onlp_oid_t oid, onlp_thermal_info_t* info)
     info->hdr.id = oid;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_thermal_info_get, onlp_oid_t, oid, onlp_thermal_info_t*, info);
+ONLP_LOCKED_RAPI2(onlp_thermal_info_get, onlp_oid_t, oid, onlp_thermal_info_t*, info);
 
 int
 onlp_thermal_info_to_user_json(onlp_thermal_info_t* info, cJSON** cjp, uint32_t flags)
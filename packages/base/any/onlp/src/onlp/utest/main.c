@@ -59,6 +59,13 @@
         fflush(stderr);                                         \
     } while(0)
 
+#define CHECK(_expr)                                                    \
+    do {                                                                \
+        if(!(_expr)) {                                                  \
+            AIM_DIE("%s:%d: check failed: %s", __FILE__, __LINE__, #_expr); \
+        }                                                               \
+    } while(0)
+
 #define TRY(_expr) __TRY("  ", _expr, "\r")
 #define TRYNR(_expr) ___TRYNR("  ", _expr, "\r")
 #define TEST(_expr) __TRYNR("", _expr, "\n");
@@ -105,27 +112,174 @@ iter__(onlp_oid_t oid, void* cookie)
 
 #include <onlp/fan.h>
 #include <onlp/thermal.h>
-#include <onlp/oids.h>
-#include <onlp/sys.h>
+#include <onlp/platform.h>
+#include <onlp/sfp.h>
+#include <onlp/platformi/sfpi.h>
+#include <onlp/platformi/platformi.h>
+
+/**
+ * The utest is its own platform. Everything other than
+ * the mock SFP port below uses the default implementations.
+ */
+#define UTEST_PLATFORM "utest"
+
+const char*
+onlp_platformi_get(void)
+{
+    return UTEST_PLATFORM;
+}
+
+int
+onlp_platformi_sw_init(void)
+{
+    return 0;
+}
+
+/**
+ * A single mock SFP port whose module can be swapped
+ * underneath the SFP info cache.
+ */
+static struct {
+    int present;
+    uint8_t a0[256];
+    /** Bytes read from 0x50 */
+    int reads;
+} sfp_mock__;
+
+int
+onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
+{
+    AIM_BITMAP_SET(bmap, 0);
+    return 0;
+}
+
+int
+onlp_sfpi_is_present(onlp_oid_id_t id)
+{
+    return sfp_mock__.present;
+}
+
+int
+onlp_sfpi_dev_read(onlp_oid_id_t id, int devaddr, int addr,
+                   uint8_t* dst, int len)
+{
+    if(!sfp_mock__.present || devaddr != 0x50 ||
+       addr < 0 || addr + len > (int)sizeof(sfp_mock__.a0)) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    memcpy(dst, sfp_mock__.a0 + addr, len);
+    sfp_mock__.reads += len;
+    return 0;
+}
+
+static void
+sfp_mock_field__(int offset, int size, const char* s)
+{
+    memset(sfp_mock__.a0 + offset, ' ', size);
+    memcpy(sfp_mock__.a0 + offset, s, strlen(s));
+}
+
+/**
+ * Insert a 10GBASE-SR SFP without DOM with the given serial number.
+ */
+static void
+sfp_mock_insert__(const char* serial)
+{
+    int i;
+    uint8_t cc;
+
+    memset(sfp_mock__.a0, 0, sizeof(sfp_mock__.a0));
+    sfp_mock__.a0[0] = 0x03;
+    sfp_mock__.a0[1] = 0x04;
+    sfp_mock__.a0[2] = 0x07;
+    sfp_mock__.a0[3] = 0x10;
+    sfp_mock__.a0[12] = 0x67;
+    sfp_mock_field__(20, 16, "UTEST");
+    sfp_mock_field__(40, 16, "UTEST-SR");
+    sfp_mock_field__(68, 16, serial);
+    sfp_mock_field__(84, 8, "20260101");
+    for(cc = 0, i = 0; i < 63; i++) {
+        cc += sfp_mock__.a0[i];
+    }
+    sfp_mock__.a0[63] = cc;
+    for(cc = 0, i = 64; i < 95; i++) {
+        cc += sfp_mock__.a0[i];
+    }
+    sfp_mock__.a0[95] = cc;
+    sfp_mock__.present = 1;
+}
+
+/**
+ * Cached SFP info must never outlive the module it was read from.
+ */
+void
+sfp_cache_test(void)
+{
+#if ONLP_CONFIG_INCLUDE_SFP_CACHE == 1
+    onlp_oid_t oid = ONLP_SFP_ID_CREATE(1);
+    onlp_sfp_info_t info;
+
+    sfp_mock_insert__("SERIAL-A");
+    TRY(onlp_sfp_cache_invalidate(oid));
+    TRY(onlp_sfp_info_get(oid, &info));
+    CHECK(!memcmp(info.bytes.a0 + 68, "SERIAL-A", 8));
+
+    /* Cache hit. Only the identifier and serial number are read. */
+    sfp_mock__.reads = 0;
+    TRY(onlp_sfp_info_get(oid, &info));
+    CHECK(sfp_mock__.reads == 17);
+    CHECK(!memcmp(info.bytes.a0 + 68, "SERIAL-A", 8));
+
+    /* Swapped between two presence reads. */
+    sfp_mock_insert__("SERIAL-B");
+    TRY(onlp_sfp_info_get(oid, &info));
+    CHECK(!memcmp(info.bytes.a0 + 68, "SERIAL-B", 8));
+
+    /* Same serial number, different module type. */
+    sfp_mock__.a0[0] = 0x0B;
+    sfp_mock__.reads = 0;
+    TRY(onlp_sfp_info_get(oid, &info));
+    CHECK(sfp_mock__.reads > 17);
+    CHECK(info.bytes.a0[0] == 0x0B);
+
+    /* Removed and reinserted. */
+    sfp_mock_insert__("SERIAL-B");
+    TRY(onlp_sfp_info_get(oid, &info));
+    sfp_mock__.present = 0;
+    CHECK(onlp_sfp_is_present(oid) == 0);
+    sfp_mock__.present = 1;
+    CHECK(onlp_sfp_is_present(oid) == 1);
+    sfp_mock__.reads = 0;
+    TRY(onlp_sfp_info_get(oid, &info));
+    CHECK(sfp_mock__.reads >= (int)sizeof(info.bytes.a0));
+
+    /* Written to. */
+    sfp_mock__.reads = 0;
+    onlp_sfp_dev_writeb(oid, 0x50, 127, 0);
+    TRY(onlp_sfp_info_get(oid, &info));
+    CHECK(sfp_mock__.reads >= (int)sizeof(info.bytes.a0));
+#endif
+}
 
 int
 aim_main(int argc, char* argv[])
 {
     //    TEST(shlock_test());
 
-    /* Example Platform Dump */
-    onlp_init();
-    onlp_platform_dump(&aim_pvs_stdout, ONLP_OID_DUMP_RECURSE);
-    onlp_oid_iterate(0, 0, iter__, NULL);
-    onlp_platform_show(&aim_pvs_stdout, ONLP_OID_SHOW_RECURSE|ONLP_OID_SHOW_EXTENDED);
+    TRY(onlp_sw_init(UTEST_PLATFORM));
+    TEST(sfp_cache_test());
+
+    /* Example Platform Walk */
+    onlp_oid_iterate(ONLP_OID_CHASSIS, 0, iter__, NULL);
 
     if(argv[1] && !strcmp("manage", argv[1])) {
-        onlp_sys_platform_manage_start();
+        onlp_platform_manager_start(0);
         printf("Sleeping...\n");
         sleep(10);
         printf("Stopping...\n");
-        onlp_sys_platform_manage_stop();
+        onlp_platform_manager_stop(1);
         printf("Stopped.\n");
     }
+    onlp_sw_denit();
     return 0;
 }
@@ -0,0 +1,9 @@
+###############################################################################
+#
+# onlp_bench Autogeneration
+#
+###############################################################################
+onlp_bench_AUTO_DEFS := module/auto/onlp_bench.yml
+onlp_bench_AUTO_DIRS := module/inc/onlp_bench module/src
+include $(BUILDER)/auto.mk
+
@@ -0,0 +1,26 @@
+/**************************************************************************//**
+ *
+ * onlp_bench Doxygen Header
+ *
+ *****************************************************************************/
+#ifndef __ONLP_BENCH_DOX_H__
+#define __ONLP_BENCH_DOX_H__
+
+/**
+ * @defgroup onlp_bench onlp_bench - onlp_bench Description
+ *
+
+The documentation overview for this module should go here.
+
+ *
+ * @{
+ *
+ * @defgroup onlp_bench-onlp_bench Public Interface
+ * @defgroup onlp_bench-config Compile Time Configuration
+ * @defgroup onlp_bench-porting Porting Macros
+ *
+ * @}
+ *
+ */
+
+#endif /* __ONLP_BENCH_DOX_H__ */
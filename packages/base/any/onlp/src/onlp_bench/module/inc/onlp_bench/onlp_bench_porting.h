@@ -0,0 +1,107 @@
+/**************************************************************************//**
+ *
+ * @file
+ * @brief onlp_bench Porting Macros.
+ *
+ * @addtogroup onlp_bench-porting
+ * @{
+ *
+ *****************************************************************************/
+#ifndef __ONLP_BENCH_PORTING_H__
+#define __ONLP_BENCH_PORTING_H__
+
+
+/* <auto.start.portingmacro(ALL).define> */
+#if ONLP_BENCH_CONFIG_PORTING_INCLUDE_STDLIB_HEADERS == 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <memory.h>
+#endif
+
+#ifndef ONLP_BENCH_MALLOC
+    #if defined(GLOBAL_MALLOC)
+        #define ONLP_BENCH_MALLOC GLOBAL_MALLOC
+    #elif ONLP_BENCH_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_BENCH_MALLOC malloc
+    #else
+        #error The macro ONLP_BENCH_MALLOC is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_BENCH_FREE
+    #if defined(GLOBAL_FREE)
+        #define ONLP_BENCH_FREE GLOBAL_FREE
+    #elif ONLP_BENCH_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_BENCH_FREE free
+    #else
+        #error The macro ONLP_BENCH_FREE is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_BENCH_MEMSET
+    #if defined(GLOBAL_MEMSET)
+        #define ONLP_BENCH_MEMSET GLOBAL_MEMSET
+    #elif ONLP_BENCH_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_BENCH_MEMSET memset
+    #else
+        #error The macro ONLP_BENCH_MEMSET is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_BENCH_MEMCPY
+    #if defined(GLOBAL_MEMCPY)
+        #define ONLP_BENCH_MEMCPY GLOBAL_MEMCPY
+    #elif ONLP_BENCH_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_BENCH_MEMCPY memcpy
+    #else
+        #error The macro ONLP_BENCH_MEMCPY is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_BENCH_STRNCPY
+    #if defined(GLOBAL_STRNCPY)
+        #define ONLP_BENCH_STRNCPY GLOBAL_STRNCPY
+    #elif ONLP_BENCH_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_BENCH_STRNCPY strncpy
+    #else
+        #error The macro ONLP_BENCH_STRNCPY is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_BENCH_VSNPRINTF
+    #if defined(GLOBAL_VSNPRINTF)
+        #define ONLP_BENCH_VSNPRINTF GLOBAL_VSNPRINTF
+    #elif ONLP_BENCH_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_BENCH_VSNPRINTF vsnprintf
+    #else
+        #error The macro ONLP_BENCH_VSNPRINTF is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_BENCH_SNPRINTF
+    #if defined(GLOBAL_SNPRINTF)
+        #define ONLP_BENCH_SNPRINTF GLOBAL_SNPRINTF
+    #elif ONLP_BENCH_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_BENCH_SNPRINTF snprintf
+    #else
+        #error The macro ONLP_BENCH_SNPRINTF is required but cannot be defined.
+    #endif
+#endif
+
+#ifndef ONLP_BENCH_STRLEN
+    #if defined(GLOBAL_STRLEN)
+        #define ONLP_BENCH_STRLEN GLOBAL_STRLEN
+    #elif ONLP_BENCH_CONFIG_PORTING_STDLIB == 1
+        #define ONLP_BENCH_STRLEN strlen
+    #else
+        #error The macro ONLP_BENCH_STRLEN is required but cannot be defined.
+    #endif
+#endif
+
+/* <auto.end.portingmacro(ALL).define> */
+
+
+#endif /* __ONLP_BENCH_PORTING_H__ */
+/* @} */
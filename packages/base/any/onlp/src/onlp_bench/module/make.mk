@@ -0,0 +1,10 @@
+###############################################################################
+#
+# 
+#
+###############################################################################
+THIS_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
+onlp_bench_INCLUDES := -I $(THIS_DIR)inc
+onlp_bench_INTERNAL_INCLUDES := -I $(THIS_DIR)src
+onlp_bench_DEPENDMODULE_ENTRIES := init:onlp_bench ucli:onlp_bench
+
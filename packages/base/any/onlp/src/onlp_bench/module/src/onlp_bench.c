@@ -0,0 +1,483 @@
+/**************************************************************************//**
+ *
+ * ONLP API benchmarks.
+ *
+ * Each benchmark runs a single operation repeatedly on one or
+ * more threads for a fixed duration and reports the throughput
+ * and latency percentiles of that operation.
+ *
+ *****************************************************************************/
+#include <onlp_bench/onlp_bench_config.h>
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+#include <onlp/sfp.h>
+#include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include <cjson/cJSON.h>
+#include "onlp_bench_log.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <inttypes.h>
+
+/**
+ * A benchmark operation. Returns the number of API calls
+ * made, or an ONLP_STATUS_E_* error.
+ */
+typedef int (*bench_op_f)(void);
+
+typedef struct bench_s {
+    const char* name;
+    const char* desc;
+    bench_op_f op;
+} bench_t;
+
+/******************************************************************************
+ *
+ * Operations
+ *
+ *****************************************************************************/
+
+static int
+iterate_cb__(onlp_oid_t oid, void* cookie)
+{
+    (*(int*)cookie)++;
+    return 0;
+}
+
+static int
+op_oid_iterate__(void)
+{
+    int count = 0;
+    ONLP_IF_ERROR_RETURN(onlp_oid_iterate(ONLP_OID_CHASSIS, 0,
+                                          iterate_cb__, &count));
+    return 1;
+}
+
+static int
+op_hdr_get_all__(void)
+{
+    biglist_t* list = NULL;
+    ONLP_IF_ERROR_RETURN(onlp_oid_hdr_get_all(ONLP_OID_CHASSIS, 0, 0, &list));
+    onlp_oid_get_all_free(list);
+    return 1;
+}
+
+static int
+op_info_get_all__(void)
+{
+    biglist_t* list = NULL;
+    ONLP_IF_ERROR_RETURN(onlp_oid_info_get_all(ONLP_OID_CHASSIS, 0, 0, &list));
+    onlp_oid_get_all_free(list);
+    return 1;
+}
+
+static onlp_sfp_bitmap_t sfp_ports__;
+static int sfp_count__;
+
+static int
+op_sfp_info_get__(void)
+{
+    static __thread int next = 0;
+    onlp_sfp_info_t info;
+    int p, i = 0;
+
+    if(sfp_count__ == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    /* One port per call, round robin. */
+    AIM_BITMAP_ITER(&sfp_ports__, p) {
+        if(i++ == next) {
+            break;
+        }
+    }
+    next = (next + 1) % sfp_count__;
+    ONLP_IF_ERROR_RETURN(onlp_sfp_info_get(ONLP_SFP_ID_CREATE(p+1), &info));
+    return 1;
+}
+
+static int
+op_sfp_info_get_all__(void)
+{
+    int rv;
+    onlp_sfp_info_t* info;
+
+    if(sfp_count__ == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    info = aim_zmalloc(sizeof(*info) * sfp_count__);
+    rv = onlp_sfp_info_get_all(&sfp_ports__, info, sfp_count__);
+    aim_free(info);
+    return (rv < 0) ? rv : 1;
+}
+
+static int
+op_json__(void)
+{
+    cJSON* cj = NULL;
+    char* s;
+    ONLP_IF_ERROR_RETURN(onlp_oid_to_json(ONLP_OID_CHASSIS, &cj,
+                                          ONLP_OID_JSON_FLAG_RECURSIVE));
+    s = cJSON_PrintUnformatted(cj);
+    free(s);
+    cJSON_Delete(cj);
+    return 1;
+}
+
+static int
+op_mixed__(void)
+{
+    static __thread int next = 0;
+    static const bench_op_f ops[] = {
+        op_hdr_get_all__,
+        op_sfp_info_get__,
+        op_info_get_all__,
+        op_sfp_info_get__,
+        op_json__,
+    };
+    int rv = ops[next]();
+    next = (next + 1) % AIM_ARRAYSIZE(ops);
+    return (rv == ONLP_STATUS_E_UNSUPPORTED) ? 0 : rv;
+}
+
+static bench_t benches__[] = {
+    { "oid-iterate", "onlp_oid_iterate() over the chassis", op_oid_iterate__ },
+    { "hdr-get-all", "onlp_oid_hdr_get_all() for the chassis", op_hdr_get_all__ },
+    { "info-get-all", "onlp_oid_info_get_all() for the chassis", op_info_get_all__ },
+    { "sfp-info-get", "onlp_sfp_info_get() for one port", op_sfp_info_get__ },
+    { "sfp-info-get-all", "onlp_sfp_info_get_all() for all ports", op_sfp_info_get_all__ },
+    { "json", "onlp_oid_to_json() and serialization of the chassis", op_json__ },
+    { "mixed", "A mix of the header, info, SFP, and JSON operations", op_mixed__ },
+};
+
+/******************************************************************************
+ *
+ * Runner
+ *
+ *****************************************************************************/
+
+/** Initial size of each thread's sample buffer. */
+#define BENCH_SAMPLES_INITIAL 4096
+
+typedef struct bench_thread_s {
+    pthread_t thread;
+    bench_t* bench;
+    uint64_t deadline;
+    uint64_t ops;
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t min, max;
+    /** Reservoir of latency samples */
+    uint64_t* samples;
+    int nsamples;
+    int size;
+    int limit;
+    unsigned int seed;
+} bench_thread_t;
+
+/**
+ * Keep a uniform random sample of all latencies once the
+ * buffer reaches its limit (reservoir sampling).
+ */
+static void
+bench_sample__(bench_thread_t* t, uint64_t usecs)
+{
+    if(t->ops == 1 || usecs < t->min) {
+        t->min = usecs;
+    }
+    if(usecs > t->max) {
+        t->max = usecs;
+    }
+
+    if(t->nsamples < t->limit) {
+        if(t->nsamples == t->size) {
+            t->size = t->size ? t->size * 2 : BENCH_SAMPLES_INITIAL;
+            if(t->size > t->limit) {
+                t->size = t->limit;
+            }
+            t->samples = aim_realloc(t->samples, sizeof(uint64_t) * t->size);
+        }
+        t->samples[t->nsamples++] = usecs;
+    }
+    else {
+        uint64_t r = ((uint64_t)rand_r(&t->seed) << 31 | rand_r(&t->seed)) % t->ops;
+        if(r < t->limit) {
+            t->samples[r] = usecs;
+        }
+    }
+}
+
+static void*
+bench_thread__(void* arg)
+{
+    bench_thread_t* t = arg;
+
+    while(aim_time_monotonic() < t->deadline) {
+        uint64_t t0 = aim_time_monotonic();
+        int rv = t->bench->op();
+        uint64_t t1 = aim_time_monotonic();
+        if(rv < 0) {
+            t->errors++;
+        }
+        else if(rv > 0) {
+            t->calls += rv;
+        }
+        t->ops++;
+        bench_sample__(t, t1 - t0);
+    }
+    return NULL;
+}
+
+static int
+u64_compare__(const void* a, const void* b)
+{
+    uint64_t ua = *(const uint64_t*)a;
+    uint64_t ub = *(const uint64_t*)b;
+    return (ua < ub) ? -1 : (ua > ub) ? 1 : 0;
+}
+
+static uint64_t
+percentile__(uint64_t* sorted, int count, double pct)
+{
+    int i;
+    if(count == 0) {
+        return 0;
+    }
+    i = (int)((pct / 100.0) * (count - 1) + 0.5);
+    return sorted[i];
+}
+
+typedef struct bench_result_s {
+    uint64_t ops;
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t usecs;
+    uint64_t min, p50, p90, p99, p999, max;
+} bench_result_t;
+
+static const struct {
+    const char* name;
+    double pct;
+} percentiles__[] = {
+    { "p50", 50.0 },
+    { "p90", 90.0 },
+    { "p99", 99.0 },
+    { "p99.9", 99.9 },
+};
+
+static void
+bench_run__(bench_t* bench, int threads, int seconds, bench_result_t* r)
+{
+    int i, n = 0;
+    uint64_t start;
+    uint64_t* all;
+    bench_thread_t* t = aim_zmalloc(sizeof(*t) * threads);
+
+    memset(r, 0, sizeof(*r));
+
+    /* Warm any caches before measuring. */
+    bench->op();
+
+    start = aim_time_monotonic();
+    for(i = 0; i < threads; i++) {
+        t[i].bench = bench;
+        t[i].deadline = start + (uint64_t)seconds * 1000000;
+        t[i].limit = ONLP_BENCH_CONFIG_SAMPLES_MAX / threads;
+        if(t[i].limit < 1) {
+            t[i].limit = 1;
+        }
+        t[i].seed = (unsigned int)start + i;
+        pthread_create(&t[i].thread, NULL, bench_thread__, t + i);
+    }
+    for(i = 0; i < threads; i++) {
+        pthread_join(t[i].thread, NULL);
+        r->ops += t[i].ops;
+        r->calls += t[i].calls;
+        r->errors += t[i].errors;
+        if(t[i].ops) {
+            if(r->ops == t[i].ops || t[i].min < r->min) {
+                r->min = t[i].min;
+            }
+            if(t[i].max > r->max) {
+                r->max = t[i].max;
+            }
+        }
+        n += t[i].nsamples;
+    }
+    r->usecs = aim_time_monotonic() - start;
+
+    all = aim_zmalloc(sizeof(uint64_t) * (n + 1));
+    for(i = 0, n = 0; i < threads; i++) {
+        if(t[i].nsamples) {
+            memcpy(all + n, t[i].samples, sizeof(uint64_t) * t[i].nsamples);
+            n += t[i].nsamples;
+        }
+        aim_free(t[i].samples);
+    }
+    qsort(all, n, sizeof(uint64_t), u64_compare__);
+    r->p50 = percentile__(all, n, percentiles__[0].pct);
+    r->p90 = percentile__(all, n, percentiles__[1].pct);
+    r->p99 = percentile__(all, n, percentiles__[2].pct);
+    r->p999 = percentile__(all, n, percentiles__[3].pct);
+    aim_free(all);
+    aim_free(t);
+}
+
+static double
+ops_per_sec__(bench_result_t* r)
+{
+    return r->usecs ? (double)r->ops * 1000000.0 / r->usecs : 0.0;
+}
+
+static cJSON*
+result_to_json__(bench_t* bench, bench_result_t* r)
+{
+    cJSON* cj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(cj, "ops", r->ops);
+    cJSON_AddNumberToObject(cj, "calls", r->calls);
+    cJSON_AddNumberToObject(cj, "errors", r->errors);
+    cJSON_AddNumberToObject(cj, "usecs", r->usecs);
+    cJSON_AddNumberToObject(cj, "ops-per-sec", ops_per_sec__(r));
+    cJSON_AddNumberToObject(cj, "min", r->min);
+    cJSON_AddNumberToObject(cj, percentiles__[0].name, r->p50);
+    cJSON_AddNumberToObject(cj, percentiles__[1].name, r->p90);
+    cJSON_AddNumberToObject(cj, percentiles__[2].name, r->p99);
+    cJSON_AddNumberToObject(cj, percentiles__[3].name, r->p999);
+    cJSON_AddNumberToObject(cj, "max", r->max);
+    return cj;
+}
+
+static void
+usage__(const char* argv0)
+{
+    int i;
+    fprintf(stderr,
+            "usage: %s [-t threads] [-d seconds] [-p ports] [-j] [-a] [benchmark...]\n"
+            "  -t  Number of threads (default 1).\n"
+            "  -d  Duration of each benchmark in seconds (default 5).\n"
+            "  -p  Number of simulated SFP ports (sets ONLP_PLATFORM_SIM_SFP_PORTS).\n"
+            "  -j  Write the results as JSON.\n"
+            "  -a  Include the ONLP API statistics in the JSON results.\n"
+            "All latencies are in microseconds.\n\n"
+            "benchmarks:\n", argv0);
+    for(i = 0; i < AIM_ARRAYSIZE(benches__); i++) {
+        fprintf(stderr, "  %-18s %s\n", benches__[i].name, benches__[i].desc);
+    }
+}
+
+int
+onlp_bench_main(int argc, char* argv[])
+{
+    int c, i, j;
+    int threads = 1;
+    int seconds = 5;
+    int json = 0;
+    int api_stats = 0;
+    cJSON* results = NULL;
+
+    while( (c = getopt(argc, argv, "t:d:p:jah")) != -1) {
+        switch(c)
+            {
+            case 't': threads = atoi(optarg); break;
+            case 'd': seconds = atoi(optarg); break;
+            case 'p': setenv("ONLP_PLATFORM_SIM_SFP_PORTS", optarg, 1); break;
+            case 'j': json = 1; break;
+            case 'a': api_stats = 1; break;
+            case 'h': usage__(argv[0]); return 0;
+            default: usage__(argv[0]); return 1;
+            }
+    }
+
+    if(threads < 1 || threads > ONLP_BENCH_CONFIG_THREADS_MAX || seconds < 1) {
+        usage__(argv[0]);
+        return 1;
+    }
+
+    for(i = optind; i < argc; i++) {
+        for(j = 0; j < AIM_ARRAYSIZE(benches__); j++) {
+            if(!strcmp(argv[i], benches__[j].name)) {
+                break;
+            }
+        }
+        if(j == AIM_ARRAYSIZE(benches__)) {
+            fprintf(stderr, "unknown benchmark '%s'\n", argv[i]);
+            usage__(argv[0]);
+            return 1;
+        }
+    }
+
+    AIM_TRY_OR_DIE(onlp_sw_init(NULL));
+
+    onlp_sfp_bitmap_t_init(&sfp_ports__);
+    if(ONLP_SUCCESS(onlp_sfp_bitmap_get(&sfp_ports__))) {
+        int p;
+        AIM_BITMAP_ITER(&sfp_ports__, p) {
+            sfp_count__++;
+        }
+    }
+
+    if(json) {
+        results = cJSON_CreateObject();
+        cJSON_AddNumberToObject(results, "threads", threads);
+        cJSON_AddNumberToObject(results, "seconds", seconds);
+        cJSON_AddNumberToObject(results, "sfp-ports", sfp_count__);
+        cJSON_AddItemToObject(results, "benchmarks", cJSON_CreateObject());
+    }
+    else {
+        printf("threads=%d seconds=%d sfp-ports=%d\n", threads, seconds, sfp_count__);
+        printf("%-18s %10s %12s %8s %8s %8s %8s %8s %8s %8s\n",
+               "benchmark", "ops", "ops/sec", "errors",
+               "min", "p50", "p90", "p99", "p99.9", "max");
+    }
+
+    onlp_api_stats_reset();
+
+    for(j = 0; j < AIM_ARRAYSIZE(benches__); j++) {
+        bench_t* b = benches__ + j;
+        bench_result_t r;
+
+        if(optind < argc) {
+            for(i = optind; i < argc; i++) {
+                if(!strcmp(argv[i], b->name)) {
+                    break;
+                }
+            }
+            if(i == argc) {
+                continue;
+            }
+        }
+
+        bench_run__(b, threads, seconds, &r);
+
+        if(json) {
+            cJSON_AddItemToObject(cJSON_GetObjectItem(results, "benchmarks"),
+                                  b->name, result_to_json__(b, &r));
+        }
+        else {
+            printf("%-18s %10"PRIu64" %12.1f %8"PRIu64" %8"PRIu64" %8"PRIu64" %8"PRIu64" %8"PRIu64" %8"PRIu64" %8"PRIu64"\n",
+                   b->name, r.ops, ops_per_sec__(&r), r.errors,
+                   r.min, r.p50, r.p90, r.p99, r.p999, r.max);
+            fflush(stdout);
+        }
+    }
+
+    if(json) {
+        char* s;
+        cJSON* stats = NULL;
+        if(api_stats && ONLP_SUCCESS(onlp_api_stats_to_json(&stats))) {
+            cJSON_AddItemToObject(results, "api", stats);
+        }
+        s = cJSON_Print(results);
+        printf("%s\n", s);
+        free(s);
+        cJSON_Delete(results);
+    }
+    else if(api_stats) {
+        onlp_api_stats_show(&aim_pvs_stdout, 0);
+    }
+
+    AIM_TRY_OR_DIE(onlp_sw_denit());
+    return 0;
+}
@@ -0,0 +1,12 @@
+/**************************************************************************//**
+ *
+ * onlp_bench Internal Header
+ *
+ *****************************************************************************/
+#ifndef __ONLP_BENCH_INT_H__
+#define __ONLP_BENCH_INT_H__
+
+#include <onlp_bench/onlp_bench_config.h>
+
+
+#endif /* __ONLP_BENCH_INT_H__ */
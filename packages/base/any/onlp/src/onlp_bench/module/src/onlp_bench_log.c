@@ -0,0 +1,18 @@
+/**************************************************************************//**
+ *
+ *
+ *
+ *****************************************************************************/
+#include <onlp_bench/onlp_bench_config.h>
+
+#include "onlp_bench_log.h"
+/*
+ * onlp_bench log struct.
+ */
+AIM_LOG_STRUCT_DEFINE(
+                      ONLP_BENCH_CONFIG_LOG_OPTIONS_DEFAULT,
+                      ONLP_BENCH_CONFIG_LOG_BITS_DEFAULT,
+                      NULL, /* Custom log map */
+                      ONLP_BENCH_CONFIG_LOG_CUSTOM_BITS_DEFAULT
+                     );
+
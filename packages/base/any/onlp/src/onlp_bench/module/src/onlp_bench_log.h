@@ -0,0 +1,12 @@
+/**************************************************************************//**
+ *
+ * 
+ *
+ *****************************************************************************/
+#ifndef __ONLP_BENCH_LOG_H__
+#define __ONLP_BENCH_LOG_H__
+
+#define AIM_LOG_MODULE_NAME onlp_bench
+#include <AIM/aim_log.h>
+
+#endif /* __ONLP_BENCH_LOG_H__ */
@@ -0,0 +1,22 @@
+/**************************************************************************//**
+ *
+ *
+ *
+ *****************************************************************************/
+#include <onlp_bench/onlp_bench_config.h>
+
+#include "onlp_bench_log.h"
+
+static int
+datatypes_init__(void)
+{
+#define ONLP_BENCH_ENUMERATION_ENTRY(_enum_name, _desc)     AIM_DATATYPE_MAP_REGISTER(_enum_name, _enum_name##_map, _desc,                               AIM_LOG_INTERNAL);
+#include <onlp_bench/onlp_bench.x>
+    return 0;
+}
+
+void __onlp_bench_module_init__(void)
+{
+    AIM_LOG_STRUCT_REGISTER();
+    datatypes_init__();
+}
@@ -0,0 +1,13 @@
+
+###############################################################################
+#
+# Inclusive Makefile for the onlp_bench module.
+#
+# Autogenerated 2026-10-17 10:12:41.208617
+#
+###############################################################################
+onlp_bench_BASEDIR := $(dir $(abspath $(lastword $(MAKEFILE_LIST))))
+include $(onlp_bench_BASEDIR)module/make.mk
+include $(onlp_bench_BASEDIR)module/auto/make.mk
+include $(onlp_bench_BASEDIR)module/src/make.mk
+
@@ -35,6 +35,7 @@ __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t*
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_post_insert(onlp_oid_id_t id, sff_info_t* sff_info));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_port_map(onlp_oid_id_t id, int* rport));
+__ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_port_domain_get(onlp_oid_id_t id, int* domain));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_denit(void));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_control_supported(onlp_oid_id_t id, onlp_sfp_control_t control, int* rv));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_control_set(onlp_oid_id_t id, onlp_sfp_control_t control, int value));
@@ -27,6 +27,8 @@ int onlp_platform_sim_oids_init(const char* fname);
  * @param[out] hdr Receives the pointer to the structure.
  * @note You would not normally use this function.
  * Instead use the instances provided below.
+ * @note The returned structure remains valid until the
+ * OID file has changed twice.
  */
 onlp_oid_hdr_t*
 onlp_platform_sim_oid_lookup(onlp_oid_t oid);
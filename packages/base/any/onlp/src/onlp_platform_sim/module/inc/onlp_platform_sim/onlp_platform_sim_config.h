@@ -89,6 +89,26 @@
 #define ONLP_PLATFORM_SIM_CONFIG_INCLUDE_UCLI 0
 #endif
 
+/**
+ * ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH
+ *
+ * Rebuild the OID table only when inotify reports a change to the JSON file. */
+
+
+#ifndef ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH
+#define ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH 1
+#endif
+
+/**
+ * ONLP_PLATFORM_SIM_CONFIG_SFP_PORTS_DEFAULT
+ *
+ * The number of simulated SFP ports if ONLP_PLATFORM_SIM_SFP_PORTS is not set and the SFP directory exists. */
+
+
+#ifndef ONLP_PLATFORM_SIM_CONFIG_SFP_PORTS_DEFAULT
+#define ONLP_PLATFORM_SIM_CONFIG_SFP_PORTS_DEFAULT 32
+#endif
+
 
 
 /**
@@ -25,30 +25,239 @@
 
 #include <cjson_util/cjson_util_file.h>
 
-struct {
+#include <pthread.h>
+#include <errno.h>
+#include <unistd.h>
+#include <libgen.h>
+
+/** One past the largest OID type */
+enum {
+#define ONLP_OID_TYPE_ENTRY(_name, _id, _upper, _lower) OID_TYPE_##_name##__ = _id,
+#include <onlp/onlp.x>
+    OID_TYPES__
+};
+
+/**
+ * The OID table is indexed by OID type and id. It is rebuilt
+ * only when the JSON file changes.
+ */
+typedef struct oid_table_s {
+    /** All OID structures, as returned by onlp_oid_from_json() */
     biglist_t* oid_list;
+    /** Structures by [type][id] */
+    onlp_oid_hdr_t** index[OID_TYPES__];
+    /** The size of each index */
+    int count[OID_TYPES__];
+} oid_table_t;
+
+struct {
+    oid_table_t table;
+    /**
+     * The previous table. Pointers returned by lookups remain
+     * valid until the table is rebuilt twice.
+     */
+    oid_table_t previous;
     cjson_util_file_t cjf;
+    pthread_rwlock_t lock;
+    /** The file must be checked on every lookup. */
+    int poll;
+#if ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH == 1
+    int watch_started;
+    pthread_t watch_thread;
+#endif
 } ctrl__;
 
 
+static void
+table_free__(oid_table_t* t)
+{
+    int i;
+    if(t->oid_list) {
+        biglist_free_all(t->oid_list, aim_free);
+    }
+    for(i = 0; i < AIM_ARRAYSIZE(t->index); i++) {
+        aim_free(t->index[i]);
+    }
+    memset(t, 0, sizeof(*t));
+}
+
 static int
-rebuild__(void)
+table_build__(cJSON* root, oid_table_t* t)
 {
-    /* Delete old entries */
-    if(ctrl__.oid_list) {
-        biglist_free_all(ctrl__.oid_list, aim_free);
-        ctrl__.oid_list = NULL;
-    }
-    /* Rebuild current entries */
-    int rv = onlp_oid_from_json(ctrl__.cjf.root, NULL, &ctrl__.oid_list,
-                                ONLP_OID_JSON_FLAG_RECURSIVE);
+    int rv;
+    biglist_t* ble;
+    onlp_oid_hdr_t* hdr;
+
+    memset(t, 0, sizeof(*t));
+    rv = onlp_oid_from_json(root, NULL, &t->oid_list,
+                            ONLP_OID_JSON_FLAG_RECURSIVE);
     if(ONLP_FAILURE(rv)) {
+        return rv;
+    }
+
+    /* Size each type's index by its largest id */
+    BIGLIST_FOREACH_DATA(ble, t->oid_list, onlp_oid_hdr_t*, hdr) {
+        int type = ONLP_OID_TYPE_GET(hdr->id);
+        int id = ONLP_OID_ID_GET(hdr->id);
+        if(type < OID_TYPES__ && id >= t->count[type]) {
+            t->count[type] = id + 1;
+        }
+    }
+    for(rv = 0; rv < OID_TYPES__; rv++) {
+        if(t->count[rv]) {
+            t->index[rv] = aim_zmalloc(sizeof(onlp_oid_hdr_t*) * t->count[rv]);
+        }
+    }
+    BIGLIST_FOREACH_DATA(ble, t->oid_list, onlp_oid_hdr_t*, hdr) {
+        int type = ONLP_OID_TYPE_GET(hdr->id);
+        if(type < OID_TYPES__) {
+            t->index[type][ONLP_OID_ID_GET(hdr->id)] = hdr;
+        }
+    }
+    return ONLP_STATUS_OK;
+}
+
+/**
+ * Reload the JSON file and rebuild the table.
+ * The caller must hold the write lock.
+ */
+static int
+rebuild__(int force)
+{
+    int rv;
+    oid_table_t t;
+
+    if(cjson_util_file_reload(&ctrl__.cjf, force) != 1 && !force) {
+        /* Unchanged */
+        return ONLP_STATUS_OK;
+    }
+
+    if(ONLP_FAILURE(rv = table_build__(ctrl__.cjf.root, &t))) {
         AIM_LOG_ERROR("error rebuilding from json file %s: %{onlp_status}",
-                      ctrl__.cjf.filename);
+                      ctrl__.cjf.filename, rv);
+        table_free__(&t);
+        return rv;
+    }
+    table_free__(&ctrl__.previous);
+    ctrl__.previous = ctrl__.table;
+    ctrl__.table = t;
+    return ONLP_STATUS_OK;
+}
+
+#if ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH == 1
+
+#include <sys/inotify.h>
+
+/**
+ * The directory is watched rather than the file itself so
+ * that files replaced by rename (as most editors do) are seen.
+ */
+static void*
+watch_thread__(void* arg)
+{
+    int fd, wd;
+    char* dname;
+    char* bname;
+    char* dcopy = aim_strdup(ctrl__.cjf.filename);
+    char* bcopy = aim_strdup(ctrl__.cjf.filename);
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+    dname = dirname(dcopy);
+    bname = basename(bcopy);
+
+    if((fd = inotify_init1(IN_CLOEXEC)) < 0 ||
+       (wd = inotify_add_watch(fd, dname,
+                               IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)) < 0) {
+        AIM_LOG_WARN("inotify on %s: %{errno}. The OID file will be polled.",
+                     dname, errno);
+        if(fd >= 0) {
+            close(fd);
+        }
+        __atomic_store_n(&ctrl__.poll, 1, __ATOMIC_RELEASE);
+        aim_free(dcopy);
+        aim_free(bcopy);
+        return NULL;
+    }
+
+    for(;;) {
+        char* p;
+        int changed = 0;
+        ssize_t len = read(fd, buf, sizeof(buf));
+        if(len <= 0) {
+            if(len < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for(p = buf; p < buf + len; ) {
+            struct inotify_event* e = (struct inotify_event*)p;
+            if(e->mask & IN_Q_OVERFLOW) {
+                changed = 1;
+            }
+            else if(e->len && !strcmp(e->name, bname)) {
+                changed = 1;
+            }
+            p += sizeof(*e) + e->len;
+        }
+        if(changed) {
+            pthread_rwlock_wrlock(&ctrl__.lock);
+            rebuild__(1);
+            pthread_rwlock_unlock(&ctrl__.lock);
+        }
+    }
+
+    close(fd);
+    __atomic_store_n(&ctrl__.poll, 1, __ATOMIC_RELEASE);
+    aim_free(dcopy);
+    aim_free(bcopy);
+    return NULL;
+}
+
+/**
+ * Threads do not survive fork(). The platform manager daemon
+ * forks after initialization, so the watcher is started on
+ * the first lookup in each process.
+ */
+static void
+watch_atfork_child__(void)
+{
+    ctrl__.watch_started = 0;
+}
+
+static void
+watch_start__(void)
+{
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_mutex_lock(&lock);
+    if(!ctrl__.watch_started) {
+        /* Catch any changes made while nobody was watching. */
+        pthread_rwlock_wrlock(&ctrl__.lock);
+        rebuild__(0);
+        pthread_rwlock_unlock(&ctrl__.lock);
+        if(pthread_create(&ctrl__.watch_thread, NULL, watch_thread__, NULL) == 0) {
+            pthread_detach(ctrl__.watch_thread);
+        }
+        else {
+            ctrl__.poll = 1;
+        }
+        __atomic_store_n(&ctrl__.watch_started, 1, __ATOMIC_RELEASE);
     }
-    return rv;
+    pthread_mutex_unlock(&lock);
 }
 
+#define WATCH_CHECK__()                                                 \
+    do {                                                                \
+        if(!__atomic_load_n(&ctrl__.watch_started, __ATOMIC_ACQUIRE)) { \
+            watch_start__();                                            \
+        }                                                               \
+    } while(0)
+
+#else
+
+#define WATCH_CHECK__()
+
+#endif /* ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH */
+
 int
 onlp_platform_sim_oids_init(const char* fname)
 {
@@ -72,33 +281,84 @@ onlp_platform_sim_oids_init(const char* fname)
         AIM_DIE("could not open json file.");
     }
 
-    if(ONLP_FAILURE(rebuild__())) {
+    pthread_rwlock_init(&ctrl__.lock, NULL);
+#if ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH == 1
+    pthread_atfork(NULL, NULL, watch_atfork_child__);
+#else
+    ctrl__.poll = 1;
+#endif
+
+    if(ONLP_FAILURE(rebuild__(1))) {
         AIM_DIE("rebuild failed.");
     }
     return 0;
 }
 
-biglist_t*
-reload__(void)
+/**
+ * Lookup an OID. The caller must hold the read lock.
+ */
+static onlp_oid_hdr_t*
+lookup__(onlp_oid_t oid)
+{
+    int type = ONLP_OID_TYPE_GET(oid);
+    int id = ONLP_OID_ID_GET(oid);
+
+    if(type >= OID_TYPES__ || id >= ctrl__.table.count[type]) {
+        return NULL;
+    }
+    return ctrl__.table.index[type][id];
+}
+
+/**
+ * Take the read lock for a lookup.
+ */
+static void
+lookup_lock__(void)
 {
-    if(cjson_util_file_reload(&ctrl__.cjf, 0) == 1) {
-        rebuild__();
+    WATCH_CHECK__();
+    if(__atomic_load_n(&ctrl__.poll, __ATOMIC_ACQUIRE)) {
+        pthread_rwlock_wrlock(&ctrl__.lock);
+        rebuild__(0);
+        pthread_rwlock_unlock(&ctrl__.lock);
     }
-    return ctrl__.oid_list;
+    pthread_rwlock_rdlock(&ctrl__.lock);
 }
 
 onlp_oid_hdr_t*
 onlp_platform_sim_oid_lookup(onlp_oid_t oid)
 {
-    biglist_t* ble;
     onlp_oid_hdr_t* hdr;
-    biglist_t* list = reload__();
-    BIGLIST_FOREACH_DATA(ble, list, onlp_oid_hdr_t*, hdr) {
-        if(hdr->id == oid) {
-            return hdr;
-        }
+    lookup_lock__();
+    hdr = lookup__(oid);
+    pthread_rwlock_unlock(&ctrl__.lock);
+    return hdr;
+}
+
+/**
+ * Copy an OID structure while holding the read lock.
+ */
+static int
+oid_copy__(onlp_oid_t oid, onlp_oid_hdr_t* hdr,
+           void* info, int size, void** pinfo)
+{
+    onlp_oid_hdr_t* p;
+
+    lookup_lock__();
+    if((p = lookup__(oid)) == NULL) {
+        pthread_rwlock_unlock(&ctrl__.lock);
+        return ONLP_STATUS_E_MISSING;
     }
-    return NULL;
+    if(info) {
+        memcpy(info, p, size);
+    }
+    if(hdr) {
+        memcpy(hdr, p, sizeof(*hdr));
+    }
+    if(pinfo) {
+        *pinfo = p;
+    }
+    pthread_rwlock_unlock(&ctrl__.lock);
+    return ONLP_STATUS_OK;
 }
 
 #define ONLP_OID_TYPE_ENTRY(_name, _id, _upper, _lower)  \
@@ -113,23 +373,12 @@ onlp_platform_sim_oid_lookup(onlp_oid_t oid)
                           __FUNCTION__, oid, #_lower);                  \
             return ONLP_STATUS_E_PARAM;                                 \
         }                                                               \
-        onlp_##_lower##_info_t* p = (onlp_##_lower##_info_t*)           \
-            onlp_platform_sim_oid_lookup(oid);                          \
-                                                                        \
-        if(!p) {                                                        \
+        if(oid_copy__(oid, hdr, info, sizeof(*info),                    \
+                      (void**)pinfo) < 0) {                             \
             AIM_LOG_ERROR("%s: %{onlp_oid} does not exist.",            \
                           __FUNCTION__, oid);                           \
             return ONLP_STATUS_E_MISSING;                               \
         }                                                               \
-        if(info) {                                                      \
-            memcpy(info, p, sizeof(*info));                             \
-        }                                                               \
-        if(hdr) {                                                       \
-            memcpy(hdr, &p->hdr, sizeof(*hdr));                         \
-        }                                                               \
-        if(pinfo) {                                                     \
-            *pinfo = p;                                                 \
-        }                                                               \
         return 0;                                                       \
     }
 #include <onlp/onlp.x>
@@ -44,6 +44,16 @@ onlp_platform_sim_config_settings_t onlp_platform_sim_config_settings[] =
     { __onlp_platform_sim_config_STRINGIFY_NAME(ONLP_PLATFORM_SIM_CONFIG_INCLUDE_UCLI), __onlp_platform_sim_config_STRINGIFY_VALUE(ONLP_PLATFORM_SIM_CONFIG_INCLUDE_UCLI) },
 #else
 { ONLP_PLATFORM_SIM_CONFIG_INCLUDE_UCLI(__onlp_platform_sim_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH
+    { __onlp_platform_sim_config_STRINGIFY_NAME(ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH), __onlp_platform_sim_config_STRINGIFY_VALUE(ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH) },
+#else
+{ ONLP_PLATFORM_SIM_CONFIG_INCLUDE_OID_WATCH(__onlp_platform_sim_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_PLATFORM_SIM_CONFIG_SFP_PORTS_DEFAULT
+    { __onlp_platform_sim_config_STRINGIFY_NAME(ONLP_PLATFORM_SIM_CONFIG_SFP_PORTS_DEFAULT), __onlp_platform_sim_config_STRINGIFY_VALUE(ONLP_PLATFORM_SIM_CONFIG_SFP_PORTS_DEFAULT) },
+#else
+{ ONLP_PLATFORM_SIM_CONFIG_SFP_PORTS_DEFAULT(__onlp_platform_sim_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
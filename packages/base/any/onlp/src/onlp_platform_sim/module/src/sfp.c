@@ -1,9 +1,83 @@
+/**************************************************************************//**
+ *
+ * Simulated SFP ports.
+ *
+ * Each port's EEPROM devices are served from files:
+ *
+ *   <dir>/<port>/<devaddr>
+ *
+ * where <port> starts at 1 and <devaddr> is the 7-bit device
+ * address in hex (50, 51). A port is present if its 50 file
+ * exists. An optional <dir>/<port>/type file names the
+ * connector type (SFP, QSFP, SFP28, QSFP28). Writes update
+ * the files.
+ *
+ * The following environment variables configure the simulation:
+ *
+ *   ONLP_PLATFORM_SIM_SFP_DIR           The port directory.
+ *   ONLP_PLATFORM_SIM_SFP_PORTS         The number of ports.
+ *   ONLP_PLATFORM_SIM_SFP_LATENCY       Usecs added to every device access.
+ *   ONLP_PLATFORM_SIM_SFP_BYTE_LATENCY  Usecs added per byte transferred.
+ *   ONLP_PLATFORM_SIM_SFP_DOMAINS       The number of access domains.
+ *
+ *****************************************************************************/
 #include <onlp/platformi/sfpi.h>
+#include <onlp_platform_sim/onlp_platform_sim_config.h>
+#include <onlplib/file.h>
 #include <sff/sff.h>
+#include <AIM/aim.h>
+#include <AIM/aim_sleep.h>
+#include "onlp_platform_sim_log.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#define SFP_DIR_DEFAULT__ "/var/run/onlp-platform-sim/sfp"
+
+/** The size of onlp_sfp_bitmap_t */
+#define SFP_PORTS_MAX__ 256
+
+static struct {
+    char* dir;
+    int ports;
+    int latency;
+    int byte_latency;
+    int domains;
+} sim__;
+
+static int
+env_int__(const char* name, int def)
+{
+    char* v = getenv(name);
+    return v ? atoi(v) : def;
+}
 
 int
 onlp_sfpi_sw_init(void)
 {
+    char* dir = getenv("ONLP_PLATFORM_SIM_SFP_DIR");
+    struct stat st;
+
+    aim_free(sim__.dir);
+    sim__.dir = aim_strdup(dir ? dir : SFP_DIR_DEFAULT__);
+
+    sim__.ports = env_int__("ONLP_PLATFORM_SIM_SFP_PORTS",
+                            (stat(sim__.dir, &st) == 0 && S_ISDIR(st.st_mode)) ?
+                            ONLP_PLATFORM_SIM_CONFIG_SFP_PORTS_DEFAULT : 0);
+    if(sim__.ports < 0 || sim__.ports > SFP_PORTS_MAX__) {
+        sim__.ports = 0;
+    }
+    sim__.latency = env_int__("ONLP_PLATFORM_SIM_SFP_LATENCY", 0);
+    sim__.byte_latency = env_int__("ONLP_PLATFORM_SIM_SFP_BYTE_LATENCY", 0);
+    sim__.domains = env_int__("ONLP_PLATFORM_SIM_SFP_DOMAINS", 0);
+
+    AIM_LOG_VERBOSE("sfp simulation: dir=%s ports=%d latency=%d+%d/byte domains=%d",
+                    sim__.dir, sim__.ports, sim__.latency, sim__.byte_latency,
+                    sim__.domains);
     return 0;
 }
 
@@ -14,28 +88,64 @@ onlp_sfpi_hw_init(uint32_t flags)
 }
 
 int
-onlp_sfpi_info_get(onlp_oid_t port, onlp_sfp_info_t* info)
+onlp_sfpi_sw_denit(void)
 {
-    return ONLP_STATUS_E_MISSING;
+    aim_free(sim__.dir);
+    memset(&sim__, 0, sizeof(sim__));
+    return 0;
 }
 
 int
 onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
 {
+    int p;
     AIM_BITMAP_CLR_ALL(bmap);
+    for(p = 0; p < sim__.ports; p++) {
+        AIM_BITMAP_SET(bmap, p);
+    }
     return 0;
 }
 
+/**
+ * Simulate the bus time of a device access.
+ */
+static void
+delay__(int len)
+{
+    int usecs = sim__.latency + (len * sim__.byte_latency);
+    if(usecs > 0) {
+        aim_sleep_usecs(usecs);
+    }
+}
+
+static int
+present__(onlp_oid_id_t id)
+{
+    char fname[PATH_MAX];
+    snprintf(fname, sizeof(fname), "%s/%d/50", sim__.dir, id+1);
+    return access(fname, F_OK) == 0;
+}
+
 int
-onlp_sfpi_is_present(int port)
+onlp_sfpi_is_present(onlp_oid_id_t id)
 {
-    return ONLP_STATUS_E_MISSING;
+    delay__(1);
+    return present__(id);
 }
 
 int
 onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
 {
-    return ONLP_STATUS_E_UNSUPPORTED;
+    int p;
+    /** A platform would read the presence registers in one access. */
+    delay__(sim__.ports / 8);
+    AIM_BITMAP_CLR_ALL(dst);
+    for(p = 0; p < sim__.ports; p++) {
+        if(present__(p)) {
+            AIM_BITMAP_SET(dst, p);
+        }
+    }
+    return 0;
 }
 
 int
@@ -43,3 +153,120 @@ onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst)
 {
     return ONLP_STATUS_E_UNSUPPORTED;
 }
+
+int
+onlp_sfpi_type_get(onlp_oid_id_t id, onlp_sfp_type_t* rtype)
+{
+    char* s = NULL;
+    *rtype = ONLP_SFP_TYPE_SFP;
+    if(onlp_file_read_str(&s, "%s/%d/type", sim__.dir, id+1) > 0) {
+        char* nl = strchr(s, '\n');
+        if(nl) {
+            *nl = 0;
+        }
+        if(onlp_sfp_type_value(s, rtype, 1) < 0) {
+            AIM_LOG_ERROR("port %d: unknown sfp type '%s'", id+1, s);
+            *rtype = ONLP_SFP_TYPE_SFP;
+        }
+    }
+    aim_free(s);
+    return 0;
+}
+
+int
+onlp_sfpi_port_domain_get(onlp_oid_id_t id, int* domain)
+{
+    if(sim__.domains <= 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    /* Contiguous port ranges, like ports behind separate i2c muxes. */
+    *domain = id / ((sim__.ports + sim__.domains - 1) / sim__.domains);
+    return 0;
+}
+
+/**
+ * Open the EEPROM file for the given device.
+ */
+static int
+dev_open__(onlp_oid_id_t id, int devaddr, int flags)
+{
+    int fd = onlp_file_open(flags, 0, "%s/%d/%x", sim__.dir, id+1, devaddr);
+    if(fd < 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    return fd;
+}
+
+int
+onlp_sfpi_dev_read(onlp_oid_id_t id, int devaddr, int addr,
+                   uint8_t* dst, int len)
+{
+    int fd;
+    ssize_t rv;
+
+    delay__(len);
+    if((fd = dev_open__(id, devaddr, O_RDONLY)) < 0) {
+        return fd;
+    }
+    rv = pread(fd, dst, len, addr);
+    close(fd);
+    if(rv < 0) {
+        AIM_LOG_ERROR("port %d: read 0x%x@%d: %{errno}", id+1, devaddr, addr, errno);
+        return ONLP_STATUS_E_I2C;
+    }
+    /* Bytes beyond the end of the image read as unprogrammed. */
+    if(rv < len) {
+        memset(dst + rv, 0xFF, len - rv);
+    }
+    return len;
+}
+
+int
+onlp_sfpi_dev_write(onlp_oid_id_t id, int devaddr, int addr,
+                    uint8_t* src, int len)
+{
+    int fd;
+    ssize_t rv;
+
+    delay__(len);
+    if((fd = dev_open__(id, devaddr, O_WRONLY)) < 0) {
+        return fd;
+    }
+    rv = pwrite(fd, src, len, addr);
+    close(fd);
+    if(rv != len) {
+        AIM_LOG_ERROR("port %d: write 0x%x@%d: %{errno}", id+1, devaddr, addr, errno);
+        return ONLP_STATUS_E_I2C;
+    }
+    return 0;
+}
+
+int
+onlp_sfpi_dev_readb(onlp_oid_id_t id, int devaddr, int addr)
+{
+    uint8_t b;
+    int rv = onlp_sfpi_dev_read(id, devaddr, addr, &b, 1);
+    return (rv < 0) ? rv : b;
+}
+
+int
+onlp_sfpi_dev_writeb(onlp_oid_id_t id, int devaddr, int addr, uint8_t value)
+{
+    return onlp_sfpi_dev_write(id, devaddr, addr, &value, 1);
+}
+
+int
+onlp_sfpi_dev_readw(onlp_oid_id_t id, int devaddr, int addr)
+{
+    uint8_t w[2];
+    int rv = onlp_sfpi_dev_read(id, devaddr, addr, w, 2);
+    /* SMBus words are little endian */
+    return (rv < 0) ? rv : (w[0] | (w[1] << 8));
+}
+
+int
+onlp_sfpi_dev_writew(onlp_oid_id_t id, int devaddr, int addr, uint16_t value)
+{
+    uint8_t w[2] = { value & 0xFF, value >> 8 };
+    return onlp_sfpi_dev_write(id, devaddr, addr, w, 2);
+}
@@ -0,0 +1,139 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * BMC serial console command engine.
+ *
+ * Some platforms can only reach their fans, PSUs and other
+ * devices by running shell commands on the BMC over a serial
+ * console. This module keeps the console open and logged in,
+ * reads responses until they are complete instead of sleeping
+ * for a fixed time, sends a whole batch of commands in a single
+ * round trip and caches recent results.
+ *
+ * Each command in a batch is followed by a marker which carries
+ * the command index and exit status. The markers are produced
+ * by printf on the BMC so they never match the echoed command
+ * line, which lets the output of each command be split out
+ * reliably whether or not the console echoes input.
+ *
+ * The ONLP_BMC_TTY_DEVICE environment variable overrides the
+ * device, so the engine can be pointed at a pty driven by a BMC
+ * stand-in.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_BMC_TTY_H__
+#define __ONLPLIB_BMC_TTY_H__
+
+#include <onlplib/onlplib_config.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_BMC_TTY == 1
+
+#include <stdint.h>
+
+/**
+ * Console settings.
+ */
+typedef struct onlp_bmc_tty_config_s {
+    /** The console device. */
+    const char* device;
+    /** The termios speed (e.g. B57600). */
+    int speed;
+
+    /** The shell prompt (or a unique part of it). */
+    const char* prompt;
+    /** Login prompt, user name and password. */
+    const char* login_prompt;
+    const char* user;
+    const char* password;
+
+    /** Deadline for a command batch to complete. */
+    int timeout_ms;
+    /** Deadline for each step of the login sequence. */
+    int login_timeout_ms;
+    /** Number of attempts for each batch. */
+    int retries;
+
+    /** Cached results are reused for this long. 0 disables the cache. */
+    uint64_t cache_usecs;
+} onlp_bmc_tty_config_t;
+
+/** The result may be served from (and stored in) the cache. */
+#define ONLP_BMC_TTY_F_CACHED 0x1
+
+/**
+ * A single console command and its output.
+ */
+typedef struct onlp_bmc_tty_cmd_s {
+    /** The shell command. Trailing line terminators are ignored. */
+    const char* cmd;
+    /** ONLP_BMC_TTY_F_* */
+    uint32_t flags;
+
+    /** Output buffer. Carriage returns are removed. */
+    char* out;
+    int out_size;
+
+    /** [out] Output length (truncated to out_size - 1). */
+    int out_len;
+    /** [out] The exit status of the command. */
+    int exit;
+} onlp_bmc_tty_cmd_t;
+
+/**
+ * @brief Set the console configuration.
+ * @param config The configuration. It is copied.
+ * @note The console is opened on first use.
+ */
+int onlp_bmc_tty_init(const onlp_bmc_tty_config_t* config);
+
+/**
+ * @brief Close the console.
+ */
+int onlp_bmc_tty_deinit(void);
+
+/**
+ * @brief Execute a batch of commands in one round trip.
+ * @param cmds The commands.
+ * @param count The number of commands.
+ * @note Commands which are not marked ONLP_BMC_TTY_F_CACHED are
+ * assumed to change state on the BMC and invalidate the cache.
+ */
+int onlp_bmc_tty_exec_batch(onlp_bmc_tty_cmd_t* cmds, int count);
+
+/**
+ * @brief Execute a single command.
+ * @param cmd The command.
+ * @param out Receives the output (optional).
+ * @param size The size of the output buffer.
+ * @param flags ONLP_BMC_TTY_F_*
+ * @returns The output length, or a negative error.
+ * A non-zero exit status is reported as ONLP_STATUS_E_INTERNAL.
+ */
+int onlp_bmc_tty_exec(const char* cmd, char* out, int size, uint32_t flags);
+
+/**
+ * @brief Discard all cached results.
+ */
+void onlp_bmc_tty_cache_invalidate(void);
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_BMC_TTY */
+
+#endif /* __ONLPLIB_BMC_TTY_H__ */
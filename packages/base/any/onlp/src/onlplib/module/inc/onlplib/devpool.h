@@ -0,0 +1,320 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Declarative i2c device pool.
+ *
+ * Platforms describe their devices in tables: the chip driver,
+ * the bus and address, and the bus steps (mux selection, CPLD
+ * bus enables) which must run around each access. The pool then
+ * provides the thermal, fan, PSU, SFP and CPLD pin accessors.
+ *
+ * Each device has a register window which is read in a single
+ * transfer and cached, so all sensors, fans or pins served by one
+ * chip share one bus access per cache period. Failures are
+ * counted per device, and a device which keeps failing is left
+ * alone for a while instead of costing a bus timeout per query.
+ *
+ * Accesses are serialized per bus: the bus lock of the device is
+ * held across its open steps, the transfer and its close steps.
+ * Step lists are expected to act on the device's own bus. Platforms
+ * which run their own step lists on a bus the pool also uses must
+ * hold onlp_devpool_bus_lock() around them.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_DEVPOOL_H__
+#define __ONLPLIB_DEVPOOL_H__
+
+#include <onlplib/i2c.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_DEVPOOL == 1
+
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <onlp/sfp.h>
+#include <AIM/aim_pvs.h>
+
+#define ONLP_DEVPOOL_WINDOW_MAX 256
+
+/**
+ * Bus step types.
+ */
+typedef enum onlp_devpool_step_type_e {
+    /** Terminates a step list. */
+    ONLP_DEVPOOL_STEP_END = 0,
+    /** Write value to the register. */
+    ONLP_DEVPOOL_STEP_WRITE = 1,
+    /** Replace the mask bits of the register with those of match. */
+    ONLP_DEVPOOL_STEP_MODIFY = 2,
+} onlp_devpool_step_type_t;
+
+/**
+ * A single bus step.
+ */
+typedef struct onlp_devpool_step_s {
+    /** onlp_devpool_step_type_t */
+    int type;
+    int bus;
+    uint8_t addr;
+    uint8_t offset;
+    /** ONLP_DEVPOOL_STEP_WRITE */
+    uint8_t value;
+    /** ONLP_DEVPOOL_STEP_MODIFY */
+    uint8_t mask;
+    uint8_t match;
+} onlp_devpool_step_t;
+
+struct onlp_devpool_dev_s;
+
+/**
+ * SFP control field.
+ */
+typedef struct onlp_devpool_field_s {
+    onlp_sfp_control_t control;
+    /** Added to the device address (e.g. 1 for the SFF-8472 A2 page). */
+    uint8_t addr_offset;
+    uint8_t offset;
+    uint8_t mask;
+    /** The field is writable. */
+    int rw;
+} onlp_devpool_field_t;
+
+/**
+ * A chip driver.
+ */
+typedef struct onlp_devpool_driver_s {
+    const char* name;
+
+    /** The default register window. */
+    uint8_t window_offset;
+    int window_size;
+    /** ONLP_I2C_F_* flags used for this chip. */
+    uint32_t flags;
+
+    /**
+     * Registers which are read individually instead of the window,
+     * for chips which do not auto-increment. Optional.
+     */
+    const uint8_t* registers;
+    int register_count;
+
+    /**
+     * Fill the register window. Optional.
+     * The default reads the window (or the register list) after
+     * running the device's open steps.
+     */
+    int (*refresh)(struct onlp_devpool_dev_s* dev, uint8_t* regs);
+
+    /** Decode a temperature channel from the window. */
+    int (*temp)(const uint8_t* regs, int channel, int* mcelsius);
+    /** Decode a fan channel from the window. */
+    int (*rpm)(const uint8_t* regs, int channel, int* rpm);
+    /** Set a fan channel target. */
+    int (*rpm_set)(struct onlp_devpool_dev_s* dev, int channel, int rpm);
+    /** Decode PSU information from the window. */
+    int (*psu)(const uint8_t* regs, onlp_psu_info_t* info);
+
+    /** SFP control fields, terminated by an entry with mask 0. */
+    const onlp_devpool_field_t* fields;
+} onlp_devpool_driver_t;
+
+/**
+ * Per-device runtime state. Zero initialized.
+ */
+typedef struct onlp_devpool_state_s {
+    uint8_t regs[ONLP_DEVPOOL_WINDOW_MAX];
+    int valid;
+    uint64_t updated;
+
+    /** Error accounting. */
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t errors;
+    uint32_t failures;
+    int last_error;
+    uint64_t holdoff_until;
+} onlp_devpool_state_t;
+
+/**
+ * A device instance.
+ */
+typedef struct onlp_devpool_dev_s {
+    const char* name;
+    const onlp_devpool_driver_t* driver;
+
+    /** Bus and address after the open steps have run. */
+    int bus;
+    uint8_t addr;
+
+    /** Steps run before and after each access. Optional. */
+    const onlp_devpool_step_t* open;
+    const onlp_devpool_step_t* close;
+
+    /** Overrides the driver's register window if window_size is set. */
+    uint8_t window_offset;
+    int window_size;
+
+    /** Additional ONLP_I2C_F_* flags. */
+    uint32_t flags;
+
+    /** Cached window lifetime. 0 means ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS. */
+    uint64_t cache_usecs;
+
+    onlp_devpool_state_t state;
+} onlp_devpool_dev_t;
+
+
+/**
+ * @brief Take the lock for a bus.
+ * @note The lock is recursive.
+ */
+void onlp_devpool_bus_lock(int bus);
+
+/**
+ * @brief Release the lock for a bus.
+ */
+void onlp_devpool_bus_unlock(int bus);
+
+/**
+ * @brief Run a step list.
+ * @param steps The steps. NULL is an empty list.
+ * @note Steps are always performed with ONLP_I2C_F_FORCE.
+ */
+int onlp_devpool_steps_run(const onlp_devpool_step_t* steps);
+
+/**
+ * @brief Read bytes from the device.
+ * @note Served from the cached register window if it covers the
+ * range. The window is refreshed if the cached copy is too old.
+ */
+int onlp_devpool_read(onlp_devpool_dev_t* dev, uint8_t offset,
+                      uint8_t* data, int size);
+
+/**
+ * @brief Read a byte from the device.
+ */
+int onlp_devpool_readb(onlp_devpool_dev_t* dev, uint8_t offset);
+
+/**
+ * @brief Write a byte to the device.
+ * @note The cached window is updated.
+ */
+int onlp_devpool_writeb(onlp_devpool_dev_t* dev, uint8_t offset, uint8_t value);
+
+/**
+ * @brief Read-modify-write a byte of the device.
+ * @note The current value is always read from the device.
+ */
+int onlp_devpool_modifyb(onlp_devpool_dev_t* dev, uint8_t offset,
+                         uint8_t andmask, uint8_t ormask);
+
+/**
+ * @brief Get a pin state.
+ * @returns 1 if (register & mask) == match, 0 if not.
+ */
+int onlp_devpool_pin_get(onlp_devpool_dev_t* dev, uint8_t offset,
+                         uint8_t mask, uint8_t match);
+
+/**
+ * @brief Discard the device's cached window.
+ * @note Use this on presence changes. Cached strings such as the
+ * PSU model and serial are discarded as well.
+ */
+void onlp_devpool_invalidate(onlp_devpool_dev_t* dev);
+
+/**
+ * @brief Fill in the temperature of a channel.
+ * @note The OID header is left to the caller.
+ */
+int onlp_devpool_thermal_info_get(onlp_devpool_dev_t* dev, int channel,
+                                  onlp_thermal_info_t* info);
+
+/**
+ * @brief Fill in the speed and capabilities of a fan channel.
+ */
+int onlp_devpool_fan_info_get(onlp_devpool_dev_t* dev, int channel,
+                              onlp_fan_info_t* info);
+
+/**
+ * @brief Set the target speed of a fan channel.
+ */
+int onlp_devpool_fan_rpm_set(onlp_devpool_dev_t* dev, int channel, int rpm);
+
+/**
+ * @brief Fill in PSU model, serial, readings and capabilities.
+ */
+int onlp_devpool_psu_info_get(onlp_devpool_dev_t* dev, onlp_psu_info_t* info);
+
+/**
+ * @brief Read the SFP module EEPROM.
+ */
+int onlp_devpool_sfp_eeprom_read(onlp_devpool_dev_t* dev, uint8_t data[256]);
+
+/**
+ * @brief Determine whether the device's chip supports an SFP control.
+ */
+int onlp_devpool_sfp_control_supported(onlp_devpool_dev_t* dev,
+                                       onlp_sfp_control_t control, int* rv);
+
+/**
+ * @brief Get an SFP control from the module.
+ */
+int onlp_devpool_sfp_control_get(onlp_devpool_dev_t* dev,
+                                 onlp_sfp_control_t control, int* value);
+
+/**
+ * @brief Set an SFP control on the module.
+ */
+int onlp_devpool_sfp_control_set(onlp_devpool_dev_t* dev,
+                                 onlp_sfp_control_t control, int value);
+
+/**
+ * @brief Show the error accounting for a device table.
+ */
+void onlp_devpool_show(aim_pvs_t* pvs, onlp_devpool_dev_t* devs, int count);
+
+
+/**************************************************************************//**
+ *
+ * Chip drivers.
+ *
+ *****************************************************************************/
+
+/** Register windows only. Devices must set their window. */
+extern const onlp_devpool_driver_t onlp_devpool_driver_cpld;
+/** 256 byte EEPROM. */
+extern const onlp_devpool_driver_t onlp_devpool_driver_eeprom;
+/** TMP75 and compatibles. One channel. */
+extern const onlp_devpool_driver_t onlp_devpool_driver_tmp75;
+/** TMP461. Channel 0 is local, channel 1 is remote. */
+extern const onlp_devpool_driver_t onlp_devpool_driver_tmp461;
+/** EMC2305. Channels 0-4. */
+extern const onlp_devpool_driver_t onlp_devpool_driver_emc2305;
+/** PMBus PSU. Fan channel 0 is READ_FAN_SPEED_1. */
+extern const onlp_devpool_driver_t onlp_devpool_driver_pmbus;
+/** SFF-8472 SFP module. */
+extern const onlp_devpool_driver_t onlp_devpool_driver_sff8472;
+/** SFF-8636 QSFP module. */
+extern const onlp_devpool_driver_t onlp_devpool_driver_sff8636;
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_DEVPOOL */
+
+#endif /* __ONLPLIB_DEVPOOL_H__ */
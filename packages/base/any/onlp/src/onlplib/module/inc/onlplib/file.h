@@ -227,7 +227,64 @@ int onlp_file_vopen(int flags, int log, const char* fmt, va_list vargs);
 
 /**
  * @brief Search a directory tree for the given file.
+ * @note Results, including not found, are cached
+ * (see ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE).
  */
 int onlp_file_find(char* root, char* fname, char** rpath);
 
+/**
+ * @brief Discard the cached search result for the given file.
+ */
+void onlp_file_find_invalidate(char* root, char* fname);
+
+/**
+ * @brief Discard all cached search results.
+ */
+void onlp_file_find_cache_flush(void);
+
+/**
+ * @brief Close all cached sysfs attribute descriptors.
+ * @note Reads of sysfs attributes keep their descriptors open
+ * (see ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE). Descriptors which
+ * fail with ENODEV or ESTALE are reopened automatically.
+ */
+void onlp_file_fd_cache_flush(void);
+
+/**
+ * Attribute handle.
+ * Holds an attribute open for repeated reads.
+ */
+typedef struct onlp_file_handle_s onlp_file_handle_t;
+
+/**
+ * @brief Open an attribute handle.
+ * @param[out] handle Receives the handle.
+ * @param fmt The filename format string.
+ * @param ... The filename format string arguments.
+ */
+int onlp_file_handle_open(onlp_file_handle_t** handle, const char* fmt, ...);
+
+/**
+ * @brief Read the current contents of an attribute.
+ * @param handle The handle.
+ * @param data Receives the data.
+ * @param max Maximum read size.
+ * @param len Receives the actual read length.
+ */
+int onlp_file_handle_read(onlp_file_handle_t* handle, uint8_t* data, int max,
+                          int* len);
+
+/**
+ * @brief Read the current contents of an attribute as an integer.
+ * @param handle The handle.
+ * @param value Receives the integer value.
+ */
+int onlp_file_handle_read_int(onlp_file_handle_t* handle, int* value);
+
+/**
+ * @brief Close an attribute handle.
+ * @param handle The handle.
+ */
+int onlp_file_handle_close(onlp_file_handle_t* handle);
+
 #endif /* __ONLPLIB_FILE_H__ */
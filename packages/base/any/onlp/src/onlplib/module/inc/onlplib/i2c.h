@@ -76,15 +76,47 @@
  */
 #define ONLP_I2C_F_DISABLE_READ_RETRIES 0x80
 
+/**
+ * Do not use the file descriptor cache for this transaction.
+ * The device is opened and closed around the operation.
+ */
+#define ONLP_I2C_F_NO_FD_CACHE 0x100
+
+/**
+ * Read using a single combined I2C_RDWR transaction (offset write
+ * followed by a repeated-start read of the full length) if the
+ * adapter supports plain I2C transfers. Falls back to the
+ * SMBUS read methods if it does not.
+ */
+#define ONLP_I2C_F_USE_RDWR 0x200
+
 /**
  * @brief Open and prepare for reading or writing.
  * @param bus The i2c bus number.
  * @param addr The slave address.
  * @param flags See ONLP_I2C_F_*
  * @note Normal applications will not use this function directly.
+ * The returned descriptor is owned by the caller and is never cached.
  */
 int onlp_i2c_open(int bus, uint8_t addr, uint32_t flags);
 
+/**
+ * @brief Close cached i2c file descriptors.
+ * @param bus The i2c bus number, or -1 for all busses.
+ * @note Descriptors which are in use are closed when released.
+ */
+void onlp_i2c_fd_cache_flush(int bus);
+
+/**
+ * @brief Get the physical root adapter of an i2c bus.
+ * @param bus The i2c bus number.
+ * @returns The root bus number, or an error.
+ * @note Busses created by mux channels resolve to the adapter the
+ * mux hangs off. Transactions on busses with different roots can
+ * proceed concurrently.
+ */
+int onlp_i2c_root_bus_get(int bus);
+
 
 /**
  * @brief Read i2c data.
@@ -94,7 +126,8 @@ int onlp_i2c_open(int bus, uint8_t addr, uint32_t flags);
  * @param size The byte count.
  * @param rdata [out] Receives the data.
  * @param flags See ONLP_I2C_F_*
- * @note This function reads a byte at a time.
+ * @note This function reads a byte at a time unless
+ * ONLP_I2C_F_USE_RDWR is specified.
  * See onlp_i2c_read_block() for block reads.
  */
 
@@ -109,6 +142,7 @@ int onlp_i2c_read(int bus, uint8_t addr, uint8_t offset, int size,
  * @param size The byte count.
  * @param flags Seel ONLP_I2C_F_*
  * @note This function reads in increments of ONLPLIB_CONFIG_I2C_BLOCK_SIZE
+ * unless ONLP_I2C_F_USE_RDWR is specified.
  */
 int onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
                         uint8_t* rdata, uint32_t flags);
@@ -0,0 +1,211 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * In-process IPMI client.
+ *
+ * Platforms with a BMC often need a handful of IPMI commands
+ * for every sensor or register access. Spawning ipmitool for
+ * each of them is very expensive. This module talks to the local
+ * BMC directly through the OpenIPMI device interface (/dev/ipmi0)
+ * and can issue batches of requests concurrently.
+ *
+ * The transport is pluggable. The built-in transports are:
+ *   - The OpenIPMI character device (the default).
+ *   - A unix domain socket. This is used when the ONLP_IPMI_SOCKET
+ *     environment variable is set and allows a BMC simulator
+ *     (for example an onlp_file_uds service) to stand in for the BMC.
+ *
+ * Domain socket protocol. Each connection carries one batch:
+ *   Request:  netfn, cmd, len, data[len]  (repeated)
+ *   Response: ccode, len, data[len]       (one per request, in order)
+ * The client half-closes the socket after the last request.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_IPMI_H__
+#define __ONLPLIB_IPMI_H__
+
+#include <onlplib/onlplib_config.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+
+#include <stdint.h>
+
+/** Common network functions */
+#define ONLP_IPMI_NETFN_CHASSIS   0x00
+#define ONLP_IPMI_NETFN_SENSOR    0x04
+#define ONLP_IPMI_NETFN_APP       0x06
+#define ONLP_IPMI_NETFN_STORAGE   0x0A
+
+/** Completion code for success. */
+#define ONLP_IPMI_CC_OK 0x00
+
+/** The maximum request or response data size. */
+#define ONLP_IPMI_DATA_MAX 255
+
+/**
+ * A single IPMI request and its response.
+ */
+typedef struct onlp_ipmi_msg_s {
+    /** Network function */
+    uint8_t netfn;
+    /** Command */
+    uint8_t cmd;
+    /** Request data */
+    const uint8_t* data;
+    int data_len;
+
+    /** Response data buffer. The completion code is not included. */
+    uint8_t* rsp;
+    int rsp_size;
+
+    /** [out] The response data length. */
+    int rsp_len;
+    /** [out] The completion code. */
+    uint8_t ccode;
+    /** [out] ONLP_STATUS_OK, or the error for this request. */
+    int status;
+} onlp_ipmi_msg_t;
+
+/**
+ * IPMI transport.
+ */
+typedef struct onlp_ipmi_transport_s {
+    /** Transport name, used for logging. */
+    const char* name;
+
+    /**
+     * @brief Execute a batch of requests.
+     * @param cookie The transport cookie.
+     * @param msgs The requests.
+     * @param count The number of requests.
+     * @param timeout_ms The response timeout.
+     * @note The transport must set the status of every request.
+     * Requests may be executed concurrently and in any order.
+     * @returns ONLP_STATUS_OK if the batch was processed.
+     */
+    int (*execute)(void* cookie, onlp_ipmi_msg_t* msgs, int count,
+                   int timeout_ms);
+
+    /**
+     * @brief Release any resources held by the transport.
+     * @param cookie The transport cookie.
+     */
+    void (*close)(void* cookie);
+
+} onlp_ipmi_transport_t;
+
+/** OpenIPMI device transport. The cookie is the device path or NULL. */
+extern const onlp_ipmi_transport_t onlp_ipmi_transport_dev;
+
+/** Unix domain socket transport. The cookie is the socket path. */
+extern const onlp_ipmi_transport_t onlp_ipmi_transport_uds;
+
+/**
+ * @brief Select the IPMI transport.
+ * @param transport The transport. NULL restores the default.
+ * @param cookie The transport cookie.
+ */
+int onlp_ipmi_transport_set(const onlp_ipmi_transport_t* transport,
+                            void* cookie);
+
+/**
+ * @brief Execute a batch of IPMI requests.
+ * @param msgs The requests.
+ * @param count The number of requests.
+ * @returns The number of requests which completed with
+ * ONLP_IPMI_CC_OK, or a negative error if the batch could not be issued.
+ * @note The status and completion code of each request are reported
+ * in the message itself.
+ */
+int onlp_ipmi_execute(onlp_ipmi_msg_t* msgs, int count);
+
+/**
+ * @brief Execute a single IPMI request.
+ * @param netfn The network function.
+ * @param cmd The command.
+ * @param data The request data.
+ * @param len The request data length.
+ * @param rsp Receives the response data.
+ * @param rsp_size The size of the response buffer.
+ * @returns The response length, or a negative error.
+ * @note A non-zero completion code is reported as an error.
+ */
+int onlp_ipmi_cmd(uint8_t netfn, uint8_t cmd,
+                  const uint8_t* data, int len,
+                  uint8_t* rsp, int rsp_size);
+
+/**
+ * @brief Raw I2C transaction through the BMC (Master Write-Read).
+ * @param bus The BMC bus id byte (channel, bus id and bus type).
+ * @param addr The 7-bit slave address.
+ * @param wdata The data to write.
+ * @param wlen The write length.
+ * @param rdata Receives the data read.
+ * @param rlen The read length.
+ */
+int onlp_ipmi_master_write_read(uint8_t bus, uint8_t addr,
+                                const uint8_t* wdata, int wlen,
+                                uint8_t* rdata, int rlen);
+
+/**
+ * @brief Read a device register through a BMC OEM raw I2C command.
+ * @param netfn The OEM network function.
+ * @param cmd The OEM read command.
+ * @param bus The bus number.
+ * @param addr The slave address.
+ * @param offset The register offset.
+ * @param dst Receives the data.
+ * @param len The number of bytes to read.
+ * @note Many BMCs implement raw I2C access as an OEM command which
+ * takes (bus, addr, offset, len) and returns the data bytes.
+ */
+int onlp_ipmi_oem_i2c_read(uint8_t netfn, uint8_t cmd,
+                           int bus, uint8_t addr, uint8_t offset,
+                           uint8_t* dst, int len);
+
+/**
+ * @brief Write a device register through a BMC OEM raw I2C command.
+ * @param netfn The OEM network function.
+ * @param cmd The OEM write command.
+ * @param bus The bus number.
+ * @param addr The slave address.
+ * @param offset The register offset.
+ * @param src The data to write.
+ * @param len The number of bytes to write.
+ * @note The request is (bus, addr, offset, len, data[len]).
+ */
+int onlp_ipmi_oem_i2c_write(uint8_t netfn, uint8_t cmd,
+                            int bus, uint8_t addr, uint8_t offset,
+                            const uint8_t* src, int len);
+
+/**
+ * @brief Get a sensor reading.
+ * @param sensor The sensor number.
+ * @param[out] raw Receives the raw reading.
+ * @param[out] status Receives the reading status byte (optional).
+ * @returns ONLP_STATUS_E_MISSING if the reading is unavailable.
+ */
+int onlp_ipmi_sensor_reading_get(uint8_t sensor, uint8_t* raw,
+                                 uint8_t* status);
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_IPMI */
+
+#endif /* __ONLPLIB_IPMI_H__ */
@@ -0,0 +1,77 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * IPMI SDR repository cache.
+ *
+ * The sensor data records are read from the BMC once and kept
+ * until the repository's most recent addition or erase timestamp
+ * changes. Sensor readings for all cached sensors are collected
+ * in a single batch and reused until they are older than the
+ * configured reading age, so every thermal, fan and PSU query in
+ * one poll interval is served from the same pass.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_IPMI_SDR_H__
+#define __ONLPLIB_IPMI_SDR_H__
+
+#include <onlplib/ipmi.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+
+#include <AIM/aim_pvs.h>
+
+/**
+ * @brief Set the cache ages.
+ * @param reading_usecs The maximum age of the cached sensor readings.
+ * @param check_usecs The interval between repository change checks.
+ * @note Platforms call this from their init routines.
+ * The defaults are ONLPLIB_CONFIG_IPMI_SDR_READING_USECS and
+ * ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS.
+ */
+void onlp_ipmi_sdr_age_set(uint64_t reading_usecs, uint64_t check_usecs);
+
+/**
+ * @brief Discard the cached records and readings.
+ * @note The next access reloads the repository.
+ */
+void onlp_ipmi_sdr_invalidate(void);
+
+/**
+ * @brief Get the converted reading of a sensor.
+ * @param name The sensor ID string. If no sensor has exactly this
+ * name, the first sensor whose name contains it is used.
+ * @param[out] value Receives the reading in thousandths of the
+ * sensor unit (millidegrees, millivolts, milliamps, milliwatts).
+ * Fan readings are reported in thousandths of an RPM.
+ * @returns ONLP_STATUS_E_MISSING if the sensor does not exist
+ * or has no valid reading.
+ */
+int onlp_ipmi_sdr_reading_get(const char* name, int* value);
+
+/**
+ * @brief Show all cached sensors and their readings.
+ * @param pvs The output pvs.
+ */
+int onlp_ipmi_sdr_show(aim_pvs_t* pvs);
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_IPMI */
+
+#endif /* __ONLPLIB_IPMI_SDR_H__ */
@@ -145,6 +145,246 @@
 #define ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT 16
 #endif
 
+/**
+ * ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE
+ *
+ * Keep i2c device file descriptors open across transactions. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE
+#define ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+ *
+ * The maximum number of i2c file descriptors held open by the descriptor cache. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+#define ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE 32
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE
+ *
+ * Keep sysfs attribute file descriptors open across reads. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE
+#define ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_FD_CACHE_SIZE
+ *
+ * The maximum number of file descriptors held open by the sysfs attribute cache. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_FD_CACHE_SIZE
+#define ONLPLIB_CONFIG_FILE_FD_CACHE_SIZE 64
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE
+ *
+ * Cache the results of asterisk path searches. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE
+#define ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_FIND_CACHE_SIZE
+ *
+ * The maximum number of cached path search results. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_FIND_CACHE_SIZE
+#define ONLPLIB_CONFIG_FILE_FIND_CACHE_SIZE 64
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_FIND_NEGATIVE_USECS
+ *
+ * How long a failed path search is remembered. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_FIND_NEGATIVE_USECS
+#define ONLPLIB_CONFIG_FILE_FIND_NEGATIVE_USECS 5000000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT
+ *
+ * Discard cached path searches when the kernel reports device changes. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT
+#define ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_INCLUDE_IPMI
+ *
+ * Include the in-process IPMI client. */
+
+
+#ifndef ONLPLIB_CONFIG_INCLUDE_IPMI
+#define ONLPLIB_CONFIG_INCLUDE_IPMI 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_DEVICE
+ *
+ * The default OpenIPMI device. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_DEVICE
+#define ONLPLIB_CONFIG_IPMI_DEVICE "/dev/ipmi0"
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+ *
+ * IPMI response timeout in milliseconds. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+#define ONLPLIB_CONFIG_IPMI_TIMEOUT_MS 5000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_BATCH_MAX
+ *
+ * Maximum number of IPMI requests outstanding at once. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_BATCH_MAX
+#define ONLPLIB_CONFIG_IPMI_BATCH_MAX 16
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_SDR_READING_USECS
+ *
+ * Default maximum age (in usecs) of cached IPMI sensor readings. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_SDR_READING_USECS
+#define ONLPLIB_CONFIG_IPMI_SDR_READING_USECS 2000000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS
+ *
+ * Default interval (in usecs) between SDR repository change checks. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS
+#define ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS 60000000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_SDR_SENSORS_MAX
+ *
+ * Maximum number of SDR sensor records cached. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_SDR_SENSORS_MAX
+#define ONLPLIB_CONFIG_IPMI_SDR_SENSORS_MAX 256
+#endif
+
+/**
+ * ONLPLIB_CONFIG_INCLUDE_BMC_TTY
+ *
+ * Include the BMC serial console command engine. */
+
+
+#ifndef ONLPLIB_CONFIG_INCLUDE_BMC_TTY
+#define ONLPLIB_CONFIG_INCLUDE_BMC_TTY 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE
+ *
+ * Size of the BMC console receive buffer. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE
+#define ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE 8192
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_TTY_BATCH_MAX
+ *
+ * Maximum number of BMC console commands sent in one round trip. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_TTY_BATCH_MAX
+#define ONLPLIB_CONFIG_BMC_TTY_BATCH_MAX 16
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES
+ *
+ * Number of BMC console command results cached. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES
+#define ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES 32
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_TTY_CACHE_OUTPUT_MAX
+ *
+ * Largest BMC console command output which is cached. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_TTY_CACHE_OUTPUT_MAX
+#define ONLPLIB_CONFIG_BMC_TTY_CACHE_OUTPUT_MAX 256
+#endif
+
+/**
+ * ONLPLIB_CONFIG_INCLUDE_DEVPOOL
+ *
+ * Include the declarative device pool. */
+
+
+#ifndef ONLPLIB_CONFIG_INCLUDE_DEVPOOL
+#define ONLPLIB_CONFIG_INCLUDE_DEVPOOL 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS
+ *
+ * Default lifetime (in usecs) of cached device pool register windows. */
+
+
+#ifndef ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS
+#define ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS 1000000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD
+ *
+ * Consecutive device pool access failures before a device is held off. */
+
+
+#ifndef ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD
+#define ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD 3
+#endif
+
+/**
+ * ONLPLIB_CONFIG_DEVPOOL_ERROR_HOLDOFF_USECS
+ *
+ * How long (in usecs) a failing device pool device is not accessed. */
+
+
+#ifndef ONLPLIB_CONFIG_DEVPOOL_ERROR_HOLDOFF_USECS
+#define ONLPLIB_CONFIG_DEVPOOL_ERROR_HOLDOFF_USECS 10000000
+#endif
+
 /**
  * ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER
  *
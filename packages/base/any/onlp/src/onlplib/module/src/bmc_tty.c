@@ -0,0 +1,606 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/bmc_tty.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_BMC_TTY == 1
+
+#include <onlp/onlp.h>
+#include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include <termios.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "onlplib_log.h"
+
+/*
+ * The command line for a batch is
+ *
+ *   printf '\n@@ONLP:%s@@\n' S; cmd0; printf '\n@@ONLP:%d:%d@@\n' 0 $?; cmd1; ...
+ *
+ * which produces "@@ONLP:S@@" before the first output and
+ * "@@ONLP:<index>:<exit status>@@" after each command's output.
+ */
+#define TTY_MARKER              "@@ONLP:"
+#define TTY_MARKER_END          "@@"
+#define TTY_MARKER_START        TTY_MARKER "S" TTY_MARKER_END
+#define TTY_PASSWORD_PROMPT     "assword:"
+
+#define TTY_CACHE_CMD_MAX       128
+
+typedef struct tty_cache_entry_s {
+    char cmd[TTY_CACHE_CMD_MAX];
+    char out[ONLPLIB_CONFIG_BMC_TTY_CACHE_OUTPUT_MAX];
+    int out_len;
+    uint64_t updated;
+} tty_cache_entry_t;
+
+static struct {
+    pthread_mutex_t lock;
+    onlp_bmc_tty_config_t config;
+    int configured;
+
+    int fd;
+    /** Logged in and at the shell prompt. */
+    int ready;
+
+    /** Receive buffer. Carriage returns and NULs are dropped. */
+    char buf[ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE + 1];
+    int len;
+
+    char line[ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE];
+
+    tty_cache_entry_t cache[ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES];
+    int cache_next;
+} tty__ = {
+    PTHREAD_MUTEX_INITIALIZER,
+    .fd = -1,
+};
+
+static int
+tty_cmd_len__(const char* cmd)
+{
+    int len = strlen(cmd);
+    while(len > 0 && (cmd[len-1] == '\r' || cmd[len-1] == '\n' ||
+                      cmd[len-1] == ' ' || cmd[len-1] == ';')) {
+        len--;
+    }
+    return len;
+}
+
+static int
+tty_remaining_ms__(uint64_t deadline)
+{
+    uint64_t now = aim_time_monotonic();
+    return (now >= deadline) ? 0 : (int)((deadline - now + 999) / 1000);
+}
+
+static void
+tty_close__(void)
+{
+    if(tty__.fd >= 0) {
+        close(tty__.fd);
+    }
+    tty__.fd = -1;
+    tty__.ready = 0;
+    tty__.len = 0;
+}
+
+static int
+tty_open__(void)
+{
+    struct termios attr;
+    const char* device;
+
+    if(tty__.fd >= 0) {
+        return 0;
+    }
+
+    if((device = getenv("ONLP_BMC_TTY_DEVICE")) == NULL) {
+        device = tty__.config.device;
+    }
+
+    tty__.fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if(tty__.fd < 0) {
+        AIM_LOG_ERROR("bmc tty: open %s: %{errno}", device, errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    if(tcgetattr(tty__.fd, &attr) == 0) {
+        attr.c_cflag = CS8 | CLOCAL | CREAD;
+        attr.c_iflag = IGNPAR;
+        attr.c_oflag = 0;
+        attr.c_lflag = 0;
+        attr.c_cc[VMIN] = 0;
+        attr.c_cc[VTIME] = 0;
+        if(tty__.config.speed) {
+            cfsetospeed(&attr, (speed_t)tty__.config.speed);
+            cfsetispeed(&attr, (speed_t)tty__.config.speed);
+        }
+        tcsetattr(tty__.fd, TCSANOW, &attr);
+    }
+
+    tty__.ready = 0;
+    tty__.len = 0;
+    return 0;
+}
+
+static int
+tty_write__(const char* data, int len, uint64_t deadline)
+{
+    while(len > 0) {
+        int rv = write(tty__.fd, data, len);
+        if(rv > 0) {
+            data += rv;
+            len -= rv;
+            continue;
+        }
+        if(rv < 0 && errno != EAGAIN && errno != EINTR) {
+            AIM_LOG_ERROR("bmc tty: write: %{errno}", errno);
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        else {
+            struct pollfd pfd = { tty__.fd, POLLOUT, 0 };
+            int ms = tty_remaining_ms__(deadline);
+            if(ms == 0 || poll(&pfd, 1, ms) == 0) {
+                return ONLP_STATUS_E_INTERNAL;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Append whatever is available to the receive buffer.
+ * Waits until the deadline if nothing is available yet.
+ */
+static int
+tty_fill__(uint64_t deadline)
+{
+    char data[512];
+    int i, rv;
+
+    for(;;) {
+        rv = read(tty__.fd, data, sizeof(data));
+        if(rv > 0) {
+            break;
+        }
+        if(rv < 0 && errno != EAGAIN && errno != EINTR) {
+            AIM_LOG_ERROR("bmc tty: read: %{errno}", errno);
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        else {
+            struct pollfd pfd = { tty__.fd, POLLIN, 0 };
+            int ms = tty_remaining_ms__(deadline);
+            if(ms == 0 || poll(&pfd, 1, ms) == 0) {
+                return ONLP_STATUS_E_MISSING;
+            }
+        }
+    }
+
+    for(i = 0; i < rv; i++) {
+        if(data[i] == '\r' || data[i] == '\0') {
+            continue;
+        }
+        if(tty__.len >= sizeof(tty__.buf) - 1) {
+            AIM_LOG_ERROR("bmc tty: receive buffer overflow.");
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        tty__.buf[tty__.len++] = data[i];
+    }
+    tty__.buf[tty__.len] = 0;
+    return 0;
+}
+
+/**
+ * Discard everything currently pending on the console.
+ */
+static void
+tty_drain__(void)
+{
+    char data[512];
+    while(read(tty__.fd, data, sizeof(data)) > 0);
+    tty__.len = 0;
+    tty__.buf[0] = 0;
+}
+
+/**
+ * Wait for any of the given strings to appear in the receive
+ * buffer at or after 'from'.
+ * Returns the index of the string found.
+ */
+static int
+tty_wait__(const char** patterns, int count, int from, uint64_t deadline,
+           char** found)
+{
+    int i, rv;
+
+    for(;;) {
+        for(i = 0; i < count; i++) {
+            char* p = strstr(tty__.buf + from, patterns[i]);
+            if(p) {
+                if(found) {
+                    *found = p;
+                }
+                return i;
+            }
+        }
+        if((rv = tty_fill__(deadline)) < 0) {
+            return rv;
+        }
+    }
+}
+
+static int
+tty_send_wait__(const char* data, const char* pattern, uint64_t deadline)
+{
+    int rv;
+    tty_drain__();
+    if((rv = tty_write__(data, strlen(data), deadline)) < 0) {
+        return rv;
+    }
+    return tty_wait__(&pattern, 1, 0, deadline, NULL);
+}
+
+static int
+tty_login__(void)
+{
+    const char* patterns[] = { tty__.config.prompt, tty__.config.login_prompt };
+    uint64_t deadline;
+    int rv;
+
+    tty_drain__();
+    deadline = aim_time_monotonic() + tty__.config.login_timeout_ms * 1000ULL;
+    if((rv = tty_write__("\r", 1, deadline)) < 0) {
+        return rv;
+    }
+
+    rv = tty_wait__(patterns, tty__.config.login_prompt ? 2 : 1, 0, deadline, NULL);
+    if(rv == 1) {
+        char data[64];
+
+        AIM_LOG_VERBOSE("bmc tty: logging in as %s", tty__.config.user);
+        snprintf(data, sizeof(data), "%s\r", tty__.config.user);
+        deadline = aim_time_monotonic() + tty__.config.login_timeout_ms * 1000ULL;
+        if((rv = tty_send_wait__(data, TTY_PASSWORD_PROMPT, deadline)) < 0) {
+            return rv;
+        }
+        snprintf(data, sizeof(data), "%s\r", tty__.config.password);
+        deadline = aim_time_monotonic() + tty__.config.login_timeout_ms * 1000ULL;
+        rv = tty_send_wait__(data, tty__.config.prompt, deadline);
+    }
+    if(rv < 0) {
+        return rv;
+    }
+
+    tty__.ready = 1;
+    return 0;
+}
+
+/**
+ * Run one batch of commands on the console.
+ */
+static int
+tty_transact__(onlp_bmc_tty_cmd_t** cmds, int count)
+{
+    uint64_t deadline;
+    int i, rv, pos, from;
+    char* p;
+
+    pos = snprintf(tty__.line, sizeof(tty__.line),
+                   "printf '\\n" TTY_MARKER "%%s" TTY_MARKER_END "\\n' S");
+    for(i = 0; i < count; i++) {
+        pos += snprintf(tty__.line + pos, sizeof(tty__.line) - pos,
+                        "; %.*s; printf '\\n" TTY_MARKER "%%d:%%d" TTY_MARKER_END "\\n' %d $?",
+                        tty_cmd_len__(cmds[i]->cmd), cmds[i]->cmd, i);
+        if(pos >= sizeof(tty__.line) - 1) {
+            AIM_LOG_ERROR("bmc tty: command line too long.");
+            return ONLP_STATUS_E_PARAM;
+        }
+    }
+    tty__.line[pos++] = '\r';
+
+    tty_drain__();
+    deadline = aim_time_monotonic() + tty__.config.timeout_ms * 1000ULL;
+    if((rv = tty_write__(tty__.line, pos, deadline)) < 0) {
+        return rv;
+    }
+
+    {
+        const char* start = TTY_MARKER_START;
+        if((rv = tty_wait__(&start, 1, 0, deadline, &p)) < 0) {
+            return rv;
+        }
+        from = p + strlen(start) - tty__.buf;
+    }
+
+    for(i = 0; i < count; i++) {
+        onlp_bmc_tty_cmd_t* c = cmds[i];
+        char marker[32];
+        const char* mp = marker;
+        int start, end;
+
+        snprintf(marker, sizeof(marker), TTY_MARKER "%d:", i);
+        if((rv = tty_wait__(&mp, 1, from, deadline, &p)) < 0) {
+            return rv;
+        }
+        /* Wait for the whole marker, including the exit status. */
+        p += strlen(marker);
+        while(strstr(p, TTY_MARKER_END) == NULL) {
+            if((rv = tty_fill__(deadline)) < 0) {
+                return rv;
+            }
+        }
+
+        start = from;
+        end = p - strlen(marker) - tty__.buf;
+        while(start < end && tty__.buf[start] == '\n') {
+            start++;
+        }
+        while(end > start && tty__.buf[end-1] == '\n') {
+            end--;
+        }
+
+        c->exit = atoi(p);
+        c->out_len = end - start;
+        if(c->out) {
+            if(c->out_len > c->out_size - 1) {
+                c->out_len = c->out_size - 1;
+            }
+            memcpy(c->out, tty__.buf + start, c->out_len);
+            c->out[c->out_len] = 0;
+        }
+
+        /* Consume everything up to the end of this marker. */
+        p = strstr(p, TTY_MARKER_END) + strlen(TTY_MARKER_END);
+        tty__.len -= p - tty__.buf;
+        memmove(tty__.buf, p, tty__.len + 1);
+        from = 0;
+    }
+
+    /* Wait for the prompt so it isn't mistaken for output next time. */
+    {
+        const char* prompt = tty__.config.prompt;
+        tty_wait__(&prompt, 1, 0, deadline, NULL);
+    }
+    return 0;
+}
+
+static int
+tty_run__(onlp_bmc_tty_cmd_t** cmds, int count)
+{
+    int attempt, rv = ONLP_STATUS_E_INTERNAL;
+    int retries = tty__.config.retries > 0 ? tty__.config.retries : 1;
+
+    for(attempt = 0; attempt < retries; attempt++) {
+        if((rv = tty_open__()) < 0) {
+            continue;
+        }
+        if(!tty__.ready && (rv = tty_login__()) < 0) {
+            AIM_LOG_VERBOSE("bmc tty: login failed: %{onlp_status}", rv);
+            tty_close__();
+            continue;
+        }
+        if((rv = tty_transact__(cmds, count)) == 0) {
+            return 0;
+        }
+        if(rv == ONLP_STATUS_E_PARAM) {
+            return rv;
+        }
+        /* The shell may have logged us out. Check before retrying. */
+        tty__.ready = 0;
+    }
+
+    tty_close__();
+    return rv;
+}
+
+static tty_cache_entry_t*
+tty_cache_find__(const char* cmd, int len)
+{
+    int i;
+    if(len >= TTY_CACHE_CMD_MAX) {
+        return NULL;
+    }
+    for(i = 0; i < AIM_ARRAYSIZE(tty__.cache); i++) {
+        tty_cache_entry_t* e = tty__.cache + i;
+        if(e->updated && !strncmp(e->cmd, cmd, len) && e->cmd[len] == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void
+tty_cache_put__(onlp_bmc_tty_cmd_t* c, uint64_t now)
+{
+    int len = tty_cmd_len__(c->cmd);
+    tty_cache_entry_t* e;
+
+    if(len >= TTY_CACHE_CMD_MAX || c->out == NULL ||
+       c->out_len >= sizeof(e->out) || c->out_len >= c->out_size - 1) {
+        /* Too large, or we don't have the whole output. */
+        return;
+    }
+
+    if((e = tty_cache_find__(c->cmd, len)) == NULL) {
+        e = tty__.cache + tty__.cache_next;
+        tty__.cache_next = (tty__.cache_next + 1) % AIM_ARRAYSIZE(tty__.cache);
+        memcpy(e->cmd, c->cmd, len);
+        e->cmd[len] = 0;
+    }
+    memcpy(e->out, c->out, c->out_len + 1);
+    e->out_len = c->out_len;
+    e->updated = now;
+}
+
+static void
+tty_cache_invalidate__(void)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(tty__.cache); i++) {
+        tty__.cache[i].updated = 0;
+    }
+}
+
+int
+onlp_bmc_tty_init(const onlp_bmc_tty_config_t* config)
+{
+    if(config == NULL || config->device == NULL || config->prompt == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&tty__.lock);
+    tty_close__();
+    tty__.config = *config;
+    tty__.configured = 1;
+    tty_cache_invalidate__();
+    pthread_mutex_unlock(&tty__.lock);
+    return 0;
+}
+
+int
+onlp_bmc_tty_deinit(void)
+{
+    pthread_mutex_lock(&tty__.lock);
+    tty_close__();
+    pthread_mutex_unlock(&tty__.lock);
+    return 0;
+}
+
+/**
+ * Run the commands which were not served from the cache and cache
+ * their results. Cache hits are never put back, so entries expire
+ * however often they are requested.
+ */
+static int
+tty_run_pending__(onlp_bmc_tty_cmd_t** pending, int n, int invalidate)
+{
+    int i, rv;
+    uint64_t now;
+
+    rv = tty_run__(pending, n);
+
+    if(invalidate) {
+        tty_cache_invalidate__();
+    }
+    if(rv == 0 && tty__.config.cache_usecs) {
+        now = aim_time_monotonic();
+        for(i = 0; i < n; i++) {
+            if((pending[i]->flags & ONLP_BMC_TTY_F_CACHED) && pending[i]->exit == 0) {
+                tty_cache_put__(pending[i], now);
+            }
+        }
+    }
+    return rv;
+}
+
+int
+onlp_bmc_tty_exec_batch(onlp_bmc_tty_cmd_t* cmds, int count)
+{
+    onlp_bmc_tty_cmd_t* pending[ONLPLIB_CONFIG_BMC_TTY_BATCH_MAX];
+    uint64_t now;
+    int i, n, rv = 0, invalidate = 0;
+
+    pthread_mutex_lock(&tty__.lock);
+
+    if(!tty__.configured) {
+        AIM_LOG_ERROR("bmc tty: not initialized.");
+        pthread_mutex_unlock(&tty__.lock);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    now = aim_time_monotonic();
+    for(i = 0, n = 0; i < count && rv == 0; i++) {
+        onlp_bmc_tty_cmd_t* c = cmds + i;
+        tty_cache_entry_t* e;
+
+        if(c->flags & ONLP_BMC_TTY_F_CACHED) {
+            e = tty_cache_find__(c->cmd, tty_cmd_len__(c->cmd));
+            if(e && tty__.config.cache_usecs &&
+               now - e->updated < tty__.config.cache_usecs) {
+                c->exit = 0;
+                c->out_len = 0;
+                if(c->out && c->out_size > 0) {
+                    c->out_len = (e->out_len < c->out_size) ? e->out_len : c->out_size - 1;
+                    memcpy(c->out, e->out, c->out_len);
+                    c->out[c->out_len] = 0;
+                }
+                continue;
+            }
+        }
+        else {
+            invalidate = 1;
+        }
+
+        pending[n++] = c;
+        if(n == AIM_ARRAYSIZE(pending)) {
+            rv = tty_run_pending__(pending, n, invalidate);
+            n = 0;
+            invalidate = 0;
+        }
+    }
+    if(rv == 0 && n > 0) {
+        rv = tty_run_pending__(pending, n, invalidate);
+    }
+
+    pthread_mutex_unlock(&tty__.lock);
+    return rv;
+}
+
+int
+onlp_bmc_tty_exec(const char* cmd, char* out, int size, uint32_t flags)
+{
+    int rv;
+    onlp_bmc_tty_cmd_t c;
+
+    memset(&c, 0, sizeof(c));
+    c.cmd = cmd;
+    c.flags = flags;
+    c.out = out;
+    c.out_size = out ? size : 0;
+
+    if((rv = onlp_bmc_tty_exec_batch(&c, 1)) < 0) {
+        return rv;
+    }
+    if(c.exit != 0) {
+        AIM_LOG_VERBOSE("bmc tty: '%s' exited with %d", cmd, c.exit);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return c.out_len;
+}
+
+void
+onlp_bmc_tty_cache_invalidate(void)
+{
+    pthread_mutex_lock(&tty__.lock);
+    tty_cache_invalidate__();
+    pthread_mutex_unlock(&tty__.lock);
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_BMC_TTY */
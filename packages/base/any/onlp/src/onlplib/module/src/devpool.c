@@ -0,0 +1,1002 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/devpool.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_DEVPOOL == 1
+
+#include <onlp/onlp.h>
+#include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include <pthread.h>
+#include "onlplib_log.h"
+
+/*
+ * One lock per bus, held across the steps and transfers of each
+ * access so devices on other buses are not serialized behind it.
+ * The locks are recursive so platforms can hold a bus across their
+ * own step lists while calling into the pool.
+ */
+#define DEVPOOL_BUS_LOCKS 32
+
+static pthread_mutex_t devpool_bus_locks__[DEVPOOL_BUS_LOCKS];
+static pthread_once_t devpool_bus_locks_once__ = PTHREAD_ONCE_INIT;
+
+static void
+devpool_bus_locks_init__(void)
+{
+    int i;
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    for(i = 0; i < DEVPOOL_BUS_LOCKS; i++) {
+        pthread_mutex_init(devpool_bus_locks__ + i, &attr);
+    }
+    pthread_mutexattr_destroy(&attr);
+}
+
+static pthread_mutex_t*
+devpool_bus_lock__(int bus)
+{
+    pthread_once(&devpool_bus_locks_once__, devpool_bus_locks_init__);
+    return devpool_bus_locks__ + ((unsigned)bus % DEVPOOL_BUS_LOCKS);
+}
+
+void
+onlp_devpool_bus_lock(int bus)
+{
+    pthread_mutex_lock(devpool_bus_lock__(bus));
+}
+
+void
+onlp_devpool_bus_unlock(int bus)
+{
+    pthread_mutex_unlock(devpool_bus_lock__(bus));
+}
+
+#define DEVPOOL_LOCK(_dev) onlp_devpool_bus_lock((_dev)->bus)
+#define DEVPOOL_UNLOCK(_dev) onlp_devpool_bus_unlock((_dev)->bus)
+
+#define DEV_NAME(_dev) ((_dev)->name ? (_dev)->name : (_dev)->driver->name)
+
+int
+onlp_devpool_steps_run(const onlp_devpool_step_t* steps)
+{
+    int rv = 0;
+
+    for(; steps && steps->type != ONLP_DEVPOOL_STEP_END; steps++) {
+        switch(steps->type)
+            {
+            case ONLP_DEVPOOL_STEP_WRITE:
+                rv = onlp_i2c_writeb(steps->bus, steps->addr, steps->offset,
+                                     steps->value, ONLP_I2C_F_FORCE);
+                break;
+            case ONLP_DEVPOOL_STEP_MODIFY:
+                rv = onlp_i2c_modifyb(steps->bus, steps->addr, steps->offset,
+                                      ~steps->mask, steps->match & steps->mask,
+                                      ONLP_I2C_F_FORCE);
+                break;
+            default:
+                AIM_LOG_ERROR("Unknown device pool step type %d.", steps->type);
+                return ONLP_STATUS_E_PARAM;
+            }
+        if(rv < 0) {
+            return rv;
+        }
+    }
+    return 0;
+}
+
+static uint32_t
+dev_flags__(onlp_devpool_dev_t* dev)
+{
+    return dev->flags | dev->driver->flags;
+}
+
+static void
+dev_window__(onlp_devpool_dev_t* dev, int* offset, int* size)
+{
+    if(dev->window_size) {
+        *offset = dev->window_offset;
+        *size = dev->window_size;
+    }
+    else {
+        *offset = dev->driver->window_offset;
+        *size = dev->driver->window_size;
+    }
+}
+
+static int
+dev_window_covers__(onlp_devpool_dev_t* dev, int offset, int size)
+{
+    int woffset, wsize;
+
+    if(dev->driver->registers || dev->driver->refresh) {
+        return 0;
+    }
+    dev_window__(dev, &woffset, &wsize);
+    return wsize > 0 && offset >= woffset && offset + size <= woffset + wsize;
+}
+
+/*
+ * Devices which fail repeatedly are not accessed again until the
+ * holdoff expires. The last error is returned instead.
+ */
+static int
+dev_available__(onlp_devpool_dev_t* dev, uint64_t now)
+{
+    onlp_devpool_state_t* st = &dev->state;
+
+    if(st->failures >= ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD &&
+       now < st->holdoff_until) {
+        return st->last_error;
+    }
+    return 0;
+}
+
+static int
+dev_account__(onlp_devpool_dev_t* dev, int rv, uint64_t now)
+{
+    onlp_devpool_state_t* st = &dev->state;
+
+    if(rv < 0) {
+        st->errors++;
+        st->last_error = rv;
+        if(++st->failures == ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD) {
+            AIM_LOG_ERROR("%s: %d consecutive failures (%{onlp_status}). Holding off.",
+                          DEV_NAME(dev), st->failures, rv);
+        }
+        if(st->failures >= ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD) {
+            st->holdoff_until = now + ONLPLIB_CONFIG_DEVPOOL_ERROR_HOLDOFF_USECS;
+        }
+    }
+    else {
+        if(st->failures >= ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD) {
+            AIM_LOG_INFO("%s: recovered.", DEV_NAME(dev));
+        }
+        st->failures = 0;
+    }
+    return rv;
+}
+
+/*
+ * A single transfer with the device's steps around it.
+ */
+static int
+dev_xfer__(onlp_devpool_dev_t* dev, int write, uint8_t addr_offset,
+           uint8_t offset, uint8_t* data, int size)
+{
+    int rv, crv;
+    uint64_t now = aim_time_monotonic();
+    uint32_t flags = dev_flags__(dev);
+    uint8_t addr = dev->addr + addr_offset;
+
+    if( (rv = dev_available__(dev, now)) < 0) {
+        return rv;
+    }
+
+    if(write) {
+        dev->state.writes++;
+    }
+    else {
+        dev->state.reads++;
+    }
+
+    if( (rv = onlp_devpool_steps_run(dev->open)) >= 0) {
+        if(write) {
+            rv = onlp_i2c_write(dev->bus, addr, offset, size, data, flags);
+        }
+        else if(flags & ONLP_I2C_F_USE_BLOCK_READ) {
+            rv = onlp_i2c_block_read(dev->bus, addr, offset, size, data, flags);
+        }
+        else {
+            rv = onlp_i2c_read(dev->bus, addr, offset, size, data, flags);
+        }
+    }
+    crv = onlp_devpool_steps_run(dev->close);
+    if(rv >= 0) {
+        rv = crv;
+    }
+
+    return dev_account__(dev, rv, now);
+}
+
+static int
+dev_refresh_default__(onlp_devpool_dev_t* dev, uint8_t* regs)
+{
+    int i, rv, offset, size;
+    uint32_t flags = dev_flags__(dev);
+    const onlp_devpool_driver_t* driver = dev->driver;
+
+    if(driver->registers) {
+        for(i = 0; i < driver->register_count; i++) {
+            if( (rv = onlp_i2c_readb(dev->bus, dev->addr,
+                                     driver->registers[i], flags)) < 0) {
+                return rv;
+            }
+            regs[driver->registers[i]] = rv;
+        }
+        return 0;
+    }
+
+    dev_window__(dev, &offset, &size);
+    if(size <= 0 || offset + size > ONLP_DEVPOOL_WINDOW_MAX) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    if(flags & ONLP_I2C_F_USE_BLOCK_READ) {
+        return onlp_i2c_block_read(dev->bus, dev->addr, offset, size,
+                                   regs + offset, flags);
+    }
+    return onlp_i2c_read(dev->bus, dev->addr, offset, size,
+                         regs + offset, flags);
+}
+
+/*
+ * Make sure the cached window is current. Called with the bus lock held.
+ */
+static int
+dev_refresh__(onlp_devpool_dev_t* dev)
+{
+    int rv, crv;
+    onlp_devpool_state_t* st = &dev->state;
+    uint64_t now = aim_time_monotonic();
+    uint64_t age = dev->cache_usecs ? dev->cache_usecs :
+        ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS;
+
+    if(st->valid && now - st->updated < age) {
+        return 0;
+    }
+
+    st->valid = 0;
+    if( (rv = dev_available__(dev, now)) < 0) {
+        return rv;
+    }
+
+    st->reads++;
+    if( (rv = onlp_devpool_steps_run(dev->open)) >= 0) {
+        if(dev->driver->refresh) {
+            rv = dev->driver->refresh(dev, st->regs);
+        }
+        else {
+            rv = dev_refresh_default__(dev, st->regs);
+        }
+    }
+    crv = onlp_devpool_steps_run(dev->close);
+    if(rv >= 0) {
+        rv = crv;
+    }
+
+    if(rv >= 0) {
+        st->valid = 1;
+        st->updated = now;
+    }
+    else {
+        /* Nothing cached survives a failure, e.g. the PSU strings. */
+        ONLPLIB_MEMSET(st->regs, 0, sizeof(st->regs));
+    }
+    return dev_account__(dev, rv, now);
+}
+
+int
+onlp_devpool_read(onlp_devpool_dev_t* dev, uint8_t offset,
+                  uint8_t* data, int size)
+{
+    int rv;
+
+    if(size <= 0 || offset + size > ONLP_DEVPOOL_WINDOW_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    DEVPOOL_LOCK(dev);
+    if(dev_window_covers__(dev, offset, size)) {
+        if( (rv = dev_refresh__(dev)) >= 0) {
+            ONLPLIB_MEMCPY(data, dev->state.regs + offset, size);
+        }
+    }
+    else {
+        rv = dev_xfer__(dev, 0, 0, offset, data, size);
+    }
+    DEVPOOL_UNLOCK(dev);
+
+    return (rv < 0) ? rv : 0;
+}
+
+int
+onlp_devpool_readb(onlp_devpool_dev_t* dev, uint8_t offset)
+{
+    uint8_t byte;
+    int rv = onlp_devpool_read(dev, offset, &byte, 1);
+    return (rv < 0) ? rv : byte;
+}
+
+static int
+dev_writeb__(onlp_devpool_dev_t* dev, uint8_t offset, uint8_t value)
+{
+    int rv = dev_xfer__(dev, 1, 0, offset, &value, 1);
+
+    if(rv >= 0 && dev_window_covers__(dev, offset, 1)) {
+        dev->state.regs[offset] = value;
+    }
+    return rv;
+}
+
+int
+onlp_devpool_writeb(onlp_devpool_dev_t* dev, uint8_t offset, uint8_t value)
+{
+    int rv;
+
+    DEVPOOL_LOCK(dev);
+    rv = dev_writeb__(dev, offset, value);
+    DEVPOOL_UNLOCK(dev);
+
+    return (rv < 0) ? rv : 0;
+}
+
+int
+onlp_devpool_modifyb(onlp_devpool_dev_t* dev, uint8_t offset,
+                     uint8_t andmask, uint8_t ormask)
+{
+    int rv;
+    uint8_t value;
+
+    DEVPOOL_LOCK(dev);
+    if( (rv = dev_xfer__(dev, 0, 0, offset, &value, 1)) >= 0) {
+        value &= andmask;
+        value |= ormask;
+        rv = dev_writeb__(dev, offset, value);
+    }
+    DEVPOOL_UNLOCK(dev);
+
+    return (rv < 0) ? rv : 0;
+}
+
+int
+onlp_devpool_pin_get(onlp_devpool_dev_t* dev, uint8_t offset,
+                     uint8_t mask, uint8_t match)
+{
+    int rv = onlp_devpool_readb(dev, offset);
+    if(rv < 0) {
+        return rv;
+    }
+    return ((rv & mask) == match) ? 1 : 0;
+}
+
+void
+onlp_devpool_invalidate(onlp_devpool_dev_t* dev)
+{
+    DEVPOOL_LOCK(dev);
+    dev->state.valid = 0;
+    ONLPLIB_MEMSET(dev->state.regs, 0, sizeof(dev->state.regs));
+    DEVPOOL_UNLOCK(dev);
+}
+
+int
+onlp_devpool_thermal_info_get(onlp_devpool_dev_t* dev, int channel,
+                              onlp_thermal_info_t* info)
+{
+    int rv;
+
+    if(dev->driver->temp == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    DEVPOOL_LOCK(dev);
+    if( (rv = dev_refresh__(dev)) >= 0) {
+        rv = dev->driver->temp(dev->state.regs, channel, &info->mcelsius);
+    }
+    DEVPOOL_UNLOCK(dev);
+
+    if(rv < 0) {
+        return rv;
+    }
+    info->caps |= ONLP_THERMAL_CAPS_GET_TEMPERATURE;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_devpool_fan_info_get(onlp_devpool_dev_t* dev, int channel,
+                          onlp_fan_info_t* info)
+{
+    int rv;
+
+    if(dev->driver->rpm == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    DEVPOOL_LOCK(dev);
+    if( (rv = dev_refresh__(dev)) >= 0) {
+        rv = dev->driver->rpm(dev->state.regs, channel, &info->rpm);
+    }
+    DEVPOOL_UNLOCK(dev);
+
+    if(rv < 0) {
+        return rv;
+    }
+    info->caps |= ONLP_FAN_CAPS_GET_RPM;
+    if(dev->driver->rpm_set) {
+        info->caps |= ONLP_FAN_CAPS_SET_RPM;
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_devpool_fan_rpm_set(onlp_devpool_dev_t* dev, int channel, int rpm)
+{
+    if(dev->driver->rpm_set == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    return dev->driver->rpm_set(dev, channel, rpm);
+}
+
+int
+onlp_devpool_psu_info_get(onlp_devpool_dev_t* dev, onlp_psu_info_t* info)
+{
+    int rv;
+
+    if(dev->driver->psu == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    DEVPOOL_LOCK(dev);
+    if( (rv = dev_refresh__(dev)) >= 0) {
+        rv = dev->driver->psu(dev->state.regs, info);
+    }
+    DEVPOOL_UNLOCK(dev);
+
+    return (rv < 0) ? rv : ONLP_STATUS_OK;
+}
+
+int
+onlp_devpool_sfp_eeprom_read(onlp_devpool_dev_t* dev, uint8_t data[256])
+{
+    return onlp_devpool_read(dev, 0, data, 256);
+}
+
+static const onlp_devpool_field_t*
+dev_field__(onlp_devpool_dev_t* dev, onlp_sfp_control_t control)
+{
+    const onlp_devpool_field_t* f;
+
+    for(f = dev->driver->fields; f && f->mask; f++) {
+        if(f->control == control) {
+            return f;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Channel controls report the field bits. All others report
+ * whether any of the field bits are set.
+ */
+static int
+field_value_get__(const onlp_devpool_field_t* f, uint8_t byte)
+{
+    if(f->control == ONLP_SFP_CONTROL_TX_DISABLE_CHANNEL) {
+        return (byte & f->mask) >> (__builtin_ffs(f->mask) - 1);
+    }
+    return (byte & f->mask) ? 1 : 0;
+}
+
+static uint8_t
+field_value_set__(const onlp_devpool_field_t* f, uint8_t byte, int value)
+{
+    byte &= ~f->mask;
+    if(f->control == ONLP_SFP_CONTROL_TX_DISABLE_CHANNEL) {
+        byte |= (value << (__builtin_ffs(f->mask) - 1)) & f->mask;
+    }
+    else if(value) {
+        byte |= f->mask;
+    }
+    return byte;
+}
+
+int
+onlp_devpool_sfp_control_supported(onlp_devpool_dev_t* dev,
+                                   onlp_sfp_control_t control, int* rv)
+{
+    *rv = (dev_field__(dev, control) != NULL);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_devpool_sfp_control_get(onlp_devpool_dev_t* dev,
+                             onlp_sfp_control_t control, int* value)
+{
+    int rv;
+    uint8_t byte;
+    const onlp_devpool_field_t* f = dev_field__(dev, control);
+
+    if(f == NULL) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    /* Status fields are latched by the module. Always read them. */
+    DEVPOOL_LOCK(dev);
+    rv = dev_xfer__(dev, 0, f->addr_offset, f->offset, &byte, 1);
+    DEVPOOL_UNLOCK(dev);
+
+    if(rv < 0) {
+        return rv;
+    }
+    *value = field_value_get__(f, byte);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_devpool_sfp_control_set(onlp_devpool_dev_t* dev,
+                             onlp_sfp_control_t control, int value)
+{
+    int rv;
+    uint8_t byte;
+    const onlp_devpool_field_t* f = dev_field__(dev, control);
+
+    if(f == NULL || !f->rw) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    DEVPOOL_LOCK(dev);
+    if( (rv = dev_xfer__(dev, 0, f->addr_offset, f->offset, &byte, 1)) >= 0) {
+        byte = field_value_set__(f, byte, value);
+        rv = dev_xfer__(dev, 1, f->addr_offset, f->offset, &byte, 1);
+    }
+    dev->state.valid = 0;
+    DEVPOOL_UNLOCK(dev);
+
+    return (rv < 0) ? rv : ONLP_STATUS_OK;
+}
+
+void
+onlp_devpool_show(aim_pvs_t* pvs, onlp_devpool_dev_t* devs, int count)
+{
+    int i;
+
+    aim_printf(pvs, "%-24s %-10s %10s %10s %10s  %s\n",
+               "Device", "Driver", "Reads", "Writes", "Errors", "Status");
+
+    for(i = 0; i < count; i++) {
+        onlp_devpool_dev_t* dev = devs + i;
+        onlp_devpool_state_t* st = &dev->state;
+        DEVPOOL_LOCK(dev);
+        aim_printf(pvs, "%-24s %-10s %10u %10u %10u  ",
+                   DEV_NAME(dev), dev->driver->name,
+                   st->reads, st->writes, st->errors);
+        if(st->failures >= ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD) {
+            aim_printf(pvs, "held off (%{onlp_status})\n", st->last_error);
+        }
+        else if(st->failures) {
+            aim_printf(pvs, "failing (%{onlp_status})\n", st->last_error);
+        }
+        else {
+            aim_printf(pvs, "ok\n");
+        }
+        DEVPOOL_UNLOCK(dev);
+    }
+}
+
+
+/**************************************************************************//**
+ *
+ * Chip drivers.
+ *
+ *****************************************************************************/
+
+const onlp_devpool_driver_t onlp_devpool_driver_cpld = {
+    .name = "cpld",
+};
+
+const onlp_devpool_driver_t onlp_devpool_driver_eeprom = {
+    .name = "eeprom",
+    .window_offset = 0,
+    .window_size = 256,
+    .flags = ONLP_I2C_F_USE_BLOCK_READ,
+};
+
+/*
+ * TMP75: 12-bit two's complement temperature, left justified in a
+ * big endian register, 0.0625C per bit.
+ */
+static int
+tmp75_temp__(const uint8_t* regs, int channel, int* mcelsius)
+{
+    int16_t raw = (int16_t)((regs[0] << 8) | regs[1]);
+
+    if(channel != 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    *mcelsius = (raw >> 4) * 125 / 2;
+    return 0;
+}
+
+const onlp_devpool_driver_t onlp_devpool_driver_tmp75 = {
+    .name = "tmp75",
+    .window_offset = 0,
+    .window_size = 2,
+    .flags = ONLP_I2C_F_USE_BLOCK_READ,
+    .temp = tmp75_temp__,
+};
+
+/*
+ * TMP461: the integer part and the fraction live in separate
+ * registers which the chip does not auto-increment between.
+ */
+#define TMP461_LOCAL_HIGH       0x00
+#define TMP461_REMOTE_HIGH      0x01
+#define TMP461_REMOTE_LOW       0x10
+#define TMP461_LOCAL_LOW        0x15
+
+static const uint8_t tmp461_registers__[] = {
+    TMP461_LOCAL_HIGH, TMP461_REMOTE_HIGH, TMP461_REMOTE_LOW, TMP461_LOCAL_LOW,
+};
+
+static int
+tmp461_temp__(const uint8_t* regs, int channel, int* mcelsius)
+{
+    int16_t raw;
+
+    switch(channel)
+        {
+        case 0:
+            raw = (int16_t)((regs[TMP461_LOCAL_HIGH] << 8) | regs[TMP461_LOCAL_LOW]);
+            break;
+        case 1:
+            raw = (int16_t)((regs[TMP461_REMOTE_HIGH] << 8) | regs[TMP461_REMOTE_LOW]);
+            break;
+        default:
+            return ONLP_STATUS_E_PARAM;
+        }
+    *mcelsius = (raw >> 4) * 125 / 2;
+    return 0;
+}
+
+const onlp_devpool_driver_t onlp_devpool_driver_tmp461 = {
+    .name = "tmp461",
+    .registers = tmp461_registers__,
+    .register_count = AIM_ARRAYSIZE(tmp461_registers__),
+    .temp = tmp461_temp__,
+};
+
+/*
+ * EMC2305: five fan channels, 0x10 registers apart.
+ */
+#define EMC2305_CHANNELS        5
+#define EMC2305_REG(_base, _ch) ((_base) + 0x10 * (_ch))
+#define EMC2305_CONFIG1         0x32
+#define EMC2305_TACH_TARGET_LOW 0x3C
+#define EMC2305_TACH_TARGET_HIGH 0x3D
+#define EMC2305_TACH_HIGH       0x3E
+#define EMC2305_TACH_LOW        0x3F
+#define EMC2305_TACH_STALLED    0x1FFF
+#define EMC2305_RPM_FACTOR      7864320
+
+static const uint8_t emc2305_registers__[] = {
+    0x3E, 0x3F, 0x4E, 0x4F, 0x5E, 0x5F, 0x6E, 0x6F, 0x7E, 0x7F,
+};
+
+static int
+emc2305_rpm__(const uint8_t* regs, int channel, int* rpm)
+{
+    int count;
+
+    if(channel < 0 || channel >= EMC2305_CHANNELS) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    count = ((regs[EMC2305_REG(EMC2305_TACH_HIGH, channel)] << 8) |
+             regs[EMC2305_REG(EMC2305_TACH_LOW, channel)]) >> 3;
+    *rpm = (count == 0 || count == EMC2305_TACH_STALLED) ? 0 :
+        EMC2305_RPM_FACTOR / count;
+    return 0;
+}
+
+static int
+emc2305_rpm_set__(onlp_devpool_dev_t* dev, int channel, int rpm)
+{
+    int rv;
+    int count;
+
+    if(channel < 0 || channel >= EMC2305_CHANNELS || rpm <= 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    count = (EMC2305_RPM_FACTOR / rpm) << 3;
+    if( (rv = onlp_devpool_writeb(dev, EMC2305_REG(EMC2305_TACH_TARGET_HIGH, channel),
+                                  (count >> 8) & 0xFF)) < 0 ||
+        (rv = onlp_devpool_writeb(dev, EMC2305_REG(EMC2305_TACH_TARGET_LOW, channel),
+                                  count & 0xFF)) < 0) {
+        return rv;
+    }
+    /* RPM (closed loop) mode. */
+    return onlp_devpool_writeb(dev, EMC2305_REG(EMC2305_CONFIG1, channel), 0xAB);
+}
+
+const onlp_devpool_driver_t onlp_devpool_driver_emc2305 = {
+    .name = "emc2305",
+    .registers = emc2305_registers__,
+    .register_count = AIM_ARRAYSIZE(emc2305_registers__),
+    .rpm = emc2305_rpm__,
+    .rpm_set = emc2305_rpm_set__,
+};
+
+/*
+ * PMBus. The readings are collected under one open/close of the
+ * device into a window laid out as:
+ *
+ *   [0]                    VOUT_MODE
+ *   [1..2]                 Bitmap of the readings which succeeded
+ *   [2 * (cmd - 0x80)]     Readings, little endian
+ *   [0x80], [0xC0]         Model and serial, length prefixed
+ *
+ * The model and serial are only read until they have been seen. They
+ * are dropped with the rest of the window when a refresh fails or the
+ * device is invalidated, so a replacement PSU is read again.
+ */
+#define PMBUS_VOUT_MODE         0x20
+#define PMBUS_READ_VIN          0x88
+#define PMBUS_READ_IIN          0x89
+#define PMBUS_READ_VOUT         0x8B
+#define PMBUS_READ_IOUT         0x8C
+#define PMBUS_READ_FAN_SPEED_1  0x90
+#define PMBUS_READ_POUT         0x96
+#define PMBUS_READ_PIN          0x97
+#define PMBUS_MFR_MODEL         0x9A
+#define PMBUS_MFR_SERIAL        0x9E
+
+#define PMBUS_WIN_VALID         1
+#define PMBUS_WIN_WORD(_cmd)    (2 * ((_cmd) - 0x80))
+#define PMBUS_WIN_MODEL         0x80
+#define PMBUS_WIN_SERIAL        0xC0
+#define PMBUS_WIN_STR_MAX       0x3F
+
+static const uint8_t pmbus_words__[] = {
+    PMBUS_READ_VIN, PMBUS_READ_IIN, PMBUS_READ_VOUT, PMBUS_READ_IOUT,
+    PMBUS_READ_FAN_SPEED_1, PMBUS_READ_POUT, PMBUS_READ_PIN,
+};
+
+static int
+pmbus_word_valid__(const uint8_t* regs, uint8_t cmd)
+{
+    int i;
+    uint16_t valid = regs[PMBUS_WIN_VALID] | (regs[PMBUS_WIN_VALID + 1] << 8);
+
+    for(i = 0; i < AIM_ARRAYSIZE(pmbus_words__); i++) {
+        if(pmbus_words__[i] == cmd) {
+            return (valid >> i) & 1;
+        }
+    }
+    return 0;
+}
+
+static uint16_t
+pmbus_word__(const uint8_t* regs, uint8_t cmd)
+{
+    return regs[PMBUS_WIN_WORD(cmd)] | (regs[PMBUS_WIN_WORD(cmd) + 1] << 8);
+}
+
+static int
+pmbus_string_read__(onlp_devpool_dev_t* dev, uint8_t cmd, uint8_t* dst)
+{
+    int len;
+    uint8_t data[PMBUS_WIN_STR_MAX + 1];
+    uint32_t flags = dev_flags__(dev);
+
+    if(dst[0]) {
+        return 0;
+    }
+
+    /* Block read: the first byte is the length. */
+    if( (len = onlp_i2c_readb(dev->bus, dev->addr, cmd, flags)) < 0) {
+        return len;
+    }
+    if(len > PMBUS_WIN_STR_MAX - 1) {
+        len = PMBUS_WIN_STR_MAX - 1;
+    }
+    if(len == 0 ||
+       onlp_i2c_block_read(dev->bus, dev->addr, cmd, len + 1, data, flags) < 0) {
+        return 0;
+    }
+    ONLPLIB_MEMCPY(dst + 1, data + 1, len);
+    dst[0] = len;
+    return 0;
+}
+
+static int
+pmbus_refresh__(onlp_devpool_dev_t* dev, uint8_t* regs)
+{
+    int i, rv;
+    uint16_t valid = 0;
+    uint32_t flags = dev_flags__(dev);
+
+    if( (rv = onlp_i2c_readb(dev->bus, dev->addr, PMBUS_VOUT_MODE, flags)) < 0) {
+        return rv;
+    }
+    regs[0] = rv;
+
+    /* Not every PSU implements every reading. */
+    for(i = 0; i < AIM_ARRAYSIZE(pmbus_words__); i++) {
+        uint8_t cmd = pmbus_words__[i];
+        if( (rv = onlp_i2c_readw(dev->bus, dev->addr, cmd, flags)) >= 0) {
+            regs[PMBUS_WIN_WORD(cmd)] = rv & 0xFF;
+            regs[PMBUS_WIN_WORD(cmd) + 1] = (rv >> 8) & 0xFF;
+            valid |= (1 << i);
+        }
+    }
+    regs[PMBUS_WIN_VALID] = valid & 0xFF;
+    regs[PMBUS_WIN_VALID + 1] = valid >> 8;
+
+    pmbus_string_read__(dev, PMBUS_MFR_MODEL, regs + PMBUS_WIN_MODEL);
+    pmbus_string_read__(dev, PMBUS_MFR_SERIAL, regs + PMBUS_WIN_SERIAL);
+    return 0;
+}
+
+/*
+ * LINEAR11: 5 bit signed exponent, 11 bit signed mantissa.
+ */
+static int
+pmbus_linear11__(uint16_t word, int scale)
+{
+    int64_t mantissa = ((int16_t)(word << 5)) >> 5;
+    int exponent = ((int16_t)word) >> 11;
+
+    mantissa *= scale;
+    return (exponent >= 0) ? (mantissa << exponent) : (mantissa >> -exponent);
+}
+
+/*
+ * LINEAR16: unsigned mantissa, exponent from VOUT_MODE.
+ */
+static int
+pmbus_linear16__(uint16_t word, uint8_t vout_mode, int scale)
+{
+    int64_t mantissa = (int64_t)word * scale;
+    int exponent = ((int8_t)(vout_mode << 3)) >> 3;
+
+    return (exponent >= 0) ? (mantissa << exponent) : (mantissa >> -exponent);
+}
+
+static void
+pmbus_string__(const uint8_t* src, char* dst, int size)
+{
+    int len = src[0];
+    if(len > size - 1) {
+        len = size - 1;
+    }
+    ONLPLIB_MEMCPY(dst, src + 1, len);
+    dst[len] = 0;
+}
+
+static int
+pmbus_psu__(const uint8_t* regs, onlp_psu_info_t* info)
+{
+    static const struct {
+        uint8_t cmd;
+        uint32_t cap;
+    } readings[] = {
+        { PMBUS_READ_VIN, ONLP_PSU_CAPS_GET_VIN },
+        { PMBUS_READ_IIN, ONLP_PSU_CAPS_GET_IIN },
+        { PMBUS_READ_VOUT, ONLP_PSU_CAPS_GET_VOUT },
+        { PMBUS_READ_IOUT, ONLP_PSU_CAPS_GET_IOUT },
+        { PMBUS_READ_POUT, ONLP_PSU_CAPS_GET_POUT },
+        { PMBUS_READ_PIN, ONLP_PSU_CAPS_GET_PIN },
+    };
+    int i;
+
+    for(i = 0; i < AIM_ARRAYSIZE(readings); i++) {
+        uint8_t cmd = readings[i].cmd;
+        int value;
+
+        if(!pmbus_word_valid__(regs, cmd)) {
+            continue;
+        }
+        if(cmd == PMBUS_READ_VOUT) {
+            if(regs[0] >> 5) {
+                /* Only the linear VOUT mode is supported. */
+                continue;
+            }
+            value = pmbus_linear16__(pmbus_word__(regs, cmd), regs[0], 1000);
+        }
+        else {
+            value = pmbus_linear11__(pmbus_word__(regs, cmd), 1000);
+        }
+
+        switch(cmd)
+            {
+            case PMBUS_READ_VIN: info->mvin = value; break;
+            case PMBUS_READ_IIN: info->miin = value; break;
+            case PMBUS_READ_VOUT: info->mvout = value; break;
+            case PMBUS_READ_IOUT: info->miout = value; break;
+            case PMBUS_READ_POUT: info->mpout = value; break;
+            case PMBUS_READ_PIN: info->mpin = value; break;
+            }
+        info->caps |= readings[i].cap;
+    }
+
+    if(regs[PMBUS_WIN_MODEL]) {
+        pmbus_string__(regs + PMBUS_WIN_MODEL, info->model, sizeof(info->model));
+    }
+    if(regs[PMBUS_WIN_SERIAL]) {
+        pmbus_string__(regs + PMBUS_WIN_SERIAL, info->serial, sizeof(info->serial));
+    }
+    return 0;
+}
+
+static int
+pmbus_rpm__(const uint8_t* regs, int channel, int* rpm)
+{
+    if(channel != 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if(!pmbus_word_valid__(regs, PMBUS_READ_FAN_SPEED_1)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    *rpm = pmbus_linear11__(pmbus_word__(regs, PMBUS_READ_FAN_SPEED_1), 1);
+    return 0;
+}
+
+const onlp_devpool_driver_t onlp_devpool_driver_pmbus = {
+    .name = "pmbus",
+    .refresh = pmbus_refresh__,
+    .rpm = pmbus_rpm__,
+    .psu = pmbus_psu__,
+};
+
+/*
+ * SFP modules. The EEPROM is the window. Control fields are read
+ * from the module directly.
+ */
+static const onlp_devpool_field_t sff8472_fields__[] = {
+    /* A2 status/control byte 110 */
+    { ONLP_SFP_CONTROL_RX_LOS,     1, 110, 0x02, 0 },
+    { ONLP_SFP_CONTROL_TX_FAULT,   1, 110, 0x04, 0 },
+    { ONLP_SFP_CONTROL_TX_DISABLE, 1, 110, 0x40, 1 },
+    { 0 },
+};
+
+const onlp_devpool_driver_t onlp_devpool_driver_sff8472 = {
+    .name = "sff8472",
+    .window_offset = 0,
+    .window_size = 256,
+    .flags = ONLP_I2C_F_USE_BLOCK_READ,
+    .fields = sff8472_fields__,
+};
+
+static const onlp_devpool_field_t sff8636_fields__[] = {
+    { ONLP_SFP_CONTROL_RX_LOS,             0,  3, 0x0F, 0 },
+    { ONLP_SFP_CONTROL_TX_FAULT,           0,  4, 0x0F, 0 },
+    { ONLP_SFP_CONTROL_TX_DISABLE,         0, 86, 0x0F, 1 },
+    { ONLP_SFP_CONTROL_TX_DISABLE_CHANNEL, 0, 86, 0x0F, 1 },
+    { ONLP_SFP_CONTROL_POWER_OVERRIDE,     0, 93, 0x01, 1 },
+    { 0 },
+};
+
+const onlp_devpool_driver_t onlp_devpool_driver_sff8636 = {
+    .name = "sff8636",
+    .window_offset = 0,
+    .window_size = 256,
+    .flags = ONLP_I2C_F_USE_BLOCK_READ,
+    .fields = sff8636_fields__,
+};
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_DEVPOOL */
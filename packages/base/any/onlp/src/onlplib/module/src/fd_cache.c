@@ -0,0 +1,152 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include "fd_cache.h"
+#include <AIM/aim.h>
+#include <string.h>
+#include <unistd.h>
+
+static void
+fd_cache_init__(onlplib_fd_cache_t* cache)
+{
+    if(!cache->initialized) {
+        int i;
+        for(i = 0; i < cache->size; i++) {
+            cache->entries[i].fd = -1;
+        }
+        cache->initialized = 1;
+    }
+}
+
+static void
+fd_cache_entry_close__(onlplib_fd_cache_entry_t* e)
+{
+    close(e->fd);
+    aim_free(e->key);
+    memset(e, 0, sizeof(*e));
+    e->fd = -1;
+}
+
+int
+onlplib_fd_cache_get(onlplib_fd_cache_t* cache, const char* key, int tag,
+                     onlplib_fd_cache_open_f openf, void* cookie)
+{
+    int i, fd;
+    onlplib_fd_cache_entry_t* e;
+    onlplib_fd_cache_entry_t* unused = NULL;
+    onlplib_fd_cache_entry_t* lru = NULL;
+    onlplib_fd_cache_entry_t* victim;
+
+    pthread_mutex_lock(&cache->lock);
+    fd_cache_init__(cache);
+
+    for(i = 0; i < cache->size; i++) {
+        e = cache->entries + i;
+        if(e->fd < 0) {
+            if(unused == NULL) {
+                unused = e;
+            }
+            continue;
+        }
+        if(!e->stale && !strcmp(e->key, key)) {
+            e->refs++;
+            e->used = ++cache->clock;
+            pthread_mutex_unlock(&cache->lock);
+            return e->fd;
+        }
+        if(e->refs == 0 && (lru == NULL || e->used < lru->used)) {
+            lru = e;
+        }
+    }
+
+    victim = (unused) ? unused : lru;
+
+    /*
+     * The lock is held across the open so concurrent misses on the
+     * same key do not both populate the cache.
+     */
+    fd = openf(key, cookie);
+
+    if(fd >= 0 && victim) {
+        if(victim->fd >= 0) {
+            fd_cache_entry_close__(victim);
+        }
+        victim->fd = fd;
+        victim->key = aim_strdup(key);
+        victim->tag = tag;
+        victim->refs = 1;
+        victim->stale = 0;
+        victim->used = ++cache->clock;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+    return fd;
+}
+
+void
+onlplib_fd_cache_put(onlplib_fd_cache_t* cache, int fd, int stale)
+{
+    int i;
+
+    pthread_mutex_lock(&cache->lock);
+    fd_cache_init__(cache);
+
+    for(i = 0; i < cache->size; i++) {
+        onlplib_fd_cache_entry_t* e = cache->entries + i;
+        if(e->fd == fd && e->refs > 0) {
+            e->stale |= stale;
+            if(--e->refs == 0 && e->stale) {
+                fd_cache_entry_close__(e);
+            }
+            pthread_mutex_unlock(&cache->lock);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    /* Not a cached descriptor. */
+    close(fd);
+}
+
+void
+onlplib_fd_cache_flush(onlplib_fd_cache_t* cache, int tag)
+{
+    int i;
+
+    pthread_mutex_lock(&cache->lock);
+    fd_cache_init__(cache);
+
+    for(i = 0; i < cache->size; i++) {
+        onlplib_fd_cache_entry_t* e = cache->entries + i;
+        if(e->fd >= 0 && (tag < 0 || e->tag == tag)) {
+            if(e->refs) {
+                e->stale = 1;
+            }
+            else {
+                fd_cache_entry_close__(e);
+            }
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
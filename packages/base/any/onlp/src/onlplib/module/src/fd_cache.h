@@ -0,0 +1,117 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+
+/********************************************************//**
+ *
+ * Shared descriptor cache.
+ *
+ * Used by the i2c and sysfs attribute code to keep descriptors
+ * open across transactions. Entries are found by a key string
+ * and may carry a tag so a subset can be flushed.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_FD_CACHE_H__
+#define __ONLPLIB_FD_CACHE_H__
+
+#include <onlplib/onlplib_config.h>
+#include <pthread.h>
+#include <stdint.h>
+
+/**
+ * Cached descriptor.
+ */
+typedef struct onlplib_fd_cache_entry_s {
+    /** Open descriptor, or -1 if this slot is unused. */
+    int fd;
+    /** Lookup key. */
+    char* key;
+    /** Flush tag. */
+    int tag;
+
+    /** Number of users currently holding this descriptor. */
+    int refs;
+
+    /** Close the descriptor once the last user releases it. */
+    int stale;
+
+    /** LRU timestamp. */
+    uint64_t used;
+} onlplib_fd_cache_entry_t;
+
+/**
+ * Descriptor cache.
+ * Declare with ONLPLIB_FD_CACHE_DEFINE().
+ */
+typedef struct onlplib_fd_cache_s {
+    onlplib_fd_cache_entry_t* entries;
+    int size;
+    pthread_mutex_t lock;
+    uint64_t clock;
+    int initialized;
+} onlplib_fd_cache_t;
+
+#define ONLPLIB_FD_CACHE_DEFINE(_name, _size)                           \
+    static onlplib_fd_cache_entry_t _name##_entries__[_size];           \
+    static onlplib_fd_cache_t _name = {                                 \
+        _name##_entries__, _size, PTHREAD_MUTEX_INITIALIZER, 0, 0       \
+    }
+
+/**
+ * Opens the descriptor for a key on a cache miss.
+ * Returns the descriptor or a negative ONLP status.
+ */
+typedef int (*onlplib_fd_cache_open_f)(const char* key, void* cookie);
+
+/**
+ * @brief Get a descriptor from the cache, opening it on a miss.
+ * @param cache The cache.
+ * @param key The lookup key.
+ * @param tag The flush tag for a newly cached descriptor.
+ * @param openf Called with key and cookie on a miss.
+ * @param cookie Passed to openf.
+ * @note The descriptor must be returned with onlplib_fd_cache_put().
+ * If every slot is in use the descriptor is returned uncached and
+ * closed by onlplib_fd_cache_put().
+ */
+int onlplib_fd_cache_get(onlplib_fd_cache_t* cache, const char* key, int tag,
+                         onlplib_fd_cache_open_f openf, void* cookie);
+
+/**
+ * @brief Release a descriptor from onlplib_fd_cache_get().
+ * @param cache The cache.
+ * @param fd The descriptor.
+ * @param stale The descriptor must not be handed out again.
+ */
+void onlplib_fd_cache_put(onlplib_fd_cache_t* cache, int fd, int stale);
+
+/**
+ * @brief Close cached descriptors.
+ * @param cache The cache.
+ * @param tag Only flush entries with this tag, or all if < 0.
+ * @note Descriptors still in use are closed when released.
+ */
+void onlplib_fd_cache_flush(onlplib_fd_cache_t* cache, int tag);
+
+#endif /* __ONLPLIB_FD_CACHE_H__ */
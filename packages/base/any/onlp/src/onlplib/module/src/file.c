@@ -31,9 +31,11 @@
 #include "onlplib_log.h"
 #include <onlp/onlp.h>
 #include <errno.h>
+#include "fd_cache.h"
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/stat.h>
+#include <pthread.h>
 
 /**
  * @brief Connects to a unix domain socket.
@@ -78,21 +80,17 @@ ds_connect__(const char* path)
 }
 
 /**
- * @brief Open a file or domain socket.
- * @param dst Receives the full filename (for logging purposes).
- * @param flags The open flags.
- * @param fmt Format specifier.
- * @param vargs Format specifier arguments.
+ * @brief Resolve a filename specifier.
+ * @param spec The filename, which may contain an asterisk.
+ * @param fname Receives the full filename (PATH_MAX).
+ * @param refresh Discard any cached resolution of the specifier.
  */
 static int
-vopen__(char** dst, int flags, const char* fmt, va_list vargs)
+resolve__(const char* spec, char* fname, int refresh)
 {
-    int fd;
-    struct stat sb;
-    char fname[PATH_MAX];
     char* asterisk;
 
-    ONLPLIB_VSNPRINTF(fname, sizeof(fname)-1, fmt, vargs);
+    aim_strlcpy(fname, spec, PATH_MAX);
 
     /**
      * An asterisk in the filename separates a search root
@@ -102,16 +100,31 @@ vopen__(char** dst, int flags, const char* fmt, va_list vargs)
         char* root = fname;
         char* rpath = NULL;
         *asterisk = 0;
+        if(refresh) {
+            onlp_file_find_invalidate(root, asterisk+1);
+        }
         if(onlp_file_find(root, asterisk+1, &rpath) < 0) {
             return ONLP_STATUS_E_MISSING;
         }
-        strcpy(fname, rpath);
+        aim_strlcpy(fname, rpath, PATH_MAX);
         aim_free(rpath);
     }
+    return ONLP_STATUS_OK;
+}
 
-    if(dst) {
-        *dst = aim_strdup(fname);
-    }
+/** The resolution of this specifier may be cached. */
+#define SPEC_IS_SEARCH__(_spec) (strchr(_spec, '*') != NULL)
+
+/**
+ * @brief Open a resolved file or domain socket.
+ * @param fname The filename.
+ * @param flags The open flags.
+ */
+static int
+open__(const char* fname, int flags)
+{
+    int fd;
+    struct stat sb;
 
     if(stat(fname, &sb) == -1) {
         return ONLP_STATUS_E_MISSING;
@@ -127,6 +140,153 @@ vopen__(char** dst, int flags, const char* fmt, va_list vargs)
     return (fd > 0) ? fd : ONLP_STATUS_E_MISSING;
 }
 
+/**
+ * @brief Resolve and open a filename specifier.
+ * @param spec The filename specifier.
+ * @param fname Receives the full filename (PATH_MAX).
+ * @param flags The open flags.
+ * @note A cached search result which no longer exists is resolved again.
+ */
+static int
+open_spec__(const char* spec, char* fname, int flags)
+{
+    int fd;
+
+    ONLP_TRY(resolve__(spec, fname, 0));
+    fd = open__(fname, flags);
+    if(fd == ONLP_STATUS_E_MISSING && SPEC_IS_SEARCH__(spec)) {
+        ONLP_TRY(resolve__(spec, fname, 1));
+        fd = open__(fname, flags);
+    }
+    return fd;
+}
+
+/**
+ * @brief Open a file or domain socket.
+ * @param dst Receives the full filename (for logging purposes).
+ * @param flags The open flags.
+ * @param fmt Format specifier.
+ * @param vargs Format specifier arguments.
+ */
+static int
+vopen__(char** dst, int flags, const char* fmt, va_list vargs)
+{
+    int rv;
+    char spec[PATH_MAX];
+    char fname[PATH_MAX];
+
+    ONLPLIB_VSNPRINTF(spec, sizeof(spec)-1, fmt, vargs);
+    rv = open_spec__(spec, fname, flags);
+
+    if(dst) {
+        *dst = aim_strdup(fname);
+    }
+    return rv;
+}
+
+/**
+ * Only sysfs attributes are cached. Reading at offset 0
+ * calls the attribute's show() method again.
+ */
+#define FILE_FD_CACHEABLE__(_fname) (!strncmp(_fname, "/sys/", 5))
+
+/**
+ * These errors mean the attribute's device or driver went away
+ * under an open descriptor. The path may be valid again.
+ */
+#define FILE_FD_STALE__(_errno) ((_errno) == ENODEV || (_errno) == ESTALE)
+
+#if ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE == 1
+
+/**
+ * Cached sysfs attribute descriptors, keyed by resolved path.
+ */
+ONLPLIB_FD_CACHE_DEFINE(file_fd_cache__, ONLPLIB_CONFIG_FILE_FD_CACHE_SIZE);
+
+static int
+file_fd_open__(const char* fname, void* cookie)
+{
+    return open__(fname, O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * Get a read descriptor for the given path.
+ * The descriptor must be returned with file_fd_put__().
+ */
+static int
+file_fd_get__(const char* fname)
+{
+    return onlplib_fd_cache_get(&file_fd_cache__, fname, 0,
+                                file_fd_open__, NULL);
+}
+
+/**
+ * Release a descriptor from file_fd_get__().
+ * @param stale The descriptor should not be used again.
+ */
+static void
+file_fd_put__(int fd, int stale)
+{
+    onlplib_fd_cache_put(&file_fd_cache__, fd, stale);
+}
+
+void
+onlp_file_fd_cache_flush(void)
+{
+    onlplib_fd_cache_flush(&file_fd_cache__, -1);
+}
+
+#else
+
+static int
+file_fd_get__(const char* fname)
+{
+    return open__(fname, O_RDONLY | O_CLOEXEC);
+}
+
+static void
+file_fd_put__(int fd, int stale)
+{
+    close(fd);
+}
+
+void
+onlp_file_fd_cache_flush(void)
+{
+}
+
+#endif /* ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE */
+
+/**
+ * @brief Read a sysfs attribute through a cached descriptor.
+ * @param fname The resolved filename.
+ * @param data Receives the data.
+ * @param max Maximum read size.
+ * @param len Receives the actual read length.
+ */
+static int
+cached_read__(const char* fname, uint8_t* data, int max, int* len)
+{
+    int attempt, n = -1;
+
+    /* A stale descriptor is reopened once. */
+    for(attempt = 0; attempt < 2; attempt++) {
+        int fd, stale;
+        if( (fd = file_fd_get__(fname)) < 0) {
+            return fd;
+        }
+        n = pread(fd, data, max, 0);
+        stale = (n < 0 && FILE_FD_STALE__(errno));
+        file_fd_put__(fd, stale);
+        if(!stale) {
+            break;
+        }
+    }
+
+    *len = n;
+    return (n > 0) ? ONLP_STATUS_OK : ONLP_STATUS_E_INTERNAL;
+}
+
 int
 onlp_file_vsize(const char* fmt, va_list vargs)
 {
@@ -162,8 +322,30 @@ onlp_file_vread(uint8_t* data, int max, int* len, const char* fmt, va_list vargs
     int fd;
     char* fname = NULL;
     int rv;
+    char spec[PATH_MAX];
+    char path[PATH_MAX];
+
+    ONLPLIB_VSNPRINTF(spec, sizeof(spec)-1, fmt, vargs);
+    if(ONLP_FAILURE(rv = resolve__(spec, path, 0))) {
+        return rv;
+    }
+
+    if(FILE_FD_CACHEABLE__(path)) {
+        memset(data, 0, max);
+        rv = cached_read__(path, data, max, len);
+        if(rv == ONLP_STATUS_E_MISSING && SPEC_IS_SEARCH__(spec)) {
+            /* The cached search result is gone. Search again. */
+            ONLP_TRY(resolve__(spec, path, 1));
+            rv = cached_read__(path, data, max, len);
+        }
+        if(rv == ONLP_STATUS_E_INTERNAL) {
+            AIM_LOG_ERROR("Failed to read input file '%s'", path);
+        }
+        return rv;
+    }
 
-    if ((fd = vopen__(&fname, O_RDONLY, fmt, vargs)) < 0) {
+    fname = aim_strdup(path);
+    if ((fd = open_spec__(spec, path, O_RDONLY)) < 0) {
         rv = fd;
     }
     else {
@@ -463,18 +645,113 @@ onlp_file_vopen(int flags, int log, const char* fmt, va_list vargs)
     return rv;
 }
 
+/**
+ * Attribute handle.
+ */
+struct onlp_file_handle_s {
+    /** The filename specifier */
+    char* spec;
+    /** The resolved path */
+    char path[PATH_MAX];
+    /** The open descriptor, or -1 after a failed reopen. */
+    int fd;
+};
+
+int
+onlp_file_handle_open(onlp_file_handle_t** handle, const char* fmt, ...)
+{
+    va_list vargs;
+    onlp_file_handle_t* h;
+
+    if(handle == NULL || fmt == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    h = aim_zmalloc(sizeof(*h));
+    va_start(vargs, fmt);
+    h->spec = aim_vdfstrdup(fmt, vargs);
+    va_end(vargs);
+
+    if( (h->fd = open_spec__(h->spec, h->path, O_RDONLY | O_CLOEXEC)) < 0) {
+        int rv = h->fd;
+        onlp_file_handle_close(h);
+        return rv;
+    }
+    *handle = h;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_file_handle_read(onlp_file_handle_t* handle, uint8_t* data, int max, int* len)
+{
+    int attempt, n = -1;
+
+    if(handle == NULL || data == NULL || len == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    memset(data, 0, max);
+    for(attempt = 0; attempt < 2; attempt++) {
+        if(handle->fd < 0 &&
+           (handle->fd = open_spec__(handle->spec, handle->path,
+                                     O_RDONLY | O_CLOEXEC)) < 0) {
+            handle->fd = -1;
+            return ONLP_STATUS_E_MISSING;
+        }
+        n = pread(handle->fd, data, max, 0);
+        if(n < 0 && FILE_FD_STALE__(errno)) {
+            /* The driver was reloaded. Reopen and try again. */
+            close(handle->fd);
+            handle->fd = -1;
+            continue;
+        }
+        break;
+    }
+
+    if(n <= 0) {
+        AIM_LOG_ERROR("Failed to read input file '%s'", handle->path);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    *len = n;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_file_handle_read_int(onlp_file_handle_t* handle, int* value)
+{
+    uint8_t data[32];
+    int len;
+
+    ONLP_TRY(onlp_file_handle_read(handle, data, sizeof(data)-1, &len));
+    *value = ONLPLIB_ATOI((char*)data);
+    return 0;
+}
+
+int
+onlp_file_handle_close(onlp_file_handle_t* handle)
+{
+    if(handle) {
+        if(handle->fd >= 0) {
+            close(handle->fd);
+        }
+        aim_free(handle->spec);
+        aim_free(handle);
+    }
+    return 0;
+}
+
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <err.h>
 #include <fts.h>
 
-int
-onlp_file_find(char* root, char* fname, char** rpath)
+static int
+file_find_walk__(const char* root, const char* fname, char** rpath)
 {
     FTS *fs;
     FTSENT *ent;
     char* argv[] = { NULL, NULL };
-    argv[0] = root;
+    argv[0] = (char*)root;
 
     if ((fs = fts_open(argv, FTS_PHYSICAL | FTS_NOCHDIR | FTS_COMFOLLOW,
                        NULL)) == NULL) {
@@ -499,3 +776,239 @@ onlp_file_find(char* root, char* fname, char** rpath)
     fts_close(fs);
     return ONLP_STATUS_E_MISSING;
 }
+
+#if ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE == 1
+
+#include <AIM/aim_time.h>
+
+#if ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT == 1
+#include <linux/netlink.h>
+#endif
+
+/**
+ * Cached search result.
+ */
+typedef struct file_find_entry_s {
+    /** "root*fname", or NULL if this slot is unused. */
+    char* key;
+    /** The resolved path, or NULL if the file was not found. */
+    char* rpath;
+    /** When this entry was resolved. */
+    uint64_t resolved;
+    /** LRU timestamp. */
+    uint64_t used;
+} file_find_entry_t;
+
+static file_find_entry_t file_find_cache__[ONLPLIB_CONFIG_FILE_FIND_CACHE_SIZE];
+static pthread_mutex_t file_find_cache_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t file_find_cache_clock__ = 0;
+
+static void
+file_find_entry_clear__(file_find_entry_t* e)
+{
+    aim_free(e->key);
+    aim_free(e->rpath);
+    memset(e, 0, sizeof(*e));
+}
+
+static void
+file_find_cache_flush_locked__(void)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(file_find_cache__); i++) {
+        file_find_entry_clear__(file_find_cache__ + i);
+    }
+}
+
+#if ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT == 1
+
+/**
+ * Kernel uevents announce devices being added or removed.
+ * Any such event discards all cached search results. The
+ * socket is drained without blocking on every lookup so no
+ * thread is needed.
+ */
+static int file_find_uevent_fd__ = -1;
+static int file_find_uevent_init__ = 0;
+
+static void
+file_find_uevent_poll_locked__(void)
+{
+    char buf[2048];
+    int changed = 0;
+
+    if(!file_find_uevent_init__) {
+        struct sockaddr_nl addr;
+
+        file_find_uevent_init__ = 1;
+        file_find_uevent_fd__ = socket(AF_NETLINK,
+                                       SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                                       NETLINK_KOBJECT_UEVENT);
+        if(file_find_uevent_fd__ < 0) {
+            AIM_LOG_VERBOSE("uevent socket: %{errno}", errno);
+            return;
+        }
+        memset(&addr, 0, sizeof(addr));
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = 1;
+        if(bind(file_find_uevent_fd__, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            AIM_LOG_VERBOSE("uevent bind: %{errno}", errno);
+            close(file_find_uevent_fd__);
+            file_find_uevent_fd__ = -1;
+        }
+        return;
+    }
+
+    if(file_find_uevent_fd__ < 0) {
+        return;
+    }
+
+    for(;;) {
+        ssize_t len = recv(file_find_uevent_fd__, buf, sizeof(buf)-1, 0);
+        if(len < 0) {
+            if(errno == ENOBUFS) {
+                /* Events were lost. */
+                changed = 1;
+                continue;
+            }
+            break;
+        }
+        buf[len] = 0;
+        /* Kernel messages start with "<action>@<devpath>" */
+        if(!strncmp(buf, "add@", 4) || !strncmp(buf, "remove@", 7) ||
+           !strncmp(buf, "move@", 5) || !strncmp(buf, "bind@", 5) ||
+           !strncmp(buf, "unbind@", 7)) {
+            changed = 1;
+        }
+    }
+
+    if(changed) {
+        file_find_cache_flush_locked__();
+    }
+}
+
+#else
+
+#define file_find_uevent_poll_locked__()
+
+#endif /* ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT */
+
+int
+onlp_file_find(char* root, char* fname, char** rpath)
+{
+    int i, rv;
+    char* key;
+    uint64_t now;
+    file_find_entry_t* e;
+    file_find_entry_t* victim = NULL;
+
+    key = aim_fstrdup("%s*%s", root, fname);
+
+    pthread_mutex_lock(&file_find_cache_lock__);
+    file_find_uevent_poll_locked__();
+    now = aim_time_monotonic();
+    for(i = 0; i < AIM_ARRAYSIZE(file_find_cache__); i++) {
+        e = file_find_cache__ + i;
+        if(e->key == NULL) {
+            continue;
+        }
+        if(!strcmp(e->key, key)) {
+            if(e->rpath) {
+                *rpath = aim_strdup(e->rpath);
+                e->used = ++file_find_cache_clock__;
+                pthread_mutex_unlock(&file_find_cache_lock__);
+                aim_free(key);
+                return ONLP_STATUS_OK;
+            }
+            if(now - e->resolved < ONLPLIB_CONFIG_FILE_FIND_NEGATIVE_USECS) {
+                e->used = ++file_find_cache_clock__;
+                pthread_mutex_unlock(&file_find_cache_lock__);
+                aim_free(key);
+                return ONLP_STATUS_E_MISSING;
+            }
+            /* The negative entry has expired. */
+            file_find_entry_clear__(e);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&file_find_cache_lock__);
+
+    /* The walk runs outside of the lock. */
+    *rpath = NULL;
+    rv = file_find_walk__(root, fname, rpath);
+    if(rv < 0 && rv != ONLP_STATUS_E_MISSING) {
+        /* Do not cache errors other than not found. */
+        aim_free(key);
+        return rv;
+    }
+
+    pthread_mutex_lock(&file_find_cache_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(file_find_cache__); i++) {
+        e = file_find_cache__ + i;
+        if(e->key && !strcmp(e->key, key)) {
+            /* Raced with another lookup. */
+            file_find_entry_clear__(e);
+        }
+        if(e->key == NULL) {
+            if(victim == NULL || victim->key) {
+                victim = e;
+            }
+        }
+        else if(victim == NULL || (victim->key && e->used < victim->used)) {
+            victim = e;
+        }
+    }
+    file_find_entry_clear__(victim);
+    victim->key = key;
+    victim->rpath = (*rpath) ? aim_strdup(*rpath) : NULL;
+    victim->resolved = aim_time_monotonic();
+    victim->used = ++file_find_cache_clock__;
+    pthread_mutex_unlock(&file_find_cache_lock__);
+
+    return rv;
+}
+
+void
+onlp_file_find_invalidate(char* root, char* fname)
+{
+    int i;
+    char* key = aim_fstrdup("%s*%s", root, fname);
+
+    pthread_mutex_lock(&file_find_cache_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(file_find_cache__); i++) {
+        file_find_entry_t* e = file_find_cache__ + i;
+        if(e->key && !strcmp(e->key, key)) {
+            file_find_entry_clear__(e);
+        }
+    }
+    pthread_mutex_unlock(&file_find_cache_lock__);
+    aim_free(key);
+}
+
+void
+onlp_file_find_cache_flush(void)
+{
+    pthread_mutex_lock(&file_find_cache_lock__);
+    file_find_cache_flush_locked__();
+    pthread_mutex_unlock(&file_find_cache_lock__);
+}
+
+#else
+
+int
+onlp_file_find(char* root, char* fname, char** rpath)
+{
+    return file_find_walk__(root, fname, rpath);
+}
+
+void
+onlp_file_find_invalidate(char* root, char* fname)
+{
+}
+
+void
+onlp_file_find_cache_flush(void)
+{
+}
+
+#endif /* ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE */
@@ -39,8 +39,10 @@
 #include <sys/types.h>
 #include <sys/ioctl.h>
 #include <errno.h>
+#include <pthread.h>
 #include <onlp/onlp.h>
 #include "onlplib_log.h"
+#include "fd_cache.h"
 
 int
 onlp_i2c_open(int bus, uint8_t addr, uint32_t flags)
@@ -90,18 +92,233 @@ onlp_i2c_open(int bus, uint8_t addr, uint32_t flags)
     return ONLP_STATUS_E_I2C;
 }
 
+/**
+ * The flags which determine how a descriptor was configured
+ * by onlp_i2c_open(). Descriptors are only shared between
+ * transactions which agree on these.
+ */
+#define I2C_FD_OPEN_FLAGS (ONLP_I2C_F_TENBIT | ONLP_I2C_F_FORCE | ONLP_I2C_F_PEC)
+
+#if ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE == 1
+
+/**
+ * Cached i2c device file descriptors.
+ * Keyed by bus, address and open flags, tagged by bus.
+ */
+ONLPLIB_FD_CACHE_DEFINE(i2c_fd_cache__, ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE);
+
+typedef struct i2c_fd_key_s {
+    int bus;
+    uint8_t addr;
+    uint32_t flags;
+} i2c_fd_key_t;
+
+static int
+i2c_fd_open__(const char* key, void* cookie)
+{
+    i2c_fd_key_t* k = (i2c_fd_key_t*)cookie;
+    return onlp_i2c_open(k->bus, k->addr, k->flags);
+}
+
+/**
+ * Get a descriptor for the given bus and address.
+ * The descriptor must be returned with i2c_fd_put__().
+ */
+static int
+i2c_fd_get__(int bus, uint8_t addr, uint32_t flags)
+{
+    char key[32];
+    i2c_fd_key_t k;
+
+    if(flags & ONLP_I2C_F_NO_FD_CACHE) {
+        return onlp_i2c_open(bus, addr, flags);
+    }
+
+    k.bus = bus;
+    k.addr = addr;
+    k.flags = flags & I2C_FD_OPEN_FLAGS;
+    snprintf(key, sizeof(key), "%d:%x:%x", k.bus, k.addr, k.flags);
+    return onlplib_fd_cache_get(&i2c_fd_cache__, key, bus, i2c_fd_open__, &k);
+}
+
+/**
+ * Release a descriptor returned by i2c_fd_get__().
+ * Descriptors which saw a transaction error are closed
+ * rather than reused.
+ */
+static void
+i2c_fd_put__(int fd, int error)
+{
+    onlplib_fd_cache_put(&i2c_fd_cache__, fd, error);
+}
+
+void
+onlp_i2c_fd_cache_flush(int bus)
+{
+    onlplib_fd_cache_flush(&i2c_fd_cache__, bus);
+}
+
+#else
+
+static int
+i2c_fd_get__(int bus, uint8_t addr, uint32_t flags)
+{
+    return onlp_i2c_open(bus, addr, flags);
+}
+
+static void
+i2c_fd_put__(int fd, int error)
+{
+    close(fd);
+}
+
+void
+onlp_i2c_fd_cache_flush(int bus)
+{
+}
+
+#endif /* ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE */
+
+int
+onlp_i2c_root_bus_get(int bus)
+{
+    char path[64];
+    char* rpath;
+    char* s;
+    int root = bus;
+
+    /*
+     * Mux channel adapters are children of their parent adapter in
+     * the device tree, ie .../i2c-0/0-0070/i2c-18. The first adapter
+     * in the resolved path is the physical root.
+     */
+    snprintf(path, sizeof(path), "/sys/bus/i2c/devices/i2c-%d", bus);
+    if( (rpath = realpath(path, NULL)) == NULL) {
+        AIM_LOG_VERBOSE("realpath(%s): %{errno}", path, errno);
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    for(s = rpath; (s = strstr(s, "/i2c-")) != NULL; s++) {
+        if(sscanf(s, "/i2c-%d", &root) == 1) {
+            break;
+        }
+    }
+    free(rpath);
+    return root;
+}
+
+/**
+ * Adapter I2C_RDWR support, indexed by bus number.
+ * 0 = unknown, 1 = supported, -1 = unsupported.
+ */
+static int i2c_rdwr_support__[256];
+
+static int
+i2c_rdwr_supported__(int fd, int bus)
+{
+    unsigned long funcs = 0;
+    int supported;
+
+    if(bus >= 0 && bus < AIM_ARRAYSIZE(i2c_rdwr_support__) &&
+       i2c_rdwr_support__[bus]) {
+        return i2c_rdwr_support__[bus] > 0;
+    }
+
+    if(ioctl(fd, I2C_FUNCS, &funcs) == -1) {
+        AIM_LOG_VERBOSE("i2c-%d: I2C_FUNCS failed: %{errno}", bus, errno);
+        supported = 0;
+    }
+    else {
+        supported = (funcs & I2C_FUNC_I2C) ? 1 : 0;
+    }
+
+    if(bus >= 0 && bus < AIM_ARRAYSIZE(i2c_rdwr_support__)) {
+        i2c_rdwr_support__[bus] = (supported) ? 1 : -1;
+    }
+    return supported;
+}
+
+/**
+ * Read the given range in a single combined transaction.
+ *
+ * Returns ONLP_STATUS_E_UNSUPPORTED if the adapter cannot perform
+ * the transfer, in which case the caller should use the SMBUS methods.
+ */
+static int
+i2c_rdwr_read__(int fd, int bus, uint8_t addr, uint8_t offset, int size,
+                uint8_t* rdata, uint32_t flags)
+{
+    struct i2c_msg msgs[2];
+    struct i2c_rdwr_ioctl_data rdwr;
+    int retries, rv = -1;
+
+    if(flags & ONLP_I2C_F_PEC) {
+        /* PEC is an SMBUS concept. */
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    if(!i2c_rdwr_supported__(fd, bus)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    msgs[0].addr = addr;
+    msgs[0].flags = (flags & ONLP_I2C_F_TENBIT) ? I2C_M_TEN : 0;
+    msgs[0].len = 1;
+    msgs[0].buf = &offset;
+
+    msgs[1].addr = addr;
+    msgs[1].flags = msgs[0].flags | I2C_M_RD;
+    msgs[1].len = size;
+    msgs[1].buf = rdata;
+
+    rdwr.msgs = msgs;
+    rdwr.nmsgs = 2;
+
+    retries = (flags & ONLP_I2C_F_DISABLE_READ_RETRIES) ? 1 : ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT;
+    while(retries-- && rv < 0) {
+        rv = ioctl(fd, I2C_RDWR, &rdwr);
+        if(rv < 0 && (errno == EOPNOTSUPP || errno == EINVAL)) {
+            /*
+             * The adapter rejected the transfer itself (typically a
+             * message length quirk). Use the SMBUS methods from now on.
+             */
+            AIM_LOG_VERBOSE("i2c-%d: I2C_RDWR not usable: %{errno}", bus, errno);
+            if(bus >= 0 && bus < AIM_ARRAYSIZE(i2c_rdwr_support__)) {
+                i2c_rdwr_support__[bus] = -1;
+            }
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+    }
+
+    if(rv != 2) {
+        AIM_LOG_ERROR("i2c-%d: combined read address 0x%x, offset %d, size=%d failed: %{errno}",
+                      bus, addr, offset, size, errno);
+        return ONLP_STATUS_E_I2C;
+    }
+
+    return 0;
+}
+
 int
 onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
                     uint8_t* rdata, uint32_t flags)
 {
     int fd;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
     }
 
+    if(flags & ONLP_I2C_F_USE_RDWR) {
+        int rv = i2c_rdwr_read__(fd, bus, addr, offset, size, rdata, flags);
+        if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+            i2c_fd_put__(fd, rv < 0);
+            return rv;
+        }
+    }
+
     int count = size;
     uint8_t* p = rdata;
     while(count > 0) {
@@ -133,11 +350,11 @@ onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
         count -= rsize;
     }
 
-    close(fd);
+    i2c_fd_put__(fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_put__(fd, 1);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -148,12 +365,20 @@ onlp_i2c_read(int bus, uint8_t addr, uint8_t offset, int size,
     int i;
     int fd;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
     }
 
+    if(flags & ONLP_I2C_F_USE_RDWR) {
+        int rv = i2c_rdwr_read__(fd, bus, addr, offset, size, rdata, flags);
+        if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+            i2c_fd_put__(fd, rv < 0);
+            return rv;
+        }
+    }
+
     for(i = 0; i < size; i++) {
         int rv = -1;
         int retries = (flags & ONLP_I2C_F_DISABLE_READ_RETRIES) ? 1: ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT;
@@ -171,11 +396,11 @@ onlp_i2c_read(int bus, uint8_t addr, uint8_t offset, int size,
             rdata[i] = rv;
         }
     }
-    close(fd);
+    i2c_fd_put__(fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_put__(fd, 1);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -187,7 +412,7 @@ onlp_i2c_write(int bus, uint8_t addr, uint8_t offset, int size,
     int i;
     int fd;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -201,11 +426,11 @@ onlp_i2c_write(int bus, uint8_t addr, uint8_t offset, int size,
             goto error;
         }
     }
-    close(fd);
+    i2c_fd_put__(fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_put__(fd, 1);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -242,7 +467,7 @@ onlp_i2c_readw(int bus, uint8_t addr, uint8_t offset, uint32_t flags)
     int fd;
     int rv;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -250,7 +475,7 @@ onlp_i2c_readw(int bus, uint8_t addr, uint8_t offset, uint32_t flags)
 
     rv = i2c_smbus_read_word_data(fd, offset);
 
-    close(fd);
+    i2c_fd_put__(fd, rv < 0);
     return rv;
 }
 
@@ -261,7 +486,7 @@ onlp_i2c_writew(int bus, uint8_t addr, uint8_t offset, uint16_t word,
     int fd;
     int rv;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_get__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -269,7 +494,7 @@ onlp_i2c_writew(int bus, uint8_t addr, uint8_t offset, uint16_t word,
 
     rv = i2c_smbus_write_word_data(fd, offset, word);
 
-    close(fd);
+    i2c_fd_put__(fd, rv < 0);
     return rv;
 
 }
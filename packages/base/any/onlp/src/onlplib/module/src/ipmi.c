@@ -0,0 +1,542 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/ipmi.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+
+#include <onlp/onlp.h>
+#include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <linux/ipmi.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include "onlplib_log.h"
+
+/**
+ * All IPMI access is serialized. The BMC processes requests
+ * serially anyway; batching is what provides the speedup.
+ */
+static pthread_mutex_t ipmi_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static const onlp_ipmi_transport_t* ipmi_transport__ = NULL;
+static void* ipmi_cookie__ = NULL;
+
+
+/**************************************************************************
+ *
+ * OpenIPMI Device Transport
+ *
+ *************************************************************************/
+
+static const char* ipmi_dev_paths__[] = {
+    ONLPLIB_CONFIG_IPMI_DEVICE,
+    "/dev/ipmi0",
+    "/dev/ipmi/0",
+    "/dev/ipmidev/0",
+    NULL
+};
+
+/** The device is kept open across requests. */
+static int ipmi_dev_fd__ = -1;
+static long ipmi_dev_msgid__ = 0;
+
+static int
+ipmi_dev_open__(const char* path)
+{
+    int i;
+
+    if(ipmi_dev_fd__ >= 0) {
+        return ipmi_dev_fd__;
+    }
+
+    if(path) {
+        ipmi_dev_fd__ = open(path, O_RDWR | O_CLOEXEC);
+    }
+    else {
+        for(i = 0; ipmi_dev_paths__[i] && ipmi_dev_fd__ < 0; i++) {
+            ipmi_dev_fd__ = open(ipmi_dev_paths__[i], O_RDWR | O_CLOEXEC);
+        }
+    }
+
+    if(ipmi_dev_fd__ < 0) {
+        AIM_LOG_ERROR("ipmi: cannot open the IPMI device: %{errno}", errno);
+        return ONLP_STATUS_E_MISSING;
+    }
+    return ipmi_dev_fd__;
+}
+
+static void
+ipmi_dev_close__(void* cookie)
+{
+    if(ipmi_dev_fd__ >= 0) {
+        close(ipmi_dev_fd__);
+        ipmi_dev_fd__ = -1;
+    }
+}
+
+static int
+ipmi_dev_send__(int fd, onlp_ipmi_msg_t* msg, long msgid)
+{
+    struct ipmi_system_interface_addr bmc;
+    struct ipmi_req req;
+
+    memset(&bmc, 0, sizeof(bmc));
+    bmc.addr_type = IPMI_SYSTEM_INTERFACE_ADDR_TYPE;
+    bmc.channel = IPMI_BMC_CHANNEL;
+
+    memset(&req, 0, sizeof(req));
+    req.addr = (unsigned char*)&bmc;
+    req.addr_len = sizeof(bmc);
+    req.msgid = msgid;
+    req.msg.netfn = msg->netfn;
+    req.msg.cmd = msg->cmd;
+    req.msg.data = (unsigned char*)msg->data;
+    req.msg.data_len = msg->data_len;
+
+    if(ioctl(fd, IPMICTL_SEND_COMMAND, &req) < 0) {
+        AIM_LOG_ERROR("ipmi: send netfn 0x%x cmd 0x%x: %{errno}",
+                      msg->netfn, msg->cmd, errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+/**
+ * Receive one response.
+ * Returns the index of the request it completes, or -1.
+ */
+static int
+ipmi_dev_recv__(int fd, onlp_ipmi_msg_t* msgs, long base, int count)
+{
+    struct ipmi_addr addr;
+    struct ipmi_recv recv;
+    uint8_t data[IPMI_MAX_MSG_LENGTH];
+    onlp_ipmi_msg_t* msg;
+    int i, len;
+
+    memset(&recv, 0, sizeof(recv));
+    recv.addr = (unsigned char*)&addr;
+    recv.addr_len = sizeof(addr);
+    recv.msg.data = data;
+    recv.msg.data_len = sizeof(data);
+
+    if(ioctl(fd, IPMICTL_RECEIVE_MSG_TRUNC, &recv) < 0 && errno != EMSGSIZE) {
+        if(errno != EAGAIN && errno != EINTR) {
+            AIM_LOG_ERROR("ipmi: receive: %{errno}", errno);
+        }
+        return -1;
+    }
+
+    if(recv.recv_type != IPMI_RESPONSE_RECV_TYPE ||
+       recv.msgid < base || recv.msgid >= base + count) {
+        /* Events or a stale response from an earlier timed out batch. */
+        return -1;
+    }
+
+    i = recv.msgid - base;
+    msg = msgs + i;
+    if(recv.msg.data_len < 1) {
+        msg->status = ONLP_STATUS_E_INTERNAL;
+        return i;
+    }
+
+    msg->ccode = data[0];
+    len = recv.msg.data_len - 1;
+    if(len > msg->rsp_size) {
+        len = msg->rsp_size;
+    }
+    if(len > 0) {
+        memcpy(msg->rsp, data + 1, len);
+    }
+    msg->rsp_len = len;
+    msg->status = ONLP_STATUS_OK;
+    return i;
+}
+
+static int
+ipmi_dev_execute__(void* cookie, onlp_ipmi_msg_t* msgs, int count,
+                   int timeout_ms)
+{
+    int fd, i, sent, done;
+    long base;
+    uint64_t deadline;
+    char pending[ONLPLIB_CONFIG_IPMI_BATCH_MAX];
+
+    if((fd = ipmi_dev_open__((const char*)cookie)) < 0) {
+        return fd;
+    }
+
+    while(count > 0) {
+        /* Keep at most BATCH_MAX requests outstanding. */
+        int n = count < ONLPLIB_CONFIG_IPMI_BATCH_MAX ? count : ONLPLIB_CONFIG_IPMI_BATCH_MAX;
+
+        base = ipmi_dev_msgid__;
+        ipmi_dev_msgid__ += n;
+
+        for(i = 0, sent = 0; i < n; i++) {
+            msgs[i].status = ipmi_dev_send__(fd, msgs + i, base + i);
+            pending[i] = (msgs[i].status == 0);
+            sent += pending[i];
+        }
+
+        deadline = aim_time_monotonic() + timeout_ms*1000ULL;
+        for(done = 0; done < sent; ) {
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            uint64_t now = aim_time_monotonic();
+            int rv;
+
+            if(now >= deadline) {
+                break;
+            }
+            rv = poll(&pfd, 1, (deadline - now + 999) / 1000);
+            if(rv < 0 && errno != EINTR) {
+                AIM_LOG_ERROR("ipmi: poll: %{errno}", errno);
+                break;
+            }
+            if(rv <= 0) {
+                continue;
+            }
+            if((i = ipmi_dev_recv__(fd, msgs, base, n)) >= 0 && pending[i]) {
+                pending[i] = 0;
+                done++;
+            }
+        }
+
+        for(i = 0; i < n; i++) {
+            if(pending[i]) {
+                AIM_LOG_ERROR("ipmi: netfn 0x%x cmd 0x%x: no response after %d ms",
+                              msgs[i].netfn, msgs[i].cmd, timeout_ms);
+                msgs[i].status = ONLP_STATUS_E_INTERNAL;
+            }
+        }
+
+        msgs += n;
+        count -= n;
+    }
+    return 0;
+}
+
+const onlp_ipmi_transport_t onlp_ipmi_transport_dev = {
+    "dev",
+    ipmi_dev_execute__,
+    ipmi_dev_close__,
+};
+
+
+/**************************************************************************
+ *
+ * Domain Socket Transport
+ *
+ *************************************************************************/
+
+static int
+ipmi_uds_xfer__(int fd, void* buf, int len, int wr)
+{
+    uint8_t* p = buf;
+    while(len > 0) {
+        int rv = wr ? write(fd, p, len) : read(fd, p, len);
+        if(rv < 0 && errno == EINTR) {
+            continue;
+        }
+        if(rv <= 0) {
+            return -1;
+        }
+        p += rv;
+        len -= rv;
+    }
+    return 0;
+}
+
+static int
+ipmi_uds_execute__(void* cookie, onlp_ipmi_msg_t* msgs, int count,
+                   int timeout_ms)
+{
+    int fd, i;
+    struct sockaddr_un addr;
+    struct timeval tv;
+    const char* path = (const char*)cookie;
+
+    if(path == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    aim_strlcpy(addr.sun_path, path, sizeof(addr.sun_path));
+    if(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        AIM_LOG_ERROR("ipmi: connect(%s): %{errno}", path, errno);
+        close(fd);
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    /* Send the whole batch, then collect the responses in order. */
+    for(i = 0; i < count; i++) {
+        uint8_t hdr[3] = { msgs[i].netfn, msgs[i].cmd, msgs[i].data_len };
+        msgs[i].status = ONLP_STATUS_E_INTERNAL;
+        if(ipmi_uds_xfer__(fd, hdr, sizeof(hdr), 1) < 0 ||
+           ipmi_uds_xfer__(fd, (void*)msgs[i].data, msgs[i].data_len, 1) < 0) {
+            count = i;
+            break;
+        }
+    }
+    shutdown(fd, SHUT_WR);
+
+    for(i = 0; i < count; i++) {
+        uint8_t hdr[2];
+        uint8_t data[ONLP_IPMI_DATA_MAX];
+        int len;
+
+        if(ipmi_uds_xfer__(fd, hdr, sizeof(hdr), 0) < 0 ||
+           ipmi_uds_xfer__(fd, data, hdr[1], 0) < 0) {
+            break;
+        }
+        msgs[i].ccode = hdr[0];
+        len = hdr[1] < msgs[i].rsp_size ? hdr[1] : msgs[i].rsp_size;
+        if(len > 0) {
+            memcpy(msgs[i].rsp, data, len);
+        }
+        msgs[i].rsp_len = len;
+        msgs[i].status = ONLP_STATUS_OK;
+    }
+
+    close(fd);
+    return 0;
+}
+
+const onlp_ipmi_transport_t onlp_ipmi_transport_uds = {
+    "uds",
+    ipmi_uds_execute__,
+    NULL,
+};
+
+
+/**************************************************************************
+ *
+ * Public API
+ *
+ *************************************************************************/
+
+static void
+ipmi_transport_default__(void)
+{
+    char* sock = getenv("ONLP_IPMI_SOCKET");
+    if(sock && *sock) {
+        ipmi_transport__ = &onlp_ipmi_transport_uds;
+        ipmi_cookie__ = sock;
+    }
+    else {
+        ipmi_transport__ = &onlp_ipmi_transport_dev;
+        ipmi_cookie__ = NULL;
+    }
+}
+
+int
+onlp_ipmi_transport_set(const onlp_ipmi_transport_t* transport, void* cookie)
+{
+    pthread_mutex_lock(&ipmi_lock__);
+    if(ipmi_transport__ && ipmi_transport__->close) {
+        ipmi_transport__->close(ipmi_cookie__);
+    }
+    if(transport) {
+        ipmi_transport__ = transport;
+        ipmi_cookie__ = cookie;
+    }
+    else {
+        ipmi_transport_default__();
+    }
+    pthread_mutex_unlock(&ipmi_lock__);
+    return 0;
+}
+
+int
+onlp_ipmi_execute(onlp_ipmi_msg_t* msgs, int count)
+{
+    int i, rv, ok = 0;
+
+    if(msgs == NULL || count < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    for(i = 0; i < count; i++) {
+        if(msgs[i].data_len < 0 || msgs[i].data_len > ONLP_IPMI_DATA_MAX ||
+           (msgs[i].data_len && msgs[i].data == NULL) ||
+           (msgs[i].rsp_size && msgs[i].rsp == NULL)) {
+            return ONLP_STATUS_E_PARAM;
+        }
+        msgs[i].rsp_len = 0;
+        msgs[i].ccode = 0;
+        msgs[i].status = ONLP_STATUS_E_INTERNAL;
+    }
+
+    pthread_mutex_lock(&ipmi_lock__);
+    if(ipmi_transport__ == NULL) {
+        ipmi_transport_default__();
+    }
+    rv = ipmi_transport__->execute(ipmi_cookie__, msgs, count,
+                                   ONLPLIB_CONFIG_IPMI_TIMEOUT_MS);
+    pthread_mutex_unlock(&ipmi_lock__);
+
+    if(ONLP_FAILURE(rv)) {
+        return rv;
+    }
+    for(i = 0; i < count; i++) {
+        if(ONLP_SUCCESS(msgs[i].status) && msgs[i].ccode == ONLP_IPMI_CC_OK) {
+            ok++;
+        }
+    }
+    return ok;
+}
+
+int
+onlp_ipmi_cmd(uint8_t netfn, uint8_t cmd, const uint8_t* data, int len,
+              uint8_t* rsp, int rsp_size)
+{
+    int rv;
+    onlp_ipmi_msg_t msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.netfn = netfn;
+    msg.cmd = cmd;
+    msg.data = data;
+    msg.data_len = len;
+    msg.rsp = rsp;
+    msg.rsp_size = rsp_size;
+
+    if(ONLP_FAILURE(rv = onlp_ipmi_execute(&msg, 1))) {
+        return rv;
+    }
+    if(ONLP_FAILURE(msg.status)) {
+        return msg.status;
+    }
+    if(msg.ccode != ONLP_IPMI_CC_OK) {
+        AIM_LOG_VERBOSE("ipmi: netfn 0x%x cmd 0x%x: completion code 0x%x",
+                        netfn, cmd, msg.ccode);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return msg.rsp_len;
+}
+
+int
+onlp_ipmi_master_write_read(uint8_t bus, uint8_t addr,
+                            const uint8_t* wdata, int wlen,
+                            uint8_t* rdata, int rlen)
+{
+    int rv;
+    uint8_t req[ONLP_IPMI_DATA_MAX];
+
+    if(wlen < 0 || wlen > sizeof(req) - 3 || rlen < 0 || rlen > ONLP_IPMI_DATA_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    req[0] = bus;
+    req[1] = addr << 1;
+    req[2] = rlen;
+    if(wlen) {
+        memcpy(req + 3, wdata, wlen);
+    }
+
+    rv = onlp_ipmi_cmd(ONLP_IPMI_NETFN_APP, 0x52, req, 3 + wlen, rdata, rlen);
+    if(rv < 0) {
+        return ONLP_STATUS_E_I2C;
+    }
+    return (rv == rlen) ? 0 : ONLP_STATUS_E_I2C;
+}
+
+int
+onlp_ipmi_oem_i2c_read(uint8_t netfn, uint8_t cmd, int bus, uint8_t addr,
+                       uint8_t offset, uint8_t* dst, int len)
+{
+    int rv;
+    uint8_t req[4] = { bus, addr, offset, len };
+
+    if(len <= 0 || len > ONLP_IPMI_DATA_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    rv = onlp_ipmi_cmd(netfn, cmd, req, sizeof(req), dst, len);
+    if(rv < 0) {
+        return ONLP_STATUS_E_I2C;
+    }
+    return (rv == len) ? 0 : ONLP_STATUS_E_I2C;
+}
+
+int
+onlp_ipmi_oem_i2c_write(uint8_t netfn, uint8_t cmd, int bus, uint8_t addr,
+                        uint8_t offset, const uint8_t* src, int len)
+{
+    uint8_t req[ONLP_IPMI_DATA_MAX];
+
+    if(len <= 0 || len > sizeof(req) - 4) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    req[0] = bus;
+    req[1] = addr;
+    req[2] = offset;
+    req[3] = len;
+    memcpy(req + 4, src, len);
+
+    if(onlp_ipmi_cmd(netfn, cmd, req, 4 + len, NULL, 0) < 0) {
+        return ONLP_STATUS_E_I2C;
+    }
+    return 0;
+}
+
+int
+onlp_ipmi_sensor_reading_get(uint8_t sensor, uint8_t* raw, uint8_t* status)
+{
+    int rv;
+    uint8_t rsp[4];
+
+    if(raw == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    rv = onlp_ipmi_cmd(ONLP_IPMI_NETFN_SENSOR, 0x2D, &sensor, 1,
+                       rsp, sizeof(rsp));
+    if(rv < 0) {
+        return rv;
+    }
+    if(rv < 2 || (rsp[1] & 0x20)) {
+        /* Reading/state unavailable */
+        return ONLP_STATUS_E_MISSING;
+    }
+    *raw = rsp[0];
+    if(status) {
+        *status = rsp[1];
+    }
+    return 0;
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_IPMI */
@@ -0,0 +1,518 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/ipmi_sdr.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+
+#include <onlp/onlp.h>
+#include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include <pthread.h>
+#include "onlplib_log.h"
+
+/** Storage commands */
+#define SDR_CMD_REPOSITORY_INFO 0x20
+#define SDR_CMD_RESERVE         0x22
+#define SDR_CMD_GET             0x23
+/** Sensor commands */
+#define SDR_CMD_SENSOR_READING  0x2D
+
+/** Reservation cancelled */
+#define SDR_CC_RESERVATION      0xC5
+
+#define SDR_RECORD_FULL         0x01
+#define SDR_RECORD_COMPACT      0x02
+#define SDR_RECORD_HDR_SIZE     5
+#define SDR_RECORD_SIZE_MAX     (SDR_RECORD_HDR_SIZE + 255)
+
+/** Bytes per Get SDR request. Small reads are supported by every BMC. */
+#define SDR_READ_CHUNK          16
+
+#define SDR_RECORD_ID_LAST      0xFFFF
+
+/** Sensors owned by the BMC can be read with Get Sensor Reading. */
+#define SDR_OWNER_BMC           0x20
+
+typedef struct sdr_sensor_s {
+    char name[17];
+    uint8_t record_type;
+    uint8_t owner;
+    uint8_t number;
+    uint8_t sensor_type;
+    /** Analog data format from the unit field (bits 7:6). */
+    uint8_t format;
+
+    /** y = (M*x + B*10^bexp) * 10^rexp */
+    int m;
+    int b;
+    int bexp;
+    int rexp;
+
+    /** Last reading */
+    uint8_t raw;
+    uint8_t status;
+    int valid;
+} sdr_sensor_t;
+
+static struct {
+    pthread_mutex_t lock;
+    sdr_sensor_t sensors[ONLPLIB_CONFIG_IPMI_SDR_SENSORS_MAX];
+    int count;
+    int loaded;
+
+    /** Repository timestamps of the cached records. */
+    uint32_t addition;
+    uint32_t erase;
+
+    uint64_t checked;
+    uint64_t read;
+
+    uint64_t reading_usecs;
+    uint64_t check_usecs;
+} sdr__ = {
+    PTHREAD_MUTEX_INITIALIZER,
+    .reading_usecs = ONLPLIB_CONFIG_IPMI_SDR_READING_USECS,
+    .check_usecs = ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS,
+};
+
+#define LE16(_p) ((_p)[0] | ((_p)[1] << 8))
+#define LE32(_p) ((uint32_t)LE16(_p) | ((uint32_t)LE16((_p)+2) << 16))
+
+/** Sign extend an n-bit value. */
+static int
+sdr_sext__(int v, int bits)
+{
+    int m = 1 << (bits - 1);
+    v &= (1 << bits) - 1;
+    return (v ^ m) - m;
+}
+
+static int
+sdr_repository_info__(uint32_t* addition, uint32_t* erase)
+{
+    uint8_t rsp[14];
+    int rv = onlp_ipmi_cmd(ONLP_IPMI_NETFN_STORAGE, SDR_CMD_REPOSITORY_INFO,
+                           NULL, 0, rsp, sizeof(rsp));
+    if(rv < 0) {
+        return rv;
+    }
+    if(rv < 13) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    *addition = LE32(rsp + 5);
+    *erase = LE32(rsp + 9);
+    return 0;
+}
+
+static int
+sdr_reserve__(uint16_t* reservation)
+{
+    uint8_t rsp[2];
+    int rv = onlp_ipmi_cmd(ONLP_IPMI_NETFN_STORAGE, SDR_CMD_RESERVE,
+                           NULL, 0, rsp, sizeof(rsp));
+    if(rv < 0) {
+        return rv;
+    }
+    if(rv < 2) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    *reservation = LE16(rsp);
+    return 0;
+}
+
+/**
+ * Read one complete record.
+ * The body is requested in a single batch of partial reads.
+ */
+static int
+sdr_record_get__(uint16_t reservation, uint16_t id, uint16_t* next,
+                 uint8_t* record, int* length)
+{
+    onlp_ipmi_msg_t msgs[(SDR_RECORD_SIZE_MAX + SDR_READ_CHUNK - 1) / SDR_READ_CHUNK];
+    uint8_t reqs[AIM_ARRAYSIZE(msgs)][6];
+    uint8_t rsps[AIM_ARRAYSIZE(msgs)][2 + SDR_READ_CHUNK];
+    int i, n, offset, size;
+
+    memset(msgs, 0, sizeof(msgs));
+
+    /* Header first. It gives the record length. */
+    n = 0;
+    offset = 0;
+    size = SDR_RECORD_HDR_SIZE;
+    for(;;) {
+        int count = n;
+        while(offset < size) {
+            int len = size - offset < SDR_READ_CHUNK ? size - offset : SDR_READ_CHUNK;
+            uint8_t* req = reqs[count];
+            req[0] = reservation & 0xff;
+            req[1] = reservation >> 8;
+            req[2] = id & 0xff;
+            req[3] = id >> 8;
+            req[4] = offset;
+            req[5] = len;
+            msgs[count].netfn = ONLP_IPMI_NETFN_STORAGE;
+            msgs[count].cmd = SDR_CMD_GET;
+            msgs[count].data = req;
+            msgs[count].data_len = 6;
+            msgs[count].rsp = rsps[count];
+            msgs[count].rsp_size = 2 + len;
+            offset += len;
+            count++;
+        }
+
+        if(count > n) {
+            int rv = onlp_ipmi_execute(msgs + n, count - n);
+            if(rv < 0) {
+                return rv;
+            }
+            for(i = n; i < count; i++) {
+                if(ONLP_FAILURE(msgs[i].status)) {
+                    return msgs[i].status;
+                }
+                if(msgs[i].ccode == SDR_CC_RESERVATION) {
+                    return SDR_CC_RESERVATION;
+                }
+                if(msgs[i].ccode != ONLP_IPMI_CC_OK ||
+                   msgs[i].rsp_len != msgs[i].rsp_size) {
+                    return ONLP_STATUS_E_INTERNAL;
+                }
+                memcpy(record + msgs[i].data[4], rsps[i] + 2, msgs[i].rsp_len - 2);
+            }
+            *next = LE16(rsps[n]);
+            n = count;
+        }
+
+        if(size == SDR_RECORD_HDR_SIZE) {
+            size += record[4];
+            if(size == SDR_RECORD_HDR_SIZE) {
+                break;
+            }
+            continue;
+        }
+        break;
+    }
+
+    *length = size;
+    return 0;
+}
+
+/**
+ * Add a full or compact sensor record to the cache.
+ */
+static void
+sdr_record_parse__(const uint8_t* r, int length, sdr_sensor_t* s)
+{
+    int idlen, idofs;
+
+    memset(s, 0, sizeof(*s));
+    s->record_type = r[3];
+    s->owner = r[5];
+    s->number = r[7];
+    s->sensor_type = r[12];
+    s->format = r[20] >> 6;
+
+    if(s->record_type == SDR_RECORD_FULL) {
+        s->m = sdr_sext__(r[24] | ((r[25] & 0xc0) << 2), 10);
+        s->b = sdr_sext__(r[26] | ((r[27] & 0xc0) << 2), 10);
+        s->rexp = sdr_sext__(r[29] >> 4, 4);
+        s->bexp = sdr_sext__(r[29] & 0x0f, 4);
+        idofs = 47;
+    }
+    else {
+        /* Compact records have no conversion factors. */
+        s->m = 1;
+        idofs = 31;
+    }
+
+    if(idofs < length) {
+        idlen = r[idofs] & 0x1f;
+        if(idofs + 1 + idlen > length) {
+            idlen = length - idofs - 1;
+        }
+        if(idlen > sizeof(s->name) - 1) {
+            idlen = sizeof(s->name) - 1;
+        }
+        memcpy(s->name, r + idofs + 1, idlen);
+        s->name[idlen] = 0;
+    }
+}
+
+static int
+sdr_load__(void)
+{
+    uint16_t reservation, id, next;
+    uint8_t record[SDR_RECORD_SIZE_MAX];
+    int length, rv, retries = 0;
+
+    sdr__.count = 0;
+    sdr__.loaded = 0;
+
+    if((rv = sdr_reserve__(&reservation)) < 0) {
+        return rv;
+    }
+
+    for(id = 0; id != SDR_RECORD_ID_LAST; id = next) {
+        rv = sdr_record_get__(reservation, id, &next, record, &length);
+        if(rv == SDR_CC_RESERVATION && retries++ < 8) {
+            /* The repository changed under us. Start over. */
+            sdr__.count = 0;
+            next = 0;
+            if((rv = sdr_reserve__(&reservation)) < 0) {
+                return rv;
+            }
+            continue;
+        }
+        if(rv != 0) {
+            AIM_LOG_ERROR("ipmi sdr: record 0x%x: %{onlp_status}", id, rv);
+            return (rv > 0) ? ONLP_STATUS_E_INTERNAL : rv;
+        }
+
+        if((record[3] == SDR_RECORD_FULL || record[3] == SDR_RECORD_COMPACT) &&
+           length > 31) {
+            if(sdr__.count >= AIM_ARRAYSIZE(sdr__.sensors)) {
+                AIM_LOG_WARN("ipmi sdr: more than %d sensors; the rest are ignored.",
+                             AIM_ARRAYSIZE(sdr__.sensors));
+                break;
+            }
+            sdr_record_parse__(record, length, sdr__.sensors + sdr__.count++);
+        }
+    }
+
+    sdr__.loaded = 1;
+    sdr__.read = 0;
+    return 0;
+}
+
+/**
+ * Reload the repository if it has changed (or was never loaded).
+ */
+static int
+sdr_validate__(uint64_t now)
+{
+    uint32_t addition, erase;
+    int rv;
+
+    if(sdr__.loaded && now - sdr__.checked < sdr__.check_usecs) {
+        return 0;
+    }
+
+    rv = sdr_repository_info__(&addition, &erase);
+    if(rv < 0) {
+        /* Keep serving the old records if we have them. */
+        return sdr__.loaded ? 0 : rv;
+    }
+    sdr__.checked = now;
+
+    if(sdr__.loaded && addition == sdr__.addition && erase == sdr__.erase) {
+        return 0;
+    }
+
+    if((rv = sdr_load__()) < 0) {
+        return rv;
+    }
+    sdr__.addition = addition;
+    sdr__.erase = erase;
+    return 0;
+}
+
+/**
+ * Collect the readings of all BMC sensors in one batch.
+ */
+static void
+sdr_readings_update__(uint64_t now)
+{
+    onlp_ipmi_msg_t* msgs;
+    uint8_t (*rsps)[4];
+    int i, n = 0;
+
+    if(now - sdr__.read < sdr__.reading_usecs && sdr__.read) {
+        return;
+    }
+
+    msgs = aim_zmalloc(sizeof(*msgs) * (sdr__.count + 1));
+    rsps = aim_zmalloc(sizeof(*rsps) * (sdr__.count + 1));
+
+    for(i = 0; i < sdr__.count; i++) {
+        sdr_sensor_t* s = sdr__.sensors + i;
+        s->valid = 0;
+        if(s->owner != SDR_OWNER_BMC) {
+            continue;
+        }
+        msgs[n].netfn = ONLP_IPMI_NETFN_SENSOR;
+        msgs[n].cmd = SDR_CMD_SENSOR_READING;
+        msgs[n].data = &s->number;
+        msgs[n].data_len = 1;
+        msgs[n].rsp = rsps[n];
+        msgs[n].rsp_size = sizeof(rsps[n]);
+        n++;
+    }
+
+    if(n > 0 && onlp_ipmi_execute(msgs, n) >= 0) {
+        for(i = 0, n = 0; i < sdr__.count; i++) {
+            sdr_sensor_t* s = sdr__.sensors + i;
+            onlp_ipmi_msg_t* m;
+            if(s->owner != SDR_OWNER_BMC) {
+                continue;
+            }
+            m = msgs + n++;
+            if(ONLP_SUCCESS(m->status) && m->ccode == ONLP_IPMI_CC_OK &&
+               m->rsp_len >= 2 && !(m->rsp[1] & 0x20)) {
+                s->raw = m->rsp[0];
+                s->status = m->rsp[1];
+                s->valid = 1;
+            }
+        }
+    }
+
+    aim_free(msgs);
+    aim_free(rsps);
+    sdr__.read = now;
+}
+
+static sdr_sensor_t*
+sdr_find__(const char* name)
+{
+    int i;
+    for(i = 0; i < sdr__.count; i++) {
+        if(!strcmp(sdr__.sensors[i].name, name)) {
+            return sdr__.sensors + i;
+        }
+    }
+    for(i = 0; i < sdr__.count; i++) {
+        if(strstr(sdr__.sensors[i].name, name)) {
+            return sdr__.sensors + i;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Scale v by 10^exp, rounding to the nearest integer.
+ */
+static int64_t
+sdr_scale__(int64_t v, int exp)
+{
+    for(; exp > 0; exp--) {
+        v *= 10;
+    }
+    if(exp < 0) {
+        int64_t d = 1;
+        for(; exp < 0; exp++) {
+            d *= 10;
+        }
+        v = (v + ((v < 0) ? -d : d) / 2) / d;
+    }
+    return v;
+}
+
+static int
+sdr_convert__(sdr_sensor_t* s)
+{
+    int x;
+
+    switch(s->format)
+        {
+        case 1: x = (s->raw & 0x80) ? -(int)(~s->raw & 0x7f) : s->raw; break;
+        case 2: x = (int8_t)s->raw; break;
+        default: x = s->raw; break;
+        }
+
+    /* Work in thousandths: y * 1000 = (M*x*1000 + B*10^(bexp+3)) * 10^rexp */
+    return (int)sdr_scale__((int64_t)s->m * x * 1000 +
+                            sdr_scale__(s->b, s->bexp + 3), s->rexp);
+}
+
+void
+onlp_ipmi_sdr_age_set(uint64_t reading_usecs, uint64_t check_usecs)
+{
+    pthread_mutex_lock(&sdr__.lock);
+    sdr__.reading_usecs = reading_usecs;
+    sdr__.check_usecs = check_usecs;
+    pthread_mutex_unlock(&sdr__.lock);
+}
+
+void
+onlp_ipmi_sdr_invalidate(void)
+{
+    pthread_mutex_lock(&sdr__.lock);
+    sdr__.loaded = 0;
+    sdr__.count = 0;
+    sdr__.read = 0;
+    pthread_mutex_unlock(&sdr__.lock);
+}
+
+int
+onlp_ipmi_sdr_reading_get(const char* name, int* value)
+{
+    int rv;
+    sdr_sensor_t* s;
+    uint64_t now = aim_time_monotonic();
+
+    if(name == NULL || value == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&sdr__.lock);
+    if((rv = sdr_validate__(now)) == 0) {
+        sdr_readings_update__(now);
+        if((s = sdr_find__(name)) == NULL || !s->valid) {
+            rv = ONLP_STATUS_E_MISSING;
+        }
+        else {
+            *value = sdr_convert__(s);
+        }
+    }
+    pthread_mutex_unlock(&sdr__.lock);
+    return rv;
+}
+
+int
+onlp_ipmi_sdr_show(aim_pvs_t* pvs)
+{
+    int i, rv;
+    uint64_t now = aim_time_monotonic();
+
+    pthread_mutex_lock(&sdr__.lock);
+    if((rv = sdr_validate__(now)) == 0) {
+        sdr_readings_update__(now);
+        aim_printf(pvs, "Num   Type  Owner  Name              Raw   Value\n");
+        for(i = 0; i < sdr__.count; i++) {
+            sdr_sensor_t* s = sdr__.sensors + i;
+            if(s->valid) {
+                aim_printf(pvs, "0x%02x  0x%02x  0x%02x   %-16s  0x%02x  %d\n",
+                           s->number, s->sensor_type, s->owner, s->name,
+                           s->raw, sdr_convert__(s));
+            }
+            else {
+                aim_printf(pvs, "0x%02x  0x%02x  0x%02x   %-16s  -     -\n",
+                           s->number, s->sensor_type, s->owner, s->name);
+            }
+        }
+    }
+    pthread_mutex_unlock(&sdr__.lock);
+    return rv;
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_IPMI */
@@ -80,6 +80,126 @@ onlplib_config_settings_t onlplib_config_settings[] =
 #else
 { ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE) },
+#else
+{ ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE) },
+#else
+{ ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE) },
+#else
+{ ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_FD_CACHE_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_FD_CACHE_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_FD_CACHE_SIZE) },
+#else
+{ ONLPLIB_CONFIG_FILE_FD_CACHE_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE) },
+#else
+{ ONLPLIB_CONFIG_FILE_INCLUDE_FIND_CACHE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_FIND_CACHE_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_FIND_CACHE_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_FIND_CACHE_SIZE) },
+#else
+{ ONLPLIB_CONFIG_FILE_FIND_CACHE_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_FIND_NEGATIVE_USECS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_FIND_NEGATIVE_USECS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_FIND_NEGATIVE_USECS) },
+#else
+{ ONLPLIB_CONFIG_FILE_FIND_NEGATIVE_USECS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT) },
+#else
+{ ONLPLIB_CONFIG_FILE_FIND_CACHE_UEVENT(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_INCLUDE_IPMI
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_IPMI), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_IPMI) },
+#else
+{ ONLPLIB_CONFIG_INCLUDE_IPMI(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_DEVICE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_DEVICE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_DEVICE) },
+#else
+{ ONLPLIB_CONFIG_IPMI_DEVICE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_TIMEOUT_MS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_TIMEOUT_MS) },
+#else
+{ ONLPLIB_CONFIG_IPMI_TIMEOUT_MS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_BATCH_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_BATCH_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_BATCH_MAX) },
+#else
+{ ONLPLIB_CONFIG_IPMI_BATCH_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_SDR_READING_USECS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_SDR_READING_USECS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_SDR_READING_USECS) },
+#else
+{ ONLPLIB_CONFIG_IPMI_SDR_READING_USECS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS) },
+#else
+{ ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_SDR_SENSORS_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_SDR_SENSORS_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_SDR_SENSORS_MAX) },
+#else
+{ ONLPLIB_CONFIG_IPMI_SDR_SENSORS_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_INCLUDE_BMC_TTY
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_BMC_TTY), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_BMC_TTY) },
+#else
+{ ONLPLIB_CONFIG_INCLUDE_BMC_TTY(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE) },
+#else
+{ ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_TTY_BATCH_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_TTY_BATCH_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_TTY_BATCH_MAX) },
+#else
+{ ONLPLIB_CONFIG_BMC_TTY_BATCH_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES) },
+#else
+{ ONLPLIB_CONFIG_BMC_TTY_CACHE_ENTRIES(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_TTY_CACHE_OUTPUT_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_TTY_CACHE_OUTPUT_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_TTY_CACHE_OUTPUT_MAX) },
+#else
+{ ONLPLIB_CONFIG_BMC_TTY_CACHE_OUTPUT_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_INCLUDE_DEVPOOL
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_DEVPOOL), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_DEVPOOL) },
+#else
+{ ONLPLIB_CONFIG_INCLUDE_DEVPOOL(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS) },
+#else
+{ ONLPLIB_CONFIG_DEVPOOL_CACHE_USECS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD) },
+#else
+{ ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_DEVPOOL_ERROR_HOLDOFF_USECS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_DEVPOOL_ERROR_HOLDOFF_USECS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_DEVPOOL_ERROR_HOLDOFF_USECS) },
+#else
+{ ONLPLIB_CONFIG_DEVPOOL_ERROR_HOLDOFF_USECS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER
     { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER) },
 #else
@@ -24,16 +24,949 @@
  ***********************************************************/
 
 #include <onlplib/onlplib_config.h>
+#include <onlplib/devpool.h>
+#include <onlplib/bmc_tty.h>
+#include <onlplib/file.h>
+#include <onlplib/ipmi_sdr.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include <onlp/onlp.h>
+
+#define CHECK(_expr)                                                    \
+    do {                                                                \
+        if(!(_expr)) {                                                  \
+            AIM_DIE("%s:%d: check failed: %s", __FILE__, __LINE__, #_expr); \
+        }                                                               \
+    } while(0)
+
+#if ONLPLIB_CONFIG_INCLUDE_DEVPOOL == 1
+
+/**
+ * Device pool: chip decoding.
+ */
+static void
+devpool_decode_test(void)
+{
+    uint8_t regs[ONLP_DEVPOOL_WINDOW_MAX];
+    int mc, rpm;
+
+    /* TMP75: 25.5C and -25C */
+    memset(regs, 0, sizeof(regs));
+    regs[0] = 0x19; regs[1] = 0x80;
+    CHECK(onlp_devpool_driver_tmp75.temp(regs, 0, &mc) == 0 && mc == 25500);
+    regs[0] = 0xE7; regs[1] = 0x00;
+    CHECK(onlp_devpool_driver_tmp75.temp(regs, 0, &mc) == 0 && mc == -25000);
+    CHECK(onlp_devpool_driver_tmp75.temp(regs, 1, &mc) < 0);
+
+    /* TMP461: local is 0x00/0x15, remote is 0x01/0x10 */
+    memset(regs, 0, sizeof(regs));
+    regs[0x00] = 0x28; regs[0x15] = 0x40;
+    regs[0x01] = 0xE7; regs[0x10] = 0x00;
+    CHECK(onlp_devpool_driver_tmp461.temp(regs, 0, &mc) == 0 && mc == 40250);
+    CHECK(onlp_devpool_driver_tmp461.temp(regs, 1, &mc) == 0 && mc == -25000);
+    CHECK(onlp_devpool_driver_tmp461.temp(regs, 2, &mc) < 0);
+
+    /* EMC2305: channel 1 at 0x4E/0x4F, stalled reads as 0 */
+    memset(regs, 0, sizeof(regs));
+    regs[0x4E] = (1310 << 3) >> 8; regs[0x4F] = (1310 << 3) & 0xFF;
+    CHECK(onlp_devpool_driver_emc2305.rpm(regs, 1, &rpm) == 0 && rpm == 6003);
+    regs[0x4E] = 0xFF; regs[0x4F] = 0xF8;
+    CHECK(onlp_devpool_driver_emc2305.rpm(regs, 1, &rpm) == 0 && rpm == 0);
+    CHECK(onlp_devpool_driver_emc2305.rpm(regs, 5, &rpm) < 0);
+}
+
+/*
+ * PMBus window layout, see devpool.c.
+ */
+#define PMBUS_WORD_SET(_regs, _cmd, _word)                      \
+    do {                                                        \
+        (_regs)[2 * ((_cmd) - 0x80)] = (_word) & 0xFF;          \
+        (_regs)[2 * ((_cmd) - 0x80) + 1] = ((_word) >> 8) & 0xFF; \
+    } while(0)
+
+#define LINEAR11(_exp, _mantissa) \
+    ((((_exp) & 0x1F) << 11) | ((_mantissa) & 0x7FF))
+
+/**
+ * Device pool: PMBus linear11/linear16 decoding.
+ */
+static void
+devpool_pmbus_test(void)
+{
+    uint8_t regs[ONLP_DEVPOOL_WINDOW_MAX];
+    onlp_psu_info_t info;
+    int rpm;
+
+    memset(regs, 0, sizeof(regs));
+    /* VOUT_MODE linear, exponent -9 */
+    regs[0] = 0x17;
+    /* All seven readings valid */
+    regs[1] = 0x7F;
+    PMBUS_WORD_SET(regs, 0x88, LINEAR11(-1, 460));      /* VIN 230V */
+    PMBUS_WORD_SET(regs, 0x89, LINEAR11(-2, 9));        /* IIN 2.25A */
+    PMBUS_WORD_SET(regs, 0x8B, 0x1800);                 /* VOUT 12V */
+    PMBUS_WORD_SET(regs, 0x8C, LINEAR11(-2, -4));       /* IOUT -1A */
+    PMBUS_WORD_SET(regs, 0x90, LINEAR11(2, 1000));      /* FAN 4000rpm */
+    PMBUS_WORD_SET(regs, 0x96, LINEAR11(1, 300));       /* POUT 600W */
+    PMBUS_WORD_SET(regs, 0x97, LINEAR11(0, 650));       /* PIN 650W */
+    regs[0x80] = 4; memcpy(regs + 0x81, "PSU1", 4);
+    regs[0xC0] = 3; memcpy(regs + 0xC1, "SN7", 3);
+
+    memset(&info, 0, sizeof(info));
+    CHECK(onlp_devpool_driver_pmbus.psu(regs, &info) == 0);
+    CHECK(info.mvin == 230000);
+    CHECK(info.miin == 2250);
+    CHECK(info.mvout == 12000);
+    CHECK(info.miout == -1000);
+    CHECK(info.mpout == 600000);
+    CHECK(info.mpin == 650000);
+    CHECK(!strcmp(info.model, "PSU1"));
+    CHECK(!strcmp(info.serial, "SN7"));
+    CHECK(info.caps == (ONLP_PSU_CAPS_GET_VIN | ONLP_PSU_CAPS_GET_IIN |
+                        ONLP_PSU_CAPS_GET_VOUT | ONLP_PSU_CAPS_GET_IOUT |
+                        ONLP_PSU_CAPS_GET_POUT | ONLP_PSU_CAPS_GET_PIN));
+    CHECK(onlp_devpool_driver_pmbus.rpm(regs, 0, &rpm) == 0 && rpm == 4000);
+
+    /* Readings which failed and non-linear VOUT modes are not reported. */
+    regs[0] = 0x40;
+    regs[1] = 0x05;
+    memset(&info, 0, sizeof(info));
+    CHECK(onlp_devpool_driver_pmbus.psu(regs, &info) == 0);
+    CHECK(info.caps == ONLP_PSU_CAPS_GET_VIN);
+    CHECK(onlp_devpool_driver_pmbus.rpm(regs, 0, &rpm) < 0);
+}
+
+static int utest_refresh_rv__;
+static int utest_refresh_calls__;
+
+static int
+utest_refresh__(onlp_devpool_dev_t* dev, uint8_t* regs)
+{
+    utest_refresh_calls__++;
+    if(utest_refresh_rv__ >= 0) {
+        regs[0] = 0x19;
+        regs[1] = 0x80;
+    }
+    return utest_refresh_rv__;
+}
+
+/**
+ * Device pool: caching and error holdoff.
+ */
+static void
+devpool_holdoff_test(void)
+{
+    int i;
+    onlp_thermal_info_t ti;
+    onlp_devpool_driver_t driver = onlp_devpool_driver_tmp75;
+    onlp_devpool_dev_t dev;
+
+    driver.name = "utest";
+    driver.refresh = utest_refresh__;
+    memset(&dev, 0, sizeof(dev));
+    dev.driver = &driver;
+
+    /* Served from the cache until invalidated. */
+    utest_refresh_rv__ = 0;
+    CHECK(onlp_devpool_thermal_info_get(&dev, 0, &ti) == 0);
+    CHECK(ti.mcelsius == 25500 && utest_refresh_calls__ == 1);
+    CHECK(onlp_devpool_thermal_info_get(&dev, 0, &ti) == 0);
+    CHECK(utest_refresh_calls__ == 1);
+    onlp_devpool_invalidate(&dev);
+    CHECK(dev.state.regs[0] == 0);
+    CHECK(onlp_devpool_thermal_info_get(&dev, 0, &ti) == 0);
+    CHECK(utest_refresh_calls__ == 2);
+
+    /* The device is left alone after the threshold is reached. */
+    utest_refresh_rv__ = ONLP_STATUS_E_I2C;
+    onlp_devpool_invalidate(&dev);
+    for(i = 0; i < 2 * ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD; i++) {
+        CHECK(onlp_devpool_thermal_info_get(&dev, 0, &ti) == ONLP_STATUS_E_I2C);
+    }
+    CHECK(utest_refresh_calls__ == 2 + ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD);
+    CHECK(dev.state.errors == ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD);
+    CHECK(dev.state.failures == ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD);
+    CHECK(dev.state.last_error == ONLP_STATUS_E_I2C);
+
+    /* And tried again once the holdoff expires. */
+    dev.state.holdoff_until = 0;
+    utest_refresh_rv__ = 0;
+    CHECK(onlp_devpool_thermal_info_get(&dev, 0, &ti) == 0);
+    CHECK(utest_refresh_calls__ == 3 + ONLPLIB_CONFIG_DEVPOOL_ERROR_THRESHOLD);
+    CHECK(dev.state.failures == 0);
+
+    onlp_devpool_show(&aim_pvs_stdout, &dev, 1);
+}
+
+/**
+ * Device pool: a swapped PSU must not report the old model and serial.
+ */
+static void
+devpool_psu_swap_test(void)
+{
+    onlp_psu_info_t info;
+    onlp_devpool_dev_t dev;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.driver = &onlp_devpool_driver_pmbus;
+    /* No such bus, so every refresh fails. */
+    dev.bus = 250;
+
+    dev.state.regs[0x80] = 3; memcpy(dev.state.regs + 0x81, "OLD", 3);
+    dev.state.regs[0xC0] = 3; memcpy(dev.state.regs + 0xC1, "OLD", 3);
+    memset(&info, 0, sizeof(info));
+    CHECK(onlp_devpool_psu_info_get(&dev, &info) < 0);
+    CHECK(dev.state.regs[0x80] == 0 && dev.state.regs[0xC0] == 0);
+
+    dev.state.regs[0x80] = 3; memcpy(dev.state.regs + 0x81, "OLD", 3);
+    dev.state.regs[0xC0] = 3; memcpy(dev.state.regs + 0xC1, "OLD", 3);
+    onlp_devpool_invalidate(&dev);
+    CHECK(dev.state.regs[0x80] == 0 && dev.state.regs[0xC0] == 0);
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_DEVPOOL */
+
+#if ONLPLIB_CONFIG_INCLUDE_BMC_TTY == 1
+
+/*
+ * BMC stand-in on the master side of a pty. It asks for a login,
+ * optionally echoes its input like a console, and runs each command
+ * line with /bin/sh.
+ */
+#define BMC_PROMPT "root@bmc:~# "
+
+static struct {
+    int master;
+    /* Held open so the master does not see a hangup when the engine
+       closes and reopens the console. */
+    int slave;
+    int echo;
+    /* 0: login, 1: password, 2: shell */
+    int state;
+    /* Command lines run. */
+    int lines;
+    pthread_mutex_t lock;
+    pthread_t thread;
+} bmc__ = { -1, -1, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER };
+
+static void
+bmc_write__(const char* s, int len)
+{
+    while(len > 0) {
+        int rv = write(bmc__.master, s, len);
+        if(rv < 0 && errno == EINTR) {
+            continue;
+        }
+        if(rv <= 0) {
+            return;
+        }
+        s += rv;
+        len -= rv;
+    }
+}
+
+static void
+bmc_puts__(const char* s)
+{
+    bmc_write__(s, strlen(s));
+}
+
+static void
+bmc_run__(const char* line)
+{
+    char out[1024];
+    int len;
+    FILE* fp;
+
+    pthread_mutex_lock(&bmc__.lock);
+    bmc__.lines++;
+    pthread_mutex_unlock(&bmc__.lock);
+
+    if((fp = popen(line, "r")) == NULL) {
+        return;
+    }
+    while((len = fread(out, 1, sizeof(out), fp)) > 0) {
+        bmc_write__(out, len);
+    }
+    pclose(fp);
+}
+
+static void*
+bmc_thread__(void* arg)
+{
+    char line[ONLPLIB_CONFIG_BMC_TTY_BUFFER_SIZE];
+    int len = 0;
+    char ch;
+    int rv;
+
+    for(;;) {
+        if((rv = read(bmc__.master, &ch, 1)) < 0 && errno == EINTR) {
+            continue;
+        }
+        if(rv <= 0) {
+            break;
+        }
+        if(ch != '\r') {
+            if(len < sizeof(line) - 1) {
+                line[len++] = ch;
+            }
+            continue;
+        }
+        line[len] = 0;
+        len = 0;
+
+        if(bmc__.echo) {
+            bmc_puts__(line);
+            bmc_puts__("\r\n");
+        }
+        switch(bmc__.state)
+            {
+            case 0:
+                if(line[0]) {
+                    bmc__.state = 1;
+                    bmc_puts__("Password: ");
+                }
+                else {
+                    bmc_puts__("bmc login: ");
+                }
+                break;
+            case 1:
+                bmc__.state = 2;
+                bmc_puts__(BMC_PROMPT);
+                break;
+            default:
+                if(line[0]) {
+                    bmc_run__(line);
+                }
+                bmc_puts__(BMC_PROMPT);
+                break;
+            }
+    }
+    return NULL;
+}
+
+static int
+bmc_lines__(void)
+{
+    int lines;
+    pthread_mutex_lock(&bmc__.lock);
+    lines = bmc__.lines;
+    pthread_mutex_unlock(&bmc__.lock);
+    return lines;
+}
+
+static void
+bmc_tty_framing_test(void)
+{
+    char out[3][64];
+    onlp_bmc_tty_cmd_t cmds[3];
+    int i;
+
+    memset(cmds, 0, sizeof(cmds));
+    cmds[0].cmd = "echo one";
+    cmds[1].cmd = "printf 'two\\nlines\\n'";
+    cmds[2].cmd = "echo three; false";
+    for(i = 0; i < 3; i++) {
+        cmds[i].out = out[i];
+        cmds[i].out_size = sizeof(out[i]);
+    }
+
+    /* With and without console echo. */
+    for(bmc__.echo = 0; bmc__.echo < 2; bmc__.echo++) {
+        int lines = bmc_lines__();
+        CHECK(onlp_bmc_tty_exec_batch(cmds, 3) == 0);
+        CHECK(!strcmp(out[0], "one") && cmds[0].exit == 0);
+        CHECK(!strcmp(out[1], "two\nlines") && cmds[1].exit == 0);
+        CHECK(!strcmp(out[2], "three") && cmds[2].exit == 1);
+        /* One round trip for the batch. */
+        CHECK(bmc_lines__() == lines + 1);
+    }
+    bmc__.echo = 0;
+
+    CHECK(onlp_bmc_tty_exec("echo single", out[0], sizeof(out[0]), 0) == 6);
+    CHECK(!strcmp(out[0], "single"));
+    CHECK(onlp_bmc_tty_exec("false", NULL, 0, 0) == ONLP_STATUS_E_INTERNAL);
+}
+
+static void
+bmc_tty_cache_test(void)
+{
+    char out[64];
+    int i, lines;
+
+    onlp_bmc_tty_cache_invalidate();
+    lines = bmc_lines__();
+    CHECK(onlp_bmc_tty_exec("echo cached", out, sizeof(out), ONLP_BMC_TTY_F_CACHED) == 6);
+    CHECK(onlp_bmc_tty_exec("echo cached", out, sizeof(out), ONLP_BMC_TTY_F_CACHED) == 6);
+    CHECK(!strcmp(out, "cached"));
+    CHECK(bmc_lines__() == lines + 1);
+
+    /*
+     * Polled faster than the cache lifetime (200ms), the entry must
+     * still expire and be refreshed.
+     */
+    for(i = 0; i < 12; i++) {
+        usleep(50 * 1000);
+        CHECK(onlp_bmc_tty_exec("echo cached", out, sizeof(out), ONLP_BMC_TTY_F_CACHED) == 6);
+    }
+    CHECK(bmc_lines__() >= lines + 3);
+
+    /* Uncached commands invalidate the cache. */
+    lines = bmc_lines__();
+    CHECK(onlp_bmc_tty_exec("true", NULL, 0, 0) == 0);
+    CHECK(onlp_bmc_tty_exec("echo cached", out, sizeof(out), ONLP_BMC_TTY_F_CACHED) == 6);
+    CHECK(bmc_lines__() == lines + 2);
+}
+
+static void
+bmc_tty_timeout_test(void)
+{
+    uint64_t start = aim_time_monotonic();
+
+    /* 300ms deadline, one attempt. */
+    CHECK(onlp_bmc_tty_exec("sleep 1", NULL, 0, 0) < 0);
+    CHECK(aim_time_monotonic() - start < 900 * 1000);
+
+    /* Let the stand-in finish, then the console recovers. */
+    usleep(1200 * 1000);
+    CHECK(onlp_bmc_tty_exec("echo back", NULL, 0, 0) == 4);
+}
+
+static void
+bmc_tty_test(void)
+{
+    onlp_bmc_tty_config_t config;
+
+    bmc__.master = posix_openpt(O_RDWR | O_NOCTTY);
+    CHECK(bmc__.master >= 0);
+    CHECK(grantpt(bmc__.master) == 0 && unlockpt(bmc__.master) == 0);
+    bmc__.slave = open(ptsname(bmc__.master), O_RDWR | O_NOCTTY);
+    CHECK(bmc__.slave >= 0);
+    CHECK(pthread_create(&bmc__.thread, NULL, bmc_thread__, NULL) == 0);
+
+    memset(&config, 0, sizeof(config));
+    config.device = ptsname(bmc__.master);
+    config.prompt = BMC_PROMPT;
+    config.login_prompt = "login:";
+    config.user = "root";
+    config.password = "0penBmc";
+    config.timeout_ms = 300;
+    config.login_timeout_ms = 1000;
+    config.retries = 1;
+    config.cache_usecs = 200 * 1000;
+    CHECK(onlp_bmc_tty_init(&config) == 0);
+
+    bmc_tty_framing_test();
+    bmc_tty_cache_test();
+    bmc_tty_timeout_test();
+
+    onlp_bmc_tty_deinit();
+    close(bmc__.slave);
+    pthread_join(bmc__.thread, NULL);
+    close(bmc__.master);
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_BMC_TTY */
+
+/**
+ * Attribute descriptors.
+ *
+ * pread() is interposed so the descriptors of one file can be made
+ * to fail with ENODEV, the way sysfs attributes fail once their
+ * device is unbound or the driver is reloaded.
+ */
+static struct {
+    dev_t dev;
+    ino_t ino;
+    /** Number of reads on the file which still fail. */
+    int fails;
+    /** Number of reads which failed. */
+    int hits;
+} file_stale__;
+
+ssize_t
+pread(int fd, void* buf, size_t count, off_t offset)
+{
+    struct stat sb;
+
+    if(file_stale__.fails > 0 && fstat(fd, &sb) == 0 &&
+       sb.st_dev == file_stale__.dev && sb.st_ino == file_stale__.ino) {
+        file_stale__.fails--;
+        file_stale__.hits++;
+        errno = ENODEV;
+        return -1;
+    }
+    if(lseek(fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+    return read(fd, buf, count);
+}
+
+static void
+file_stale_set__(const char* path, int fails)
+{
+    struct stat sb;
+    CHECK(stat(path, &sb) == 0);
+    file_stale__.dev = sb.st_dev;
+    file_stale__.ino = sb.st_ino;
+    file_stale__.fails = fails;
+    file_stale__.hits = 0;
+}
+
+static void
+file_write__(const char* path, const char* data)
+{
+    FILE* fp = fopen(path, "w");
+    CHECK(fp != NULL);
+    CHECK(fputs(data, fp) >= 0);
+    CHECK(fclose(fp) == 0);
+}
+
+/*
+ * A handle whose attribute is removed and recreated (module hot-swap,
+ * driver rebind) must reopen the new attribute rather than keep
+ * reading the old one.
+ */
+static void
+file_handle_swap_test(void)
+{
+    char path[64], tmp[80];
+    onlp_file_handle_t* h;
+    int v;
+
+    snprintf(path, sizeof(path), "/tmp/onlplib-utest.%d", (int)getpid());
+    snprintf(tmp, sizeof(tmp), "%s.new", path);
+
+    file_write__(path, "1\n");
+    CHECK(onlp_file_handle_open(&h, "%s", path) == 0);
+    CHECK(onlp_file_handle_read_int(h, &v) == 0 && v == 1);
+
+    /* Replace the attribute. The old one stays dead. */
+    file_stale_set__(path, 1000);
+    file_write__(tmp, "2\n");
+    CHECK(rename(tmp, path) == 0);
+
+    CHECK(onlp_file_handle_read_int(h, &v) == 0 && v == 2);
+    CHECK(file_stale__.hits == 1);
+    CHECK(onlp_file_handle_read_int(h, &v) == 0 && v == 2);
+    CHECK(file_stale__.hits == 1);
+
+    /* Gone for good. */
+    file_stale_set__(path, 1000);
+    CHECK(unlink(path) == 0);
+    CHECK(onlp_file_handle_read_int(h, &v) < 0);
+
+    /* And back again. */
+    file_stale__.fails = 0;
+    file_write__(path, "3\n");
+    CHECK(onlp_file_handle_read_int(h, &v) == 0 && v == 3);
+
+    onlp_file_handle_close(h);
+    unlink(path);
+}
+
+#if ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE == 1
+
+#define FILE_SYSFS_ATTR "/sys/devices/system/cpu/online"
+
+/*
+ * A cached sysfs descriptor which goes stale must be dropped and the
+ * attribute reopened, and must not be handed out again.
+ */
+static void
+file_fd_cache_test(void)
+{
+    uint8_t first[128], data[128];
+    int len, first_len;
+
+    if(access(FILE_SYSFS_ATTR, R_OK) != 0) {
+        printf("%s not readable, skipping fd cache test.\n", FILE_SYSFS_ATTR);
+        return;
+    }
+
+    CHECK(onlp_file_read(first, sizeof(first), &first_len,
+                         FILE_SYSFS_ATTR) == 0);
+
+    /* The cached descriptor fails once. The read must still succeed. */
+    file_stale_set__(FILE_SYSFS_ATTR, 1);
+    CHECK(onlp_file_read(data, sizeof(data), &len, FILE_SYSFS_ATTR) == 0);
+    CHECK(file_stale__.hits == 1);
+    CHECK(len == first_len && !memcmp(first, data, len));
+
+    /* A reopen which also fails is reported, not retried forever. */
+    file_stale_set__(FILE_SYSFS_ATTR, 2);
+    CHECK(onlp_file_read(data, sizeof(data), &len, FILE_SYSFS_ATTR) < 0);
+    CHECK(file_stale__.hits == 2);
+
+    /* Nothing stale was kept. */
+    CHECK(onlp_file_read(data, sizeof(data), &len, FILE_SYSFS_ATTR) == 0);
+    CHECK(len == first_len && !memcmp(first, data, len));
+
+    onlp_file_fd_cache_flush();
+    CHECK(onlp_file_read(data, sizeof(data), &len, FILE_SYSFS_ATTR) == 0);
+    CHECK(len == first_len && !memcmp(first, data, len));
+}
+
+#endif /* ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE */
+
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+
+/**
+ * IPMI SDR cache against a canned BMC on ONLP_IPMI_SOCKET.
+ */
+#define SDR_NUM_VIN      0x10
+#define SDR_NUM_VIN_AUX  0x11
+#define SDR_NUM_TEMP     0x12
+#define SDR_NUM_VOUT     0x13
+#define SDR_NUM_ME       0x14
+#define SDR_NUM_PSU2     0x15
+#define SDR_NUM_LATE     0x16
+
+static struct {
+    pthread_mutex_t lock;
+    int listener;
+    pthread_t thread;
+    char dir[64];
+    char path[96];
+
+    uint8_t records[8][64];
+    int lengths[8];
+    int count;
+
+    uint32_t addition;
+    uint16_t reservation;
+    /** Cancel the reservation after this many Get SDR requests. */
+    int cancel_after;
+
+    /** Sensor number -> raw reading; bit 8 set means unavailable */
+    int readings[256];
+
+    int info_reqs;
+    int get_reqs;
+    int reading_reqs;
+} sdr_bmc__ = { PTHREAD_MUTEX_INITIALIZER };
+
+static void
+sdr_bmc_add_full__(uint8_t owner, uint8_t number, int format,
+                   int m, int b, int rexp, int bexp, const char* name)
+{
+    uint8_t* r = sdr_bmc__.records[sdr_bmc__.count];
+    int len = strlen(name);
+
+    memset(r, 0, sizeof(sdr_bmc__.records[0]));
+    r[2] = 0x51;
+    r[3] = 0x01;
+    r[4] = 48 + len - 5;
+    r[5] = owner;
+    r[7] = number;
+    r[12] = 0x01;
+    r[20] = format << 6;
+    r[24] = m & 0xff;
+    r[25] = (m >> 2) & 0xc0;
+    r[26] = b & 0xff;
+    r[27] = (b >> 2) & 0xc0;
+    r[29] = ((rexp & 0xf) << 4) | (bexp & 0xf);
+    r[47] = 0xc0 | len;
+    memcpy(r + 48, name, len);
+    sdr_bmc__.lengths[sdr_bmc__.count++] = 48 + len;
+}
+
+static void
+sdr_bmc_add_compact__(uint8_t number, const char* name)
+{
+    uint8_t* r = sdr_bmc__.records[sdr_bmc__.count];
+    int len = strlen(name);
+
+    memset(r, 0, sizeof(sdr_bmc__.records[0]));
+    r[2] = 0x51;
+    r[3] = 0x02;
+    r[4] = 32 + len - 5;
+    r[5] = 0x20;
+    r[7] = number;
+    r[12] = 0x02;
+    r[31] = 0xc0 | len;
+    memcpy(r + 32, name, len);
+    sdr_bmc__.lengths[sdr_bmc__.count++] = 32 + len;
+}
+
+/** Answer one request. Returns the response length including the ccode. */
+static int
+sdr_bmc_answer__(uint8_t netfn, uint8_t cmd, const uint8_t* req, int len,
+                 uint8_t* rsp)
+{
+    rsp[0] = 0xc1; /* Invalid command */
+
+    if(netfn == ONLP_IPMI_NETFN_STORAGE && cmd == 0x20) {
+        sdr_bmc__.info_reqs++;
+        memset(rsp, 0, 15);
+        rsp[1] = 0x51;
+        rsp[2] = sdr_bmc__.count;
+        rsp[6] = sdr_bmc__.addition & 0xff;
+        rsp[7] = (sdr_bmc__.addition >> 8) & 0xff;
+        rsp[8] = (sdr_bmc__.addition >> 16) & 0xff;
+        rsp[9] = sdr_bmc__.addition >> 24;
+        return 15;
+    }
+    if(netfn == ONLP_IPMI_NETFN_STORAGE && cmd == 0x22) {
+        sdr_bmc__.reservation++;
+        rsp[0] = 0;
+        rsp[1] = sdr_bmc__.reservation & 0xff;
+        rsp[2] = sdr_bmc__.reservation >> 8;
+        return 3;
+    }
+    if(netfn == ONLP_IPMI_NETFN_STORAGE && cmd == 0x23 && len == 6) {
+        int id = req[2] | (req[3] << 8);
+        int next = (id + 1 < sdr_bmc__.count) ? id + 1 : 0xffff;
+        sdr_bmc__.get_reqs++;
+        if(sdr_bmc__.cancel_after > 0 && --sdr_bmc__.cancel_after == 0) {
+            sdr_bmc__.reservation++;
+        }
+        if((req[0] | (req[1] << 8)) != sdr_bmc__.reservation) {
+            rsp[0] = 0xc5;
+            return 1;
+        }
+        if(id >= sdr_bmc__.count ||
+           req[4] + req[5] > sdr_bmc__.lengths[id]) {
+            rsp[0] = 0xcb;
+            return 1;
+        }
+        rsp[0] = 0;
+        rsp[1] = next & 0xff;
+        rsp[2] = next >> 8;
+        memcpy(rsp + 3, sdr_bmc__.records[id] + req[4], req[5]);
+        return 3 + req[5];
+    }
+    if(netfn == ONLP_IPMI_NETFN_SENSOR && cmd == 0x2d && len == 1) {
+        int v = sdr_bmc__.readings[req[0]];
+        sdr_bmc__.reading_reqs++;
+        if(v < 0) {
+            rsp[0] = 0xcb;
+            return 1;
+        }
+        rsp[0] = 0;
+        rsp[1] = v & 0xff;
+        rsp[2] = (v & 0x100) ? 0xe0 : 0xc0;
+        rsp[3] = 0;
+        return 4;
+    }
+    return 1;
+}
+
+static int
+sdr_bmc_xfer__(int fd, void* buf, int len, int wr)
+{
+    uint8_t* p = buf;
+    while(len > 0) {
+        int rv = wr ? write(fd, p, len) : read(fd, p, len);
+        if(rv <= 0) {
+            return -1;
+        }
+        p += rv;
+        len -= rv;
+    }
+    return 0;
+}
+
+/*
+ * Requests are netfn, cmd, len, data until the client shuts down
+ * its side. Responses are ccode, len, data in the same order.
+ */
+static void*
+sdr_bmc_thread__(void* arg)
+{
+    static uint8_t out[64 * (2 + ONLP_IPMI_DATA_MAX)];
+    uint8_t hdr[3], req[ONLP_IPMI_DATA_MAX], rsp[2 + ONLP_IPMI_DATA_MAX];
+    int fd, olen, rlen;
+
+    while((fd = accept(sdr_bmc__.listener, NULL, NULL)) >= 0) {
+        olen = 0;
+        pthread_mutex_lock(&sdr_bmc__.lock);
+        while(sdr_bmc_xfer__(fd, hdr, 3, 0) == 0 &&
+              sdr_bmc_xfer__(fd, req, hdr[2], 0) == 0) {
+            rlen = sdr_bmc_answer__(hdr[0], hdr[1], req, hdr[2], rsp);
+            CHECK(olen + 1 + rlen <= sizeof(out));
+            out[olen++] = rsp[0];
+            out[olen++] = rlen - 1;
+            memcpy(out + olen, rsp + 1, rlen - 1);
+            olen += rlen - 1;
+        }
+        pthread_mutex_unlock(&sdr_bmc__.lock);
+        sdr_bmc_xfer__(fd, out, olen, 1);
+        close(fd);
+    }
+    return NULL;
+}
+
+static void
+sdr_bmc_start__(void)
+{
+    struct sockaddr_un addr;
+
+    snprintf(sdr_bmc__.dir, sizeof(sdr_bmc__.dir), "/tmp/onlplib-utest.XXXXXX");
+    CHECK(mkdtemp(sdr_bmc__.dir) != NULL);
+    snprintf(sdr_bmc__.path, sizeof(sdr_bmc__.path), "%s/bmc", sdr_bmc__.dir);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, sdr_bmc__.path);
+    CHECK((sdr_bmc__.listener = socket(AF_UNIX, SOCK_STREAM, 0)) >= 0);
+    CHECK(bind(sdr_bmc__.listener, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    CHECK(listen(sdr_bmc__.listener, 4) == 0);
+    CHECK(pthread_create(&sdr_bmc__.thread, NULL, sdr_bmc_thread__, NULL) == 0);
+
+    setenv("ONLP_IPMI_SOCKET", sdr_bmc__.path, 1);
+    onlp_ipmi_transport_set(NULL, NULL);
+}
+
+static void
+sdr_bmc_stop__(void)
+{
+    shutdown(sdr_bmc__.listener, SHUT_RDWR);
+    pthread_join(sdr_bmc__.thread, NULL);
+    close(sdr_bmc__.listener);
+    unlink(sdr_bmc__.path);
+    rmdir(sdr_bmc__.dir);
+
+    unsetenv("ONLP_IPMI_SOCKET");
+    onlp_ipmi_transport_set(NULL, NULL);
+}
+
+static void
+sdr_bmc_reading_set__(uint8_t number, int raw)
+{
+    pthread_mutex_lock(&sdr_bmc__.lock);
+    sdr_bmc__.readings[number] = raw;
+    pthread_mutex_unlock(&sdr_bmc__.lock);
+}
+
+static int
+sdr_bmc_count__(int* counter)
+{
+    int v;
+    pthread_mutex_lock(&sdr_bmc__.lock);
+    v = *counter;
+    pthread_mutex_unlock(&sdr_bmc__.lock);
+    return v;
+}
+
+static void
+ipmi_sdr_test(void)
+{
+    int i, v, gets;
+
+    for(i = 0; i < AIM_ARRAYSIZE(sdr_bmc__.readings); i++) {
+        sdr_bmc__.readings[i] = -1;
+    }
+
+    /* (x + 5*10^1) * 10^-1 */
+    sdr_bmc_add_full__(0x20, SDR_NUM_VIN_AUX, 0, 1, 5, -1, 1, "PSU1_VIN_AUX");
+    sdr_bmc_add_full__(0x20, SDR_NUM_VIN, 0, 1, 5, -1, 1, "PSU1_VIN");
+    /* Two's complement, negative M */
+    sdr_bmc_add_full__(0x20, SDR_NUM_TEMP, 2, -2, 0, 0, 0, "Temp_CPU");
+    sdr_bmc_add_compact__(SDR_NUM_VOUT, "PSU1_VOUT");
+    /* Owned by the ME; never read through the BMC */
+    sdr_bmc_add_full__(0x2c, SDR_NUM_ME, 0, 1, 0, 0, 0, "ME_TEMP");
+    sdr_bmc_add_full__(0x20, SDR_NUM_PSU2, 0, 1, 0, 0, 0, "PSU2_VIN");
+
+    sdr_bmc__.readings[SDR_NUM_VIN] = 200;
+    sdr_bmc__.readings[SDR_NUM_VIN_AUX] = 100;
+    sdr_bmc__.readings[SDR_NUM_TEMP] = 0xf6;
+    sdr_bmc__.readings[SDR_NUM_VOUT] = 12;
+    sdr_bmc__.readings[SDR_NUM_ME] = 40;
+    sdr_bmc__.readings[SDR_NUM_PSU2] = 0x100;
+    sdr_bmc__.addition = 1;
+
+    sdr_bmc_start__();
+    onlp_ipmi_sdr_age_set(60000000, 60000000);
+    onlp_ipmi_sdr_invalidate();
+
+    /* Exact names win over earlier substring matches. */
+    CHECK(onlp_ipmi_sdr_reading_get("PSU1_VIN", &v) == 0 && v == 25000);
+    CHECK(onlp_ipmi_sdr_reading_get("VIN_AUX", &v) == 0 && v == 15000);
+    CHECK(onlp_ipmi_sdr_reading_get("Temp_CPU", &v) == 0 && v == 20000);
+    CHECK(onlp_ipmi_sdr_reading_get("PSU1_VOUT", &v) == 0 && v == 12000);
+    CHECK(onlp_ipmi_sdr_reading_get("ME_TEMP", &v) == ONLP_STATUS_E_MISSING);
+    CHECK(onlp_ipmi_sdr_reading_get("PSU2_VIN", &v) == ONLP_STATUS_E_MISSING);
+    CHECK(onlp_ipmi_sdr_reading_get("PSU3_VIN", &v) == ONLP_STATUS_E_MISSING);
+
+    /* One repository pass, one batch of readings, none for the ME. */
+    CHECK(sdr_bmc_count__(&sdr_bmc__.info_reqs) == 1);
+    CHECK(sdr_bmc_count__(&sdr_bmc__.reading_reqs) == 5);
+    gets = sdr_bmc_count__(&sdr_bmc__.get_reqs);
+
+    /* Cached readings are reused within the reading age. */
+    sdr_bmc_reading_set__(SDR_NUM_VIN, 250);
+    CHECK(onlp_ipmi_sdr_reading_get("PSU1_VIN", &v) == 0 && v == 25000);
+    CHECK(sdr_bmc_count__(&sdr_bmc__.reading_reqs) == 5);
+
+    /* Expired readings are refreshed without reloading the records. */
+    onlp_ipmi_sdr_age_set(0, 0);
+    CHECK(onlp_ipmi_sdr_reading_get("PSU1_VIN", &v) == 0 && v == 30000);
+    CHECK(sdr_bmc_count__(&sdr_bmc__.reading_reqs) == 10);
+    CHECK(sdr_bmc_count__(&sdr_bmc__.get_reqs) == gets);
+
+    /* A new addition timestamp reloads the repository. */
+    pthread_mutex_lock(&sdr_bmc__.lock);
+    sdr_bmc_add_full__(0x20, SDR_NUM_LATE, 0, 1, 0, 0, 0, "PSU2_VOUT");
+    sdr_bmc__.readings[SDR_NUM_LATE] = 12;
+    sdr_bmc__.readings[SDR_NUM_PSU2] = 230;
+    sdr_bmc__.addition++;
+    pthread_mutex_unlock(&sdr_bmc__.lock);
+    CHECK(onlp_ipmi_sdr_reading_get("PSU2_VOUT", &v) == 0 && v == 12000);
+    CHECK(onlp_ipmi_sdr_reading_get("PSU2_VIN", &v) == 0 && v == 230000);
+    CHECK(sdr_bmc_count__(&sdr_bmc__.get_reqs) > gets);
+
+    /* A reservation lost mid-load restarts the walk. */
+    pthread_mutex_lock(&sdr_bmc__.lock);
+    sdr_bmc__.cancel_after = 3;
+    pthread_mutex_unlock(&sdr_bmc__.lock);
+    onlp_ipmi_sdr_invalidate();
+    CHECK(onlp_ipmi_sdr_reading_get("PSU1_VIN", &v) == 0 && v == 30000);
+    CHECK(onlp_ipmi_sdr_reading_get("PSU2_VOUT", &v) == 0 && v == 12000);
+    CHECK(onlp_ipmi_sdr_reading_get("ME_TEMP", &v) == ONLP_STATUS_E_MISSING);
+
+    sdr_bmc_stop__();
+    onlp_ipmi_sdr_invalidate();
+    onlp_ipmi_sdr_age_set(ONLPLIB_CONFIG_IPMI_SDR_READING_USECS,
+                          ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS);
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_IPMI */
 
 int aim_main(int argc, char* argv[])
 {
-    printf("onlplib Utest Is Empty\n");
     onlplib_config_show(&aim_pvs_stdout);
+
+#if ONLPLIB_CONFIG_INCLUDE_DEVPOOL == 1
+    devpool_decode_test();
+    devpool_pmbus_test();
+    devpool_holdoff_test();
+    devpool_psu_swap_test();
+#endif
+#if ONLPLIB_CONFIG_INCLUDE_BMC_TTY == 1
+    bmc_tty_test();
+#endif
+
+    file_handle_swap_test();
+#if ONLPLIB_CONFIG_FILE_INCLUDE_FD_CACHE == 1
+    file_fd_cache_test();
+#endif
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+    ipmi_sdr_test();
+#endif
+
+    printf("onlplib utest passed.\n");
     return 0;
 }
 
@@ -2,6 +2,12 @@
 #define SFF_A0_BASE 0x0
 #define SFF_A2_BASE 0x100
 
+/* Each SFF device address spans 256 bytes. Bytes 128-255 are paged. */
+#define SFF_ADDRESS_SPACE_SIZE 256
+#define SFF_PAGE_SELECT_BASE 128
+/* The page select byte (SFF-8472 A2h, SFF-8636 A0h). */
+#define SFF_PAGE_SELECT_OFFSET 127
+
 /**
  * SFF_EEPROM_DATA_DEBUG
  * For printing the eeprom hex data for debugging. 
@@ -23,6 +23,7 @@
  *
  ***********************************************************/
 #include <errno.h>
+#include <pthread.h>
 #include <onlp/onlp.h>
 #include <onlp/sfp.h>
 #include <sff/sff.h>
@@ -39,14 +40,83 @@ void __oom_shim_module_init__(void) {
     onlp_sw_init(0);
 }
 
+/*
+ * Serializes page select + access sequences so concurrent
+ * OOM callers cannot switch the page under each other.
+ */
+static pthread_mutex_t oom_page_lock__ = PTHREAD_MUTEX_INITIALIZER;
+
+/* Convert an OOM port to the ONLP port number */
+static int oom_port_number__(oom_port_t* port){
+    if(port == NULL || port->handle == NULL){
+        return -EINVAL;
+    }
+    return (int)(uintptr_t)port->handle - 1;
+}
+
+/* Convert an ONLP status to a negative errno for OOM callers */
+static int oom_errno__(int rv){
+    switch(rv){
+    case ONLP_STATUS_E_UNSUPPORTED: return -EOPNOTSUPP;
+    case ONLP_STATUS_E_MISSING: return -ENODEV;
+    case ONLP_STATUS_E_PARAM: return -EINVAL;
+    default: return -EIO;
+    }
+}
+
+/*
+ * Validate an SFF memory request and return the 7-bit device address.
+ * OOM uses 8-bit (write) addresses, eg A0h, A2h, A8h.
+ */
+static int oom_sff_devaddr__(int address, int page, int offset, int len){
+    if((address & 1) || address < 0 || address > 0xff){
+        aim_printf(&aim_pvs_stdout, "Error invalid address: 0x%02x\n", address);
+        return -EINVAL;
+    }
+    if(offset < 0 || len <= 0 || offset + len > SFF_ADDRESS_SPACE_SIZE){
+        return -EINVAL;  /* out of range */
+    }
+    if(page < 0 || page > 0xff){
+        return -EINVAL;
+    }
+    return address >> 1;
+}
+
+/*
+ * Select the given page before an access to the upper half of
+ * the address space. Page 0 is the power-on default and is never
+ * written, so modules without paging (eg SFP A0h) are untouched.
+ * Returns 1 if the page was changed and must be restored.
+ */
+static int oom_sff_page_select__(int port_num, int devaddr, int page, int offset, int len){
+    int rv;
+
+    if(page == 0 || offset + len <= SFF_PAGE_SELECT_BASE){
+        return 0;
+    }
+    rv = onlp_sfp_dev_writeb(port_num, devaddr, SFF_PAGE_SELECT_OFFSET, page);
+    if(rv < 0){
+        return rv;
+    }
+    return 1;
+}
+
+static void oom_sff_page_restore__(int port_num, int devaddr, int selected){
+    if(selected > 0){
+        onlp_sfp_dev_writeb(port_num, devaddr, SFF_PAGE_SELECT_OFFSET, 0);
+    }
+}
+
 /*Gets the portlist of the SFP ports on the switch*/
 int oom_get_portlist(oom_port_t portlist[], int listsize){
 
     int port,i=0;
+    int bulk;
     oom_port_t* pptr;
 
 
     onlp_sfp_bitmap_t bitmap;
+    onlp_sfp_bitmap_t present;
     onlp_sfp_bitmap_t_init(&bitmap);
     onlp_sfp_bitmap_get(&bitmap);
 
@@ -58,6 +128,13 @@ int oom_get_portlist(oom_port_t portlist[], int listsize){
             return AIM_BITMAP_COUNT(&bitmap);
     }
 
+    /*
+     * One presence read for all ports. Fall back to
+     * per-port reads only if the bulk read fails.
+     */
+    onlp_sfp_bitmap_t_init(&present);
+    bulk = ONLP_SUCCESS(onlp_sfp_presence_bitmap_get(&present));
+
     AIM_BITMAP_ITER(&bitmap, port){
         int rv;
 
@@ -67,7 +144,7 @@ int oom_get_portlist(oom_port_t portlist[], int listsize){
         sprintf(pptr->name, "port%d", port+1);
         i++;
 
-        rv = onlp_sfp_is_present(port);
+        rv = bulk ? AIM_BITMAP_GET(&present, port) : onlp_sfp_is_present(port);
         if(rv == 0){
             /* aim_printf(&aim_pvs_stdout, "module %d is not present\n", port);*/
             pptr->oom_class = OOM_PORT_CLASS_UNKNOWN;
@@ -85,43 +162,84 @@ int oom_get_portlist(oom_port_t portlist[], int listsize){
 
 
 int oom_get_memory_sff(oom_port_t* port, int address, int page, int offset, int len, uint8_t* data){
-    int rv;
-    unsigned int port_num;
-    uint8_t* idprom = NULL;
-
-    port_num = (unsigned int)(uintptr_t)port->handle;
-    port_num -= 1;
+    int rv, selected;
+    int port_num, devaddr;
 
-    if (offset >= 256)
-        return -1;  /* out of range */
+    if((port_num = oom_port_number__(port)) < 0){
+        return port_num;
+    }
+    if((devaddr = oom_sff_devaddr__(address, page, offset, len)) < 0){
+        return devaddr;
+    }
 
-    /**
-     * place holder implementation until onlp_sfp_eeprom_read()
-     * can be improved to handle partial page gets
-     **/
+    pthread_mutex_lock(&oom_page_lock__);
+    selected = oom_sff_page_select__(port_num, devaddr, page, offset, len);
+    if(selected < 0){
+        rv = selected;
+    }
+    else {
+        /* Only the requested bytes are transferred. */
+        rv = onlp_sfp_dev_read(port_num, devaddr, offset, data, len);
+        oom_sff_page_restore__(port_num, devaddr, selected);
+    }
+    pthread_mutex_unlock(&oom_page_lock__);
 
-    if (address == 0xa0) {
-        rv = onlp_sfp_dev_alloc_read(port_num, 0x50, 0, 256, &idprom);
-    } else if (address == 0xa2) {
-        rv = onlp_sfp_dev_alloc_read(port_num, 0x51, 0, 256, &idprom);
-    } else {
-        aim_printf(&aim_pvs_stdout, "Error invalid address: 0x%02x\n", address);
-        return -EINVAL;
+    if(rv == ONLP_STATUS_E_UNSUPPORTED && page == 0){
+        /*
+         * Platforms without random access support still
+         * provide the full A0h/A2h blocks.
+         */
+        uint8_t* idprom = NULL;
+        rv = onlp_sfp_dev_alloc_read(port_num, devaddr, 0, SFF_ADDRESS_SPACE_SIZE, &idprom);
+        if(rv >= 0){
+            memcpy(data, &idprom[offset], len);
+            rv = len;
+        }
+        aim_free(idprom);
     }
 
     if(rv < 0) {
-        aim_printf(&aim_pvs_stdout, "Error reading eeprom: %{onlp_status}\n");
-        return -1;
+        aim_printf(&aim_pvs_stdout, "Error reading eeprom: %{onlp_status}\n", rv);
+        return oom_errno__(rv);
     }
-    memcpy(data, &idprom[offset], len);
-    aim_free(idprom);
-
-    return 0;
+    return len;
 }
 
 int oom_get_function(oom_port_t* port, oom_functions_t function, int* rv){
-    //not implemented
-    return -1;
+    int port_num, control, value, status;
+
+    if(rv == NULL){
+        return -EINVAL;
+    }
+    if((port_num = oom_port_number__(port)) < 0){
+        return port_num;
+    }
+
+    switch(function){
+    case OOM_FUNCTIONS_MODULE_ABSENT:
+        status = onlp_sfp_is_present(port_num);
+        if(status < 0){
+            return oom_errno__(status);
+        }
+        *rv = !status;
+        return 0;
+    case OOM_FUNCTIONS_TX_FAULT: control = ONLP_SFP_CONTROL_TX_FAULT; break;
+    case OOM_FUNCTIONS_TX_DISABLE: control = ONLP_SFP_CONTROL_TX_DISABLE; break;
+    case OOM_FUNCTIONS_RXLOSS_OF_SIG: control = ONLP_SFP_CONTROL_RX_LOS; break;
+    case OOM_FUNCTIONS_RS0:
+    case OOM_FUNCTIONS_RS1:
+        /* Rate select pins are not exposed by ONLP */
+        return -EOPNOTSUPP;
+    default:
+        return -EINVAL;
+    }
+
+    status = onlp_sfp_control_get(port_num, control, &value);
+    if(status < 0){
+        return oom_errno__(status);
+    }
+    *rv = value ? 1 : 0;
+    return 0;
 }
 
 int oom_get_memory_cfp(oom_port_t* port, int address, int len, uint16_t* data){
@@ -130,13 +248,56 @@ int oom_get_memory_cfp(oom_port_t* port, int address, int len, uint16_t* data){
 }
 
 int oom_set_memory_sff(oom_port_t* port, int address, int page, int offset, int len, uint8_t* data){
-    //not implemented
-    return -1;
+    int rv, selected;
+    int port_num, devaddr;
+
+    if((port_num = oom_port_number__(port)) < 0){
+        return port_num;
+    }
+    if((devaddr = oom_sff_devaddr__(address, page, offset, len)) < 0){
+        return devaddr;
+    }
+    if(offset <= SFF_PAGE_SELECT_OFFSET && offset + len > SFF_PAGE_SELECT_OFFSET){
+        /* The page select byte is owned by the shim. */
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&oom_page_lock__);
+    selected = oom_sff_page_select__(port_num, devaddr, page, offset, len);
+    if(selected < 0){
+        rv = selected;
+    }
+    else {
+        rv = onlp_sfp_dev_write(port_num, devaddr, offset, data, len);
+        oom_sff_page_restore__(port_num, devaddr, selected);
+    }
+    pthread_mutex_unlock(&oom_page_lock__);
+
+    if(rv < 0) {
+        aim_printf(&aim_pvs_stdout, "Error writing eeprom: %{onlp_status}\n", rv);
+        return oom_errno__(rv);
+    }
+    return len;
 }
 
 int oom_set_function(oom_port_t* port, oom_functions_t function, int value){
-    //not implemented
-    return -1;
+    int port_num, rv;
+
+    if((port_num = oom_port_number__(port)) < 0){
+        return port_num;
+    }
+
+    switch(function){
+    case OOM_FUNCTIONS_TX_DISABLE:
+        rv = onlp_sfp_control_set(port_num, ONLP_SFP_CONTROL_TX_DISABLE, value ? 1 : 0);
+        return (rv < 0) ? oom_errno__(rv) : 0;
+    case OOM_FUNCTIONS_RS0:
+    case OOM_FUNCTIONS_RS1:
+        return -EOPNOTSUPP;
+    default:
+        /* Status pins are read-only */
+        return -EINVAL;
+    }
 }
 int oom_set_memory_cfp(oom_port_t* port, int address, int len, uint16_t* data){
     //not implemented
@@ -24,14 +24,16 @@
  *
  ***********************************************************/
 #include <onlp/platformi/sfpi.h>
-#include <onlplib/i2c.h>
 #include <onlplib/file.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "x86_64_accton_as5712_54x_int.h"
 #include "x86_64_accton_as5712_54x_log.h"
 
 #define CPLD_MUX_BUS_START_INDEX 2
 
 #define PORT_EEPROM_FORMAT              "/sys/bus/i2c/devices/%d-0050/eeprom"
+#define PORT_FLUSH_CACHE_FORMAT         "/sys/bus/i2c/devices/%d-0050/flush_cache"
 #define MODULE_PRESENT_FORMAT		    "/sys/bus/i2c/devices/0-00%d/module_present_%d"
 #define MODULE_RXLOS_FORMAT             "/sys/bus/i2c/devices/0-00%d/module_rx_los_%d"
 #define MODULE_TXFAULT_FORMAT           "/sys/bus/i2c/devices/0-00%d/module_tx_fault_%d"
@@ -139,6 +141,25 @@ onlp_sfpi_port_map(onlp_oid_id_t port, int* rport)
  * for both the R0 and R0B. When we have to interpret the CPLD register
  * values directly, however, we need to apply the correct mapping from R0B -> R0.
  */
+/*
+ * optoe is loaded with page_cache=1 on this platform. It keeps each
+ * module's page select and paging capabilities until told to forget
+ * them, so tell it whenever a module comes or goes.
+ */
+static uint64_t present__;
+
+static void
+port_presence_update__(onlp_oid_id_t port, int present)
+{
+    uint64_t bit = 1ULL << port;
+
+    if(!!(present__ & bit) != !!present) {
+        present__ ^= bit;
+        onlp_file_write_int(1, PORT_FLUSH_CACHE_FORMAT,
+                            front_port_bus_index(port));
+    }
+}
+
 static void
 port_qsfp_cpld_map__(onlp_oid_id_t port, int* rport)
 {
@@ -170,6 +191,7 @@ onlp_sfpi_is_present(onlp_oid_id_t port)
         return ONLP_STATUS_E_INTERNAL;
     }
 
+    port_presence_update__(port, present);
     return present;
 }
 
@@ -221,10 +243,11 @@ onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
     }
 
     /* Populate bitmap */
-    for(i = 0; presence_all; i++) {
+    for(i = 0; i < 54; i++) {
         int p;
         port_qsfp_cpld_map__(i, &p);
         AIM_BITMAP_MOD(dst, p, (presence_all & 1));
+        port_presence_update__(p, (presence_all & 1));
         presence_all >>= 1;
     }
 
@@ -338,40 +361,74 @@ onlp_sfpi_dom_read(onlp_oid_id_t port, uint8_t data[256])
     return ONLP_STATUS_OK;
 }
 
+/*
+ * Module access goes through the optoe eeprom file rather than raw I2C.
+ * With the page cache the driver leaves the page select register
+ * wherever it was last needed, so only the driver knows what a raw
+ * read of the upper half would return.
+ *
+ * SFP ports have the 0x51 (A2h) space at offset 256.
+ */
+static int
+port_eeprom_xfer__(onlp_oid_id_t port, int devaddr, int addr,
+                   uint8_t* data, int size, int write)
+{
+    int fd, rv;
+    off_t offset = addr;
+
+    if(devaddr == 0x51 && port < 48) {
+        offset += 256;
+    }
+    else if(devaddr != 0x50) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    fd = onlp_file_open(write ? O_WRONLY : O_RDONLY, 0, PORT_EEPROM_FORMAT,
+                        front_port_bus_index(port));
+    if(fd < 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    rv = (write) ? pwrite(fd, data, size, offset) : pread(fd, data, size, offset);
+    close(fd);
+
+    return (rv == size) ? ONLP_STATUS_OK : ONLP_STATUS_E_I2C;
+}
+
 int
 onlp_sfpi_dev_read(onlp_oid_id_t port, int devaddr, int addr,
                    uint8_t* dst, int size)
 {
-    int bus = front_port_bus_index(port);
-    return onlp_i2c_block_read(bus, devaddr, addr, size, dst, ONLP_I2C_F_FORCE);
+    return port_eeprom_xfer__(port, devaddr, addr, dst, size, 0);
 }
 
 int
 onlp_sfpi_dev_readb(onlp_oid_id_t port, int devaddr, int addr)
 {
-    int bus = front_port_bus_index(port);
-    return onlp_i2c_readb(bus, devaddr, addr, ONLP_I2C_F_FORCE);
+    uint8_t b;
+    int rv = port_eeprom_xfer__(port, devaddr, addr, &b, 1, 0);
+    return (rv < 0) ? rv : b;
 }
 
 int
 onlp_sfpi_dev_writeb(onlp_oid_id_t port, int devaddr, int addr, uint8_t value)
 {
-    int bus = front_port_bus_index(port);
-    return onlp_i2c_writeb(bus, devaddr, addr, value, ONLP_I2C_F_FORCE);
+    return port_eeprom_xfer__(port, devaddr, addr, &value, 1, 1);
 }
 
 int
 onlp_sfpi_dev_readw(onlp_oid_id_t port, int devaddr, int addr)
 {
-    int bus = front_port_bus_index(port);
-    return onlp_i2c_readw(bus, devaddr, addr, ONLP_I2C_F_FORCE);
+    /* SMBus word order, low byte first. */
+    uint8_t w[2];
+    int rv = port_eeprom_xfer__(port, devaddr, addr, w, 2, 0);
+    return (rv < 0) ? rv : (w[0] | (w[1] << 8));
 }
 
 int
 onlp_sfpi_dev_writew(onlp_oid_id_t port, int devaddr, int addr, uint16_t value)
 {
-    int bus = front_port_bus_index(port);
-    return onlp_i2c_writew(bus, devaddr, addr, value, ONLP_I2C_F_FORCE);
+    uint8_t w[2] = { value & 0xFF, value >> 8 };
+    return port_eeprom_xfer__(port, devaddr, addr, w, 2, 1);
 }
 
 int
@@ -9,7 +9,9 @@ class OnlPlatform_x86_64_accton_as5712_54x_r0(OnlPlatformAccton,
     SYS_OBJECT_ID=".5712.54"
 
     def baseconfig(self):
-        self.insmod('optoe')
+        # ONLP flushes the optoe page cache on every presence change
+        # and never touches the modules behind the driver's back.
+        self.insmod('optoe', params={ 'page_cache' : 1 })
         self.insmod('cpr_4011_4mxx')
         self.insmod("ym2651y")
         for m in [ 'cpld', 'fan', 'psu', 'leds' ]:
@@ -133,6 +133,31 @@ onlp_sfpi_dev_read(onlp_oid_id_t port, int devaddr, int addr,
     return onlp_i2c_block_read(bus, devaddr, addr, size, dst, ONLP_I2C_F_FORCE);
 }
 
+int
+onlp_sfpi_port_domain_get(onlp_oid_id_t port, int* domain)
+{
+    /*
+     * Each port has its own mux channel bus. Ports behind
+     * different root adapters can be read concurrently.
+     */
+    static int root_bus[NUM_OF_SFP_PORT];
+
+    if(port >= NUM_OF_SFP_PORT) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(root_bus[port] == 0) {
+        int rv = onlp_i2c_root_bus_get(PORT_BUS_INDEX(port));
+        if(rv < 0) {
+            return rv;
+        }
+        root_bus[port] = rv + 1;
+    }
+
+    *domain = root_bus[port] - 1;
+    return ONLP_STATUS_OK;
+}
+
 int
 onlp_sfpi_dev_readb(onlp_oid_id_t port, int devaddr, int addr)
 {
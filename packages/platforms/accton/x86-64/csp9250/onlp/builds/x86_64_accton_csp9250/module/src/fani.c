@@ -23,9 +23,9 @@
  * Fan Platform Implementation Defaults.
  *
  ***********************************************************/
-#include <sys/time.h>
-#include <sys/stat.h>
 #include <onlp/platformi/fani.h>
+#include <onlplib/ipmi.h>
+#include <onlplib/ipmi_sdr.h>
 #include "platform_lib.h"
 
 #define MAX_FAN_1_SPEED     21500
@@ -36,26 +36,13 @@
 #define FAN_MAX_LENGTH     256
 #define FAN_LEAVE_NUM      2
 
-#define FAN_IPMI_TMP_FILE_RM_RPM "rm -f /tmp/fan_bmc_info_rpm > /dev/null 2>&1"
-#define FAN_IPMI_TMP_FILE_RM_PERCENT "rm -f /tmp/fan_bmc_info_rpm_percent > /dev/null 2>&1"
-
-#define FAN_IPMI_TMP_FILE_RPM            "/tmp/fan_bmc_info_rpm"
-#define FAN_IPMI_TMP_FILE_PERCENT            "/tmp/fan_bmc_info_percent"
-
-#define FAN_IPMI_TMP_FILE_FIND_NO_READ  "No Reading"
-#define FAN_IPMI_TMP_FILE_FIND "RPM"
-#define FAN_IPMI_TMP_FILE_FIND_PERCENT "02"
-
-#define FAN_IPMI_SDR_CMD      "ipmitool sdr list"
-#define FAN_IPMI_PWM_SET      "ipmitool raw 0x34 0xaa 0x5a 0x54 0x40 0x04 0x01 0xff"
-#define FAN_IPMI_PWM_GET      "ipmitool raw 0x34 0xaa 0x5a 0x54 0x40 0x04 0x02 0x01"
-#define FAN_IPMI_SDR_FILE     "/usr/bin/fan_bmc_sdr"
-#define FAN_IPMI_SDR_FILE_RM  "rm -f /usr/bin/fan_bmc_sdr > /dev/null 2>&1"
-#define FAN_CHECK_TIME        "/usr/bin/fan_check_time"
-#define FAN_IPMI_PWM_FILE     "/usr/bin/fan_bmc_pwm"
-#define FAN_IPMI_PWM_FILE_RM  "rm -f /usr/bin/fan_bmc_pwm > /dev/null 2>&1"
-
-#define FAN_CAN_SET_IPMI_TIME    5
+/* OEM PWM set: netfn 0x34 cmd 0xaa, data below followed by the percentage */
+#define FAN_IPMI_PWM_NETFN    0x34
+#define FAN_IPMI_PWM_CMD      0xaa
+#define FAN_IPMI_PWM_SET      { 0x5a, 0x54, 0x40, 0x04, 0x01, 0xff }
+/* OEM PWM get: the response carries 0x02 followed by the BCD percentage */
+#define FAN_IPMI_PWM_GET      { 0x5a, 0x54, 0x40, 0x04, 0x02, 0x01 }
+#define FAN_IPMI_PWM_GET_TAG  0x02
 
 enum fan_id {
 	FAN_1_ON_FAN_BOARD = 1,
@@ -126,169 +113,66 @@ onlp_fan_dev_t fan_sensor_table[]=
     } while(0)
  
  
-static int 
-fani_time_exist(void)
+static int
+_onlp_fani_pwm_get(int* percentage)
 {
-    struct stat file_info;    
-    if(stat(FAN_CHECK_TIME ,&file_info)==0)
-    {
-        if(file_info.st_size==0)
-            return 0;
-        return 1;      
+    uint8_t req[] = FAN_IPMI_PWM_GET;
+    uint8_t rsp[16];
+    int i, len;
+
+    len = onlp_ipmi_cmd(FAN_IPMI_PWM_NETFN, FAN_IPMI_PWM_CMD,
+                        req, sizeof(req), rsp, sizeof(rsp));
+    if(len < 0) {
+        return len;
     }
-    else
-       return 1;    
-}
-static int 
-fani_sdr_file_exist(void)
-{
-    struct stat file_info;
-    if(stat(FAN_IPMI_SDR_FILE ,&file_info)==0)
-    {
-        if(file_info.st_size==0)
-            return 0;
-        return 1;
+    for(i = 0; i < len - 1; i++) {
+        if(rsp[i] == FAN_IPMI_PWM_GET_TAG) {
+            *percentage = (rsp[i+1] >> 4) * 10 + (rsp[i+1] & 0xf);
+            return ONLP_STATUS_OK;
+        }
     }
-    else
-       return 0;    
+    return ONLP_STATUS_E_INTERNAL;
 }
 
- 
 static int
 _onlp_fani_info_get_fan(int fid, onlp_fan_info_t* info)
 {
-    int   i, size;
-    char *tag, *p;
-    char cmd[FAN_MAX_LENGTH/2]={0};
-    char fan_val_str[6]={0};
-    int  fan_val_int=0;
-    uint8_t  data[FAN_MAX_LENGTH] = {0};
-	struct  timeval    new_tv;
-    long    last_time;
-    int     get_data_by_ipmi=0;
-	
+    int   i, rpm;
+    int   fan_val_int=0;
+
 	if(fid > FAN_5_ON_FAN_BOARD)
 	    return ONLP_STATUS_E_INTERNAL;
-	
-	if(fani_time_exist())
-    {
-        if(onlp_file_read(data, FAN_MAX_LENGTH, &size, FAN_CHECK_TIME)!=ONLP_STATUS_OK)
-        {
-            last_time=0; 
-        }
-        else
-           last_time = atol((char*)data);
-    }
-    else
-        last_time=0;    
-    
-    gettimeofday(&new_tv,NULL);
-         
-    if(last_time==0) /* first time */
-    {
-        get_data_by_ipmi=1;
-    }
-    else
-    {
-         if(new_tv.tv_sec > last_time)
-         {
-             if((new_tv.tv_sec - last_time) > FAN_CAN_SET_IPMI_TIME)
-             {
-                get_data_by_ipmi=1;
-             }
-             else
-                get_data_by_ipmi=0;
-         }
-         else if(new_tv.tv_sec == last_time)
-            get_data_by_ipmi=0;
-         else
-            get_data_by_ipmi=1;
-            
-    }
-	memset(data ,0x0, FAN_MAX_LENGTH);
-    snprintf((char*)data, FAN_MAX_LENGTH-1, "%ld", new_tv.tv_sec);
-    if(onlp_file_write_str((char*)data, FAN_CHECK_TIME)!=ONLP_STATUS_OK)
-    {
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    
-    if(get_data_by_ipmi || !fani_sdr_file_exist()) /* Set ipmitool cmd to get all data and save to file*/
-    {
-        /* set ipmi sdr cmd to get rpm */
-        snprintf(cmd, (FAN_MAX_LENGTH/2) -1, "%s > %s ", FAN_IPMI_SDR_CMD, FAN_IPMI_SDR_FILE);
-        system(cmd);
-        /* set ipmi cmd to get pwm */        
-        snprintf(cmd, (FAN_MAX_LENGTH/2) -1, "%s > %s ", FAN_IPMI_PWM_GET, FAN_IPMI_PWM_FILE);
-        system(cmd);
-        fflush(stdout);
-    }    
+
 	for(i=0; i<FAN_LEAVE_NUM; i++)
 	{
-        tag=fan_sensor_table[fid].tag[i];
-        snprintf(cmd , (FAN_MAX_LENGTH/2)-1, "cat %s |grep %s > %s", FAN_IPMI_SDR_FILE, tag, FAN_IPMI_TMP_FILE_RPM);
-        system(cmd);
-        
-        if(onlp_file_read(data, FAN_MAX_LENGTH, &size, FAN_IPMI_TMP_FILE_RPM)!=ONLP_STATUS_OK)
-        {
-            return ONLP_STATUS_E_INTERNAL;
-        }    
-        p=strstr((char*)data, FAN_IPMI_TMP_FILE_FIND);
-        if(p==NULL)
+        if(onlp_ipmi_sdr_reading_get(fan_sensor_table[fid].tag[i], &rpm) < 0)
         {
             return ONLP_STATUS_E_INTERNAL;
         }
-        if(((uint8_t*)p-data) < sizeof(fan_val_str)/sizeof(char))
-        {
-            return ONLP_STATUS_E_INTERNAL;
-        }
-        fan_val_str[0]=(data[(uint8_t*)p-data-6]=='|' || data[(uint8_t*)p-data-6]==' ')?'0':data[(uint8_t*)p-data-6];
-        fan_val_str[1]=(data[(uint8_t*)p-data-5]=='|' || data[(uint8_t*)p-data-5]==' ')?'0':data[(uint8_t*)p-data-5];
-        fan_val_str[2]=(data[(uint8_t*)p-data-4]=='|' || data[(uint8_t*)p-data-4]==' ')?'0':data[(uint8_t*)p-data-4];        
-        fan_val_str[3]=(data[(uint8_t*)p-data-3]=='|' || data[(uint8_t*)p-data-3]==' ')?'0':data[(uint8_t*)p-data-3];
-        fan_val_str[4]=(data[(uint8_t*)p-data-2]=='|' || data[(uint8_t*)p-data-2]==' ')?'0':data[(uint8_t*)p-data-2];        
+        rpm /= 1000;
         /* take the min value from front/rear fan speed
 	     */
-        if(!fan_val_int)
+        if(rpm && (!fan_val_int || rpm < fan_val_int))
         {
-            if(fan_val_int < ONLPLIB_ATOI(fan_val_str))
-            {
-      	 	   fan_val_int=ONLPLIB_ATOI(fan_val_str);
-            }
+            fan_val_int=rpm;
         }
-        else
-            fan_val_int=ONLPLIB_ATOI(fan_val_str);
     }
-    
+
 	if(fan_val_int==0)
     {
         info->status &= ~ONLP_FAN_STATUS_PRESENT;
         return ONLP_STATUS_OK;
 	}
-	info->rpm=fan_val_int;	
+	info->rpm=fan_val_int;
 	info->percentage=0;
-	snprintf(cmd , (FAN_MAX_LENGTH/2)-1, "cat %s > %s", FAN_IPMI_PWM_FILE, FAN_IPMI_TMP_FILE_PERCENT);
-	system(cmd);
-	
-	if(onlp_file_read(data, FAN_MAX_LENGTH, &size, FAN_IPMI_TMP_FILE_PERCENT)!=ONLP_STATUS_OK)
-    {
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    p=strstr((char*)data, FAN_IPMI_TMP_FILE_FIND_PERCENT);
-    if(p==NULL)
-    {
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    if(((uint8_t*)p-data) < sizeof(fan_val_str)/sizeof(char))
+
+    if(_onlp_fani_pwm_get(&info->percentage) < 0)
     {
         return ONLP_STATUS_E_INTERNAL;
     }
-    memset(fan_val_str, 0x0, sizeof(fan_val_str));
-    fan_val_str[0]=data[(uint8_t*)p-data+3];
-    fan_val_str[1]=data[(uint8_t*)p-data+4];
-    info->percentage = ONLPLIB_ATOI(fan_val_str);
-    
+
     info->status |= ONLP_FAN_STATUS_PRESENT;
-  
+
 	return ONLP_STATUS_OK;
 }
 
@@ -298,12 +182,7 @@ _onlp_fani_info_get_fan(int fid, onlp_fan_info_t* info)
 int
 onlp_fani_init(void)
 {
-    char     cmd[FAN_MAX_LENGTH/2] = {0};
-    
-    snprintf(cmd, (FAN_MAX_LENGTH/2) -1, "echo 0 >  %s ", FAN_CHECK_TIME);
-    system(cmd);
     return ONLP_STATUS_OK;
-   
 }
 
 int
@@ -359,7 +238,8 @@ int
 onlp_fani_percentage_set(onlp_oid_t id, int p)
 {
     int  fid;
-    char cmd[FAN_MAX_LENGTH/2]={0};
+    uint8_t req[] = FAN_IPMI_PWM_SET;
+    uint8_t data[sizeof(req)+1];
     
     VALIDATE(id);
 
@@ -378,8 +258,13 @@ onlp_fani_percentage_set(onlp_oid_t id, int p)
             return ONLP_STATUS_E_INVALID;
     }
 	
-    snprintf(cmd,FAN_MAX_LENGTH/2,  "%s %d > /dev/null 2>&1", FAN_IPMI_PWM_SET, p);
-    system(cmd);
+    memcpy(data, req, sizeof(req));
+    data[sizeof(req)] = p;
+    if(onlp_ipmi_cmd(FAN_IPMI_PWM_NETFN, FAN_IPMI_PWM_CMD,
+                     data, sizeof(data), NULL, 0) < 0)
+    {
+        return ONLP_STATUS_E_INTERNAL;
+    }
     
 	return ONLP_STATUS_OK;
 }
@@ -1,5 +1,7 @@
 
 #include <onlp/platformi/base.h>
+#include <onlplib/ipmi_sdr.h>
+#include "platform_lib.h"
 
 const char*
 onlp_platformi_get(void)
@@ -10,6 +12,8 @@ onlp_platformi_get(void)
 int
 onlp_platformi_sw_init(void)
 {
+    onlp_ipmi_sdr_age_set(BMC_SENSOR_READING_AGE_USECS,
+                          ONLPLIB_CONFIG_IPMI_SDR_CHECK_USECS);
     return ONLP_STATUS_OK;
 }
 
@@ -38,6 +38,9 @@
 #define PSU1_ID 1
 #define PSU2_ID 2
 
+/* PMBus READ_VIN, READ_IIN, READ_IOUT, READ_POUT */
+static const uint8_t psu_pmbus_regs[] = { 0x88, 0x89, 0x8c, 0x96 };
+
 /*
  * Get all information about the given PSU oid.
  */
@@ -83,6 +86,7 @@ int
 onlp_psui_info_get(onlp_oid_t id, onlp_psu_info_t* info)
 {
 	int pid, value, addr;
+	int pmbus[AIM_ARRAYSIZE(psu_pmbus_regs)];
 	
 	uint8_t mask = 0;
 
@@ -122,16 +126,19 @@ onlp_psui_info_get(onlp_oid_t id, onlp_psu_info_t* info)
         return ONLP_STATUS_E_INTERNAL;
     }
 
-	/* Read vin */
+	/* Read the PMBus registers in one round trip */
 	addr  = (pid == PSU1_ID) ? 0x59 : 0x5a;
-	value = bmc_i2c_readw(7, addr, 0x88);
+	bmc_i2c_readw_multi(7, addr, psu_pmbus_regs, pmbus, AIM_ARRAYSIZE(psu_pmbus_regs));
+
+	/* Read vin */
+	value = pmbus[0];
 	if (value >= 0) {
 	    info->mvin = pmbus_parse_literal_format(value);
 	    info->caps |= ONLP_PSU_CAPS_VIN;
 	}
 
 	/* Read iin */
-	value = bmc_i2c_readw(7, addr, 0x89);
+	value = pmbus[1];
 	if (value >= 0) {
 	    info->miin = pmbus_parse_literal_format(value);
 	    info->caps |= ONLP_PSU_CAPS_IIN;
@@ -144,14 +151,14 @@ onlp_psui_info_get(onlp_oid_t id, onlp_psu_info_t* info)
 	}
 
 	/* Read iout */
-	value = bmc_i2c_readw(7, addr, 0x8c);
+	value = pmbus[2];
 	if (value >= 0) {
 	    info->miout = pmbus_parse_literal_format(value);
 	    info->caps |= ONLP_PSU_CAPS_IOUT;
 	}
 
 	/* Read pout */
-	value = bmc_i2c_readw(7, addr, 0x96);
+	value = pmbus[3];
 	if (value >= 0) {
 	    info->mpout = pmbus_parse_literal_format(value);
 	    info->caps |= ONLP_PSU_CAPS_POUT;
@@ -60,10 +60,12 @@ enum onlp_thermal_id
 int bmc_send_command(char *cmd);
 int bmc_file_read_str(char *file, char *result, int slen);
 int bmc_file_read_int(int* value, char *file, int base);
+int bmc_file_read_int_multi(int* values, char **files, int count, int base);
 int bmc_i2c_readb(uint8_t bus, uint8_t devaddr, uint8_t addr);
 int bmc_i2c_writeb(uint8_t bus, uint8_t devaddr, uint8_t addr, uint8_t value);
 int bmc_i2c_write_quick_mode(uint8_t bus, uint8_t devaddr, uint8_t value);
 int bmc_i2c_readw(uint8_t bus, uint8_t devaddr, uint8_t addr);
+int bmc_i2c_readw_multi(uint8_t bus, uint8_t devaddr, const uint8_t *addrs, int *values, int count);
 int bmc_i2c_readraw(uint8_t bus, uint8_t devaddr, uint8_t addr, char* data, int data_size);
 
 int bmc_tty_init(void);
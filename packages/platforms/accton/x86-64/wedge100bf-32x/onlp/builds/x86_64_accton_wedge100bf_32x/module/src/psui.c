@@ -42,6 +42,9 @@
 
 static const char *psu_pfedrv_i2c_devaddr[] = {"0059", "005a"};
 
+/* PMBus READ_VIN, READ_IIN, READ_IOUT, READ_POUT */
+static const uint8_t psu_pmbus_regs[] = { 0x88, 0x89, 0x8c, 0x96 };
+
 /*
  * Get all information about the given PSU oid.
  */
@@ -122,6 +125,7 @@ int onlp_psui_hdr_get(onlp_oid_id_t id, onlp_oid_hdr_t* rv) {
  */
 int onlp_psui_info_get(onlp_oid_id_t id, onlp_psu_info_t* info) {
     int value, addr, ret = 0;
+    int pmbus[AIM_ARRAYSIZE(psu_pmbus_regs)];
     char file[32] = {0};
     char path[80] = {0};
     
@@ -183,16 +187,19 @@ int onlp_psui_info_get(onlp_oid_id_t id, onlp_psu_info_t* info) {
     }
     usleep(1200);
 
-    /* Read vin */
+    /* Read the PMBus registers in one round trip */
     addr  = (id == PSU1_ID) ? 0x59 : 0x5a;
-    value = bmc_i2c_readw(7, addr, 0x88);
+    bmc_i2c_readw_multi(7, addr, psu_pmbus_regs, pmbus, AIM_ARRAYSIZE(psu_pmbus_regs));
+
+    /* Read vin */
+    value = pmbus[0];
     if (value >= 0) {
         info->mvin = pmbus_parse_literal_format(value);
         info->caps |= ONLP_PSU_CAPS_GET_VIN;
     }
 
     /* Read iin */
-    value = bmc_i2c_readw(7, addr, 0x89);
+    value = pmbus[1];
     if (value >= 0) {
         info->miin = pmbus_parse_literal_format(value);
         info->caps |= ONLP_PSU_CAPS_GET_IIN;
@@ -205,14 +212,14 @@ int onlp_psui_info_get(onlp_oid_id_t id, onlp_psu_info_t* info) {
     }
 
     /* Read iout */
-    value = bmc_i2c_readw(7, addr, 0x8c);
+    value = pmbus[2];
     if (value >= 0) {
         info->miout = pmbus_parse_literal_format(value);
         info->caps |= ONLP_PSU_CAPS_GET_IOUT;
     }
 
     /* Read pout */
-    value = bmc_i2c_readw(7, addr, 0x96);
+    value = pmbus[3];
     if (value >= 0) {
         info->mpout = pmbus_parse_literal_format(value);
         info->caps |= ONLP_PSU_CAPS_GET_POUT;
@@ -80,7 +80,10 @@ int
 onlp_fani_info_get(onlp_oid_t id, onlp_fan_info_t* info)
 {
     int  value = 0, fid;
+    int  rpm[2];
     char path[64] = {0};
+    char rear[64] = {0};
+    char *rpm_path[] = { path, rear };
     VALIDATE(id);
 
     fid = ONLP_OID_ID_GET(id);
@@ -101,24 +104,17 @@ onlp_fani_info_get(onlp_oid_t id, onlp_fan_info_t* info)
     info->status |= ONLP_FAN_STATUS_PRESENT;
 
 
-    /* get front fan rpm
+    /* get front and rear fan rpm in one round trip
      */
     sprintf(path, "%s""fan%d_input", FAN_BOARD_PATH, fid*2 - 1);
+    sprintf(rear, "%s""fan%d_input", FAN_BOARD_PATH, fid*2);
 
-    if (bmc_file_read_int(&value, path, 10) < 0) {
-        AIM_LOG_ERROR("Unable to read status from file (%s)\r\n", path);
-        return ONLP_STATUS_E_INTERNAL;
-    }    
-    info->rpm = value;
-
-    /* get rear fan rpm
-     */
-    sprintf(path, "%s""fan%d_input", FAN_BOARD_PATH, fid*2);
-
-    if (bmc_file_read_int(&value, path, 10) < 0) {
+    if (bmc_file_read_int_multi(rpm, rpm_path, 2, 10) < 0) {
         AIM_LOG_ERROR("Unable to read status from file (%s)\r\n", path);
         return ONLP_STATUS_E_INTERNAL;
     }
+    info->rpm = rpm[0];
+    value = rpm[1];
 
     /* take the min value from front/rear fan speed
      */
@@ -23,160 +23,119 @@
  *
  ***********************************************************/
 #include <termios.h>
-#include <unistd.h>
-#include <fcntl.h>
+#include <pthread.h>
 #include <onlplib/file.h>
+#include <onlplib/bmc_tty.h>
 #include <onlp/onlp.h>
 #include "platform_lib.h"
 
 #define TTY_DEVICE                      "/dev/ttyACM0"
 #define TTY_PROMPT                      "@bmc:"
-#define TTY_I2C_TIMEOUT                 800000
-#define TTY_BMC_LOGIN_TIMEOUT            1000000
-#define TTY_RETRY                        10
+#define TTY_TIMEOUT_MS                  5000
+#define TTY_BMC_LOGIN_TIMEOUT_MS        2000
+#define TTY_RETRY                       3
+#define TTY_CACHE_USECS                 2000000
 #define MAXIMUM_TTY_BUFFER_LENGTH       1024
-#define MAXIMUM_TTY_STRING_LENGTH       (MAXIMUM_TTY_BUFFER_LENGTH - 1)
-
-static int  tty_fd = -1;
-static char tty_buf[MAXIMUM_TTY_BUFFER_LENGTH] = {0};
-
-static int tty_open(void)
+#define MAXIMUM_BMC_CMD_LENGTH          64
+#define MAXIMUM_BMC_BATCH               8
+
+/*
+ * The BMC console is shared by all threads and kept logged in.
+ * Reads are cached for TTY_CACHE_USECS; any write invalidates the cache.
+ */
+static const onlp_bmc_tty_config_t tty_config = {
+    .device = TTY_DEVICE,
+    .speed = B57600,
+    .prompt = TTY_PROMPT,
+    .login_prompt = "bmc login:",
+    .user = "root",
+    .password = "0penBmc",
+    .timeout_ms = TTY_TIMEOUT_MS,
+    .login_timeout_ms = TTY_BMC_LOGIN_TIMEOUT_MS,
+    .retries = TTY_RETRY,
+    .cache_usecs = TTY_CACHE_USECS,
+};
+
+static pthread_once_t tty_once = PTHREAD_ONCE_INIT;
+
+static void tty_init_once(void)
 {
-    int i = 20;
-    struct termios attr;
-
-    if (tty_fd > -1) {
-        return 0;
-    }
-
-    do {
-        if ((tty_fd = open(TTY_DEVICE, O_RDWR | O_NOCTTY | O_NDELAY)) > -1) {
-            tcgetattr(tty_fd, &attr);
-            attr.c_cflag = B57600 | CS8 | CLOCAL | CREAD;
-            attr.c_iflag = IGNPAR;
-            attr.c_oflag = 0;
-            attr.c_lflag = 0;
-            attr.c_cc[VMIN] = (unsigned char)
-                ((MAXIMUM_TTY_STRING_LENGTH > 0xFF) ?  0xFF : MAXIMUM_TTY_STRING_LENGTH);
-            attr.c_cc[VTIME] = 0;
-            cfsetospeed(&attr, B57600);
-            cfsetispeed(&attr, B57600);
-            tcsetattr(tty_fd, TCSANOW, &attr);
-            return 0;
-        }
-
-        i--;
-        usleep(100000);
-    } while (i > 0);
-
-    return -1;
+    onlp_bmc_tty_init(&tty_config);
 }
 
-static int tty_close(void)
+static int bmc_exec_batch(onlp_bmc_tty_cmd_t *cmds, int count)
 {
-    close(tty_fd);
-    tty_fd = -1;
-    return 0;
+    pthread_once(&tty_once, tty_init_once);
+    return onlp_bmc_tty_exec_batch(cmds, count);
 }
 
-static int tty_exec_buf(unsigned long udelay, const char *str)
+static int bmc_exec(char *cmd, char *out, int size)
 {
-    if (tty_fd < 0)
-        return -1;
-
-    write(tty_fd, tty_buf, strlen(tty_buf)+1);
-    usleep(udelay);
-    read(tty_fd, tty_buf, MAXIMUM_TTY_BUFFER_LENGTH);
-    return (strstr(tty_buf, str) != NULL) ? 0 : -1;
+    pthread_once(&tty_once, tty_init_once);
+    return onlp_bmc_tty_exec(cmd, out, size, ONLP_BMC_TTY_F_CACHED);
 }
 
-static int tty_login(void)
+int bmc_send_command(char *cmd)
 {
-    int i = 10;
-
-    for (i = 1; i <= TTY_RETRY; i++) {
-        snprintf(tty_buf, MAXIMUM_TTY_BUFFER_LENGTH, "\r\r");
-        if (!tty_exec_buf(0, TTY_PROMPT)) {
-            return 0;
-        }
+    onlp_bmc_tty_cmd_t c;
 
-        if (strstr(tty_buf, "bmc login:") != NULL)
-        {
-            snprintf(tty_buf, MAXIMUM_TTY_BUFFER_LENGTH, "root\r");
-            
-            if (!tty_exec_buf(TTY_BMC_LOGIN_TIMEOUT, "Password:")) {
-                snprintf(tty_buf, MAXIMUM_TTY_BUFFER_LENGTH, "0penBmc\r");
-                if (!tty_exec_buf(TTY_BMC_LOGIN_TIMEOUT, TTY_PROMPT)) {
-                    return 0;
-                }
-
-            }
-        }
-        usleep(50000);
+    memset(&c, 0, sizeof(c));
+    c.cmd = cmd;
+    if (bmc_exec_batch(&c, 1) < 0) {
+        AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
+        return -1;
     }
-
-    return -1;
+    return 0;
 }
 
-int bmc_send_command(char *cmd)
+int
+bmc_command_read_int(int* value, char *cmd, int base)
 {
-    int i, ret = 0;
-    
-    for (i = 1; i <= TTY_RETRY; i++) {
-        if (tty_open() != 0) {
-            printf("ERROR: Cannot open TTY device\n");
-            continue;
-        }
-        if (tty_login() != 0) {
-            //printf("ERROR: Cannot login TTY device\n");
-            tty_close();
-            continue;
-        }
-
-            snprintf(tty_buf, MAXIMUM_TTY_BUFFER_LENGTH, "%s", cmd);
-        ret = tty_exec_buf(TTY_I2C_TIMEOUT * i, TTY_PROMPT);
-        tty_close();
-        if (ret != 0) {
-            printf("ERROR: bmc_send_command timed out\n");
-            continue;
-        }
+    char out[MAXIMUM_BMC_CMD_LENGTH];
 
-        return 0;
+    if (bmc_exec(cmd, out, sizeof(out)) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
     }
-
-    AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
-    return -1;
+    *value = strtoul(out, NULL, base);
+    return 0;
 }
 
-int
-bmc_command_read_int(int* value, char *cmd, int base)
+/*
+ * Run several read commands in one round trip.
+ * values[i] is negative if command i failed.
+ */
+static int
+bmc_command_read_int_multi(int* values, char **cmds, int count, int base)
 {
-    int len;
+    onlp_bmc_tty_cmd_t c[MAXIMUM_BMC_BATCH];
+    char out[MAXIMUM_BMC_BATCH][MAXIMUM_BMC_CMD_LENGTH];
     int i;
-    char *prev_str = NULL;
-    char *current_str= NULL;
-    if (bmc_send_command(cmd) < 0) {
-        return ONLP_STATUS_E_INTERNAL;
+
+    if (count > MAXIMUM_BMC_BATCH) {
+        return ONLP_STATUS_E_PARAM;
     }
-    len = (int)strlen(cmd);
-    prev_str = strstr(tty_buf, cmd);
-    if (prev_str == NULL) {
-        return -1;
+
+    memset(c, 0, sizeof(c));
+    for (i = 0; i < count; i++) {
+        c[i].cmd = cmds[i];
+        c[i].flags = ONLP_BMC_TTY_F_CACHED;
+        c[i].out = out[i];
+        c[i].out_size = sizeof(out[i]);
+        values[i] = ONLP_STATUS_E_INTERNAL;
+    }
+
+    if (bmc_exec_batch(c, count) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
     }
-    for (i = 1; i <= TTY_RETRY; i++) {
-        current_str = strstr(prev_str + len, cmd);
-        if(current_str == NULL) {
-            *value = strtoul(prev_str + len, NULL, base);
-            break;
-        }else {
-            prev_str = current_str;
-            continue;
+
+    for (i = 0; i < count; i++) {
+        if (c[i].exit == 0) {
+            values[i] = strtoul(out[i], NULL, base);
         }
     }
     return 0;
 }
 
-
 int
 bmc_file_read_int(int* value, char *file, int base)
 {
@@ -185,6 +144,32 @@ bmc_file_read_int(int* value, char *file, int base)
     return bmc_command_read_int(value, cmd, base);
 }
 
+int
+bmc_file_read_int_multi(int* values, char **files, int count, int base)
+{
+    char cmd[MAXIMUM_BMC_BATCH][MAXIMUM_BMC_CMD_LENGTH];
+    char *cmds[MAXIMUM_BMC_BATCH];
+    int i;
+
+    if (count > MAXIMUM_BMC_BATCH) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    for (i = 0; i < count; i++) {
+        snprintf(cmd[i], sizeof(cmd[i]), "cat %s", files[i]);
+        cmds[i] = cmd[i];
+    }
+    if (bmc_command_read_int_multi(values, cmds, count, base) < 0) {
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (values[i] < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int
 bmc_i2c_readb(uint8_t bus, uint8_t devaddr, uint8_t addr)
 {
@@ -215,26 +200,45 @@ bmc_i2c_readw(uint8_t bus, uint8_t devaddr, uint8_t addr)
     return (ret < 0) ? ret : value;
 }
 
+int
+bmc_i2c_readw_multi(uint8_t bus, uint8_t devaddr, const uint8_t *addrs, int *values, int count)
+{
+    char cmd[MAXIMUM_BMC_BATCH][MAXIMUM_BMC_CMD_LENGTH];
+    char *cmds[MAXIMUM_BMC_BATCH];
+    int i;
+
+    if (count > MAXIMUM_BMC_BATCH) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    for (i = 0; i < count; i++) {
+        snprintf(cmd[i], sizeof(cmd[i]), "i2cget -f -y %d 0x%x 0x%02x w", bus, devaddr, addrs[i]);
+        cmds[i] = cmd[i];
+    }
+    return bmc_command_read_int_multi(values, cmds, count, 16);
+}
+
 int
 bmc_i2c_readraw(uint8_t bus, uint8_t devaddr, uint8_t addr, char* data, int data_size)
 {
     int data_len, i = 0;
     char cmd[64] = {0};
+    char out[MAXIMUM_TTY_BUFFER_LENGTH];
     char *str = NULL;
     snprintf(cmd, sizeof(cmd), "i2craw -w 0x%x -r 0 %d 0x%02x\r\n", addr, bus, devaddr);
 
-    if (bmc_send_command(cmd) < 0) {
+    if (bmc_exec(cmd, out, sizeof(out)) < 0) {
         AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
         return ONLP_STATUS_E_INTERNAL;
     }
 
-    str = strstr(tty_buf, "Received:\r\n  ");
+    str = strstr(out, "Received:\n  ");
     if (str == NULL) {
         return -1;
     }
 
     /* first byte is data length */
-    str += strlen("Received:\r\n  ");;
+    str += strlen("Received:\n  ");
     data_len = strtoul(str, NULL, 16);
     if (data_size < data_len) {
         data_len = data_size;
@@ -246,6 +250,5 @@ bmc_i2c_readraw(uint8_t bus, uint8_t devaddr, uint8_t addr, char* data, int data
     }
 
     data[i] = 0;
-    return 0;    
+    return 0;
 }
-
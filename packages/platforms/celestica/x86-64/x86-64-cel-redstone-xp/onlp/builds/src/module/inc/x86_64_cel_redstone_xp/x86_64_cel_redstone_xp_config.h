@@ -89,6 +89,16 @@
 #define X86_64_CEL_REDSTONE_XP_CONFIG_INCLUDE_UCLI 0
 #endif
 
+/**
+ * X86_64_CEL_REDSTONE_XP_CONFIG_CPLD_IO_DEV_PORT
+ *
+ * Access the CPLDs through /dev/port instead of direct port I/O. */
+
+
+#ifndef X86_64_CEL_REDSTONE_XP_CONFIG_CPLD_IO_DEV_PORT
+#define X86_64_CEL_REDSTONE_XP_CONFIG_CPLD_IO_DEV_PORT 0
+#endif
+
 
 
 /**
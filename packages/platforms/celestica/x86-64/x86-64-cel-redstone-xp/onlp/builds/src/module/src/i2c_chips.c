@@ -210,66 +210,30 @@ void Sleep(int ms)
 void wdo_kick()
 {
 	/*kick watchdog*/
-	if (iopl(3))
-	{
-		perror("iopl");
-		exit(1);/* reminder here: do not use "return", I warned */
-	}
-	else
-	{
-		gpio_core_set_value(15,0);
-		Sleep(10);
-		gpio_core_set_value(15,1);
-	}
-	if (iopl(0))
-	{
-		perror("iopl");
+	if (lpc_gpio_io_init() < 0)
 		exit(1);/* reminder here: do not use "return", I warned */
-	}
 
+	gpio_core_set_value(15,0);
+	Sleep(10);
+	gpio_core_set_value(15,1);
 }
 
 int wdo_enable(int value)
 {
-	unsigned char ret;
-	unsigned char buf = 0x00;
+	int ret;
 
 	if (value == 0 ) {
-		ret = read_cpld(CPLD_RESET_CONTROL, &buf);
-		if(ret < 0)
-			return ret;
-
-        buf &= ~WDO_MASK;
-
-        ret = write_cpld(CPLD_RESET_CONTROL, buf);
-		if(ret < 0)
-			return ret;
+		ret = cpld_modify(CPLD_RESET_CONTROL, ~WDO_MASK, 0);
 	} else {
-		if (iopl(3))
-		{
-			perror("iopl");
+		if (lpc_gpio_io_init() < 0)
 			exit(1);/* reminder here: do not use "return", I warned */
-		}
-		else
-		{
-			gpio_core_init(15);
-			gpio_core_set_dir(15,gpio_out);
-		}
-		if (iopl(0))
-		{
-			perror("iopl");
-			exit(1);/* reminder here: do not use "return", I warned */
-		}
 
-		ret = read_cpld(CPLD_RESET_CONTROL, &buf);
-		if(ret < 0)
-			return ret;
+		gpio_core_init(15);
+		gpio_core_set_dir(15,gpio_out);
+
 		wdo_kick();
 
-		buf |= WDO_MASK;
-		ret = write_cpld(CPLD_RESET_CONTROL, buf);
-		if(ret < 0)
-			return ret;
+		ret = cpld_modify(CPLD_RESET_CONTROL, 0xff, WDO_MASK);
 	}
 	return ret;
 }
@@ -296,23 +260,17 @@ unsigned char getCpuId()
 	return PSOC_CTRL_SMBUS;
 #endif
 
-	if (iopl(3))
-	{
-		perror("iopl");
+	if (has_been_read)
+		return cpu_id;
+
+	if (lpc_gpio_io_init() < 0)
 		exit(1);/* reminder here: do not use "return", I warned */
-	}
-	else
-	{
-		gpio_sus_init(19);
-		gpio_sus_set_dir(19,gpio_in);
-	}
+
+	gpio_sus_init(19);
+	gpio_sus_set_dir(19,gpio_in);
+
 	/*read cpu id*/
 	cpu_id |= gpio_sus_get_value(19) << 0 ;
-	if (iopl(0))
-	{
-		perror("iopl");
-		exit(1);/* reminder here: do not use "return", I warned */
-	}
 	has_been_read = 1;
 
 	return cpu_id;
@@ -1651,22 +1609,13 @@ int setFanLedOff(int id)
 
 int setPsuLedOn(int id)
 {
-	int ret = -1;
-	unsigned char buf = 0x00;
-	ret = read_cpld(CPLD_FP_LED, &buf);
-	buf &= ~(1 << (2 + id));
-	ret = write_cpld(CPLD_FP_LED, buf);
-	return ret;
+	return cpld_modify(CPLD_FP_LED, ~(1 << (2 + id)), 0);
 }
 int setPsuLedOff(int id)
 {
-	int ret = -1;
-	unsigned char buf = 0x00;
-
-	ret = read_cpld(CPLD_FP_LED, &buf);
+	int ret;
 
-	buf |= 1 << (2 + id);
-	ret = write_cpld(CPLD_FP_LED, buf);
+	ret = cpld_modify(CPLD_FP_LED, 0xff, 1 << (2 + id));
 	if (ret < 0)
 	{
 			printf("write error\n");
@@ -1678,12 +1627,9 @@ int setPsuLedOff(int id)
 }
 int setSysLedOn()
 {
-	int ret = -1;
-	unsigned char buf = 0x00;
-	ret = read_cpld(CPLD_FP_LED, &buf);
-	buf &=  ~(BIT0);
-	buf &=  ~(BIT1);;
-	ret = write_cpld(CPLD_FP_LED, buf);
+	int ret;
+
+	ret = cpld_modify(CPLD_FP_LED, ~(BIT0 | BIT1), 0);
 	if (ret < 0)
 	{
 			printf("setSysLedOn error\n");
@@ -1697,12 +1643,9 @@ int setSysLedOn()
 int
 setSysLedOff()
 {
-	int ret = -1;
-	unsigned char buf = 0x00;
+	int ret;
 
-	ret = read_cpld(CPLD_FP_LED, &buf);
-	buf |= 0x11;
-	ret = write_cpld(CPLD_FP_LED, buf);
+	ret = cpld_modify(CPLD_FP_LED, 0xff, 0x11);
 	if (ret < 0)
 	{
 			printf("setSysLedOff error\n");
@@ -1,4 +1,6 @@
 #include <errno.h>
+#include <fcntl.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/io.h>
 
@@ -7,54 +9,303 @@
 #include "x86_64_cel_redstone_xp_int.h"
 #include "redstone_cpld.h"
 
+/*
+ * Direct port I/O.
+ * Access to the CPLD range is granted once with ioperm() instead
+ * of raising and dropping the I/O privilege level around each access.
+ * The permission belongs to the calling thread, so the grant is
+ * tracked per thread.
+ */
+static __thread int cpld_port_granted__ = 0;
+
+static int
+cpld_port_init__(void)
+{
+    if(!cpld_port_granted__) {
+        if(ioperm(CPLD_IO_BASE, CPLD_IO_SIZE, 1) == -1) {
+            AIM_LOG_ERROR("ioperm() failed: %{errno}", errno);
+            return -1;
+        }
+        cpld_port_granted__ = 1;
+    }
+    return 0;
+}
+
+static int
+cpld_port_read__(int addr, uint8_t* data, int len)
+{
+    if(cpld_port_init__() < 0) {
+        return -1;
+    }
+    while(len-- > 0) {
+        *(data++) = inb(addr++);
+    }
+    return 0;
+}
+
+static int
+cpld_port_write__(int addr, uint8_t value)
+{
+    if(cpld_port_init__() < 0) {
+        return -1;
+    }
+    outb(value, addr);
+    return 0;
+}
+
+const cpld_io_ops_t cpld_io_ops_port = {
+    "port",
+    cpld_port_init__,
+    cpld_port_read__,
+    cpld_port_write__,
+};
+
+/*
+ * /dev/port.
+ * A whole register range is read with a single pread().
+ */
+static int cpld_dev_port_fd__ = -1;
+
+static int
+cpld_dev_port_init__(void)
+{
+    if(cpld_dev_port_fd__ < 0) {
+        cpld_dev_port_fd__ = open("/dev/port", O_RDWR);
+        if(cpld_dev_port_fd__ < 0) {
+            AIM_LOG_ERROR("/dev/port: %{errno}", errno);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int
+cpld_dev_port_read__(int addr, uint8_t* data, int len)
+{
+    if(pread(cpld_dev_port_fd__, data, len, addr) != len) {
+        AIM_LOG_ERROR("/dev/port read 0x%x: %{errno}", addr, errno);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+cpld_dev_port_write__(int addr, uint8_t value)
+{
+    if(pwrite(cpld_dev_port_fd__, &value, 1, addr) != 1) {
+        AIM_LOG_ERROR("/dev/port write 0x%x: %{errno}", addr, errno);
+        return -1;
+    }
+    return 0;
+}
+
+const cpld_io_ops_t cpld_io_ops_dev_port = {
+    "/dev/port",
+    cpld_dev_port_init__,
+    cpld_dev_port_read__,
+    cpld_dev_port_write__,
+};
+
+/*
+ * Memory image of the CPLD range, for exercising the register
+ * logic without hardware.
+ */
+static uint8_t cpld_mock_regs__[CPLD_IO_SIZE];
+
+static int
+cpld_mock_init__(void)
+{
+    return 0;
+}
+
+static int
+cpld_mock_read__(int addr, uint8_t* data, int len)
+{
+    memcpy(data, cpld_mock_regs__ + (addr - CPLD_IO_BASE), len);
+    return 0;
+}
+
+static int
+cpld_mock_write__(int addr, uint8_t value)
+{
+    cpld_mock_regs__[addr - CPLD_IO_BASE] = value;
+    return 0;
+}
+
+const cpld_io_ops_t cpld_io_ops_mock = {
+    "mock",
+    cpld_mock_init__,
+    cpld_mock_read__,
+    cpld_mock_write__,
+};
+
+uint8_t*
+cpld_io_mock_regs(void)
+{
+    return cpld_mock_regs__;
+}
+
+
+#if X86_64_CEL_REDSTONE_XP_CONFIG_CPLD_IO_DEV_PORT == 1
+static const cpld_io_ops_t* cpld_io__ = &cpld_io_ops_dev_port;
+#else
+static const cpld_io_ops_t* cpld_io__ = &cpld_io_ops_port;
+#endif
+static int cpld_io_ready__ = 0;
+
+/*
+ * Registers which are only changed by read-modify-write from this
+ * library. Their last written value is kept so updates do not
+ * need to read the register back first.
+ */
+static struct {
+    int addr;
+    int valid;
+    uint8_t value;
+} cpld_shadow__[] = {
+    { CPLD_RESET_CONTROL },
+    { CPLD_FP_LED },
+};
+
+static int
+cpld_shadow_find__(int addr)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(cpld_shadow__); i++) {
+        if(cpld_shadow__[i].addr == addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void
+cpld_shadow_update__(int addr, const uint8_t* data, int len)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(cpld_shadow__); i++) {
+        if(cpld_shadow__[i].addr >= addr &&
+           cpld_shadow__[i].addr < addr + len) {
+            cpld_shadow__[i].value = data[cpld_shadow__[i].addr - addr];
+            cpld_shadow__[i].valid = 1;
+        }
+    }
+}
+
+void
+cpld_shadow_invalidate(void)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(cpld_shadow__); i++) {
+        cpld_shadow__[i].valid = 0;
+    }
+}
+
+int
+cpld_io_ops_set(const cpld_io_ops_t* ops)
+{
+    cpld_io__ = ops;
+    cpld_io_ready__ = 0;
+    cpld_shadow_invalidate();
+    return cpld_io_init();
+}
+
 int
 cpld_io_init(void)
 {
-    /* Initialize LPC access ports */
-    if(ioperm(0x100, 0x2FF, 1) == -1) {
-        AIM_LOG_ERROR("ioperm() failed: %{errno}", errno);
+    if(cpld_io_ready__) {
+        return 0;
+    }
+    if(cpld_io__->init() < 0) {
+        return -1;
+    }
+    cpld_io_ready__ = 1;
+    return 0;
+}
+
+int
+lpc_gpio_io_init(void)
+{
+    /* ioperm() applies to the calling thread only. */
+    static __thread int ready = 0;
+
+    if(!ready) {
+        if(ioperm(LPC_GPIO_IO_BASE, LPC_GPIO_IO_SIZE, 1) == -1) {
+            AIM_LOG_ERROR("ioperm() failed: %{errno}", errno);
+            return -1;
+        }
+        ready = 1;
+    }
+    return 0;
+}
+
+int
+cpld_read_range(int addr, uint8_t* data, int len)
+{
+    if(addr < CPLD_IO_BASE || len < 0 ||
+       addr + len > CPLD_IO_BASE + CPLD_IO_SIZE) {
         return -1;
     }
+    if(cpld_io_init() < 0 || cpld_io__->read(addr, data, len) < 0) {
+        return -1;
+    }
+    cpld_shadow_update__(addr, data, len);
     return 0;
 }
 
 int
 cpld_read(int addr)
 {
-    return inb(addr);
+    uint8_t v;
+    if(cpld_read_range(addr, &v, 1) < 0) {
+        return -1;
+    }
+    return v;
 }
 
 void
 cpld_write(int addr, uint8_t value)
 {
-    outb(value, addr);
+    write_cpld(addr, value);
 }
 
 int read_cpld(int reg, unsigned char *value)
 {
-    *value = inb(reg);
-    return 0;
+    return cpld_read_range(reg, value, 1);
 }
 int write_cpld(int reg, unsigned char value)
 {
-    outb(value, reg);
+    if(reg < CPLD_IO_BASE || reg >= CPLD_IO_BASE + CPLD_IO_SIZE) {
+        return -1;
+    }
+    if(cpld_io_init() < 0 || cpld_io__->write(reg, value) < 0) {
+        return -1;
+    }
+    cpld_shadow_update__(reg, &value, 1);
     return 0;
 }
 
-void
+int
 cpld_modify(int addr, uint8_t andmask, uint8_t ormask)
 {
-    int v;
-    read_cpld(addr, (unsigned char *)&v);
+    uint8_t v;
+    int s = cpld_shadow_find__(addr);
+
+    if(s >= 0 && cpld_shadow__[s].valid) {
+        v = cpld_shadow__[s].value;
+    }
+    else if(read_cpld(addr, &v) < 0) {
+        return -1;
+    }
     v &= andmask;
     v |= ormask;
-    cpld_write(addr, v);
+    return write_cpld(addr, v);
 }
 
 int
 cpld_dump(aim_pvs_t* pvs, int cpldid)
 {
-    int data;
+    unsigned char data;
 
     aim_map_si_t* si;
     aim_map_si_t* maps[] = {
@@ -70,7 +321,7 @@ cpld_dump(aim_pvs_t* pvs, int cpldid)
     }
     else {
         for(si = maps[cpldid-1]; si->s; si++) {
-            read_cpld(si->i, (unsigned char *)&data);
+            read_cpld(si->i, &data);
             aim_printf(pvs, "  %32.32s [0x%.2x] = 0x%.2x %{8bits}\n", si->s, si->i, data, data);
         }
     }
@@ -86,16 +337,47 @@ cpld_dump(aim_pvs_t* pvs, int cpldid)
 #define PORT_BANK3_END 48
 #define PORT_BANK4_START 49
 #define PORT_BANK4_END 54
+/*
+ * Wait for the SFP controller to finish the current transfer. A failed
+ * register read or a controller which stays busy is an error. So is a
+ * transfer error, after which the controller is reset.
+ */
+#define SFP_BUS_WAIT_RETRIES 1000
+
+static int
+sfp_bus_wait__(int ssrr)
+{
+    int v;
+    int retries = SFP_BUS_WAIT_RETRIES;
+
+    while((v = cpld_read(ssrr)) >= 0 && (v & 0x40)) {
+        if(--retries == 0) {
+            AIM_LOG_ERROR("SFP controller 0x%x stuck busy.", ssrr);
+            return -1;
+        }
+        usleep(100);
+    }
+    if(v < 0) {
+        return -1;
+    }
+    if((v & 0x80) == 0x80) {
+        cpld_write(ssrr, 0x00);
+        usleep(3000);
+        cpld_write(ssrr, 0x01);
+        return -1;
+    }
+    return 0;
+}
+
 int
 read_sfp(int portID, char devAddr, char reg, char *data, int len)
 {
     int count;
     char byte;
-    short temp;
     short portid, opcode, devaddr, cmdbyte0, ssrr, writedata = 0, readdata;
-    int ioBase = 0;
 
-    cpld_io_init();
+    if (cpld_io_init() < 0)
+        return -1;
 
     if ((reg + len) > 256)
         return -1;
@@ -109,14 +391,8 @@ read_sfp(int portID, char devAddr, char reg, char *data, int len)
         writedata = 0x220;
         readdata = 0x230;
 
-        while ((inb(ioBase + ssrr) & 0x40));
-
-        if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-            outb(0x00, ioBase + ssrr);
-            usleep(3000);
-            outb(0x01, ioBase + ssrr);
+        if (sfp_bus_wait__(ssrr) < 0)
             return -1;
-        }
     } else if ((portID >= PORT_BANK2_START) && (portID <= PORT_BANK2_END)) {
         portid = 0x290;
         opcode = 0x291;
@@ -126,14 +402,8 @@ read_sfp(int portID, char devAddr, char reg, char *data, int len)
         writedata = 0x2A0;
         readdata = 0x2B0;
 
-        while ((inb(ioBase + ssrr) & 0x40));
-
-        if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-            outb(0x00, ioBase + ssrr);
-            usleep(3000);
-            outb(0x01, ioBase + ssrr);
+        if (sfp_bus_wait__(ssrr) < 0)
             return -1;
-        }
     } else if ((portID >= PORT_BANK3_START) && (portID <= PORT_BANK3_END)) {
         portid = 0x390;
         opcode = 0x391;
@@ -143,14 +413,8 @@ read_sfp(int portID, char devAddr, char reg, char *data, int len)
         writedata = 0x3A0;
         readdata = 0x3B0;
 
-        while ((inb(ioBase + ssrr) & 0x40));
-
-        if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-            outb(0x00, ioBase + ssrr);
-            usleep(3000);
-            outb(0x01, ioBase + ssrr);
+        if (sfp_bus_wait__(ssrr) < 0)
             return -1;
-        }
     } else if ((portID >= PORT_BANK4_START) && (portID <= PORT_BANK4_END)) {
         portid = 0x310;
         opcode = 0x311;
@@ -160,52 +424,34 @@ read_sfp(int portID, char devAddr, char reg, char *data, int len)
         writedata = 0x320;
         readdata = 0x330;
 
-        while ((inb(ioBase + ssrr) & 0x40));
-
-        if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-            outb(0x00, ioBase + ssrr);
-            usleep(3000);
-            outb(0x01, ioBase + ssrr);
+        if (sfp_bus_wait__(ssrr) < 0)
             return -1;
-        }
     } else {
         return -1;
     }
 
     byte = 0x40 + portID;
-    outb(byte, ioBase + portid);
-    outb(reg,ioBase + cmdbyte0);
+    cpld_write(portid, byte);
+    cpld_write(cmdbyte0, reg);
 
     while (len > 0) {
         count = (len >= 8) ? 8 : len;
         len -= count;
         byte = count * 16 + 1;
-        outb(byte, ioBase + opcode);
+        cpld_write(opcode, byte);
         devAddr |= 0x01;
-        outb(devAddr, ioBase + devaddr);
+        cpld_write(devaddr, devAddr);
 
-        while ((inb(ioBase + ssrr) & 0x40))
-            usleep(100);
-
-        if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-            outb(0x00, ioBase + ssrr);
-            usleep(3000);
-            outb(0x01, ioBase + ssrr);
+        if (sfp_bus_wait__(ssrr) < 0)
             return -1;
-        }
 
-        temp = ioBase + readdata;
-
-        while (count-- > 0) {
-            char read_byte;
-            read_byte = inb(temp);
-            *(data++) = read_byte;
-            temp++;
-        }
+        if (cpld_read_range(readdata, (uint8_t *)data, count) < 0)
+            return -1;
+        data += count;
 
         if (len > 0) {
             reg += 0x08;
-            outb(reg, ioBase + cmdbyte0);
+            cpld_write(cmdbyte0, reg);
         }
     }
     return writedata * 0;
@@ -218,7 +464,9 @@ write_sfp(int portID, char devAddr, char reg, char *data, int len)
 	char byte;
 	short temp;
 	short portid, opcode, devaddr, cmdbyte0, ssrr, writedata, readdata;
-    int ioBase = 0;
+
+	if (cpld_io_init() < 0)
+		return -1;
 
 	if ((reg + len) > 256)
         return -1;
@@ -231,13 +479,8 @@ write_sfp(int portID, char devAddr, char reg, char *data, int len)
 		ssrr = 0x216;
 		writedata = 0x220;
 		readdata = 0x230;
-		while ((inb(ioBase + ssrr) & 0x40));
-		if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-			outb(0x00, ioBase + ssrr);
-			usleep(3000);
-			outb(0x01, ioBase + ssrr);
+		if (sfp_bus_wait__(ssrr) < 0)
 			return -1;
-		}
 	} else if ((portID >= PORT_BANK2_START) && (portID <= PORT_BANK2_END)) {
 		portid = 0x290;
 		opcode = 0x291;
@@ -246,13 +489,8 @@ write_sfp(int portID, char devAddr, char reg, char *data, int len)
 		ssrr = 0x296;
 		writedata = 0x2A0;
 		readdata = 0x2B0;
-		while ((inb(ioBase + ssrr) & 0x40));
-		if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-			outb(0x00, ioBase + ssrr);
-			usleep(3000);
-			outb(0x01, ioBase + ssrr);
+		if (sfp_bus_wait__(ssrr) < 0)
 			return -1;
-		}
 	} else if ((portID >= PORT_BANK3_START) && (portID <= PORT_BANK3_END)) {
 		portid = 0x390;
 		opcode = 0x391;
@@ -261,13 +499,8 @@ write_sfp(int portID, char devAddr, char reg, char *data, int len)
 		ssrr = 0x396;
 		writedata = 0x3A0;
 		readdata = 0x3B0;
-		while ((inb(ioBase + ssrr) & 0x40));
-		if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-			outb(0x00, ioBase + ssrr);
-			usleep(3000);
-			outb(0x01, ioBase + ssrr);
+		if (sfp_bus_wait__(ssrr) < 0)
 			return -1;
-		}
 	} else if ((portID >= PORT_BANK4_START) && (portID <= PORT_BANK4_END)) {
 		portid = 0x310;
 		opcode = 0x311;
@@ -276,45 +509,32 @@ write_sfp(int portID, char devAddr, char reg, char *data, int len)
 		ssrr = 0x316;
 		writedata = 0x320;
 		readdata = 0x330;
-		while ((inb(ioBase + ssrr) & 0x40));
-		if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-			outb(0x00, ioBase + ssrr);
-			usleep(3000);
-			outb(0x01, ioBase + ssrr);
+		if (sfp_bus_wait__(ssrr) < 0)
 			return -1;
-		}
 	} else {
 		return -1;
 	}
 
 	byte = 0x40 + portID;
-	outb(byte, ioBase + portid);
-	outb(reg, ioBase + cmdbyte0);
+	cpld_write(portid, byte);
+	cpld_write(cmdbyte0, reg);
 	while (len > 0) {
 		count = (len >= 8) ? 8 : len;
 		len -= count;
 		byte = (count << 4) + 1;
-		outb(byte, ioBase + opcode);
-		temp = ioBase + writedata;
+		cpld_write(opcode, byte);
+		temp = writedata;
 		while (count-- > 0) {
-			outb(*(data++), temp);
+			cpld_write(temp, *(data++));
 			temp += 0x01;
 		}
 		devAddr &= 0xfe;
-		outb(devAddr, ioBase + devaddr);
-		while ((inb(ioBase + ssrr) & 0x40))
-		{
-			usleep(100);
-		}
-		if ((inb(ioBase + ssrr) & 0x80) == 0x80) {
-			outb(0x00, ioBase + ssrr);
-			usleep(3000);
-			outb(0x01, ioBase + ssrr);
+		cpld_write(devaddr, devAddr);
+		if (sfp_bus_wait__(ssrr) < 0)
 			return -1;
-		}
 		if (len > 0) {
 			reg += 0x08;
-			outb(ioBase + cmdbyte0, reg);
+			cpld_write(cmdbyte0, reg);
 		}
 	}
     return writedata * readdata * 0;
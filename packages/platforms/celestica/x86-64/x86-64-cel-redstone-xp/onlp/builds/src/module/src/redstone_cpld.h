@@ -49,6 +49,36 @@ typedef struct SfpData
 #define CPLD_FAN_STATUS_2	0x195
 #define CPLD_PSU_STATUS	0x197
 #define CPLD_FP_LED	0x303
+#define CPLD_QSFP_ABS_STATUS	0x362
+
+/* The CPLD register window on the LPC bus. */
+#define CPLD_IO_BASE	0x100
+#define CPLD_IO_SIZE	0x300
+
+/* The chipset GPIO ports used for the watchdog and CPU ID pins. */
+#define LPC_GPIO_IO_BASE	0x500
+#define LPC_GPIO_IO_SIZE	0x90
+
+/*
+ * CPLD register access backend.
+ * read() fills len bytes from consecutive registers starting at addr.
+ */
+typedef struct cpld_io_ops_s {
+    const char* name;
+    int (*init)(void);
+    int (*read)(int addr, uint8_t* data, int len);
+    int (*write)(int addr, uint8_t value);
+} cpld_io_ops_t;
+
+extern const cpld_io_ops_t cpld_io_ops_port;
+extern const cpld_io_ops_t cpld_io_ops_dev_port;
+extern const cpld_io_ops_t cpld_io_ops_mock;
+
+/* Select the backend. The register shadows are discarded. */
+int cpld_io_ops_set(const cpld_io_ops_t* ops);
+
+/* The register image used by cpld_io_ops_mock, indexed from CPLD_IO_BASE. */
+uint8_t* cpld_io_mock_regs(void);
 
 
 int cpldRegRead(int regId, unsigned char *data, int size);
@@ -61,9 +91,12 @@ int read_sfp(int portID, char devAddr, char reg, char *data, int len);
 int write_sfp(int portID, char devAddr, char reg, char *data, int len);
 
 int cpld_io_init(void);
+int lpc_gpio_io_init(void);
 int cpld_read(int addr);
+int cpld_read_range(int addr, uint8_t* data, int len);
 void cpld_write(int addr, uint8_t value);
-void cpld_modify(int addr, uint8_t andmask, uint8_t ormask);
+int cpld_modify(int addr, uint8_t andmask, uint8_t ormask);
+void cpld_shadow_invalidate(void);
 int cpld_dump(aim_pvs_t* pvs, int cpldid);
 
 #endif /* _REDSTONE_CPLD_H_ */
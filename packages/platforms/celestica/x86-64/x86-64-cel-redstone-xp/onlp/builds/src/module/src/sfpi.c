@@ -11,72 +11,61 @@
 #include "sfp_xfp.h"
 
 
+/*
+ * Module absent bits, one bit per port starting at bit 0 of the
+ * first register of each bank.
+ */
+static const struct {
+    int first;
+    int last;
+    int reg;
+} sfp_abs_banks__[] = {
+    {  1, 18, 0x259 },
+    { 19, 36, 0x2D9 },
+    { 37, 48, 0x3D6 },
+    { 49, CEL_REDSTONE_MAX_PORT, CPLD_QSFP_ABS_STATUS },
+};
+
 static int
 _get_sfp_state(int sfp)
 {
-    unsigned char val = 0;
-    int reg;
-    int ret = -1;
-
-    if (!sfp)
-        return sfp;
-
-    if(sfp < 9) {
-        reg = 0x259;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << (sfp - 1);
-    } else if((sfp > 8) && (sfp < 17)) {
-        reg = 0x25A;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << ((sfp - 1) % 8);
-    } else if((sfp > 16) && (sfp < 19)) {
-        reg = 0x25B;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << ((sfp - 1) % 8);
-    } else if((sfp > 18) && (sfp < 29)) {
-        reg = 0x2D9;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << ((sfp - 3) % 8);
-    } else if((sfp > 28) && (sfp < 35)) {
-        reg = 0x2DA;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << ((sfp - 3) % 8);
-    } else if((sfp > 34) && (sfp < 37)) {
-        reg = 0x2DB;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << ((sfp - 3) % 8);
-    } else if((sfp > 36) && (sfp < 45)) {
-        reg = 0x3D6;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << ((sfp - 5) % 8);
-    } else if((sfp > 44) && (sfp < 49)) {
-        reg = 0x3D7;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << ((sfp - 5) % 8);
-    } else if((sfp > 48) && (sfp <= CEL_REDSTONE_MAX_PORT)) {
-        reg = 0x3D7;
-        ret = read_cpld(reg, &val);
-        if(ret < 0)
-            return ret;
-        val &= 0x1 << ((sfp - 1) % 8);
+    int i, bit, val;
+
+    for(i = 0; i < AIM_ARRAYSIZE(sfp_abs_banks__); i++) {
+        if(sfp >= sfp_abs_banks__[i].first && sfp <= sfp_abs_banks__[i].last) {
+            bit = sfp - sfp_abs_banks__[i].first;
+            val = cpld_read(sfp_abs_banks__[i].reg + bit / 8);
+            if(val < 0)
+                return val;
+            return (val & (1 << (bit % 8))) ? 0 : 1;
+        }
     }
-    return (ret = (val ? 0 : 1));
+    return 0;
+}
+
+/*
+ * Snapshot the presence of all ports with one range read per bank.
+ * present[port] is set to 1 if the module is present.
+ */
+static int
+_get_sfp_states(uint8_t present[CEL_REDSTONE_MAX_PORT + 1])
+{
+    int i, p, bit;
+    uint8_t regs[4];
+
+    for(i = 0; i < AIM_ARRAYSIZE(sfp_abs_banks__); i++) {
+        int first = sfp_abs_banks__[i].first;
+        int last = sfp_abs_banks__[i].last;
+
+        if(cpld_read_range(sfp_abs_banks__[i].reg, regs, (last - first) / 8 + 1) < 0)
+            return -1;
+
+        for(p = first; p <= last; p++) {
+            bit = p - first;
+            present[p] = (regs[bit / 8] & (1 << (bit % 8))) ? 0 : 1;
+        }
+    }
+    return 0;
 }
 
 /*@ _read_sfp
@@ -259,18 +248,17 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
 int
 onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
 {
-    uint32_t i;
-    int rt;
+    int i;
+    uint8_t present[CEL_REDSTONE_MAX_PORT + 1];
 
     AIM_BITMAP_CLR_ALL(dst);
 
-    for(i=0; i< CEL_REDSTONE_MAX_PORT; i++) {
-        rt = _get_sfp_state(i);
-        if (rt < 0 ) {
-            return ONLP_STATUS_E_INTERNAL;
-        } else if (rt) {
+    if (_get_sfp_states(present) < 0)
+        return ONLP_STATUS_E_INTERNAL;
+
+    for(i=1; i<= CEL_REDSTONE_MAX_PORT; i++) {
+        if (present[i])
             AIM_BITMAP_SET(dst, i);
-        }
     }
     return ONLP_STATUS_OK;
 }
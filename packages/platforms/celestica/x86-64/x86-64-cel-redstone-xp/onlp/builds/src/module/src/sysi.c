@@ -20,7 +20,14 @@ onlp_sysi_platform_get(void)
 int
 onlp_sysi_init(void)
 {
-    return cpld_io_init();
+    /*
+     * Grant port access from the initializing thread, before any
+     * worker threads exist.
+     */
+    if(cpld_io_init() < 0 || lpc_gpio_io_init() < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return ONLP_STATUS_OK;
 }
 
 
@@ -44,6 +44,11 @@ x86_64_cel_redstone_xp_config_settings_t x86_64_cel_redstone_xp_config_settings[
     { __x86_64_cel_redstone_xp_config_STRINGIFY_NAME(X86_64_CEL_REDSTONE_XP_CONFIG_INCLUDE_UCLI), __x86_64_cel_redstone_xp_config_STRINGIFY_VALUE(X86_64_CEL_REDSTONE_XP_CONFIG_INCLUDE_UCLI) },
 #else
 { X86_64_CEL_REDSTONE_XP_CONFIG_INCLUDE_UCLI(__x86_64_cel_redstone_xp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef X86_64_CEL_REDSTONE_XP_CONFIG_CPLD_IO_DEV_PORT
+    { __x86_64_cel_redstone_xp_config_STRINGIFY_NAME(X86_64_CEL_REDSTONE_XP_CONFIG_CPLD_IO_DEV_PORT), __x86_64_cel_redstone_xp_config_STRINGIFY_VALUE(X86_64_CEL_REDSTONE_XP_CONFIG_CPLD_IO_DEV_PORT) },
+#else
+{ X86_64_CEL_REDSTONE_XP_CONFIG_CPLD_IO_DEV_PORT(__x86_64_cel_redstone_xp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
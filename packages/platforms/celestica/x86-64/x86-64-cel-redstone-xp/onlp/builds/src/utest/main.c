@@ -0,0 +1,170 @@
+/**************************************************************************//**
+ *
+ * CPLD register layer tests, run against the mock backend.
+ *
+ *****************************************************************************/
+#include <x86_64_cel_redstone_xp/x86_64_cel_redstone_xp_config.h>
+#include <onlp/platformi/sfpi.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <AIM/aim.h>
+
+#include "../module/src/redstone_cpld.h"
+
+#define CHECK(_expr)                                                    \
+    do {                                                                \
+        if(!(_expr)) {                                                  \
+            AIM_DIE("%s:%d: check failed: %s", __FILE__, __LINE__, #_expr); \
+        }                                                               \
+    } while(0)
+
+#define MOCK(_addr) (cpld_io_mock_regs()[(_addr) - CPLD_IO_BASE])
+
+#define MAX_PORT 54
+
+/* Clear the absent bit of a port. */
+static void
+present_set(int reg, int bit)
+{
+    MOCK(reg + bit / 8) &= ~(1 << (bit % 8));
+}
+
+static void
+presence_test(void)
+{
+    int p;
+    onlp_sfp_bitmap_t bmap;
+    static const int present[] = { 1, 18, 27, 28, 48, 49, 54 };
+
+    memset(cpld_io_mock_regs(), 0xFF, CPLD_IO_SIZE);
+    present_set(0x259, 1 - 1);          /* bank 1: 1-18 */
+    present_set(0x259, 18 - 1);
+    present_set(0x2D9, 27 - 19);        /* bank 2: 19-36 */
+    present_set(0x2D9, 28 - 19);
+    present_set(0x3D6, 48 - 37);        /* bank 3: 37-48 */
+    present_set(CPLD_QSFP_ABS_STATUS, 49 - 49);
+    present_set(CPLD_QSFP_ABS_STATUS, 54 - 49);
+
+    onlp_sfp_bitmap_t_init(&bmap);
+    CHECK(onlp_sfpi_presence_bitmap_get(&bmap) == 0);
+
+    for(p = 1; p <= MAX_PORT; p++) {
+        int i, expect = 0;
+        for(i = 0; i < AIM_ARRAYSIZE(present); i++) {
+            if(present[i] == p) {
+                expect = 1;
+            }
+        }
+        if(onlp_sfpi_is_present(p) != expect ||
+           !!AIM_BITMAP_GET(&bmap, p) != expect) {
+            AIM_DIE("port %d: presence is not %d", p, expect);
+        }
+    }
+    CHECK(AIM_BITMAP_GET(&bmap, 0) == 0);
+    CHECK(AIM_BITMAP_GET(&bmap, MAX_PORT + 1) == 0);
+}
+
+static void
+shadow_test(void)
+{
+    memset(cpld_io_mock_regs(), 0, CPLD_IO_SIZE);
+
+    /* The first update reads the register. */
+    cpld_shadow_invalidate();
+    MOCK(CPLD_RESET_CONTROL) = 0xF0;
+    CHECK(cpld_modify(CPLD_RESET_CONTROL, 0xFF, 0x01) == 0);
+    CHECK(MOCK(CPLD_RESET_CONTROL) == 0xF1);
+
+    /* Later updates start from the last written value. */
+    MOCK(CPLD_RESET_CONTROL) = 0x00;
+    CHECK(cpld_modify(CPLD_RESET_CONTROL, (uint8_t)~0x10, 0) == 0);
+    CHECK(MOCK(CPLD_RESET_CONTROL) == 0xE1);
+
+    /* Reads refresh the shadow. */
+    MOCK(CPLD_RESET_CONTROL) = 0x55;
+    CHECK(cpld_read(CPLD_RESET_CONTROL) == 0x55);
+    CHECK(cpld_modify(CPLD_RESET_CONTROL, 0xFF, 0x00) == 0);
+    CHECK(MOCK(CPLD_RESET_CONTROL) == 0x55);
+
+    /* Invalidation forces a read. */
+    cpld_shadow_invalidate();
+    MOCK(CPLD_RESET_CONTROL) = 0x0F;
+    CHECK(cpld_modify(CPLD_RESET_CONTROL, 0xFF, 0x80) == 0);
+    CHECK(MOCK(CPLD_RESET_CONTROL) == 0x8F);
+
+    /* Other registers are always read. */
+    MOCK(CPLD2_REVISION + 0x20) = 0x0F;
+    CHECK(cpld_modify(CPLD2_REVISION + 0x20, 0xFF, 0x30) == 0);
+    MOCK(CPLD2_REVISION + 0x20) = 0x00;
+    CHECK(cpld_modify(CPLD2_REVISION + 0x20, 0xFF, 0x01) == 0);
+    CHECK(MOCK(CPLD2_REVISION + 0x20) == 0x01);
+}
+
+static int
+fail_init__(void)
+{
+    return 0;
+}
+
+static int
+fail_read__(int addr, uint8_t* data, int len)
+{
+    return -1;
+}
+
+static int
+fail_write__(int addr, uint8_t value)
+{
+    return -1;
+}
+
+static const cpld_io_ops_t fail_ops__ = {
+    "fail", fail_init__, fail_read__, fail_write__,
+};
+
+/*
+ * The SFP controller waits must end when the backend fails or the
+ * controller never goes idle.
+ */
+static void
+sfp_wait_test(void)
+{
+    char buf[8];
+
+    /* Bank 1 status register stuck busy. */
+    memset(cpld_io_mock_regs(), 0, CPLD_IO_SIZE);
+    MOCK(0x216) = 0x40;
+    CHECK(read_sfp(1, 0xA0, 0, buf, sizeof(buf)) < 0);
+    CHECK(write_sfp(1, 0xA0, 0, buf, 1) < 0);
+
+    /* Transfer error. The controller is reset. */
+    MOCK(0x216) = 0x80;
+    CHECK(read_sfp(1, 0xA0, 0, buf, sizeof(buf)) < 0);
+    CHECK(MOCK(0x216) == 0x01);
+
+    /* Idle controller. */
+    MOCK(0x216) = 0x00;
+    MOCK(0x230) = 0x03;
+    CHECK(read_sfp(1, 0xA0, 0, buf, 1) == 0 && buf[0] == 0x03);
+
+    CHECK(cpld_io_ops_set(&fail_ops__) == 0);
+    CHECK(cpld_read(CPLD_RESET_CONTROL) < 0);
+    CHECK(read_sfp(1, 0xA0, 0, buf, sizeof(buf)) < 0);
+    CHECK(write_sfp(49, 0xA0, 0, buf, 1) < 0);
+    CHECK(cpld_io_ops_set(&cpld_io_ops_mock) == 0);
+}
+
+int aim_main(int argc, char* argv[])
+{
+    x86_64_cel_redstone_xp_config_show(&aim_pvs_stdout);
+
+    CHECK(cpld_io_ops_set(&cpld_io_ops_mock) == 0);
+    presence_test();
+    shadow_test();
+    sfp_wait_test();
+
+    printf("x86_64_cel_redstone_xp utest passed.\n");
+    return 0;
+}
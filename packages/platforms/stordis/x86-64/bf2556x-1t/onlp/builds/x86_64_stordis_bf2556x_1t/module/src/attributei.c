@@ -27,7 +27,7 @@ onlp_attributei_onie_info_get(onlp_oid_t oid, onlp_onie_info_t* rp)
         return ONLP_STATUS_OK;
     }
 
-    vendor_dev_do_oc(eeprom_o_list[id]);
+    vendor_dev_open(eeprom_dev_list[id].bus, eeprom_o_list[id]);
     if (eeprom_dev_list[id].id == 2)
     {
         rv = eeprom->load(
@@ -44,7 +44,7 @@ onlp_attributei_onie_info_get(onlp_oid_t oid, onlp_onie_info_t* rp)
             eeprom_dev_list[id].addr,
             data);
     }
-    vendor_dev_do_oc(eeprom_c_list[id]);
+    vendor_dev_close(eeprom_dev_list[id].bus, eeprom_c_list[id]);
 
     rv = onlp_onie_decode(rp, data, 256);
     if(rv < 0) return ONLP_STATUS_E_INVALID;
@@ -130,7 +130,7 @@ int onlp_fani_info_get(onlp_oid_t oid, onlp_fan_info_t* info)
         return ONLP_STATUS_OK;
     }
 
-    vendor_dev_do_oc(fan_o_list[id]);
+    vendor_dev_open(fan_dev_list[id].bus, fan_o_list[id]);
     if(fan->rpm_get(
         busDrv, 
         fan_dev_list[id].bus,
@@ -141,7 +141,7 @@ int onlp_fani_info_get(onlp_oid_t oid, onlp_fan_info_t* info)
         info->percentage = 0;
         fail = 1;
     }
-    vendor_dev_do_oc(fan_c_list[id]);
+    vendor_dev_close(fan_dev_list[id].bus, fan_c_list[id]);
 
     if(fail == 1) return ONLP_STATUS_E_INVALID;
 
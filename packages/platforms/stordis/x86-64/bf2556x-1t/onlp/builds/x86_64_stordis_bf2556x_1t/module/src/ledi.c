@@ -76,14 +76,14 @@ onlp_ledi_info_get(onlp_oid_t oid, onlp_led_info_t* info)
     cpld_idx = vendor_find_cpld_idx(sysled_color_list[id]->addr);
     if(cpld_idx < 0) return ONLP_STATUS_E_INTERNAL;
 
-    vendor_dev_do_oc(cpld_o_list[cpld_idx]);
+    vendor_dev_open(sysled_color_list[id]->bus, cpld_o_list[cpld_idx]);
     rv = cpld->readb(
         busDrv,
         sysled_color_list[id]->bus,
         sysled_color_list[id]->addr,
         sysled_color_list[id]->offset,
         &mode);
-    vendor_dev_do_oc(cpld_c_list[cpld_idx]);
+    vendor_dev_close(sysled_color_list[id]->bus, cpld_c_list[cpld_idx]);
 
     if(rv < 0) return ONLP_STATUS_E_INTERNAL;
     curr_mode = sysled_color_list[id];
@@ -116,7 +116,7 @@ onlp_ledi_mode_set(onlp_oid_t oid, onlp_led_mode_t mode)
     cpld_idx = vendor_find_cpld_idx(sysled_color_list[id]->addr);
     if(cpld_idx < 0) return ONLP_STATUS_E_INTERNAL;
 
-    vendor_dev_do_oc(cpld_o_list[cpld_idx]);
+    vendor_dev_open(sysled_color_list[id]->bus, cpld_o_list[cpld_idx]);
     rv = cpld->readb(
         busDrv,
         sysled_color_list[id]->bus,
@@ -133,7 +133,7 @@ onlp_ledi_mode_set(onlp_oid_t oid, onlp_led_mode_t mode)
         sysled_color_list[id]->addr,
         sysled_color_list[id]->offset,
         curr_data);
-    vendor_dev_do_oc(cpld_c_list[cpld_idx]);
+    vendor_dev_close(sysled_color_list[id]->bus, cpld_c_list[cpld_idx]);
 
     if(rv < 0) return ONLP_STATUS_E_INTERNAL;
     
@@ -107,7 +107,7 @@ int onlp_psui_info_get(onlp_oid_t oid, onlp_psu_info_t* info)
         return ONLP_STATUS_OK;
     }
 
-    vendor_dev_do_oc(psu_o_list[id]);
+    vendor_dev_open(psu_dev_list[id].bus, psu_o_list[id]);
     if(psu->model_get(
         busDrv, 
         psu_dev_list[id].bus,
@@ -151,7 +151,7 @@ int onlp_psui_info_get(onlp_oid_t oid, onlp_psu_info_t* info)
     }
 
     info->mpout = mpout;
-    vendor_dev_do_oc(psu_o_list[id]);
+    vendor_dev_close(psu_dev_list[id].bus, psu_c_list[id]);
 
     if(fail == 1) return ONLP_STATUS_E_INVALID;
 
@@ -106,7 +106,7 @@ onlp_sfpi_dev_read(onlp_oid_id_t oid, int devaddr, int addr,
         }
         else
         {
-            vendor_dev_do_oc(sfp_o_list[id]);
+            vendor_dev_open(sfp_dev_list[id].bus, sfp_o_list[id]);
             if(sfp->eeprom_load(
                 busDrv, 
                 sfp_dev_list[id].bus,
@@ -116,14 +116,14 @@ onlp_sfpi_dev_read(onlp_oid_id_t oid, int devaddr, int addr,
                 AIM_LOG_ERROR("sfp->eeprom_load failed.");
                 fail = 1;
             }
-            vendor_dev_do_oc(sfp_c_list[id]);
+            vendor_dev_close(sfp_dev_list[id].bus, sfp_c_list[id]);
 
             if(fail == 1) return ONLP_STATUS_E_INTERNAL;
         }
     }
     else
     {
-        vendor_dev_do_oc(sfp_o_list[id]);
+        vendor_dev_open(sfp_dev_list[id].bus, sfp_o_list[id]);
         if(sfp->eeprom_load(
             busDrv, 
             sfp_dev_list[id].bus,
@@ -133,7 +133,7 @@ onlp_sfpi_dev_read(onlp_oid_id_t oid, int devaddr, int addr,
             AIM_LOG_ERROR("sfp->eeprom_load failed.");
             fail = 1;
         }
-        vendor_dev_do_oc(sfp_c_list[id]);
+        vendor_dev_close(sfp_dev_list[id].bus, sfp_c_list[id]);
 
         if(fail == 1) return ONLP_STATUS_E_INTERNAL;
     }
@@ -168,7 +168,7 @@ onlp_sfpi_dev_readb(onlp_oid_id_t oid, int devaddr, int addr)
         return ONLP_STATUS_E_MISSING;
     }
 
-    vendor_dev_do_oc(sfp_o_list[id]);
+    vendor_dev_open(sfp_dev_list[id].bus, sfp_o_list[id]);
     if(sfp->eeprom_readb(
         busDrv, 
         sfp_dev_list[id].bus,
@@ -179,7 +179,7 @@ onlp_sfpi_dev_readb(onlp_oid_id_t oid, int devaddr, int addr)
         AIM_LOG_ERROR("sfp->eeprom_readb failed.");
         fail = 1;
     }
-    vendor_dev_do_oc(sfp_c_list[id]);
+    vendor_dev_close(sfp_dev_list[id].bus, sfp_c_list[id]);
 
     if(fail == 1) return ONLP_STATUS_E_INTERNAL;
 
@@ -203,7 +203,7 @@ onlp_sfpi_dev_writeb(onlp_oid_id_t oid, int devaddr, int addr, uint8_t value)
         return ONLP_STATUS_E_MISSING;
     }
 
-    vendor_dev_do_oc(sfp_o_list[id]);
+    vendor_dev_open(sfp_dev_list[id].bus, sfp_o_list[id]);
     if(sfp->eeprom_writeb(
         busDrv, 
         sfp_dev_list[id].bus,
@@ -214,7 +214,7 @@ onlp_sfpi_dev_writeb(onlp_oid_id_t oid, int devaddr, int addr, uint8_t value)
         AIM_LOG_ERROR("sfp->eeprom_readb failed.");
         fail = 1;
     }
-    vendor_dev_do_oc(sfp_c_list[id]);
+    vendor_dev_close(sfp_dev_list[id].bus, sfp_c_list[id]);
 
     if(fail == 1) return ONLP_STATUS_E_INTERNAL;
 
@@ -74,7 +74,7 @@ int onlp_thermali_info_get(onlp_oid_t oid, onlp_thermal_info_t* info)
 
     ONLP_OID_INFO_ASSIGN(ONLP_OID_ID_GET(oid), onlp_thermal_info, info);
 
-    vendor_dev_do_oc(thermal_o_list[id]);
+    vendor_dev_open(thermal_dev_list[id].bus, thermal_o_list[id]);
     if(thermal->temp_get(
         busDrv, 
         thermal_dev_list[id].bus,
@@ -85,7 +85,7 @@ int onlp_thermali_info_get(onlp_oid_t oid, onlp_thermal_info_t* info)
         info->mcelsius = 0;
         fail = 1;
     }
-    vendor_dev_do_oc(thermal_c_list[id]);
+    vendor_dev_close(thermal_dev_list[id].bus, thermal_c_list[id]);
 
     if(fail == 1) return ONLP_STATUS_E_INVALID;
 
@@ -27,6 +27,7 @@
 
 #include <onlp/onlp.h>
 #include <onlplib/file.h>
+#include <onlplib/ipmi.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
 #include <errno.h>
@@ -213,32 +214,32 @@ static int smbus_driver_init()
     return vendor_driver_add(driver);
 }
 
+/*
+ * BMC OEM raw I2C commands: (bus, addr, offset, len [, data])
+ * These go straight to /dev/ipmi0 instead of forking ipmitool.
+ */
+#define IPMB_OEM_NETFN      0x3c
+#define IPMB_OEM_CMD_READ   0x01
+#define IPMB_OEM_CMD_WRITE  0x02
+
 static int ipmb_readb(int bus, uint8_t addr, uint16_t offset)
 {
-    int rv = 0, idx = 0;
-    char ipmi_cmd[80], rv_char[256], *delim = " ", *tmp;
-    uint8_t rv_data[32] = {0};
+    int rv = 0;
+    uint8_t rv_data[1] = {0};
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, addr, offset, 1);
-    if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+    rv = onlp_ipmi_oem_i2c_read(IPMB_OEM_NETFN, IPMB_OEM_CMD_READ,
+                                bus, addr, offset, rv_data, 1);
+    if (rv < 0)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Get Data Failed (ret: %d)", ipmi_cmd);
+        AIM_LOG_ERROR("IPMB readb failed bus: %d, addr: %d, offset: %d.",
+            bus, addr, offset);
         return ONLP_STATUS_E_INTERNAL;
     }
- 
-    tmp = strtok(rv_char, delim);
-
-    while (tmp != NULL)
-    {
-        rv_data[idx] = strtol(tmp,NULL,16);
-        tmp = strtok (NULL, delim);
-        idx++;
-    }
 
     rv = rv_data[0] & 0xff;
 
     /*
-    AIM_LOG_ERROR("IPMITOOL readb: bus: %02x, addr: %02x, offset: %02x, value: %x",
+    AIM_LOG_ERROR("IPMB readb: bus: %02x, addr: %02x, offset: %02x, value: %x",
                 bus, addr, offset, rv);
     */
     return rv;
@@ -247,17 +248,18 @@ static int ipmb_readb(int bus, uint8_t addr, uint16_t offset)
 static int ipmb_writeb(int bus, uint8_t addr, uint16_t offset, uint8_t byte)
 {
     int rv = 0;
-    char ipmi_cmd[80];
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x02 %d %d %d %d %d > /dev/null", bus, addr, offset, 1, byte);
-    if (vendor_system_call_set(ipmi_cmd) != 0)
+    rv = onlp_ipmi_oem_i2c_write(IPMB_OEM_NETFN, IPMB_OEM_CMD_WRITE,
+                                 bus, addr, offset, &byte, 1);
+    if (rv < 0)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Set Data Failed.", ipmi_cmd);
+        AIM_LOG_ERROR("IPMB writeb failed bus: %d, addr: %d, offset: %d.",
+            bus, addr, offset);
         return ONLP_STATUS_E_INTERNAL;
     }
     /*else
     {
-        AIM_LOG_ERROR("IPMITOOL writeb: bus: %02x, addr: %02x, offset: %02x, data: %02x",
+        AIM_LOG_ERROR("IPMB writeb: bus: %02x, addr: %02x, offset: %02x, data: %02x",
                 bus, addr, offset, byte);
     }*/
     
@@ -266,30 +268,22 @@ static int ipmb_writeb(int bus, uint8_t addr, uint16_t offset, uint8_t byte)
 
 static int ipmb_readw(int bus, uint8_t addr, uint16_t offset)
 {
-    int rv = 0, idx = 0;
-    char ipmi_cmd[80], rv_char[256], *delim = " ", *tmp;
-    uint16_t rv_data[32] = {0};
+    int rv = 0;
+    uint8_t rv_data[2] = {0};
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, addr, offset, 2);
-    if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+    rv = onlp_ipmi_oem_i2c_read(IPMB_OEM_NETFN, IPMB_OEM_CMD_READ,
+                                bus, addr, offset, rv_data, 2);
+    if (rv < 0)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Get Data Failed.", ipmi_cmd);
+        AIM_LOG_ERROR("IPMB readw failed bus: %d, addr: %d, offset: %d.",
+            bus, addr, offset);
         return ONLP_STATUS_E_INTERNAL;
     }
-        
-    tmp = strtok(rv_char, delim);
-
-    while (tmp != NULL)
-    {
-        rv_data[idx] = strtol(tmp,NULL,16);
-        tmp = strtok (NULL, delim);
-        idx++;
-    }
 
     rv = (rv_data[0] & 0xff) + ((rv_data[1]&0xff) << 8);
 
     /*
-    AIM_LOG_ERROR("IPMITOOL readw: bus: %02x, addr: %02x, offset: %02x, value: %x",
+    AIM_LOG_ERROR("IPMB readw: bus: %02x, addr: %02x, offset: %02x, value: %x",
                 bus, addr, offset, rv);
     */
 
@@ -299,17 +293,19 @@ static int ipmb_readw(int bus, uint8_t addr, uint16_t offset)
 static int ipmb_writew(int bus, uint8_t addr, uint16_t offset, uint16_t word)
 {
     int rv = 0;
-    char ipmi_cmd[80];
+    uint8_t data[2] = { word & 0xff, (word >> 8) & 0xff };
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x02 %d %d %d %d %d > /dev/null", bus, addr, offset, 2, word);
-    if (vendor_system_call_set(ipmi_cmd) != 0)
+    rv = onlp_ipmi_oem_i2c_write(IPMB_OEM_NETFN, IPMB_OEM_CMD_WRITE,
+                                 bus, addr, offset, data, 2);
+    if (rv < 0)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Set Data Failed.", ipmi_cmd);
+        AIM_LOG_ERROR("IPMB writew failed bus: %d, addr: %d, offset: %d.",
+            bus, addr, offset);
         return ONLP_STATUS_E_INTERNAL;
     }
 
     /*
-    AIM_LOG_ERROR("IPMITOOL writew: bus: %02x, addr: %02x, offset: %02x, value: %x",
+    AIM_LOG_ERROR("IPMB writew: bus: %02x, addr: %02x, offset: %02x, value: %x",
                 bus, addr, offset, word);
     */
     
@@ -319,8 +315,7 @@ static int ipmb_writew(int bus, uint8_t addr, uint16_t offset, uint16_t word)
 static int ipmb_block_read(int bus, uint8_t addr, uint16_t offset, int size, uint8_t* rdata)
 {
     int rv = 0, idx = 0;
-    char ipmi_cmd[80], rv_char[256], *delim = " ", *tmp;
-    uint8_t rv_data[32] = {0};
+    uint8_t rv_data[65] = {0};
 
     if (size > 64)
     {
@@ -328,21 +323,15 @@ static int ipmb_block_read(int bus, uint8_t addr, uint16_t offset, int size, uin
         return ONLP_STATUS_E_INTERNAL;
     }
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, addr, offset, size+1);
-    if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+    /* The first byte returned is the block length. */
+    rv = onlp_ipmi_oem_i2c_read(IPMB_OEM_NETFN, IPMB_OEM_CMD_READ,
+                                bus, addr, offset, rv_data, size+1);
+    if (rv < 0)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Block read Failed.", ipmi_cmd);
+        AIM_LOG_ERROR("IPMB block read failed bus: %d, addr: %d, offset: %d.",
+            bus, addr, offset);
         return ONLP_STATUS_E_INTERNAL;
     }
-        
-    tmp = strtok(rv_char, delim);
-
-    while (tmp != NULL)
-    {
-        rv_data[idx] = strtol(tmp,NULL,16);
-        tmp = strtok (NULL, delim);
-        idx++;
-    }
 
     for(idx = 0; idx < size; idx++)
         rdata[idx] = rv_data[idx+1] & 0xff;
@@ -2737,6 +2726,37 @@ int vendor_find_copper_by_name(const char *dev_name)
         return 0;
 }
 
+/* The CPLD pin registers, read once per cache period for all pins. */
+static onlp_devpool_dev_t *cpld_pool = NULL;
+
+static int cpld_pool_init()
+{
+    int idx;
+
+    cpld_pool = (onlp_devpool_dev_t *)calloc(cpld_list_size, sizeof(onlp_devpool_dev_t));
+    if(cpld_pool == NULL) return ONLP_STATUS_E_INTERNAL;
+
+    for(idx = 0; idx < cpld_list_size; idx++)
+    {
+        cpld_pool[idx].name         = cpld_dev_list[idx].dev_name;
+        cpld_pool[idx].driver       = &onlp_devpool_driver_cpld;
+        cpld_pool[idx].bus          = cpld_dev_list[idx].bus;
+        cpld_pool[idx].addr         = cpld_dev_list[idx].addr & 0x7f;
+        cpld_pool[idx].open         = cpld_o_list[idx];
+        cpld_pool[idx].close        = cpld_c_list[idx];
+        cpld_pool[idx].window_offset = 0x00;
+        cpld_pool[idx].window_size  = 0x10;
+        cpld_pool[idx].flags        = ONLP_I2C_F_FORCE;
+    }
+
+    return 0;
+}
+
+void vendor_cpld_pool_show(aim_pvs_t *pvs)
+{
+    if(cpld_pool) onlp_devpool_show(pvs, cpld_pool, cpld_list_size);
+}
+
 int vendor_driver_init()
 {
     smbus_driver_init();
@@ -2756,47 +2776,28 @@ int vendor_driver_init()
     bmc_thrml_driver_init();
     bmc_present_get_driver_init();
 
-    return 0;
+    return cpld_pool_init();
 }
 
 int vendor_dev_do_oc(vendor_dev_oc_t *dev_oc)
 {
-    //AIM_LOG_ERROR("Function: %s", __FUNCTION__);
-    int rv = 0;
-
-    if(dev_oc == NULL)
-    {
-        /*NO NEED */
-        return rv;
-    }
-
-    while (dev_oc->type != 0)
-    {
-        if(dev_oc->type == 1)
-        {
-            rv = smbus_writeb(dev_oc->bus, dev_oc->addr, dev_oc->offset, dev_oc->value);
-        }
-        else if (dev_oc->type == 2)
-        {
-            rv = smbus_readb(dev_oc->bus, dev_oc->addr, dev_oc->offset);
-            if(rv < 0) return rv;
-
-            rv &= ~dev_oc->mask;
-            rv |= (dev_oc->match & dev_oc->mask);
+    return onlp_devpool_steps_run(dev_oc);
+}
 
-            rv = smbus_writeb(dev_oc->bus, dev_oc->addr, dev_oc->offset, rv);
-        }
-        else
-        {
-            AIM_LOG_ERROR("Function: %s, unknown oc type. \n", __FUNCTION__);
-            rv = -1;
-        }
-        
-        if(rv < 0) return rv;
-        
-        dev_oc++;
-    }
+/*
+ * The step lists share the bus with the device pool, so hold its bus
+ * lock from the open steps until the close steps have run.
+ */
+int vendor_dev_open(int bus, vendor_dev_oc_t *dev_oc)
+{
+    onlp_devpool_bus_lock(bus);
+    return onlp_devpool_steps_run(dev_oc);
+}
 
+int vendor_dev_close(int bus, vendor_dev_oc_t *dev_oc)
+{
+    int rv = onlp_devpool_steps_run(dev_oc);
+    onlp_devpool_bus_unlock(bus);
     return rv;
 }
 
@@ -2830,17 +2831,17 @@ int vendor_get_present_status(vendor_dev_io_pin_t *present_info, int *present)
             return 0;
         }
 
-        bus    = present_info->bus;
-        addr   = present_info->addr & 0x7f;
-        offset = present_info->offset;
-
-        busDrv = (void *)vendor_find_driver_by_name("I2C");
-        pg = (present_get_driver_t *) vendor_find_driver_by_name("CPLD");
-
         cpld_idx = vendor_find_cpld_idx(present_info->addr);
-        if(cpld_idx < 0) return ONLP_STATUS_E_INTERNAL;
+        if(cpld_idx < 0 || cpld_pool == NULL) return ONLP_STATUS_E_INTERNAL;
 
-        vendor_dev_do_oc(cpld_o_list[cpld_idx]);
+        rv = onlp_devpool_pin_get(&cpld_pool[cpld_idx],
+                                  present_info->offset,
+                                  present_info->mask,
+                                  present_info->match);
+        if(rv < 0) return rv;
+
+        *present = rv;
+        return 0;
     }
     else if(present_info->type == BMC_DEV)
     {
@@ -2864,12 +2865,6 @@ int vendor_get_present_status(vendor_dev_io_pin_t *present_info, int *present)
             offset,
             (uint8_t *) present);
 
-    if(present_info->type == CPLD_DEV)
-    {
-        vendor_dev_do_oc(cpld_c_list[cpld_idx]);
-        *present = ((rv & present_info->mask) == present_info->match) ? 1 : 0;
-    }
-
     return rv;
 }
 
@@ -29,6 +29,7 @@
 #include <onlp/onlp.h>
 #include <onlplib/file.h>
 #include <onlplib/i2c.h>
+#include <onlplib/devpool.h>
 #include <onlp/platformi/base.h>
 #include <sys/mman.h>
 #include <errno.h>
@@ -53,16 +54,8 @@ typedef struct
     int id;
 }vendor_dev_t;
 
-typedef struct
-{
-    int type; /* 2 -> CPLD; 1 -> MUX; 0 -> invalid */
-    int bus;
-	uint8_t addr;
-    uint8_t offset; /* FOR CPLD & MUX */
-    uint8_t value;  /* FOR CPLD & MUX */
-    uint8_t mask;   /* FOR CPLD */
-    uint8_t match;  /* FOR CPLD */
-}vendor_dev_oc_t;
+/* 2 -> CPLD (modify); 1 -> MUX (write); 0 -> end of list */
+typedef onlp_devpool_step_t vendor_dev_oc_t;
 
 typedef struct
 {
@@ -206,7 +199,10 @@ int vendor_system_call_set(char *cmd);
 int vendor_driver_init();
 void *vendor_find_driver_by_name(const char *driver_name);
 int vendor_dev_do_oc(vendor_dev_oc_t *dev_oc);
+int vendor_dev_open(int bus, vendor_dev_oc_t *dev_oc);
+int vendor_dev_close(int bus, vendor_dev_oc_t *dev_oc);
 int vendor_get_present_status(vendor_dev_io_pin_t *present_info, int *present);
+void vendor_cpld_pool_show(aim_pvs_t *pvs);
 int vendor_find_copper_by_name(const char *dev_name);
 
 #endif /* __VENDOR_DRIVER_POOL_H__ */